@@ -0,0 +1,172 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#else
+#include "config.h"
+#endif
+
+#include "BinaryLog.h"
+#include "FieldConvertors.h"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <set>
+
+#include "../../src/getopt-repl.h"
+
+typedef std::map < std::string, std::ofstream* > Files;
+
+std::string getMsgType( const std::string& value )
+{
+  std::string::size_type begin = value.find( "\00135=" );
+  if( begin == std::string::npos ) return "";
+  begin += 4;
+  std::string::size_type end = value.find( '\001', begin );
+  if( end == std::string::npos ) return "";
+  return value.substr( begin, end - begin );
+}
+
+std::set < std::string > split( const std::string& value )
+{
+  std::set < std::string > result;
+  std::string::size_type begin = 0;
+  while( begin <= value.size() )
+  {
+    std::string::size_type end = value.find( ',', begin );
+    if( end == std::string::npos ) end = value.size();
+    if( end > begin ) result.insert( value.substr( begin, end - begin ) );
+    begin = end + 1;
+  }
+  return result;
+}
+
+std::ofstream& getFile( Files& files, const std::string& name )
+{
+  Files::iterator i = files.find( name );
+  if( i != files.end() ) return *i->second;
+  std::ofstream* pFile = new std::ofstream( name.c_str(), std::ios::out | std::ios::app );
+  if( !pFile->is_open() )
+  {
+    delete pFile;
+    throw FIX::ConfigError( "Could not open file: " + name );
+  }
+  files[ name ] = pFile;
+  return *pFile;
+}
+
+int main( int argc, char** argv )
+{
+  std::string file;
+  std::string path;
+  std::string types = "IOE";
+  std::set < std::string > sessions;
+  std::set < std::string > msgTypes;
+  bool hasBegin = false;
+  bool hasEnd = false;
+  FIX::UtcTimeStamp begin;
+  FIX::UtcTimeStamp end;
+
+  try
+  {
+    int opt;
+    while ( ( opt = getopt( argc, argv, "f:o:s:m:t:b:e:" ) ) != -1 )
+    {
+      switch( opt )
+      {
+      case 'f': file = optarg; break;
+      case 'o': path = optarg; break;
+      case 's': sessions = split( optarg ); break;
+      case 'm': msgTypes = split( optarg ); break;
+      case 't': types = optarg; break;
+      case 'b': begin = FIX::UtcTimeStampConvertor::convert( optarg, true ); hasBegin = true; break;
+      case 'e': end = FIX::UtcTimeStampConvertor::convert( optarg, true ); hasEnd = true; break;
+      default: file.clear(); opt = -1; break;
+      }
+      if( opt == -1 ) break;
+    }
+  }
+  catch ( std::exception & e )
+  {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+
+  if ( !file.size() )
+  {
+    std::cout << "usage: " << argv[ 0 ]
+    << " -f FILE [-o PATH] [-s SESSION,...] [-m MSGTYPE,...]"
+    << " [-t IOE] [-b TIME] [-e TIME]" << std::endl
+    << "  -o  write FileLog files to PATH instead of the standard output" << std::endl
+    << "  -s  only the given sessions, named like FileLog files" << std::endl
+    << "  -m  only messages of the given MsgTypes" << std::endl
+    << "  -t  entry types, Incoming, Outgoing and Event" << std::endl
+    << "  -b  only entries at or after TIME, YYYYMMDD-HH:MM:SS[.sss]" << std::endl
+    << "  -e  only entries before TIME" << std::endl;
+    return 1;
+  }
+
+  Files files;
+  int result = 0;
+  try
+  {
+    FIX::BinaryLogReader reader( file );
+    if( path.size() ) FIX::file_mkdir( path.c_str() );
+
+    FIX::BinaryLogReader::Entry entry;
+    while( reader.next( entry ) )
+    {
+      if( types.find( (char)entry.m_type ) == std::string::npos ) continue;
+      if( sessions.size() && !sessions.count( entry.m_session ) ) continue;
+      if( hasBegin && entry.m_time < begin ) continue;
+      if( hasEnd && !( entry.m_time < end ) ) continue;
+      if( msgTypes.size() )
+      {
+        if( entry.m_type == FIX::BinaryLogFile::EVENT ) continue;
+        if( !msgTypes.count( getMsgType( entry.m_value ) ) ) continue;
+      }
+
+      std::string time = FIX::UtcTimeStampConvertor::convert( entry.m_time, true );
+      if( path.size() )
+      {
+        std::string name = entry.m_session + "."
+          + ( entry.m_type == FIX::BinaryLogFile::EVENT ? "event" : "messages" )
+          + ".current.log";
+        getFile( files, FIX::file_appendpath( path, name ) )
+          << time << " : " << entry.m_value << std::endl;
+      }
+      else
+      {
+        std::cout << time << " " << entry.m_session << " "
+                  << (char)entry.m_type << " : " << entry.m_value << std::endl;
+      }
+    }
+  }
+  catch ( std::exception & e )
+  {
+    std::cout << e.what() << std::endl;
+    result = 1;
+  }
+
+  for( Files::iterator i = files.begin(); i != files.end(); ++i )
+    delete i->second;
+  return result;
+}
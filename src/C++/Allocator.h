@@ -0,0 +1 @@
+/* Empty file generated by cmake, can be replaced by a custom file */
@@ -61,6 +61,9 @@ public:
   /// Notification of app message being received from target
   virtual void fromApp( const Message&, const SessionID& )
   throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType ) = 0;
+  /// Notification of the send queue falling below its low water mark
+  /// after Session::trySend returned WouldBlock
+  virtual void onSendQueueDrained( const SessionID& ) {}
 };
 
 /**
@@ -95,6 +98,8 @@ public:
   void fromApp( const Message& message, const SessionID& sessionID )
   throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType )
   { Locker l( m_mutex ); app().fromApp( message, sessionID ); }
+  void onSendQueueDrained( const SessionID& sessionID )
+  { Locker l( m_mutex ); app().onSendQueueDrained( sessionID ); }
 
   Mutex m_mutex;
 
@@ -0,0 +1,484 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "AsyncStore.h"
+#include <limits>
+
+namespace FIX
+{
+AsyncStoreFactory::AsyncStoreFactory( MessageStoreFactory& factory )
+: m_factory( factory ), m_started( false ), m_stop( 0 ), m_stopped( false )
+{
+  m_started = thread_spawn( &writerThread, this, m_thread );
+  m_stopped = !m_started;
+}
+
+AsyncStoreFactory::~AsyncStoreFactory()
+{
+  stop();
+}
+
+MessageStore* AsyncStoreFactory::create( const SessionID& s )
+{
+  MessageStore* pStore = m_factory.create( s );
+  AsyncStore* pAsyncStore = 0;
+  try
+  {
+    pAsyncStore = new AsyncStore( pStore, *this );
+  }
+  catch( IOException& )
+  {
+    m_factory.destroy( pStore );
+    throw;
+  }
+
+  Locker l( m_mutex );
+  m_stores.insert( pAsyncStore );
+  return pAsyncStore;
+}
+
+void AsyncStoreFactory::destroy( MessageStore* pStore )
+{
+  AsyncStore* pAsyncStore = static_cast < AsyncStore* > ( pStore );
+
+  {
+    Locker l( m_mutex );
+    m_stores.erase( pAsyncStore );
+  }
+
+  // the writer may still be busy with this store, it is skipped afterwards
+  {
+    Locker l( m_writerMutex );
+  }
+
+  pAsyncStore->drain();
+  m_factory.destroy( pAsyncStore->getStore() );
+  delete pAsyncStore;
+}
+
+void AsyncStoreFactory::flush() throw ( IOException )
+{
+  Locker writerLocker( m_writerMutex );
+
+  Stores stores;
+  {
+    Locker l( m_mutex );
+    stores = m_stores;
+  }
+
+  // every store is written even if one of them fails
+  std::string error;
+  Stores::const_iterator i;
+  for( i = stores.begin(); i != stores.end(); ++i )
+  {
+    try
+    {
+      (*i)->flush();
+    }
+    catch( IOException& e )
+    {
+      if( error.empty() ) error = e.what();
+    }
+  }
+
+  if( error.size() )
+    throw IOException( error );
+}
+
+void AsyncStoreFactory::stop()
+{
+  {
+    Locker l( m_mutex );
+    if( m_stop ) return;
+    ++m_stop;
+  }
+  m_ready.signal();
+
+  if( m_started )
+    thread_join( m_thread );
+  m_started = false;
+
+  // anything changed from now on is written by the caller
+  Locker l( m_mutex );
+  m_stopped = true;
+  AsyncStore* pStore = 0;
+  while( m_ready.pop( pStore ) ) {}
+
+  Stores::const_iterator i;
+  for( i = m_stores.begin(); i != m_stores.end(); ++i )
+    (*i)->drain();
+}
+
+void AsyncStoreFactory::schedule( AsyncStore* pStore )
+{
+  Locker l( m_mutex );
+  if( m_stopped )
+    pStore->drain();
+  else
+    m_ready.push( pStore );
+}
+
+void AsyncStoreFactory::run()
+{
+  while( true )
+  {
+    AsyncStore* pStore = 0;
+    if( !m_ready.pop( pStore ) )
+    {
+      if( m_stop ) return;
+      m_ready.wait( 1 );
+      continue;
+    }
+
+    Locker writerLocker( m_writerMutex );
+    {
+      Locker l( m_mutex );
+      if( m_stores.find( pStore ) == m_stores.end() )
+        continue;
+    }
+    pStore->drain();
+  }
+}
+
+THREAD_PROC AsyncStoreFactory::writerThread( void* p )
+{
+  AsyncStoreFactory* pFactory = static_cast < AsyncStoreFactory* > ( p );
+  pFactory->run();
+  return 0;
+}
+
+AsyncStore::AsyncStore( MessageStore* pStore, AsyncStoreFactory& factory )
+throw ( IOException )
+: m_pStore( pStore ), m_factory( factory ), m_lastId( 0 ),
+  m_nextSenderMsgSeqNum( 1 ), m_nextTargetMsgSeqNum( 1 ),
+  m_senderChanged( false ), m_targetChanged( false ), m_scheduled( false )
+{
+  load();
+}
+
+AsyncStore::~AsyncStore()
+{
+}
+
+bool AsyncStore::set( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    throwError();
+
+    Pending& pending = m_overlay[ msgSeqNum ];
+    pending.m_msg = msg;
+    pending.m_id = ++m_lastId;
+    m_writes.push_back( std::make_pair( msgSeqNum, pending.m_id ) );
+    if( !schedule() ) return true;
+  }
+
+  m_factory.schedule( this );
+  return true;
+}
+
+void AsyncStore::get( int begin, int end,
+                      std::vector < std::string > & result ) const
+throw ( IOException )
+{
+  result.clear();
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void AsyncStore::getRange( int begin, int end,
+                           MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  Locker writeLocker( m_writeMutex );
+
+  // messages of an earlier batch are already in the wrapped store
+  Messages messages;
+  {
+    Locker l( m_mutex );
+    Overlay::const_iterator i = m_overlay.lower_bound( begin );
+    for( ; i != m_overlay.end() && i->first <= end; ++i )
+      messages[ i->first ] = i->second.m_msg;
+  }
+
+  if( messages.empty() )
+  {
+    m_pStore->getRange( begin, end, visitor );
+    return;
+  }
+
+  Merger merger( messages, visitor );
+  m_pStore->getRange( begin, end, merger );
+  merger.finish();
+}
+
+int AsyncStore::getNextSenderMsgSeqNum() const throw ( IOException )
+{
+  Locker l( m_mutex );
+  return m_nextSenderMsgSeqNum;
+}
+
+int AsyncStore::getNextTargetMsgSeqNum() const throw ( IOException )
+{
+  Locker l( m_mutex );
+  return m_nextTargetMsgSeqNum;
+}
+
+void AsyncStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    m_nextSenderMsgSeqNum = value;
+    m_senderChanged = true;
+    if( !schedule() ) return;
+  }
+  m_factory.schedule( this );
+}
+
+void AsyncStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    m_nextTargetMsgSeqNum = value;
+    m_targetChanged = true;
+    if( !schedule() ) return;
+  }
+  m_factory.schedule( this );
+}
+
+void AsyncStore::incrNextSenderMsgSeqNum() throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    ++m_nextSenderMsgSeqNum;
+    m_senderChanged = true;
+    if( !schedule() ) return;
+  }
+  m_factory.schedule( this );
+}
+
+void AsyncStore::incrNextTargetMsgSeqNum() throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    ++m_nextTargetMsgSeqNum;
+    m_targetChanged = true;
+    if( !schedule() ) return;
+  }
+  m_factory.schedule( this );
+}
+
+UtcTimeStamp AsyncStore::getCreationTime() const throw ( IOException )
+{
+  Locker l( m_mutex );
+  return m_creationTime;
+}
+
+void AsyncStore::reset() throw ( IOException )
+{
+  Locker writeLocker( m_writeMutex );
+
+  // nothing queued before a reset is worth writing
+  {
+    Locker l( m_mutex );
+    m_overlay.clear();
+    m_writes.clear();
+    m_senderChanged = false;
+    m_targetChanged = false;
+    m_error.clear();
+  }
+
+  m_pStore->reset();
+  load();
+}
+
+void AsyncStore::refresh() throw ( IOException )
+{
+  Locker writeLocker( m_writeMutex );
+
+  write();
+  {
+    Locker l( m_mutex );
+    throwError();
+  }
+
+  m_pStore->refresh();
+  load();
+}
+
+void AsyncStore::flush() throw ( IOException )
+{
+  drain();
+
+  Locker l( m_mutex );
+  throwError();
+}
+
+int AsyncStore::getPending() const
+{
+  Locker l( m_mutex );
+  return m_overlay.size();
+}
+
+void AsyncStore::load() throw ( IOException )
+{
+  int sender = m_pStore->getNextSenderMsgSeqNum();
+  int target = m_pStore->getNextTargetMsgSeqNum();
+  UtcTimeStamp creationTime = m_pStore->getCreationTime();
+
+  Locker l( m_mutex );
+  m_nextSenderMsgSeqNum = sender;
+  m_nextTargetMsgSeqNum = target;
+  m_creationTime = creationTime;
+}
+
+bool AsyncStore::schedule()
+{
+  if( m_scheduled ) return false;
+  m_scheduled = true;
+  return true;
+}
+
+void AsyncStore::drain()
+{
+  Locker writeLocker( m_writeMutex );
+  write();
+}
+
+void AsyncStore::write()
+{
+  std::vector < Write > writes;
+  int sender = 0;
+  int target = 0;
+
+  // take everything queued so far, the session keeps appending
+  {
+    Locker l( m_mutex );
+    m_scheduled = false;
+
+    writes.reserve( m_writes.size() );
+    Writes::const_iterator i;
+    for( i = m_writes.begin(); i != m_writes.end(); ++i )
+    {
+      // a message set again is written with the later write
+      Overlay::const_iterator pending = m_overlay.find( i->first );
+      if( pending == m_overlay.end() || pending->second.m_id != i->second )
+        continue;
+      writes.push_back( Write() );
+      writes.back().m_msgSeqNum = i->first;
+      writes.back().m_id = i->second;
+      writes.back().m_msg = pending->second.m_msg;
+    }
+    m_writes.clear();
+
+    if( m_senderChanged ) sender = m_nextSenderMsgSeqNum;
+    if( m_targetChanged ) target = m_nextTargetMsgSeqNum;
+    m_senderChanged = false;
+    m_targetChanged = false;
+  }
+
+  std::string error;
+  std::size_t written = 0;
+  try
+  {
+    for( ; written < writes.size(); ++written )
+      m_pStore->set( writes[ written ].m_msgSeqNum, writes[ written ].m_msg );
+    if( sender )
+    {
+      m_pStore->setNextSenderMsgSeqNum( sender );
+      sender = 0;
+    }
+    if( target )
+    {
+      m_pStore->setNextTargetMsgSeqNum( target );
+      target = 0;
+    }
+    // stores batching their writes write each batch at once
+    m_pStore->flush();
+  }
+  catch( IOException& e )
+  {
+    error = e.what();
+  }
+
+  Locker l( m_mutex );
+  for( std::size_t i = 0; i < written; ++i )
+  {
+    Overlay::iterator pending = m_overlay.find( writes[ i ].m_msgSeqNum );
+    if( pending != m_overlay.end() && pending->second.m_id == writes[ i ].m_id )
+      m_overlay.erase( pending );
+  }
+
+  if( error.empty() ) return;
+
+  // keep what failed in front of anything queued meanwhile
+  for( std::size_t i = writes.size(); i > written; --i )
+  {
+    const Write& failed = writes[ i - 1 ];
+    m_writes.push_front( std::make_pair( failed.m_msgSeqNum, failed.m_id ) );
+  }
+  if( sender ) m_senderChanged = true;
+  if( target ) m_targetChanged = true;
+  m_error = error;
+}
+
+void AsyncStore::throwError() throw ( IOException )
+{
+  if( m_error.empty() ) return;
+
+  std::string error;
+  error.swap( m_error );
+  throw IOException( error );
+}
+
+bool AsyncStore::Merger::onMessage
+( int msgSeqNum, const char* data, std::size_t length )
+{
+  bool replaced = false;
+  if( !visitPending( msgSeqNum, replaced ) ) return false;
+  if( replaced ) return true;
+  return m_continue = m_visitor.onMessage( msgSeqNum, data, length );
+}
+
+void AsyncStore::Merger::finish()
+{
+  bool replaced = false;
+  if( m_continue )
+    visitPending( std::numeric_limits < int > ::max(), replaced );
+}
+
+bool AsyncStore::Merger::visitPending( int last, bool& replaced )
+{
+  for( ; m_i != m_end && m_i->first <= last; ++m_i )
+  {
+    replaced = m_i->first == last;
+    m_continue = m_visitor.onMessage
+      ( m_i->first, m_i->second.data(), m_i->second.size() );
+    if( !m_continue ) return false;
+  }
+  return true;
+}
+}
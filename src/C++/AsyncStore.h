@@ -0,0 +1,197 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+
+#ifndef FIX_ASYNCSTORE_H
+#define FIX_ASYNCSTORE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "MessageStore.h"
+#include "Queue.h"
+#include "Mutex.h"
+#include "AtomicCount.h"
+#include "Utility.h"
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+class AsyncStore;
+
+/**
+ * Creates an AsyncStore in front of each store of another MessageStoreFactory.
+ *
+ * One writer thread serves all stores created by this factory, writing the
+ * queued changes of one store at a time in the order they were made.
+ * Destroying a store writes everything it still holds before the wrapped
+ * store is destroyed.
+ */
+class AsyncStoreFactory : public MessageStoreFactory
+{
+public:
+  AsyncStoreFactory( MessageStoreFactory& factory );
+  virtual ~AsyncStoreFactory();
+
+  MessageStore* create( const SessionID& );
+  void destroy( MessageStore* );
+
+  /// Waits until the queued changes of all stores are written
+  void flush() throw ( IOException );
+  /// Writes the queued changes and stops the writer, later ones are synchronous
+  void stop();
+
+private:
+  friend class AsyncStore;
+  typedef std::set < AsyncStore* > Stores;
+
+  void schedule( AsyncStore* pStore );
+  void run();
+
+  static THREAD_PROC writerThread( void* p );
+
+  MessageStoreFactory& m_factory;
+  Stores m_stores;
+  Queue < AsyncStore* > m_ready;
+  thread_id m_thread;
+  bool m_started;
+  /// Polled by the writer without a lock
+  atomic_count m_stop;
+  bool m_stopped;
+  Mutex m_mutex;
+  Mutex m_writerMutex;
+};
+/*! @} */
+
+/**
+ * Hands the writes to another MessageStore to a background thread.
+ *
+ * Stored messages and sequence number changes are queued and return at
+ * once, the sequence numbers and creation time are answered from memory.
+ * Messages stay readable until they are written, reads merge them with the
+ * ones in the wrapped store.  Only the latest sequence numbers are written,
+ * after the messages queued before them.
+ *
+ * A failed write is kept and tried again with the next batch, the error is
+ * thrown by the following set or flush.  reset and refresh wait for the
+ * writer and run synchronously, flush is the barrier for everything else.
+ */
+class AsyncStore : public MessageStore
+{
+public:
+  AsyncStore( MessageStore* pStore, AsyncStoreFactory& factory )
+  throw ( IOException );
+  virtual ~AsyncStore();
+
+  bool set( int, const std::string& ) throw ( IOException );
+  void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
+
+  int getNextSenderMsgSeqNum() const throw ( IOException );
+  int getNextTargetMsgSeqNum() const throw ( IOException );
+  void setNextSenderMsgSeqNum( int value ) throw ( IOException );
+  void setNextTargetMsgSeqNum( int value ) throw ( IOException );
+  void incrNextSenderMsgSeqNum() throw ( IOException );
+  void incrNextTargetMsgSeqNum() throw ( IOException );
+
+  UtcTimeStamp getCreationTime() const throw ( IOException );
+
+  void reset() throw ( IOException );
+  void refresh() throw ( IOException );
+  void flush() throw ( IOException );
+
+  MessageStore* getStore() { return m_pStore; }
+  /// Number of messages not yet written to the wrapped store
+  int getPending() const;
+
+private:
+  friend class AsyncStoreFactory;
+
+  /// A message waiting to be written, m_id tells apart later sets of it
+  struct Pending
+  {
+    std::string m_msg;
+    unsigned long m_id;
+  };
+
+  struct Write
+  {
+    int m_msgSeqNum;
+    unsigned long m_id;
+    std::string m_msg;
+  };
+
+  typedef std::map < int, Pending > Overlay;
+  typedef std::map < int, std::string > Messages;
+  typedef std::deque < std::pair < int, unsigned long > > Writes;
+
+  /// Passes stored messages on, replacing them by and adding unwritten ones
+  class Merger : public MessageStoreVisitor
+  {
+  public:
+    Merger( const Messages& messages, MessageStoreVisitor& visitor )
+    : m_i( messages.begin() ), m_end( messages.end() ),
+      m_visitor( visitor ), m_continue( true ) {}
+
+    bool onMessage( int msgSeqNum, const char* data, std::size_t length );
+    void finish();
+
+  private:
+    bool visitPending( int last, bool& replaced );
+
+    Messages::const_iterator m_i;
+    Messages::const_iterator m_end;
+    MessageStoreVisitor& m_visitor;
+    bool m_continue;
+  };
+
+  void load() throw ( IOException );
+  bool schedule();
+  void drain();
+  void write();
+  void throwError() throw ( IOException );
+
+  MessageStore* m_pStore;
+  AsyncStoreFactory& m_factory;
+
+  Overlay m_overlay;
+  Writes m_writes;
+  unsigned long m_lastId;
+  int m_nextSenderMsgSeqNum;
+  int m_nextTargetMsgSeqNum;
+  bool m_senderChanged;
+  bool m_targetChanged;
+  UtcTimeStamp m_creationTime;
+  std::string m_error;
+  bool m_scheduled;
+
+  mutable Mutex m_mutex;
+  /// Held while the wrapped store is used, orders the batches
+  mutable Mutex m_writeMutex;
+};
+}
+
+#endif //FIX_ASYNCSTORE_H
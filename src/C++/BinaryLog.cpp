@@ -0,0 +1,276 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "BinaryLog.h"
+#include <string.h>
+
+namespace FIX
+{
+static std::string generatePrefix( const SessionID& s )
+{
+  std::string prefix = s.getBeginString().getString() + "-"
+                       + s.getSenderCompID().getString() + "-"
+                       + s.getTargetCompID().getString();
+  if( s.getSessionQualifier().size() )
+    prefix += "-" + s.getSessionQualifier();
+  return prefix;
+}
+
+BinaryLogFactory::~BinaryLogFactory()
+{
+  delete m_pFile;
+}
+
+Log* BinaryLogFactory::create()
+{
+  Locker locker( m_mutex );
+  Dictionary settings;
+  if( !m_path.size() ) settings = m_settings.get();
+  return new BinaryLog( getFile( settings ), "GLOBAL" );
+}
+
+Log* BinaryLogFactory::create( const SessionID& s )
+{
+  Locker locker( m_mutex );
+  Dictionary settings;
+  if( !m_path.size() ) settings = m_settings.get( s );
+  return new BinaryLog( getFile( settings ), generatePrefix( s ) );
+}
+
+void BinaryLogFactory::destroy( Log* pLog )
+{
+  delete pLog;
+}
+
+BinaryLogFile& BinaryLogFactory::getFile( const Dictionary& settings )
+{
+  // the first log created opens the file shared by all of them
+  if( !m_pFile )
+  {
+    std::string path = m_path;
+    if( !path.size() ) path = settings.getString( BINARY_LOG_PATH );
+    m_pFile = new BinaryLogFile( path );
+  }
+  return *m_pFile;
+}
+
+BinaryLogFile::BinaryLogFile( const std::string& path ) throw ( ConfigError )
+: m_file( 0 ), m_sessions( 0 )
+{
+  file_mkdir( path.c_str() );
+  m_fileName = file_appendpath( path, "messages.binlog" );
+
+  m_file = file_fopen( m_fileName.c_str(), "r+b" );
+  if ( !m_file ) m_file = file_fopen( m_fileName.c_str(), "w+b" );
+  if ( !m_file ) throw ConfigError( "Could not open binary log file: " + m_fileName );
+
+  try
+  {
+    open();
+  }
+  catch( ConfigError& )
+  {
+    fclose( m_file );
+    throw;
+  }
+}
+
+void BinaryLogFile::open() throw ( ConfigError )
+{
+  if( file_seek( m_file, 0, SEEK_END ) )
+    throw ConfigError( "Could not seek in binary log file: " + m_fileName );
+  int64_t size = file_tell( m_file );
+  rewind( m_file );
+
+  char magic[ 8 ];
+  size_t length = size < 8 ? (size_t)size : 8;
+  if( fread( magic, 1, length, m_file ) != length
+      || memcmp( magic, getMagic(), length ) != 0 )
+    throw ConfigError( "Not a binary log file: " + m_fileName );
+
+  // entries are appended after the last one that was written completely,
+  // a partial entry left by a crash would put every later one out of frame
+  int64_t end = 8;
+  Header header;
+  while( size >= 8 && file_seek( m_file, end, SEEK_SET ) == 0
+         && fread( &header, sizeof(header), 1, m_file ) == 1
+         && isValid( header, size - end - (int64_t)sizeof(header) ) )
+  {
+    end += sizeof(header) + header.m_length;
+  }
+
+  if( size < 8 ) end = 0;
+  if( ( end < size && !file_truncate( m_file, end ) )
+      || file_seek( m_file, end, SEEK_SET ) )
+    throw ConfigError( "Could not truncate binary log file: " + m_fileName );
+
+  if( end == 0 )
+  {
+    fwrite( getMagic(), 1, 8, m_file );
+    fflush( m_file );
+  }
+}
+
+BinaryLogFile::~BinaryLogFile()
+{
+  if( m_file ) fclose( m_file );
+}
+
+int BinaryLogFile::addSession( const std::string& name )
+{
+  Locker locker( m_mutex );
+  if( m_sessions > 0xFFFF )
+    throw ConfigError( "Too many sessions in binary log file: " + m_fileName );
+
+  int session = m_sessions++;
+  Header header = { (uint32_t)name.size(), (uint16_t)session, SESSION, 0,
+                    toNanos( UtcTimeStamp() ) };
+  fwrite( &header, sizeof(header), 1, m_file );
+  fwrite( name.data(), 1, name.size(), m_file );
+  fflush( m_file );
+  return session;
+}
+
+void BinaryLogFile::write( int session, Type type, const std::string& value )
+{
+  Header header = { (uint32_t)value.size(), (uint16_t)session, (char)type, 0,
+                    toNanos( UtcTimeStamp() ) };
+
+  Locker locker( m_mutex );
+  fwrite( &header, sizeof(header), 1, m_file );
+  fwrite( value.data(), 1, value.size(), m_file );
+  fflush( m_file );
+}
+
+bool BinaryLogFile::isValid( const Header& header, int64_t remaining )
+{
+  switch( header.m_type )
+  {
+  case SESSION: case INCOMING: case OUTGOING: case EVENT:
+    return header.m_length <= remaining;
+  default:
+    return false;
+  }
+}
+
+const char* BinaryLogFile::getMagic()
+{
+  return "QFBLOG1";
+}
+
+int64_t BinaryLogFile::toNanos( const UtcTimeStamp& time )
+{
+  return (int64_t)( time.getJulianDate() - DateTime::JULIAN_19700101 )
+         * DateTime::NANOS_PER_DAY + time.m_time;
+}
+
+UtcTimeStamp BinaryLogFile::fromNanos( int64_t nanos )
+{
+  UtcTimeStamp time;
+  time.set( (int)( nanos / DateTime::NANOS_PER_DAY ) + DateTime::JULIAN_19700101,
+            nanos % DateTime::NANOS_PER_DAY );
+  return time;
+}
+
+BinaryLog::BinaryLog( BinaryLogFile& file, const std::string& name )
+: m_file( file ), m_session( file.addSession( name ) )
+{
+}
+
+BinaryLogReader::BinaryLogReader( const std::string& fileName ) throw ( ConfigError )
+: m_file( 0 ), m_offset( 8 ), m_size( 0 )
+{
+  m_file = file_fopen( fileName.c_str(), "rb" );
+  if ( !m_file ) throw ConfigError( "Could not open binary log file: " + fileName );
+
+  char magic[ 8 ];
+  if( fread( magic, 1, 8, m_file ) != 8
+      || memcmp( magic, BinaryLogFile::getMagic(), 8 ) != 0 )
+  {
+    fclose( m_file );
+    throw ConfigError( "Not a binary log file: " + fileName );
+  }
+
+  if( file_seek( m_file, 0, SEEK_END ) == 0 )
+    m_size = file_tell( m_file );
+  file_seek( m_file, m_offset, SEEK_SET );
+}
+
+BinaryLogReader::~BinaryLogReader()
+{
+  fclose( m_file );
+}
+
+bool BinaryLogReader::next( Entry& entry )
+{
+  while( true )
+  {
+    // a partially written entry at the end of the file is not returned
+    BinaryLogFile::Header header;
+    if( fread( &header, sizeof(header), 1, m_file ) != 1 )
+    {
+      file_seek( m_file, m_offset, SEEK_SET );
+      return false;
+    }
+
+    int64_t offset = m_offset + sizeof(header);
+    if( !BinaryLogFile::isValid( header, m_size - offset ) )
+    {
+      // the file may have grown since it was opened
+      if( file_seek( m_file, 0, SEEK_END ) == 0 )
+        m_size = file_tell( m_file );
+      if( !BinaryLogFile::isValid( header, m_size - offset ) )
+      {
+        file_seek( m_file, m_offset, SEEK_SET );
+        return false;
+      }
+      file_seek( m_file, offset, SEEK_SET );
+    }
+
+    std::string value( header.m_length, '\0' );
+    if( header.m_length
+        && fread( &value[0], 1, header.m_length, m_file ) != header.m_length )
+      return false;
+    m_offset = offset + header.m_length;
+
+    if( header.m_type == BinaryLogFile::SESSION )
+    {
+      if( m_sessions.size() <= header.m_session )
+        m_sessions.resize( header.m_session + 1 );
+      m_sessions[ header.m_session ] = value;
+      continue;
+    }
+
+    if( header.m_session < m_sessions.size() )
+      entry.m_session = m_sessions[ header.m_session ];
+    else
+      entry.m_session.clear();
+    entry.m_type = (BinaryLogFile::Type)header.m_type;
+    entry.m_time = BinaryLogFile::fromNanos( header.m_time );
+    entry.m_value.swap( value );
+    return true;
+  }
+}
+}
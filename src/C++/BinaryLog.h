@@ -0,0 +1,172 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_BINARYLOG_H
+#define FIX_BINARYLOG_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Log.h"
+#include "SessionSettings.h"
+#include "Mutex.h"
+#include "Utility.h"
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+class BinaryLogFile;
+
+/**
+ * Creates a compact binary implementation of Log.
+ *
+ * All logs created by the factory append to one binary log file.
+ */
+class BinaryLogFactory : public LogFactory
+{
+public:
+  BinaryLogFactory( const SessionSettings& settings )
+: m_settings( settings ), m_pFile( 0 ) {};
+  BinaryLogFactory( const std::string& path )
+: m_path( path ), m_pFile( 0 ) {};
+  ~BinaryLogFactory();
+
+  Log* create();
+  Log* create( const SessionID& );
+  void destroy( Log* log );
+
+private:
+  BinaryLogFile& getFile( const Dictionary& settings );
+
+  std::string m_path;
+  SessionSettings m_settings;
+  BinaryLogFile* m_pFile;
+  Mutex m_mutex;
+};
+
+/**
+ * One binary log file shared by the logs of many sessions.
+ *
+ * The file starts with an eight byte magic and is followed by entries of a
+ * fixed header of length, session index, type and timestamp in nanoseconds
+ * since 1970 UTC, in native byte order, followed by the raw text.  A session
+ * entry naming a session precedes its first use of a session index.  Entries
+ * are only ever appended, a partial entry left at the end of the file by a
+ * crash is truncated when the file is opened again.
+ *
+ * The format of the file is:<br>
+ * &nbsp;&nbsp;
+ *   [path]+messages.binlog<br>
+ */
+class BinaryLogFile
+{
+public:
+  enum Type { SESSION = 'S', INCOMING = 'I', OUTGOING = 'O', EVENT = 'E' };
+
+  struct Header
+  {
+    uint32_t m_length;
+    uint16_t m_session;
+    char m_type;
+    char m_reserved;
+    int64_t m_time;
+  };
+
+  BinaryLogFile( const std::string& path ) throw ( ConfigError );
+  ~BinaryLogFile();
+
+  /// Returns the index of a new session of the given name
+  int addSession( const std::string& name );
+  void write( int session, Type type, const std::string& value );
+
+  const std::string& getFileName() const { return m_fileName; }
+
+  static const char* getMagic();
+  /// Whether a header read with remaining bytes left after it starts an entry
+  static bool isValid( const Header& header, int64_t remaining );
+  static int64_t toNanos( const UtcTimeStamp& time );
+  static UtcTimeStamp fromNanos( int64_t nanos );
+
+private:
+  void open() throw ( ConfigError );
+
+  std::string m_fileName;
+  FILE* m_file;
+  int m_sessions;
+  Mutex m_mutex;
+};
+
+/**
+ * Binary implementation of Log.
+ *
+ * Entries are appended to a BinaryLogFile shared with the other sessions of
+ * the factory.  The file is never rewritten, clearing and backing up the log
+ * have no effect.
+ */
+class BinaryLog : public Log
+{
+public:
+  BinaryLog( BinaryLogFile& file, const std::string& name );
+
+  void clear() {}
+  void backup() {}
+
+  void onIncoming( const std::string& value )
+  { m_file.write( m_session, BinaryLogFile::INCOMING, value ); }
+  void onOutgoing( const std::string& value )
+  { m_file.write( m_session, BinaryLogFile::OUTGOING, value ); }
+  void onEvent( const std::string& value )
+  { m_file.write( m_session, BinaryLogFile::EVENT, value ); }
+
+private:
+  BinaryLogFile& m_file;
+  int m_session;
+};
+
+/// Reads back the entries of a BinaryLogFile
+class BinaryLogReader
+{
+public:
+  struct Entry
+  {
+    std::string m_session;
+    BinaryLogFile::Type m_type;
+    UtcTimeStamp m_time;
+    std::string m_value;
+  };
+
+  BinaryLogReader( const std::string& fileName ) throw ( ConfigError );
+  ~BinaryLogReader();
+
+  /// Reads the next entry, false at the end of the file
+  bool next( Entry& entry );
+
+private:
+  FILE* m_file;
+  int64_t m_offset;
+  int64_t m_size;
+  std::vector < std::string > m_sessions;
+};
+}
+
+#endif //FIX_BINARYLOG_H
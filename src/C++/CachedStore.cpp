@@ -0,0 +1,217 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "CachedStore.h"
+#include <algorithm>
+
+namespace FIX
+{
+MessageStore* CachedStoreFactory::create( const SessionID& s )
+{
+  CachedStore* pStore =
+    new CachedStore( m_factory.create( s ), m_messages, m_bytes );
+
+  Locker l( m_mutex );
+  m_stores.insert( pStore );
+  return pStore;
+}
+
+void CachedStoreFactory::destroy( MessageStore* pStore )
+{
+  CachedStore* pCachedStore = static_cast < CachedStore* > ( pStore );
+
+  {
+    Locker l( m_mutex );
+    m_stores.erase( pCachedStore );
+    m_hits += pCachedStore->getHits();
+    m_misses += pCachedStore->getMisses();
+  }
+
+  m_factory.destroy( pCachedStore->getStore() );
+  delete pCachedStore;
+}
+
+long CachedStoreFactory::getHits()
+{
+  Locker l( m_mutex );
+  long hits = m_hits;
+  Stores::const_iterator i;
+  for( i = m_stores.begin(); i != m_stores.end(); ++i )
+    hits += (*i)->getHits();
+  return hits;
+}
+
+long CachedStoreFactory::getMisses()
+{
+  Locker l( m_mutex );
+  long misses = m_misses;
+  Stores::const_iterator i;
+  for( i = m_stores.begin(); i != m_stores.end(); ++i )
+    misses += (*i)->getMisses();
+  return misses;
+}
+
+CachedStore::CachedStore( MessageStore* pStore, size_t messages, size_t bytes )
+: m_pStore( pStore ), m_maxMessages( messages ), m_maxBytes( bytes ),
+  m_head( 0 ), m_first( 0 ), m_highest( 0 ), m_hits( 0 ), m_misses( 0 )
+{
+}
+
+CachedStore::~CachedStore()
+{
+}
+
+bool CachedStore::set( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  bool result = m_pStore->set( msgSeqNum, msg );
+  cache( msgSeqNum, msg );
+  return result;
+}
+
+void CachedStore::get( int begin, int end,
+                       std::vector < std::string > & result ) const
+throw ( IOException )
+{
+  result.clear();
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void CachedStore::getRange( int begin, int end,
+                            MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  if( !isCached( begin, end ) )
+  {
+    ++m_misses;
+    m_pStore->getRange( begin, end, visitor );
+    return;
+  }
+
+  ++m_hits;
+  int last = m_first + (int)m_entries.size() - 1;
+  if( end > last ) end = last;
+
+  const char* pData = m_data.empty() ? 0 : &m_data[ 0 ];
+  for( int i = begin; i <= end; ++i )
+  {
+    const Entry& entry = m_entries[ i - m_first ];
+    if( !visitor.onMessage( i, pData + entry.m_offset, entry.m_length ) )
+      return;
+  }
+}
+
+void CachedStore::reset() throw ( IOException )
+{
+  m_pStore->reset();
+  clear();
+  m_highest = 0;
+}
+
+void CachedStore::refresh() throw ( IOException )
+{
+  m_pStore->refresh();
+  clear();
+  m_highest = 0;
+}
+
+bool CachedStore::isCached( int begin, int end ) const
+{
+  if( m_entries.empty() || begin < m_first ) return false;
+
+  // past the cached messages the store only has what was set through us
+  int last = m_first + (int)m_entries.size() - 1;
+  return end <= last || last >= m_highest;
+}
+
+void CachedStore::cache( int msgSeqNum, const std::string& msg )
+{
+  // only a run of consecutive messages can be served from memory
+  if( m_entries.size() && msgSeqNum != m_first + (int)m_entries.size() )
+    clear();
+  if( msgSeqNum > m_highest )
+    m_highest = msgSeqNum;
+
+  size_t length = msg.size();
+  if( !m_maxMessages || length > m_maxBytes )
+  {
+    clear();
+    return;
+  }
+
+  if( m_entries.size() == m_maxMessages )
+  {
+    m_entries.pop_front();
+    ++m_first;
+  }
+
+  // grow up to the limit, then wrap around and keep each message contiguous
+  size_t pos = m_head;
+  bool wrap = false;
+  if( pos + length > m_data.size() )
+  {
+    if( m_data.size() < m_maxBytes )
+    {
+      m_data.resize
+        ( std::min( m_maxBytes, std::max( m_data.size() * 2, pos + length ) ) );
+    }
+    if( pos + length > m_data.size() )
+    {
+      pos = 0;
+      wrap = true;
+    }
+  }
+
+  while( m_entries.size() )
+  {
+    const Entry& oldest = m_entries.front();
+    bool overlaps = oldest.m_offset < pos + length
+                    && pos < oldest.m_offset + oldest.m_length;
+    bool skipped = wrap && oldest.m_offset >= m_head;
+    if( !overlaps && !skipped ) break;
+    m_entries.pop_front();
+    ++m_first;
+  }
+
+  if( m_entries.empty() )
+    m_first = msgSeqNum;
+  if( length )
+    memcpy( &m_data[ pos ], msg.data(), length );
+
+  Entry entry;
+  entry.m_offset = pos;
+  entry.m_length = length;
+  m_entries.push_back( entry );
+  m_head = pos + length;
+}
+
+void CachedStore::clear()
+{
+  m_entries.clear();
+  m_head = 0;
+  m_first = 0;
+}
+}
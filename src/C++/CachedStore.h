@@ -0,0 +1,146 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_CACHEDSTORE_H
+#define FIX_CACHEDSTORE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "MessageStore.h"
+#include "AtomicCount.h"
+#include "Mutex.h"
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+class CachedStore;
+
+/**
+ * Creates a CachedStore in front of each store of another MessageStoreFactory.
+ *
+ * The hit and miss counters add up the reads of all stores created by this
+ * factory, a hit being a read served entirely from memory.
+ */
+class CachedStoreFactory : public MessageStoreFactory
+{
+public:
+  CachedStoreFactory( MessageStoreFactory& factory,
+                      size_t messages = 10000, size_t bytes = 16 * 1024 * 1024 )
+  : m_factory( factory ), m_messages( messages ), m_bytes( bytes ),
+    m_hits( 0 ), m_misses( 0 ) {}
+
+  MessageStore* create( const SessionID& );
+  void destroy( MessageStore* );
+
+  long getHits();
+  long getMisses();
+
+private:
+  typedef std::set < CachedStore* > Stores;
+
+  MessageStoreFactory& m_factory;
+  size_t m_messages;
+  size_t m_bytes;
+  Stores m_stores;
+  long m_hits;
+  long m_misses;
+  Mutex m_mutex;
+};
+/*! @} */
+
+/**
+ * Keeps the most recently stored messages of another MessageStore in memory.
+ *
+ * Up to messages messages and bytes bytes are kept back to back in a ring
+ * buffer, indexed by their distance from the oldest cached MsgSeqNum.  Reads
+ * covered by the cache are served from memory, all others and everything
+ * except messages are passed on to the wrapped store.  Writes always go to
+ * the wrapped store first.
+ */
+class CachedStore : public MessageStore
+{
+public:
+  CachedStore( MessageStore* pStore, size_t messages, size_t bytes );
+  virtual ~CachedStore();
+
+  bool set( int, const std::string& ) throw ( IOException );
+  void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
+
+  int getNextSenderMsgSeqNum() const throw ( IOException )
+  { return m_pStore->getNextSenderMsgSeqNum(); }
+  int getNextTargetMsgSeqNum() const throw ( IOException )
+  { return m_pStore->getNextTargetMsgSeqNum(); }
+  void setNextSenderMsgSeqNum( int value ) throw ( IOException )
+  { m_pStore->setNextSenderMsgSeqNum( value ); }
+  void setNextTargetMsgSeqNum( int value ) throw ( IOException )
+  { m_pStore->setNextTargetMsgSeqNum( value ); }
+  void incrNextSenderMsgSeqNum() throw ( IOException )
+  { m_pStore->incrNextSenderMsgSeqNum(); }
+  void incrNextTargetMsgSeqNum() throw ( IOException )
+  { m_pStore->incrNextTargetMsgSeqNum(); }
+
+  UtcTimeStamp getCreationTime() const throw ( IOException )
+  { return m_pStore->getCreationTime(); }
+
+  void reset() throw ( IOException );
+  void refresh() throw ( IOException );
+  void flush() throw ( IOException )
+  { m_pStore->flush(); }
+
+  MessageStore* getStore() { return m_pStore; }
+  long getHits() const { return m_hits; }
+  long getMisses() const { return m_misses; }
+
+private:
+  struct Entry
+  {
+    size_t m_offset;
+    size_t m_length;
+  };
+
+  typedef std::deque < Entry > Entries;
+
+  bool isCached( int begin, int end ) const;
+  void cache( int msgSeqNum, const std::string& msg );
+  void clear();
+
+  MessageStore* m_pStore;
+  size_t m_maxMessages;
+  size_t m_maxBytes;
+
+  std::vector < char > m_data;
+  Entries m_entries;
+  size_t m_head;
+  int m_first;
+  int m_highest;
+
+  mutable atomic_count m_hits;
+  mutable atomic_count m_misses;
+};
+}
+
+#endif //FIX_CACHEDSTORE_H
@@ -0,0 +1,61 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "Clock.h"
+
+namespace FIX
+{
+Clock& Clock::getSystem()
+{
+  static SystemClock clock;
+  return clock;
+}
+
+int64_t SystemClock::getMonotonic()
+{
+#if defined(CLOCK_MONOTONIC_COARSE)
+  timespec ts;
+  clock_gettime( CLOCK_MONOTONIC_COARSE, &ts );
+  return (int64_t)ts.tv_sec * DateTime::NANOS_PER_SEC + ts.tv_nsec;
+#else
+  return time_monotonic();
+#endif
+}
+
+UtcTimeStamp SystemClock::getUtcTime()
+{
+#if defined(_POSIX_SOURCE) && defined(CLOCK_REALTIME)
+  timespec ts;
+  clock_gettime( CLOCK_REALTIME, &ts );
+  UtcTimeStamp now( 0, 0, 0, 1, 1, 1970 );
+  now.set( (int)( ts.tv_sec / DateTime::SECONDS_PER_DAY ) + DateTime::JULIAN_19700101,
+           (int64_t)( ts.tv_sec % DateTime::SECONDS_PER_DAY ) * DateTime::NANOS_PER_SEC
+           + ts.tv_nsec );
+  return now;
+#else
+  return UtcTimeStamp();
+#endif
+}
+}
@@ -0,0 +1,72 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_CLOCK_H
+#define FIX_CLOCK_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "FieldTypes.h"
+#include "Utility.h"
+
+namespace FIX
+{
+/**
+ * Source of time for the timers and timestamps of a session.
+ *
+ * Timers measure intervals on the monotonic time, which does not jump
+ * when the wall clock is set, timestamps sent to the counterparty are
+ * taken from the UTC time.  Sessions use the system clock unless given
+ * another one, for instance to control time in a test.
+ */
+class Clock
+{
+public:
+  virtual ~Clock() {}
+
+  /// Nanoseconds since an arbitrary start, never decreasing
+  virtual int64_t getMonotonic() = 0;
+  /// Current date and time in UTC
+  virtual UtcTimeStamp getUtcTime() = 0;
+
+  /// Clock of the operating system shared by all sessions
+  static Clock& getSystem();
+};
+
+/**
+ * Clock of the operating system.
+ *
+ * The monotonic time comes from a coarse clock where the platform has
+ * one, good to a few milliseconds, which is plenty for timers counted in
+ * seconds and much cheaper to read.  The UTC time is converted from the
+ * realtime clock without going through the broken down calendar time.
+ */
+class SystemClock : public Clock
+{
+public:
+  int64_t getMonotonic();
+  UtcTimeStamp getUtcTime();
+};
+}
+
+#endif //FIX_CLOCK_H
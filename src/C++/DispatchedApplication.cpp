@@ -0,0 +1,213 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "DispatchedApplication.h"
+#include "Session.h"
+
+namespace FIX
+{
+DispatchedApplication::DispatchedApplication( Application& app, int threads )
+: m_app( app ), m_stop( 0 ), m_stopped( false )
+{
+  if( threads <= 0 )
+    threads = thread_concurrency();
+
+  for( int i = 0; i < threads; ++i )
+  {
+    thread_id thread;
+    if( thread_spawn( &workerThread, this, thread ) )
+      m_threads.push_back( thread );
+  }
+}
+
+DispatchedApplication::~DispatchedApplication()
+{
+  stop();
+
+  SessionQueues::iterator i;
+  for( i = m_queues.begin(); i != m_queues.end(); ++i )
+    delete i->second;
+}
+
+void DispatchedApplication::stop()
+{
+  {
+    Locker l( m_mutex );
+    if( m_stop ) return;
+    ++m_stop;
+  }
+  m_ready.signal();
+
+  Threads::iterator i;
+  for( i = m_threads.begin(); i != m_threads.end(); ++i )
+    thread_join( *i );
+  m_threads.clear();
+
+  // anything queued from now on is delivered by the caller
+  Locker l( m_mutex );
+  m_stopped = true;
+  SessionQueue* pQueue = 0;
+  while( m_ready.pop( pQueue ) )
+    dispatch( *pQueue );
+}
+
+void DispatchedApplication::onCreate( const SessionID& sessionID )
+{
+  {
+    Locker l( m_mutex );
+    getQueue( sessionID );
+  }
+  app().onCreate( sessionID );
+}
+
+void DispatchedApplication::onLogon( const SessionID& sessionID )
+{
+  enqueue( sessionID, Callback::LOGON );
+}
+
+void DispatchedApplication::onLogout( const SessionID& sessionID )
+{
+  enqueue( sessionID, Callback::LOGOUT );
+}
+
+void DispatchedApplication::fromApp( const Message& message, const SessionID& sessionID )
+throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType )
+{
+  enqueue( sessionID, Callback::FROM_APP, &message );
+}
+
+DispatchedApplication::SessionQueue* DispatchedApplication::getQueue
+( const SessionID& sessionID )
+{
+  SessionQueues::iterator i = m_queues.find( sessionID );
+  if( i != m_queues.end() )
+    return i->second;
+
+  SessionQueue* pQueue = new SessionQueue( sessionID );
+  m_queues[ sessionID ] = pQueue;
+  return pQueue;
+}
+
+void DispatchedApplication::enqueue
+( const SessionID& sessionID, Callback::Type type, const Message* pMessage )
+{
+  Locker l( m_mutex );
+  SessionQueue* pQueue = getQueue( sessionID );
+
+  {
+    Locker queueLocker( pQueue->m_mutex );
+    pQueue->m_callbacks.push_back( Callback( type ) );
+    if( pMessage )
+      pQueue->m_callbacks.back().m_message = *pMessage;
+    if( pQueue->m_scheduled )
+      return;
+    pQueue->m_scheduled = true;
+  }
+
+  if( m_stopped )
+    dispatch( *pQueue );
+  else
+    m_ready.push( pQueue );
+}
+
+void DispatchedApplication::dispatch( SessionQueue& queue )
+{
+  Callbacks callbacks;
+
+  while( true )
+  {
+    // take everything queued so far, the socket thread keeps appending
+    {
+      Locker l( queue.m_mutex );
+      if( queue.m_callbacks.empty() )
+      {
+        queue.m_scheduled = false;
+        return;
+      }
+      callbacks.swap( queue.m_callbacks );
+    }
+
+    Callbacks::const_iterator i;
+    for( i = callbacks.begin(); i != callbacks.end(); ++i )
+      deliver( *i, queue.m_sessionID );
+    callbacks.clear();
+  }
+}
+
+void DispatchedApplication::deliver
+( const Callback& callback, const SessionID& sessionID )
+{
+  try
+  {
+    switch( callback.m_type )
+    {
+      case Callback::LOGON:
+      app().onLogon( sessionID ); break;
+      case Callback::LOGOUT:
+      app().onLogout( sessionID ); break;
+      case Callback::FROM_APP:
+      app().fromApp( callback.m_message, sessionID ); break;
+    }
+  }
+  catch( std::exception& e )
+  {
+    Session* pSession = Session::lookupSession( sessionID );
+    if( pSession )
+      pSession->getLog()->onEvent
+        ( std::string( "Dispatched callback failed: " ) + e.what() );
+  }
+}
+
+void DispatchedApplication::run()
+{
+  while( true )
+  {
+    SessionQueue* pQueue = 0;
+    if( !m_ready.pop( pQueue ) )
+    {
+      if( m_stop )
+      {
+        // the event wakes one worker at a time, pass the stop on
+        m_ready.signal();
+        return;
+      }
+      m_ready.wait( 1 );
+      continue;
+    }
+
+    // let another worker pick up the next session
+    if( m_ready.size() )
+      m_ready.signal();
+    dispatch( *pQueue );
+  }
+}
+
+THREAD_PROC DispatchedApplication::workerThread( void* p )
+{
+  DispatchedApplication* pApplication = static_cast < DispatchedApplication* > ( p );
+  pApplication->run();
+  return 0;
+}
+}
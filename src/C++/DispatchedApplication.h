@@ -0,0 +1,130 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_DISPATCHEDAPPLICATION_H
+#define FIX_DISPATCHEDAPPLICATION_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Application.h"
+#include "Queue.h"
+#include "Mutex.h"
+#include "AtomicCount.h"
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace FIX
+{
+/**
+* This is a special implementation of the Application interface that takes
+* in another Application interface and hands its onLogon, onLogout and fromApp
+* callbacks to a pool of worker threads.
+*
+* The socket thread only runs the session level processing, so a slow
+* fromApp no longer delays heartbeats or other sessions. Callbacks for one
+* session are delivered in order and never concurrently, callbacks for
+* different sessions may run in parallel.
+*
+* The remaining callbacks are called directly on the socket thread and may
+* therefore run concurrently with the dispatched ones. Exceptions thrown by
+* a dispatched fromApp can no longer reject the message, they are written
+* to the session log instead.
+*/
+class DispatchedApplication : public Application
+{
+public:
+  /// Starts threads workers, 0 uses one per processor
+  DispatchedApplication( Application& app, int threads = 0 );
+  virtual ~DispatchedApplication();
+
+  /// Delivers the queued callbacks and stops the workers
+  void stop();
+  int getThreads() const { return m_threads.size(); }
+
+  void onCreate( const SessionID& sessionID );
+  void onLogon( const SessionID& sessionID );
+  void onLogout( const SessionID& sessionID );
+  void toAdmin( Message& message, const SessionID& sessionID )
+  { app().toAdmin( message, sessionID ); }
+  void toApp( Message& message, const SessionID& sessionID )
+  throw( DoNotSend )
+  { app().toApp( message, sessionID ); }
+  void fromAdmin( const Message& message, const SessionID& sessionID )
+  throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, RejectLogon )
+  { app().fromAdmin( message, sessionID ); }
+  void fromApp( const Message& message, const SessionID& sessionID )
+  throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType );
+  void onSendQueueDrained( const SessionID& sessionID )
+  { app().onSendQueueDrained( sessionID ); }
+
+  Application& app() { return m_app; }
+
+private:
+  struct Callback
+  {
+    enum Type { LOGON, LOGOUT, FROM_APP };
+
+    Callback( Type type ) : m_type( type ) {}
+
+    Type m_type;
+    Message m_message;
+  };
+
+  typedef std::deque < Callback > Callbacks;
+
+  /// Callbacks of one session, scheduled on at most one worker at a time
+  struct SessionQueue
+  {
+    SessionQueue( const SessionID& sessionID )
+    : m_sessionID( sessionID ), m_scheduled( false ) {}
+
+    SessionID m_sessionID;
+    Callbacks m_callbacks;
+    bool m_scheduled;
+    Mutex m_mutex;
+  };
+
+  typedef std::map < SessionID, SessionQueue* > SessionQueues;
+  typedef std::vector < thread_id > Threads;
+
+  SessionQueue* getQueue( const SessionID& sessionID );
+  void enqueue( const SessionID&, Callback::Type, const Message* pMessage = 0 );
+  void dispatch( SessionQueue& queue );
+  void deliver( const Callback& callback, const SessionID& sessionID );
+  void run();
+
+  static THREAD_PROC workerThread( void* p );
+
+  Application& m_app;
+  SessionQueues m_queues;
+  Queue < SessionQueue* > m_ready;
+  Threads m_threads;
+  /// Polled by the workers without a lock
+  atomic_count m_stop;
+  bool m_stopped;
+  Mutex m_mutex;
+};
+}
+
+#endif //FIX_DISPATCHEDAPPLICATION_H
@@ -32,7 +32,13 @@
 
 namespace FIX
 {
-/// Portable implementation of an event/conditional mutex
+/**
+ * Portable implementation of an event/conditional mutex
+ *
+ * The event resets itself when a wait returns.  A signal raised while no
+ * one waits is kept for the next wait, and a wait without a signal returns
+ * after the given number of seconds.
+ */
 class Event
 {
 public:
@@ -41,6 +47,7 @@ public:
 #ifdef _MSC_VER
     m_event = CreateEvent( 0, false, false, 0 );
 #else
+    m_signaled = false;
     pthread_mutex_init( &m_mutex, 0 );
     pthread_cond_init( &m_event, 0 );
 #endif
@@ -62,6 +69,7 @@ public:
     SetEvent( m_event );
 #else
     pthread_mutex_lock( &m_mutex );
+    m_signaled = true;
     pthread_cond_broadcast( &m_event );
     pthread_mutex_unlock( &m_mutex );
 #endif
@@ -72,12 +80,23 @@ public:
 #ifdef _MSC_VER
     WaitForSingleObject( m_event, (long)(s * 1000) );
 #else
+    // behave like an auto reset event, pthread_cond_timedwait
+    // takes an absolute time
     pthread_mutex_lock( &m_mutex );
-    timespec time, remainder;
-    double intpart;
-    time.tv_nsec = (long)(modf(s, &intpart) * 1e9);
-    time.tv_sec = (int)intpart;
-    pthread_cond_timedwait( &m_event, &m_mutex, &time );
+    if( !m_signaled )
+    {
+      timeval now;
+      gettimeofday( &now, 0 );
+      double intpart;
+      long nsec = (long)(modf(s, &intpart) * 1e9) + now.tv_usec * 1000;
+      timespec time;
+      time.tv_sec = now.tv_sec + (time_t)intpart + nsec / 1000000000;
+      time.tv_nsec = nsec % 1000000000;
+      // wakeups without a signal wait again until the deadline
+      while( !m_signaled
+             && pthread_cond_timedwait( &m_event, &m_mutex, &time ) != ETIMEDOUT ) {}
+    }
+    m_signaled = false;
     pthread_mutex_unlock( &m_mutex );
 #endif
   }
@@ -88,6 +107,7 @@ private:
 #else
   pthread_cond_t m_event;
   pthread_mutex_t m_mutex;
+  bool m_signaled;
 #endif
 };
 }
@@ -140,6 +140,14 @@ public:
     m_data.clear();
   }
 
+  /// Set the value in place, reusing the storage of the previous one
+  void setString( const char* value, size_t length )
+  {
+    m_string.assign( value, length );
+    m_metrics = no_metrics();
+    m_data.clear();
+  }
+
   /// Get the fields integer tag.
   int getTag() const
   { return m_tag; }
@@ -142,6 +142,17 @@ public:
     setField( fieldBase );
   }
 
+  /// Set a field from a buffer, overwriting the value of a set field in place
+  void setField( int tag, const char* value, size_t length )
+  throw( RepeatedTag, NoTagValue )
+  {
+    Fields::iterator i = findTag( tag );
+    if( i == m_fields.end() )
+      addField( FieldBase( tag, std::string( value, length ) ) );
+    else
+      i->setString( value, length );
+  }
+
   /// Get a field if set
   bool getFieldIfSet( FieldBase& field ) const
   {
@@ -24,9 +24,26 @@
 #endif
 
 #include "FileLog.h"
+#include <stdlib.h>
 
 namespace FIX
 {
+static long getFileSize( const std::string& fileName )
+{
+  FILE* file = file_fopen( fileName.c_str(), "rb" );
+  if( !file ) return 0;
+  fseek( file, 0, SEEK_END );
+  long size = ftell( file );
+  file_fclose( file );
+  return size;
+}
+
+FileLogFactory::~FileLogFactory()
+{
+  delete m_pWriter;
+  delete m_pArchiver;
+}
+
 Log* FileLogFactory::create()
 {
   m_globalLogCount++;
@@ -44,7 +61,18 @@ Log* FileLogFactory::create()
     if( settings.has( FILE_LOG_BACKUP_PATH ) )
       backupPath = settings.getString( FILE_LOG_BACKUP_PATH );
 
-    return m_globalLog = new FileLog( path, backupPath );
+    FileLog* pLog = new FileLog( path, backupPath );
+    try
+    {
+      initRotation( *pLog, settings );
+      initAsync( *pLog, settings );
+    }
+    catch( ConfigError& )
+    {
+      delete pLog;
+      throw;
+    }
+    return m_globalLog = pLog;
   }
   catch( ConfigError& )
   {
@@ -68,7 +96,18 @@ Log* FileLogFactory::create( const SessionID& s )
   if( settings.has( FILE_LOG_BACKUP_PATH ) )
     backupPath = settings.getString( FILE_LOG_BACKUP_PATH );
 
-  return new FileLog( path, backupPath, s );
+  FileLog* pLog = new FileLog( path, backupPath, s );
+  try
+  {
+    initRotation( *pLog, settings );
+    initAsync( *pLog, settings );
+  }
+  catch( ConfigError& )
+  {
+    delete pLog;
+    throw;
+  }
+  return pLog;
 }
 
 void FileLogFactory::destroy( Log* pLog )
@@ -88,26 +127,226 @@ void FileLogFactory::destroy( Log* pLog )
   }
 }
 
+void FileLogFactory::initAsync( FileLog& log, const Dictionary& settings )
+{
+  if( !settings.has( FILE_LOG_ASYNC ) || !settings.getBool( FILE_LOG_ASYNC ) )
+    return;
+
+  size_t size = 1024 * 1024;
+  if( settings.has( FILE_LOG_BUFFER_SIZE ) )
+    size = settings.getInt( FILE_LOG_BUFFER_SIZE );
+  FileLog::Overflow overflow = FileLog::OVERFLOW_BLOCK;
+  if( settings.has( FILE_LOG_OVERFLOW ) )
+    overflow = FileLog::getOverflow( settings.getString( FILE_LOG_OVERFLOW ) );
+
+  // one writer serves all asynchronous logs of the factory
+  if( !m_pWriter )
+  {
+    m_pWriter = new FileLogWriter();
+    m_pWriter->start();
+  }
+  log.setAsync( m_pWriter, size, overflow );
+}
+
+void FileLogFactory::initRotation( FileLog& log, const Dictionary& settings )
+{
+  long size = 0;
+  if( settings.has( FILE_LOG_ROTATE_SIZE ) )
+    size = settings.getInt( FILE_LOG_ROTATE_SIZE );
+  int interval = 0;
+  if( settings.has( FILE_LOG_ROTATE_INTERVAL ) )
+    interval = settings.getInt( FILE_LOG_ROTATE_INTERVAL );
+  if( !size && !interval ) return;
+
+  // one archiver serves all rotating logs of the factory
+  if( !m_pArchiver && settings.has( FILE_LOG_ROTATE_COMMAND ) )
+    m_pArchiver = new FileLogArchiver( settings.getString( FILE_LOG_ROTATE_COMMAND ) );
+  log.setRotation( size, interval, m_pArchiver );
+}
+
+FileLogWriter::FileLogWriter( int interval )
+: m_interval( interval ), m_threadid( 0 ), m_running( false ), m_stop( 0 )
+{
+}
+
+FileLogWriter::~FileLogWriter()
+{
+  stop();
+}
+
+void FileLogWriter::start()
+{
+  Locker l( m_mutex );
+  if( m_running ) return;
+  while( m_stop ) --m_stop;
+  m_running = thread_spawn( &writerThread, this, m_threadid );
+}
+
+void FileLogWriter::stop()
+{
+  if( !m_running ) return;
+  {
+    Locker l( m_mutex );
+    if( !m_stop ) ++m_stop;
+  }
+  m_event.signal();
+  thread_join( m_threadid );
+  m_running = false;
+
+  Locker l( m_writeMutex );
+  writeAll();
+}
+
+void FileLogWriter::add( FileLog& log )
+{
+  Locker l( m_mutex );
+  m_logs.insert( &log );
+}
+
+void FileLogWriter::remove( FileLog& log )
+{
+  Locker writeLocker( m_writeMutex );
+  Locker l( m_mutex );
+  m_logs.erase( &log );
+}
+
+void FileLogWriter::writeAll()
+{
+  Logs logs;
+  {
+    Locker l( m_mutex );
+    logs = m_logs;
+  }
+
+  Logs::iterator i;
+  for( i = logs.begin(); i != logs.end(); ++i )
+    (*i)->flush();
+}
+
+THREAD_PROC FileLogWriter::writerThread( void* p )
+{
+  FileLogWriter* pWriter = static_cast < FileLogWriter* > ( p );
+  double timeout = pWriter->m_interval > 0
+    ? pWriter->m_interval / 1000.0 : 0.1;
+
+  while( !pWriter->m_stop )
+  {
+    pWriter->m_event.wait( timeout );
+    Locker l( pWriter->m_writeMutex );
+    pWriter->writeAll();
+  }
+  return 0;
+}
+
+FileLogArchiver::FileLogArchiver( const std::string& command )
+: m_command( command ), m_threadid( 0 ), m_running( false ), m_stop( 0 )
+{
+  std::string::size_type begin = command.find_first_not_of( " \t" );
+  while( begin != std::string::npos )
+  {
+    std::string::size_type end = command.find_first_of( " \t", begin );
+    m_args.push_back( command.substr( begin, end - begin ) );
+    begin = command.find_first_not_of( " \t", end );
+  }
+}
+
+FileLogArchiver::~FileLogArchiver()
+{
+  stop();
+}
+
+void FileLogArchiver::start()
+{
+  Locker l( m_mutex );
+  if( m_running ) return;
+  while( m_stop ) --m_stop;
+  m_running = thread_spawn( &archiverThread, this, m_threadid );
+}
+
+void FileLogArchiver::stop()
+{
+  Locker l( m_mutex );
+  if( m_running )
+  {
+    if( !m_stop ) ++m_stop;
+    m_files.signal();
+    thread_join( m_threadid );
+    m_running = false;
+  }
+
+  std::string file;
+  while( m_files.pop( file ) )
+    process( file );
+}
+
+void FileLogArchiver::archive( const std::string& file )
+{
+  Locker l( m_mutex );
+  // the thread is started with the first file, none is started once stopped
+  if( !m_running && !m_stop )
+    start();
+
+  if( m_running )
+    m_files.push( file );
+  else
+    process( file );
+}
+
+bool FileLogArchiver::process( const std::string& file )
+{
+  // a file the command fails on is left as it is
+  if( m_args.empty() ) return true;
+  std::vector < std::string > args( m_args );
+  args.push_back( file );
+  return process_run( args ) == 0;
+}
+
+void FileLogArchiver::run()
+{
+  while( true )
+  {
+    std::string file;
+    if( m_files.pop( file ) )
+    {
+      process( file );
+      continue;
+    }
+    if( m_stop ) return;
+    m_files.wait( 1 );
+  }
+}
+
+THREAD_PROC FileLogArchiver::archiverThread( void* p )
+{
+  FileLogArchiver* pArchiver = static_cast < FileLogArchiver* > ( p );
+  pArchiver->run();
+  return 0;
+}
+
 FileLog::FileLog( const std::string& path )
-: m_millisecondsInTimeStamp( true )
+: m_pWriter( 0 ), m_size( 0 ), m_overflow( OVERFLOW_BLOCK ), m_dropped( 0 ),
+  m_millisecondsInTimeStamp( true )
 {
   init( path, path, "GLOBAL" );
 }
 
 FileLog::FileLog( const std::string& path, const std::string& backupPath )
-: m_millisecondsInTimeStamp( true )
+: m_pWriter( 0 ), m_size( 0 ), m_overflow( OVERFLOW_BLOCK ), m_dropped( 0 ),
+  m_millisecondsInTimeStamp( true )
 {
   init( path, backupPath, "GLOBAL" );
 }
 
 FileLog::FileLog( const std::string& path, const SessionID& s )
-: m_millisecondsInTimeStamp( true )
+: m_pWriter( 0 ), m_size( 0 ), m_overflow( OVERFLOW_BLOCK ), m_dropped( 0 ),
+  m_millisecondsInTimeStamp( true )
 {
   init( path, path, generatePrefix(s) );
 }
 
 FileLog::FileLog( const std::string& path, const std::string& backupPath, const SessionID& s )
-: m_millisecondsInTimeStamp( true )
+: m_pWriter( 0 ), m_size( 0 ), m_overflow( OVERFLOW_BLOCK ), m_dropped( 0 ),
+  m_millisecondsInTimeStamp( true )
 {
   init( path, backupPath, generatePrefix(s) );
 }
@@ -145,32 +384,68 @@ void FileLog::init( std::string path, std::string backupPath, const std::string&
 
   m_messagesFileName = m_fullPrefix + "messages.current.log";
   m_eventFileName = m_fullPrefix + "event.current.log";
+  m_nextMessagesFileName = m_fullPrefix + "messages.next.log";
+  m_nextEventFileName = m_fullPrefix + "event.next.log";
+
+  m_rotateSize = 0;
+  m_rotateInterval = 0;
+  m_pArchiver = 0;
+  m_messagesSize = 0;
+  m_eventSize = 0;
+  m_nextRotation = 0;
+  m_rotations = 0;
+
+  m_messages = &m_files[ 0 ];
+  m_event = &m_files[ 1 ];
+  m_nextMessages = &m_files[ 2 ];
+  m_nextEvent = &m_files[ 3 ];
 
-  m_messages.open( m_messagesFileName.c_str(), std::ios::out | std::ios::app );
-  if ( !m_messages.is_open() ) throw ConfigError( "Could not open messages file: " + m_messagesFileName );
-  m_event.open( m_eventFileName.c_str(), std::ios::out | std::ios::app );
-  if ( !m_event.is_open() ) throw ConfigError( "Could not open event file: " + m_eventFileName );
+  m_messages->open( m_messagesFileName.c_str(), std::ios::out | std::ios::app );
+  if ( !m_messages->is_open() ) throw ConfigError( "Could not open messages file: " + m_messagesFileName );
+  m_event->open( m_eventFileName.c_str(), std::ios::out | std::ios::app );
+  if ( !m_event->is_open() ) throw ConfigError( "Could not open event file: " + m_eventFileName );
 }
 
 FileLog::~FileLog()
 {
-  m_messages.close();
-  m_event.close();
+  if( m_pWriter ) m_pWriter->remove( *this );
+  flush();
+
+  m_messages->close();
+  m_event->close();
+
+  if( m_nextMessages->is_open() )
+  {
+    m_nextMessages->close();
+    m_nextEvent->close();
+    file_unlink( m_nextMessagesFileName.c_str() );
+    file_unlink( m_nextEventFileName.c_str() );
+  }
 }
 
 void FileLog::clear()
 {
-  m_messages.close();
-  m_event.close();
+  flush();
+  Locker l( m_fileMutex );
+
+  m_messages->close();
+  m_event->close();
 
-  m_messages.open( m_messagesFileName.c_str(), std::ios::out | std::ios::trunc );
-  m_event.open( m_eventFileName.c_str(), std::ios::out | std::ios::trunc );
+  m_messages->open( m_messagesFileName.c_str(), std::ios::out | std::ios::trunc );
+  m_event->open( m_eventFileName.c_str(), std::ios::out | std::ios::trunc );
+  m_messagesSize = 0;
+  m_eventSize = 0;
 }
 
 void FileLog::backup()
 {
-  m_messages.close();
-  m_event.close();
+  flush();
+  Locker l( m_fileMutex );
+
+  m_messages->close();
+  m_event->close();
+  m_messagesSize = 0;
+  m_eventSize = 0;
 
   int i = 0;
   while( true )
@@ -187,8 +462,8 @@ void FileLog::backup()
     {
       file_rename( m_messagesFileName.c_str(), messagesFileName.str().c_str() );
       file_rename( m_eventFileName.c_str(), eventFileName.str().c_str() );
-      m_messages.open( m_messagesFileName.c_str(), std::ios::out | std::ios::trunc );
-      m_event.open( m_eventFileName.c_str(), std::ios::out | std::ios::trunc );
+      m_messages->open( m_messagesFileName.c_str(), std::ios::out | std::ios::trunc );
+      m_event->open( m_eventFileName.c_str(), std::ios::out | std::ios::trunc );
       return;
     }
     
@@ -197,4 +472,254 @@ void FileLog::backup()
   }
 }
 
+FileLog::Overflow FileLog::getOverflow( const std::string& value )
+throw ( ConfigError )
+{
+  std::string overflow = string_toLower( value );
+  if( overflow == "block" ) return OVERFLOW_BLOCK;
+  if( overflow == "drop" ) return OVERFLOW_DROP;
+  if( overflow == "spill" ) return OVERFLOW_SPILL;
+  throw ConfigError( "Invalid value for " + std::string( FILE_LOG_OVERFLOW )
+                     + ": " + value );
+}
+
+void FileLog::setAsync( FileLogWriter* pWriter, size_t size, Overflow overflow )
+{
+  if( m_pWriter ) m_pWriter->remove( *this );
+  flush();
+
+  {
+    Locker l( m_bufferMutex );
+    m_size = size;
+    m_overflow = overflow;
+    m_buffer.reserve( size );
+    m_writing.reserve( size );
+    m_pWriter = pWriter;
+  }
+
+  if( m_pWriter ) m_pWriter->add( *this );
+}
+
+void FileLog::push( File file, const std::string& value )
+{
+  UtcTimeStamp now;
+  Entry entry;
+  entry.m_file = file;
+  entry.m_date = now.getJulianDate();
+  entry.m_time = ( now.getHour() * 3600 + now.getMinute() * 60
+                   + now.getSecond() ) * (int64_t)1000000000
+                 + now.getNanosecond();
+  entry.m_length = value.size();
+  size_t size = sizeof( Entry ) + value.size();
+
+  while( true )
+  {
+    bool half = false;
+    bool full = false;
+    // atomic_count offers increments only, claiming space in a ring shared
+    // by several producing threads would need compare and swap
+    {
+      Locker l( m_bufferMutex );
+      // an entry larger than the whole buffer still goes into an empty one
+      if( m_buffer.empty() || m_buffer.size() + size <= m_size
+          || m_overflow == OVERFLOW_SPILL )
+      {
+        half = m_buffer.size() < m_size / 2
+               && m_buffer.size() + size >= m_size / 2;
+        m_buffer.append( (const char*)&entry, sizeof( Entry ) );
+        m_buffer.append( value );
+      }
+      else if( m_overflow == OVERFLOW_DROP )
+      {
+        ++m_dropped;
+        return;
+      }
+      else
+        full = true;
+    }
+
+    // a blocked caller writes out the buffer itself
+    if( full )
+    {
+      flush();
+      continue;
+    }
+    if( half ) m_pWriter->signal();
+    return;
+  }
+}
+
+void FileLog::flush()
+{
+  Locker fileLocker( m_fileMutex );
+  {
+    Locker l( m_bufferMutex );
+    m_writing.swap( m_buffer );
+  }
+  if( m_writing.empty() ) return;
+
+  if( m_rotateInterval )
+  {
+    UtcTimeStamp now;
+    if( now.getTimeT() >= m_nextRotation ) rotate( now );
+  }
+
+  // format everything written since the last pass and write it at once
+  m_messagesText.clear();
+  m_eventText.clear();
+  UtcTimeStamp time;
+  size_t pos = 0;
+  while( pos + sizeof( Entry ) <= m_writing.size() )
+  {
+    Entry entry;
+    memcpy( &entry, m_writing.data() + pos, sizeof( Entry ) );
+    pos += sizeof( Entry );
+
+    time.set( entry.m_date, entry.m_time );
+    std::string& text = entry.m_file == MESSAGES ? m_messagesText : m_eventText;
+    m_formatter.append( text, time, m_millisecondsInTimeStamp ? 3 : 0 );
+    text += " : ";
+    text.append( m_writing, pos, entry.m_length );
+    text += '\n';
+    pos += entry.m_length;
+  }
+  m_writing.clear();
+
+  if( m_messagesText.size() )
+  {
+    m_messages->write( m_messagesText.data(), m_messagesText.size() );
+    m_messages->flush();
+  }
+  if( m_eventText.size() )
+  {
+    m_event->write( m_eventText.data(), m_eventText.size() );
+    m_event->flush();
+  }
+
+  if( m_rotateSize )
+    written( m_messagesText.size(), m_eventText.size(), UtcTimeStamp() );
+}
+
+void FileLog::write( File file, const std::string& value )
+{
+  Locker l( m_fileMutex );
+  UtcTimeStamp now;
+  if( m_rotateInterval && now.getTimeT() >= m_nextRotation )
+    rotate( now );
+
+  char time[ UtcTimeStampFormatter::MAX_LENGTH ];
+  size_t length = m_formatter.format( time, now, m_millisecondsInTimeStamp ? 3 : 0 ) - time;
+  std::ofstream& stream = file == MESSAGES ? *m_messages : *m_event;
+  stream.write( time, length ) << " : " << value << std::endl;
+
+  if( !m_rotateSize ) return;
+  size_t size = length + value.size() + 4;
+  written( file == MESSAGES ? size : 0, file == EVENT ? size : 0, now );
+}
+
+void FileLog::setRotation( long size, int interval, FileLogArchiver* pArchiver )
+{
+  flush();
+  Locker l( m_fileMutex );
+
+  m_rotateSize = size;
+  m_rotateInterval = interval;
+  m_pArchiver = pArchiver;
+  m_messagesSize = getFileSize( m_messagesFileName );
+  m_eventSize = getFileSize( m_eventFileName );
+  if( m_rotateInterval ) setNextRotation( UtcTimeStamp() );
+  if( ( m_rotateSize || m_rotateInterval ) && !m_nextMessages->is_open() )
+    prepare();
+}
+
+void FileLog::rotate()
+{
+  flush();
+  rotate( UtcTimeStamp() );
+}
+
+void FileLog::written( size_t messages, size_t event, const UtcTimeStamp& now )
+{
+  m_messagesSize += (long)messages;
+  m_eventSize += (long)event;
+
+  if( m_messagesSize >= m_rotateSize || m_eventSize >= m_rotateSize )
+    rotate( now );
+}
+
+void FileLog::rotate( const UtcTimeStamp& now )
+{
+  Locker l( m_fileMutex );
+  if( !m_nextMessages->is_open() ) prepare();
+
+  m_messages->close();
+  m_event->close();
+  std::string messagesFileName = getRotatedFileName( "messages", now );
+  std::string eventFileName = getRotatedFileName( "event", now );
+  file_rename( m_messagesFileName.c_str(), messagesFileName.c_str() );
+  file_rename( m_eventFileName.c_str(), eventFileName.c_str() );
+
+  // the prepared files become the current ones, unless they cannot be
+  // renamed while open
+  if( file_rename( m_nextMessagesFileName.c_str(), m_messagesFileName.c_str() ) == 0
+      && file_rename( m_nextEventFileName.c_str(), m_eventFileName.c_str() ) == 0 )
+  {
+    std::swap( m_messages, m_nextMessages );
+    std::swap( m_event, m_nextEvent );
+  }
+  else
+  {
+    m_messages->clear();
+    m_messages->open( m_messagesFileName.c_str(), std::ios::out | std::ios::app );
+    m_event->clear();
+    m_event->open( m_eventFileName.c_str(), std::ios::out | std::ios::app );
+  }
+
+  m_messagesSize = 0;
+  m_eventSize = 0;
+  ++m_rotations;
+  if( m_rotateInterval ) setNextRotation( now );
+
+  if( m_pArchiver )
+  {
+    m_pArchiver->archive( messagesFileName );
+    m_pArchiver->archive( eventFileName );
+  }
+
+  prepare();
+}
+
+void FileLog::prepare()
+{
+  m_nextMessages->close();
+  m_nextMessages->clear();
+  m_nextMessages->open( m_nextMessagesFileName.c_str(), std::ios::out | std::ios::trunc );
+  m_nextEvent->close();
+  m_nextEvent->clear();
+  m_nextEvent->open( m_nextEventFileName.c_str(), std::ios::out | std::ios::trunc );
+}
+
+void FileLog::setNextRotation( const UtcTimeStamp& now )
+{
+  // intervals restart at midnight, a shorter last interval ends the day
+  time_t time = now.getTimeT();
+  time_t midnight = time - time % 86400;
+  m_nextRotation = midnight + ( ( time - midnight ) / m_rotateInterval + 1 ) * m_rotateInterval;
+  if( m_nextRotation > midnight + 86400 )
+    m_nextRotation = midnight + 86400;
+}
+
+std::string FileLog::getRotatedFileName( const std::string& name, const UtcTimeStamp& now )
+{
+  std::string time = UtcTimeStampConvertor::convert( now );
+  std::string stamp;
+  for( std::string::size_type i = 0; i < time.size(); ++i )
+    if( time[ i ] != ':' ) stamp += time[ i ];
+
+  std::string fileName = m_fullBackupPrefix + name + "." + stamp + ".log";
+  for( int i = 1; file_exists( fileName.c_str() ); ++i )
+    fileName = m_fullBackupPrefix + name + "." + stamp + "." + IntConvertor::convert( i ) + ".log";
+  return fileName;
+}
+
 } //namespace FIX
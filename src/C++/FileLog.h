@@ -28,10 +28,19 @@
 
 #include "Log.h"
 #include "SessionSettings.h"
+#include "Mutex.h"
+#include "Event.h"
+#include "AtomicCount.h"
+#include "Queue.h"
 #include <fstream>
+#include <set>
 
 namespace FIX
 {
+class FileLog;
+class FileLogWriter;
+class FileLogArchiver;
+
 /**
  * Creates a file based implementation of Log
  *
@@ -41,11 +50,12 @@ class FileLogFactory : public LogFactory
 {
 public:
   FileLogFactory( const SessionSettings& settings )
-: m_settings( settings ), m_globalLog(0), m_globalLogCount(0) {};
+: m_settings( settings ), m_globalLog(0), m_globalLogCount(0), m_pWriter(0) , m_pArchiver(0) {};
   FileLogFactory( const std::string& path )
-: m_path( path ), m_backupPath( path ), m_globalLog(0), m_globalLogCount(0) {};
+: m_path( path ), m_backupPath( path ), m_globalLog(0), m_globalLogCount(0), m_pWriter(0) , m_pArchiver(0) {};
   FileLogFactory( const std::string& path, const std::string& backupPath )
-: m_path( path ), m_backupPath( backupPath ), m_globalLog(0), m_globalLogCount(0) {};
+: m_path( path ), m_backupPath( backupPath ), m_globalLog(0), m_globalLogCount(0), m_pWriter(0) , m_pArchiver(0) {};
+  ~FileLogFactory();
 
 public:
   Log* create();
@@ -53,11 +63,88 @@ public:
   void destroy( Log* log );
 
 private:
+  void initAsync( FileLog& log, const Dictionary& settings );
+  void initRotation( FileLog& log, const Dictionary& settings );
+
   std::string m_path;
   std::string m_backupPath;
   SessionSettings m_settings;
   Log* m_globalLog;
   int m_globalLogCount;
+  FileLogWriter* m_pWriter;
+  FileLogArchiver* m_pArchiver;
+};
+
+/**
+ * Background thread writing the buffered entries of asynchronous FileLogs.
+ *
+ * All logs sharing the writer are written by one pass once per interval, or
+ * earlier once a log has filled half of its buffer.
+ */
+class FileLogWriter
+{
+public:
+  /// Interval in milliseconds
+  FileLogWriter( int interval = 100 );
+  ~FileLogWriter();
+
+  void start();
+  void stop();
+
+  void add( FileLog& );
+  void remove( FileLog& );
+  void signal() { m_event.signal(); }
+
+private:
+  typedef std::set < FileLog* > Logs;
+
+  void writeAll();
+  static THREAD_PROC writerThread( void* p );
+
+  Logs m_logs;
+  int m_interval;
+  thread_id m_threadid;
+  bool m_running;
+  /// Polled by the writer thread without a lock
+  atomic_count m_stop;
+  Event m_event;
+  Mutex m_mutex;
+  Mutex m_writeMutex;
+};
+
+/**
+ * Background thread running a command on closed FileLog segments.
+ *
+ * The command is run with the name of the segment as its last argument,
+ * typically to compress or move it.  It is split at blanks and started
+ * without a shell, so file names are never interpreted.  Segments still
+ * queued when the archiver is stopped are processed by the caller.
+ */
+class FileLogArchiver
+{
+public:
+  FileLogArchiver( const std::string& command );
+  ~FileLogArchiver();
+
+  void start();
+  void stop();
+
+  void archive( const std::string& file );
+  const std::string& getCommand() const { return m_command; }
+
+private:
+  void run();
+  bool process( const std::string& file );
+  static THREAD_PROC archiverThread( void* p );
+
+  std::string m_command;
+  std::vector < std::string > m_args;
+  Queue < std::string > m_files;
+  thread_id m_threadid;
+  bool m_running;
+  /// Polled by the archiver thread without a lock
+  atomic_count m_stop;
+  Mutex m_mutex;
 };
 
 /**
@@ -66,10 +153,26 @@ private:
  * Two files are created by this implementation.  One for messages, 
  * and one for events.
  *
+ * An asynchronous log only copies each entry and a binary timestamp into a
+ * preallocated buffer, a FileLogWriter formats and writes the entries in
+ * the background.  The overflow policy decides what happens to entries that
+ * do not fit into a full buffer.  OVERFLOW_BLOCK waits for the writer,
+ * OVERFLOW_DROP discards and counts them and OVERFLOW_SPILL grows the
+ * buffer beyond its size.
+ *
+ * A rotating log starts new files once one of them grows past the rotation
+ * size, or when the wall clock passes a multiple of the rotation interval
+ * since midnight UTC.  The next files are opened as soon as the current ones
+ * are, a rotation only renames the closed files into the backup path and
+ * switches to the prepared ones between two writes.  The closed files are
+ * named after the time of the rotation and handed to the archiver, if any.
  */
 class FileLog : public Log
 {
+  friend class FileLogWriter;
 public:
+  enum Overflow { OVERFLOW_BLOCK, OVERFLOW_DROP, OVERFLOW_SPILL };
+
   FileLog( const std::string& path );
   FileLog( const std::string& path, const std::string& backupPath );
   FileLog( const std::string& path, const SessionID& sessionID );
@@ -80,31 +183,95 @@ public:
   void backup();
 
   void onIncoming( const std::string& value )
-  { m_messages << UtcTimeStampConvertor::convert(UtcTimeStamp(), m_millisecondsInTimeStamp) << " : " << value << std::endl; }
+  {
+    if( m_pWriter ) { push( MESSAGES, value ); return; }
+    write( MESSAGES, value );
+  }
   void onOutgoing( const std::string& value )
-  { m_messages << UtcTimeStampConvertor::convert(UtcTimeStamp(), m_millisecondsInTimeStamp) << " : " << value << std::endl; }
+  {
+    if( m_pWriter ) { push( MESSAGES, value ); return; }
+    write( MESSAGES, value );
+  }
   void onEvent( const std::string& value )
   {
-    UtcTimeStamp now;
-    m_event << UtcTimeStampConvertor::convert( now, m_millisecondsInTimeStamp )
-            << " : " << value << std::endl;
+    if( m_pWriter ) { push( EVENT, value ); return; }
+    write( EVENT, value );
   }
 
+  static Overflow getOverflow( const std::string& value ) throw ( ConfigError );
+
+  /// Buffers entries of size bytes for the writer, writes are synchronous without one
+  void setAsync( FileLogWriter* pWriter, size_t size = 1024 * 1024,
+                 Overflow overflow = OVERFLOW_BLOCK );
+  /// Writes all buffered entries
+  void flush();
+  /// Entries discarded by OVERFLOW_DROP
+  long getDropped() const { return m_dropped; }
+
+  /// Rotates at size bytes or every interval seconds, 0 disables either
+  void setRotation( long size, int interval, FileLogArchiver* pArchiver = 0 );
+  /// Starts new files now
+  void rotate();
+  /// Rotations since the log was opened
+  int getRotations() const { return m_rotations; }
+
   bool getMillisecondsInTimeStamp() const
   { return m_millisecondsInTimeStamp; }
   void setMillisecondsInTimeStamp ( bool value )
   { m_millisecondsInTimeStamp = value; }
 
 private:
+  enum File { MESSAGES, EVENT };
+
+  struct Entry
+  {
+    int32_t m_file;
+    int32_t m_date;
+    int64_t m_time;
+    size_t m_length;
+  };
+
   std::string generatePrefix( const SessionID& sessionID );
   void init( std::string path, std::string backupPath, const std::string& prefix );
+  void push( File file, const std::string& value );
+  void write( File file, const std::string& value );
+  void written( size_t messages, size_t event, const UtcTimeStamp& now );
+  void rotate( const UtcTimeStamp& now );
+  void prepare();
+  void setNextRotation( const UtcTimeStamp& now );
+  std::string getRotatedFileName( const std::string& name, const UtcTimeStamp& now );
+
+  FileLogWriter* m_pWriter;
+  size_t m_size;
+  Overflow m_overflow;
+  std::string m_buffer;
+  std::string m_writing;
+  std::string m_messagesText;
+  std::string m_eventText;
+  atomic_count m_dropped;
+  Mutex m_bufferMutex;
+  Mutex m_fileMutex;
+
+  long m_rotateSize;
+  int m_rotateInterval;
+  FileLogArchiver* m_pArchiver;
+  long m_messagesSize;
+  long m_eventSize;
+  time_t m_nextRotation;
+  int m_rotations;
 
-  std::ofstream m_messages;
-  std::ofstream m_event;
+  std::ofstream m_files[ 4 ];
+  std::ofstream* m_messages;
+  std::ofstream* m_event;
+  std::ofstream* m_nextMessages;
+  std::ofstream* m_nextEvent;
   std::string m_messagesFileName;
   std::string m_eventFileName;
+  std::string m_nextMessagesFileName;
+  std::string m_nextEventFileName;
   std::string m_fullPrefix;
   std::string m_fullBackupPrefix;
+  UtcTimeStampFormatter m_formatter;
   bool m_millisecondsInTimeStamp;
 };
 }
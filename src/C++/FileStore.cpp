@@ -31,9 +31,107 @@
 
 namespace FIX
 {
-FileStore::FileStore( std::string path, const SessionID& s )
-: m_msgFile( 0 ), m_headerFile( 0 ), m_seqNumsFile( 0 ), m_sessionFile( 0 )
+static const char HEADER_MAGIC[] = "QFINDEX1";
+static const long HEADER_MAGIC_SIZE = sizeof( HEADER_MAGIC ) - 1;
+static const long RANGE_READ_SIZE = 1024 * 1024;
+
+FileStoreFactory::~FileStoreFactory()
+{
+  delete m_pFlusher;
+}
+
+FileStoreFlusher::FileStoreFlusher( int messages, int interval )
+: m_messages( messages ), m_pending( 0 ), m_interval( interval ),
+  m_threadid( 0 ), m_running( false ), m_stop( 0 )
+{
+}
+
+FileStoreFlusher::~FileStoreFlusher()
+{
+  stop();
+}
+
+void FileStoreFlusher::start()
+{
+  Locker l( m_mutex );
+  if( m_running ) return;
+  while( m_stop ) --m_stop;
+  m_running = thread_spawn( &flusherThread, this, m_threadid );
+}
+
+void FileStoreFlusher::stop()
+{
+  if( !m_running ) return;
+  {
+    Locker l( m_mutex );
+    if( !m_stop ) ++m_stop;
+  }
+  m_event.signal();
+  thread_join( m_threadid );
+  m_running = false;
+
+  Locker l( m_syncMutex );
+  syncDirty();
+}
+
+void FileStoreFlusher::written( FileStore& store )
+{
+  Locker l( m_mutex );
+  m_dirty.insert( &store );
+  if( m_messages && ++m_pending >= m_messages )
+  {
+    m_pending = 0;
+    m_event.signal();
+  }
+}
+
+void FileStoreFlusher::remove( FileStore& store )
+{
+  Locker syncLocker( m_syncMutex );
+  Locker l( m_mutex );
+  m_dirty.erase( &store );
+}
+
+void FileStoreFlusher::syncDirty()
+{
+  Stores stores;
+  {
+    Locker l( m_mutex );
+    stores.swap( m_dirty );
+    m_pending = 0;
+  }
+
+  Stores::iterator i;
+  for( i = stores.begin(); i != stores.end(); ++i )
+    (*i)->sync();
+}
+
+THREAD_PROC FileStoreFlusher::flusherThread( void* p )
+{
+  FileStoreFlusher* pFlusher = static_cast < FileStoreFlusher* > ( p );
+  double timeout = pFlusher->m_interval > 0
+    ? pFlusher->m_interval / 1000000.0 : 1;
+
+  while( !pFlusher->m_stop )
+  {
+    pFlusher->m_event.wait( timeout );
+    Locker l( pFlusher->m_syncMutex );
+    pFlusher->syncDirty();
+  }
+  return 0;
+}
+
+FileStore::FileStore( std::string path, const SessionID& s,
+                      SyncMode mode, FileStoreFlusher* pFlusher )
+: m_firstSeqNum( 0 ), m_headerEnd( 0 ),
+  m_msgFile( 0 ), m_headerFile( 0 ), m_seqNumsFile( 0 ), m_sessionFile( 0 ),
+  m_syncMode( mode ), m_pFlusher( pFlusher ),
+  m_msgDirty( false ), m_headerDirty( false ),
+  m_seqNumsDirty( false ), m_sessionDirty( false )
 {
+  if ( m_syncMode == SYNC_BATCH && !m_pFlusher )
+    throw ConfigError( "FileStore batch sync mode requires a flusher" );
+
   file_mkdir( path.c_str() );
 
   if ( path.empty() ) path = ".";
@@ -70,14 +168,31 @@ FileStore::FileStore( std::string path, const SessionID& s )
 
 FileStore::~FileStore()
 {
+  if( m_pFlusher ) m_pFlusher->remove( *this );
+  if( m_syncMode == SYNC_BATCH || m_syncMode == SYNC_ALWAYS ) sync();
+
   if( m_msgFile ) fclose( m_msgFile );
   if( m_headerFile ) fclose( m_headerFile );
   if( m_seqNumsFile ) fclose( m_seqNumsFile );
   if( m_sessionFile ) fclose( m_sessionFile );
 }
 
+FileStore::SyncMode FileStore::getSyncMode( const std::string& value )
+throw ( ConfigError )
+{
+  std::string mode = string_toLower( value );
+  if( mode == "none" ) return SYNC_NONE;
+  if( mode == "flush" ) return SYNC_FLUSH;
+  if( mode == "batch" ) return SYNC_BATCH;
+  if( mode == "sync" ) return SYNC_ALWAYS;
+  throw ConfigError( "Invalid value for " + std::string( FILE_STORE_SYNC_MODE )
+                     + ": " + value );
+}
+
 void FileStore::open( bool deleteFile )
 {
+  Locker l( m_mutex );
+
   if ( m_msgFile ) fclose( m_msgFile );
   if ( m_headerFile ) fclose( m_headerFile );
   if ( m_seqNumsFile ) fclose( m_seqNumsFile );
@@ -101,9 +216,24 @@ void FileStore::open( bool deleteFile )
   if ( !m_msgFile ) m_msgFile = file_fopen( m_msgFileName.c_str(), "w+" );
   if ( !m_msgFile ) throw ConfigError( "Could not open body file: " + m_msgFileName );
 
-  m_headerFile = file_fopen( m_headerFileName.c_str(), "r+" );
-  if ( !m_headerFile ) m_headerFile = file_fopen( m_headerFileName.c_str(), "w+" );
+  m_headerFile = file_fopen( m_headerFileName.c_str(), "rb+" );
+  if ( !m_headerFile ) m_headerFile = file_fopen( m_headerFileName.c_str(), "wb+" );
   if ( !m_headerFile ) throw ConfigError( "Could not open header file: " + m_headerFileName );
+  if ( fseek( m_headerFile, 0, SEEK_END ) )
+    throw ConfigError( "Could not seek in header file: " + m_headerFileName );
+  m_headerEnd = ftell( m_headerFile );
+  if ( m_headerEnd < HEADER_MAGIC_SIZE )
+  {
+    m_headerDirty = true;
+    rewind( m_headerFile );
+    if ( fwrite( HEADER_MAGIC, 1, HEADER_MAGIC_SIZE, m_headerFile )
+         != (size_t)HEADER_MAGIC_SIZE )
+      throw ConfigError( "Could not write header file: " + m_headerFileName );
+    flush( m_headerFile, m_headerFileName );
+    m_headerEnd = HEADER_MAGIC_SIZE;
+  }
+  // a record torn by a crash is overwritten by the next one
+  m_headerEnd -= ( m_headerEnd - HEADER_MAGIC_SIZE ) % sizeof( IndexRecord );
 
   m_seqNumsFile = file_fopen( m_seqNumsFileName.c_str(), "r+" );
   if ( !m_seqNumsFile ) m_seqNumsFile = file_fopen( m_seqNumsFileName.c_str(), "w+" );
@@ -119,30 +249,20 @@ void FileStore::open( bool deleteFile )
   if ( !m_sessionFile ) throw ConfigError( "Could not open session file" );
   if ( setCreationTime ) setSession();
 
-  setNextSenderMsgSeqNum( getNextSenderMsgSeqNum() );
-  setNextTargetMsgSeqNum( getNextTargetMsgSeqNum() );
+  setSeqNum();
 }
 
 void FileStore::populateCache()
 {
-  FILE* headerFile = file_fopen( m_headerFileName.c_str(), "r+" );
+  m_offsets.clear();
+  m_firstSeqNum = 0;
+
+  FILE* headerFile = file_fopen( m_headerFileName.c_str(), "rb" );
   if ( headerFile )
   {
-    int num;
-    long offset;
-    std::size_t size;
-
-    while (FILE_FSCANF(headerFile, "%d,%ld,%lu ", &num, &offset, &size) == 3)
-    {
-      std::pair<NumToOffset::iterator, bool> it = 
-        m_offsets.insert(NumToOffset::value_type(num, std::make_pair(offset, size)));
-      //std::cout << it.first->second.first << " --- " << it.first->second.second << '\n';
-      if (it.second == false)
-      {
-        it.first->second = std::make_pair(offset, size);
-      }
-    }
+    bool binary = loadIndex( headerFile );
     fclose( headerFile );
+    if ( !binary ) migrateIndex();
   }
 
   FILE* seqNumsFile = file_fopen( m_seqNumsFileName.c_str(), "r+" );
@@ -174,6 +294,125 @@ void FileStore::populateCache()
   }
 }
 
+bool FileStore::loadIndex( FILE* headerFile )
+{
+  char magic[ HEADER_MAGIC_SIZE ];
+  if ( fread( magic, 1, HEADER_MAGIC_SIZE, headerFile ) != (size_t)HEADER_MAGIC_SIZE
+       || memcmp( magic, HEADER_MAGIC, HEADER_MAGIC_SIZE ) != 0 )
+    return false;
+
+  if ( fseek( headerFile, 0, SEEK_END ) )
+    throw ConfigError( "Could not seek in header file: " + m_headerFileName );
+  long size = ftell( headerFile );
+  if ( size < HEADER_MAGIC_SIZE )
+    throw ConfigError( "Could not read header file: " + m_headerFileName );
+
+  std::vector < IndexRecord > records
+    ( ( size - HEADER_MAGIC_SIZE ) / sizeof( IndexRecord ) );
+  if ( records.empty() ) return true;
+
+  if ( fseek( headerFile, HEADER_MAGIC_SIZE, SEEK_SET )
+       || fread( &records[ 0 ], sizeof( IndexRecord ), records.size(), headerFile )
+          != records.size() )
+    throw ConfigError( "Could not read header file: " + m_headerFileName );
+
+  // size the index once, later records for a MsgSeqNum replace earlier ones
+  int first = 0, last = 0;
+  std::vector < IndexRecord >::const_iterator i;
+  for ( i = records.begin(); i != records.end(); ++i )
+  {
+    if ( i->m_msgSeqNum <= 0 ) continue;
+    if ( !first || i->m_msgSeqNum < first ) first = i->m_msgSeqNum;
+    if ( i->m_msgSeqNum > last ) last = i->m_msgSeqNum;
+  }
+  if ( !first ) return true;
+
+  m_firstSeqNum = first;
+  m_offsets.assign( last - first + 1, OffsetSize( -1, 0 ) );
+  for ( i = records.begin(); i != records.end(); ++i )
+  {
+    if ( i->m_msgSeqNum <= 0 ) continue;
+    m_offsets[ i->m_msgSeqNum - first ] =
+      OffsetSize( (long)i->m_offset, (std::size_t)i->m_length );
+  }
+  return true;
+}
+
+void FileStore::migrateIndex()
+{
+  FILE* headerFile = file_fopen( m_headerFileName.c_str(), "r" );
+  if ( !headerFile )
+    throw ConfigError( "Could not open header file: " + m_headerFileName );
+
+  std::vector < IndexRecord > records;
+  int num;
+  long offset;
+  std::size_t size;
+
+  while ( FILE_FSCANF( headerFile, "%d,%ld,%lu ", &num, &offset, &size ) == 3 )
+  {
+    IndexRecord record;
+    record.m_offset = offset;
+    record.m_msgSeqNum = num;
+    record.m_length = (int32_t)size;
+    records.push_back( record );
+    setOffset( num, offset, size );
+  }
+  fclose( headerFile );
+
+  std::string fileName = m_headerFileName + ".tmp";
+  FILE* indexFile = file_fopen( fileName.c_str(), "wb" );
+  if ( !indexFile )
+    throw ConfigError( "Could not open header file: " + fileName );
+
+  bool written =
+    fwrite( HEADER_MAGIC, 1, HEADER_MAGIC_SIZE, indexFile ) == (size_t)HEADER_MAGIC_SIZE
+    && ( records.empty()
+         || fwrite( &records[ 0 ], sizeof( IndexRecord ), records.size(), indexFile )
+            == records.size() );
+  written = file_sync( indexFile ) && written;
+  fclose( indexFile );
+  if ( !written )
+  {
+    file_unlink( fileName.c_str() );
+    throw ConfigError( "Could not write header file: " + fileName );
+  }
+
+  if ( file_rename( fileName.c_str(), m_headerFileName.c_str() ) != 0 )
+  {
+    file_unlink( m_headerFileName.c_str() );
+    if ( file_rename( fileName.c_str(), m_headerFileName.c_str() ) != 0 )
+      throw ConfigError( "Could not replace header file: " + m_headerFileName );
+  }
+}
+
+void FileStore::setOffset( int msgSeqNum, long offset, std::size_t size )
+{
+  if ( msgSeqNum <= 0 ) return;
+
+  if ( m_offsets.empty() )
+    m_firstSeqNum = msgSeqNum;
+  else if ( msgSeqNum < m_firstSeqNum )
+  {
+    m_offsets.insert( m_offsets.begin(), m_firstSeqNum - msgSeqNum,
+                      OffsetSize( -1, 0 ) );
+    m_firstSeqNum = msgSeqNum;
+  }
+
+  std::size_t index = msgSeqNum - m_firstSeqNum;
+  if ( index >= m_offsets.size() )
+    m_offsets.resize( index + 1, OffsetSize( -1, 0 ) );
+  m_offsets[ index ] = OffsetSize( offset, size );
+}
+
+const FileStore::OffsetSize* FileStore::getOffset( int msgSeqNum ) const
+{
+  if ( m_offsets.empty() || msgSeqNum < m_firstSeqNum ) return 0;
+  std::size_t index = msgSeqNum - m_firstSeqNum;
+  if ( index >= m_offsets.size() || m_offsets[ index ].first < 0 ) return 0;
+  return &m_offsets[ index ];
+}
+
 MessageStore* FileStoreFactory::create( const SessionID& s )
 {
   if ( m_path.size() ) return new FileStore( m_path, s );
@@ -181,7 +420,37 @@ MessageStore* FileStoreFactory::create( const SessionID& s )
   std::string path;
   Dictionary settings = m_settings.get( s );
   path = settings.getString( FILE_STORE_PATH );
-  return new FileStore( path, s );
+
+  FileStore::SyncMode mode = FileStore::SYNC_FLUSH;
+  if( settings.has( FILE_STORE_SYNC_MODE ) )
+    mode = FileStore::getSyncMode( settings.getString( FILE_STORE_SYNC_MODE ) );
+
+  if( mode == FileStore::SYNC_BATCH )
+  {
+    int messages = 0, interval = 0;
+    if( settings.has( FILE_STORE_SYNC_MESSAGES ) )
+      messages = settings.getInt( FILE_STORE_SYNC_MESSAGES );
+    if( settings.has( FILE_STORE_SYNC_INTERVAL ) )
+      interval = settings.getInt( FILE_STORE_SYNC_INTERVAL );
+    if( !messages && !interval )
+      interval = 1000;
+
+    // the first session in batch mode configures the shared flusher
+    if( !m_pFlusher )
+    {
+      m_pFlusher = new FileStoreFlusher( messages, interval );
+      m_pFlusher->start();
+    }
+    else if( messages != m_pFlusher->getMessages()
+             || interval != m_pFlusher->getInterval() )
+    {
+      throw ConfigError( std::string( FILE_STORE_SYNC_MESSAGES ) + " and "
+                         + FILE_STORE_SYNC_INTERVAL
+                         + " must be the same for all batch sessions" );
+    }
+  }
+
+  return new FileStore( path, s, mode, m_pFlusher );
 }
 
 void FileStoreFactory::destroy( MessageStore* pStore )
@@ -192,9 +461,22 @@ void FileStoreFactory::destroy( MessageStore* pStore )
 bool FileStore::set( int msgSeqNum, const std::string& msg )
 throw ( IOException )
 {
+  write( msgSeqNum, msg );
+  // the sequence number change following the message syncs both at once
+  if( m_syncMode != SYNC_ALWAYS )
+    commit();
+  return true;
+}
+
+void FileStore::write( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  Locker l( m_mutex );
+
+  m_msgDirty = m_headerDirty = true;
   if ( fseek( m_msgFile, 0, SEEK_END ) ) 
     throw IOException( "Cannot seek to end of " + m_msgFileName );
-  if ( fseek( m_headerFile, 0, SEEK_END ) ) 
+  if ( fseek( m_headerFile, m_headerEnd, SEEK_SET ) ) 
     throw IOException( "Cannot seek to end of " + m_headerFileName );
 
   long offset = ftell( m_msgFile );
@@ -202,22 +484,22 @@ throw ( IOException )
     throw IOException( "Unable to get file pointer position from " + m_msgFileName );
   std::size_t size = msg.size();
 
-  if ( fprintf( m_headerFile, "%d,%ld,%lu ", msgSeqNum, offset, size ) < 0 )
-    throw IOException( "Unable to write to file " + m_headerFileName );
-  std::pair<NumToOffset::iterator, bool> it = 
-    m_offsets.insert(NumToOffset::value_type(msgSeqNum, std::make_pair(offset, size)));
-  if (it.second == false)
-  {
-    it.first->second = std::make_pair(offset, size);
-  }
+  // the message goes first so a record never points past the body file
   fwrite( msg.c_str(), sizeof( char ), msg.size(), m_msgFile );
   if ( ferror( m_msgFile ) ) 
     throw IOException( "Unable to write to file " + m_msgFileName );
-  if ( fflush( m_msgFile ) == EOF ) 
-    throw IOException( "Unable to flush file " + m_msgFileName );
-  if ( fflush( m_headerFile ) == EOF ) 
-    throw IOException( "Unable to flush file " + m_headerFileName );
-  return true;
+
+  IndexRecord record;
+  record.m_offset = offset;
+  record.m_msgSeqNum = msgSeqNum;
+  record.m_length = (int32_t)size;
+  if ( fwrite( &record, sizeof( record ), 1, m_headerFile ) != 1 )
+    throw IOException( "Unable to write to file " + m_headerFileName );
+  m_headerEnd += sizeof( record );
+  setOffset( msgSeqNum, offset, size );
+
+  flush( m_msgFile, m_msgFileName );
+  flush( m_headerFile, m_headerFileName );
 }
 
 void FileStore::get( int begin, int end,
@@ -225,11 +507,58 @@ void FileStore::get( int begin, int end,
 throw ( IOException )
 {
   result.clear();
-  std::string msg;
-  for ( int i = begin; i <= end; ++i )
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void FileStore::getRange( int begin, int end,
+                          MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  Locker l( m_mutex );
+
+  if ( m_offsets.empty() ) return;
+  if ( begin < m_firstSeqNum ) begin = m_firstSeqNum;
+  int last = m_firstSeqNum + (int)m_offsets.size() - 1;
+  if ( end > last ) end = last;
+
+  // messages are stored back to back, read them a chunk at a time
+  // instead of seeking to each one
+  std::vector < std::pair < int, OffsetSize > > chunk;
+  std::vector < char > buffer;
+  int msgSeqNum = begin;
+
+  while ( msgSeqNum <= end )
   {
-    if ( get( i, msg ) )
-      result.push_back( msg );
+    chunk.clear();
+    long start = 0, stop = 0;
+    for ( ; msgSeqNum <= end; ++msgSeqNum )
+    {
+      const OffsetSize* pOffset = getOffset( msgSeqNum );
+      if ( !pOffset ) continue;
+      if ( chunk.size() &&
+           ( pOffset->first != stop || stop - start >= RANGE_READ_SIZE ) )
+        break;
+      if ( chunk.empty() ) start = stop = pOffset->first;
+      stop += (long)pOffset->second;
+      chunk.push_back( std::make_pair( msgSeqNum, *pOffset ) );
+    }
+    if ( chunk.empty() ) return;
+
+    buffer.resize( stop - start + 1 );
+    if ( fseek( m_msgFile, start, SEEK_SET ) )
+      throw IOException( "Unable to seek in file " + m_msgFileName );
+    size_t result = fread( &buffer[ 0 ], sizeof( char ), stop - start, m_msgFile );
+    if ( ferror( m_msgFile ) || result != (size_t)( stop - start ) )
+      throw IOException( "Unable to read from file " + m_msgFileName );
+
+    std::vector < std::pair < int, OffsetSize > >::const_iterator i;
+    for ( i = chunk.begin(); i != chunk.end(); ++i )
+    {
+      if ( !visitor.onMessage( i->first, &buffer[ i->second.first - start ],
+                               i->second.second ) )
+        return;
+    }
   }
 }
 
@@ -247,24 +576,28 @@ void FileStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
 {
   m_cache.setNextSenderMsgSeqNum( value );
   setSeqNum();
+  commit();
 }
 
 void FileStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
 {
   m_cache.setNextTargetMsgSeqNum( value );
   setSeqNum();
+  commit();
 }
 
 void FileStore::incrNextSenderMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextSenderMsgSeqNum();
   setSeqNum();
+  commit();
 }
 
 void FileStore::incrNextTargetMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextTargetMsgSeqNum();
   setSeqNum();
+  commit();
 }
 
 UtcTimeStamp FileStore::getCreationTime() const throw ( IOException )
@@ -276,9 +609,13 @@ void FileStore::reset() throw ( IOException )
 {
   try
   {
-    m_cache.reset();
-    open( true );
-    setSession();
+    {
+      Locker l( m_mutex );
+      m_cache.reset();
+      open( true );
+      setSession();
+    }
+    commit();
   }
   catch( std::exception& e )
   {
@@ -290,6 +627,7 @@ void FileStore::refresh() throw ( IOException )
 {
   try
   {
+    Locker l( m_mutex );
     m_cache.reset();
     open( false );
   }
@@ -299,19 +637,66 @@ void FileStore::refresh() throw ( IOException )
   }
 }
 
+void FileStore::flush() throw ( IOException )
+{
+  if( m_syncMode == SYNC_ALWAYS )
+    commit();
+}
+
 void FileStore::setSeqNum()
 {
+  Locker l( m_mutex );
+
+  m_seqNumsDirty = true;
   rewind( m_seqNumsFile );
   fprintf( m_seqNumsFile, "%10.10d : %10.10d",
            getNextSenderMsgSeqNum(), getNextTargetMsgSeqNum() );
   if ( ferror( m_seqNumsFile ) ) 
     throw IOException( "Unable to write to file " + m_seqNumsFileName );
-  if ( fflush( m_seqNumsFile ) ) 
-    throw IOException( "Unable to flush file " + m_seqNumsFileName );
+  flush( m_seqNumsFile, m_seqNumsFileName );
+}
+
+void FileStore::flush( FILE* file, const std::string& fileName )
+{
+  // batch mode leaves flushing to the flusher thread
+  if( m_syncMode != SYNC_FLUSH && m_syncMode != SYNC_ALWAYS ) return;
+  if ( fflush( file ) == EOF )
+    throw IOException( "Unable to flush file " + fileName );
+}
+
+void FileStore::commit() throw ( IOException )
+{
+  // syncs of different stores run in parallel, the file system
+  // journal commits concurrent syncs together
+  if( m_syncMode == SYNC_BATCH )
+    m_pFlusher->written( *this );
+  else if( m_syncMode == SYNC_ALWAYS && !sync() )
+    throw IOException( "Unable to sync files of " + m_msgFileName );
+}
+
+bool FileStore::sync()
+{
+  Locker l( m_mutex );
+
+  bool result = sync( m_msgFile, m_msgDirty );
+  result = sync( m_headerFile, m_headerDirty ) && result;
+  result = sync( m_seqNumsFile, m_seqNumsDirty ) && result;
+  result = sync( m_sessionFile, m_sessionDirty ) && result;
+  return result;
+}
+
+bool FileStore::sync( FILE* file, bool& dirty )
+{
+  if( !dirty || !file ) return true;
+  dirty = false;
+  return file_sync( file );
 }
 
 void FileStore::setSession()
 {
+  Locker l( m_mutex );
+
+  m_sessionDirty = true;
   rewind( m_sessionFile );
   fprintf( m_sessionFile, "%s",
            UtcTimeStampConvertor::convert( m_cache.getCreationTime() ).c_str() );
@@ -321,25 +706,4 @@ void FileStore::setSession()
     throw IOException( "Unable to flush file " + m_sessionFileName );
 }
 
-bool FileStore::get( int msgSeqNum, std::string& msg ) const
-throw ( IOException )
-{
-  NumToOffset::const_iterator find = m_offsets.find( msgSeqNum );
-  if ( find == m_offsets.end() ) return false;
-  const OffsetSize& offset = find->second;
-  if ( fseek( m_msgFile, offset.first, SEEK_SET ) ) 
-    throw IOException( "Unable to seek in file " + m_msgFileName );
-  char* buffer = new char[ offset.second + 1 ];
-  size_t result = fread( buffer, sizeof( char ), offset.second, m_msgFile );
-  if ( ferror( m_msgFile ) || result != (size_t)offset.second ) 
-  {
-    delete [] buffer;
-    throw IOException( "Unable to read from file " + m_msgFileName );
-  }
-  buffer[ offset.second ] = 0;
-  msg = buffer;
-  delete [] buffer;
-  return true;
-}
-
 } //namespace FIX
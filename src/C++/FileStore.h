@@ -28,30 +28,86 @@
 
 #include "MessageStore.h"
 #include "SessionSettings.h"
+#include "Mutex.h"
+#include "Event.h"
+#include "AtomicCount.h"
 #include <fstream>
 #include <string>
+#include <set>
+#include <vector>
 
 namespace FIX
 {
 class Session;
+class FileStore;
+class FileStoreFlusher;
 
-/// Creates a file based implementation of MessageStore.
+/**
+ * Creates a file based implementation of MessageStore.
+ *
+ * Sessions in batch sync mode share one FileStoreFlusher, so they have to
+ * agree on FileStoreSyncMessages and FileStoreSyncInterval.
+ */
 class FileStoreFactory : public MessageStoreFactory
 {
 public:
   FileStoreFactory( const SessionSettings& settings )
-: m_settings( settings ) {};
+: m_settings( settings ), m_pFlusher( 0 ) {};
   FileStoreFactory( const std::string& path )
-: m_path( path ) {};
+: m_path( path ), m_pFlusher( 0 ) {};
+  ~FileStoreFactory();
 
   MessageStore* create( const SessionID& );
   void destroy( MessageStore* );
 private:
   std::string m_path;
   SessionSettings m_settings;
+  FileStoreFlusher* m_pFlusher;
 };
 /*! @} */
 
+/**
+ * Background thread syncing FileStore files to disk for stores in batch mode.
+ *
+ * Writes of all stores sharing the flusher are committed together by one
+ * pass once the given number of messages was written or the interval
+ * passed (group commit).
+ */
+class FileStoreFlusher
+{
+public:
+  /// Interval in microseconds, 0 waits for the message count
+  FileStoreFlusher( int messages = 0, int interval = 0 );
+  ~FileStoreFlusher();
+
+  void start();
+  void stop();
+
+  void written( FileStore& );
+  void remove( FileStore& );
+
+  int getMessages() const { return m_messages; }
+  int getInterval() const { return m_interval; }
+
+private:
+  typedef std::set < FileStore* > Stores;
+
+  void syncDirty();
+  static THREAD_PROC flusherThread( void* p );
+
+  Stores m_dirty;
+  int m_messages;
+  int m_pending;
+  int m_interval;
+  thread_id m_threadid;
+  bool m_running;
+  /// Polled by the flusher thread without a lock
+  atomic_count m_stop;
+  Event m_event;
+  Mutex m_mutex;
+  Mutex m_syncMutex;
+};
+
 /**
  * File based implementation of MessageStore.
  *
@@ -71,21 +127,42 @@ private:
  *
  *
  * The messages file is a pure stream of %FIX messages.<br><br>
+ * The header file is a binary index, an eight byte magic followed by fixed
+ * width records of offset, sequence number and length in native byte order.
+ * It is read with a single read on open.  Header files in the older text
+ * format of<br>
+ * &nbsp;&nbsp;
+ *   [MsgSeqNum],[Offset],[Length] ...<br>
+ * are converted on open.<br><br>
  * The sequence number file is in the format of<br>
  * &nbsp;&nbsp;
  *   [SenderMsgSeqNum] : [TargetMsgSeqNum]<br><br>
  * The session file is a UTC timestamp in the format of<br>
  * &nbsp;&nbsp;
  *   YYYYMMDD-HH:MM:SS
+ *
+ * The sync mode decides how far each write is pushed. SYNC_NONE leaves it in
+ * the stdio buffers, SYNC_FLUSH hands it to the operating system, SYNC_BATCH
+ * lets a FileStoreFlusher sync it to disk periodically and SYNC_ALWAYS only
+ * returns once the files it wrote are on disk.  A stored message is synced
+ * together with the sequence number change that follows it, or by flush.
  */
 class FileStore : public MessageStore
 {
+  friend class FileStoreFlusher;
 public:
-  FileStore( std::string, const SessionID& s );
+  enum SyncMode { SYNC_NONE, SYNC_FLUSH, SYNC_BATCH, SYNC_ALWAYS };
+
+  FileStore( std::string, const SessionID& s,
+             SyncMode mode = SYNC_FLUSH, FileStoreFlusher* pFlusher = 0 );
   virtual ~FileStore();
 
+  static SyncMode getSyncMode( const std::string& value ) throw ( ConfigError );
+  SyncMode getSyncMode() const { return m_syncMode; }
+
   bool set( int, const std::string& ) throw ( IOException );
   void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
 
   int getNextSenderMsgSeqNum() const throw ( IOException );
   int getNextTargetMsgSeqNum() const throw ( IOException );
@@ -98,6 +175,7 @@ public:
 
   void reset() throw ( IOException );
   void refresh() throw ( IOException );
+  void flush() throw ( IOException );
 
 private:
 #ifdef _MSC_VER
@@ -105,18 +183,35 @@ private:
 #else
   typedef std::pair < long, std::size_t > OffsetSize;
 #endif
-  typedef std::map < int, OffsetSize > NumToOffset;
+  /// Message locations indexed by MsgSeqNum - m_firstSeqNum
+  typedef std::vector < OffsetSize > NumToOffset;
+
+  struct IndexRecord
+  {
+    int64_t m_offset;
+    int32_t m_msgSeqNum;
+    int32_t m_length;
+  };
 
   void open( bool deleteFile );
   void populateCache();
+  bool loadIndex( FILE* headerFile );
+  void migrateIndex();
+  void setOffset( int msgSeqNum, long offset, std::size_t size );
+  const OffsetSize* getOffset( int msgSeqNum ) const;
   bool readFromFile( int offset, int size, std::string& msg );
   void setSeqNum();
   void setSession();
-
-  bool get( int, std::string& ) const throw ( IOException );
+  void write( int, const std::string& ) throw ( IOException );
+  void flush( FILE* file, const std::string& fileName );
+  void commit() throw ( IOException );
+  bool sync();
+  bool sync( FILE* file, bool& dirty );
 
   MemoryStore m_cache;
   NumToOffset m_offsets;
+  int m_firstSeqNum;
+  long m_headerEnd;
 
   std::string m_msgFileName;
   std::string m_headerFileName;
@@ -127,6 +222,14 @@ private:
   FILE* m_headerFile;
   FILE* m_seqNumsFile;
   FILE* m_sessionFile;
+
+  SyncMode m_syncMode;
+  FileStoreFlusher* m_pFlusher;
+  bool m_msgDirty;
+  bool m_headerDirty;
+  bool m_seqNumsDirty;
+  bool m_sessionDirty;
+  mutable Mutex m_mutex;
 };
 }
 
@@ -0,0 +1,197 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "FilterLog.h"
+#include <string.h>
+
+namespace FIX
+{
+Log* FilterLogFactory::create()
+{
+  Dictionary settings = m_settings.get();
+  return create( m_factory.create(), settings );
+}
+
+Log* FilterLogFactory::create( const SessionID& s )
+{
+  Dictionary settings = m_settings.get( s );
+  return create( m_factory.create( s ), settings );
+}
+
+void FilterLogFactory::destroy( Log* pLog )
+{
+  FilterLog* pFilterLog = static_cast < FilterLog* > ( pLog );
+  m_factory.destroy( pFilterLog->getLog() );
+  delete pFilterLog;
+}
+
+Log* FilterLogFactory::create( Log* pLog, const Dictionary& settings )
+{
+  FilterLog* pFilterLog = new FilterLog( pLog );
+  try
+  {
+    if( settings.has( FILTER_LOG_INCOMING_INCLUDE ) )
+      pFilterLog->setIncomingInclude( settings.getString( FILTER_LOG_INCOMING_INCLUDE ) );
+    if( settings.has( FILTER_LOG_INCOMING_EXCLUDE ) )
+      pFilterLog->setIncomingExclude( settings.getString( FILTER_LOG_INCOMING_EXCLUDE ) );
+    if( settings.has( FILTER_LOG_INCOMING_SAMPLE ) )
+      pFilterLog->setIncomingSample( settings.getString( FILTER_LOG_INCOMING_SAMPLE ) );
+    if( settings.has( FILTER_LOG_OUTGOING_INCLUDE ) )
+      pFilterLog->setOutgoingInclude( settings.getString( FILTER_LOG_OUTGOING_INCLUDE ) );
+    if( settings.has( FILTER_LOG_OUTGOING_EXCLUDE ) )
+      pFilterLog->setOutgoingExclude( settings.getString( FILTER_LOG_OUTGOING_EXCLUDE ) );
+    if( settings.has( FILTER_LOG_OUTGOING_SAMPLE ) )
+      pFilterLog->setOutgoingSample( settings.getString( FILTER_LOG_OUTGOING_SAMPLE ) );
+  }
+  catch( ConfigError& )
+  {
+    delete pFilterLog;
+    m_factory.destroy( pLog );
+    throw;
+  }
+  return pFilterLog;
+}
+
+static std::vector < std::string > split( const std::string& value, char separator )
+{
+  std::vector < std::string > result;
+  std::string::size_type begin = 0;
+  while( begin <= value.size() )
+  {
+    std::string::size_type end = value.find( separator, begin );
+    if( end == std::string::npos ) end = value.size();
+    std::string item = string_strip( value.substr( begin, end - begin ) );
+    if( item.size() ) result.push_back( item );
+    begin = end + 1;
+  }
+  return result;
+}
+
+FilterLog::FilterLog( Log* pLog )
+: m_pLog( pLog )
+{
+}
+
+void FilterLog::setIncomingInclude( const std::string& msgTypes )
+{ m_incoming.setInclude( msgTypes ); }
+void FilterLog::setIncomingExclude( const std::string& msgTypes )
+{ m_incoming.setExclude( msgTypes ); }
+void FilterLog::setIncomingSample( const std::string& samples )
+throw ( ConfigError )
+{ m_incoming.setSample( samples ); }
+void FilterLog::setOutgoingInclude( const std::string& msgTypes )
+{ m_outgoing.setInclude( msgTypes ); }
+void FilterLog::setOutgoingExclude( const std::string& msgTypes )
+{ m_outgoing.setExclude( msgTypes ); }
+void FilterLog::setOutgoingSample( const std::string& samples )
+throw ( ConfigError )
+{ m_outgoing.setSample( samples ); }
+
+void FilterLog::Rules::setInclude( const std::string& msgTypes )
+{
+  std::vector < std::string > types = split( msgTypes, ',' );
+  for( size_t i = 0; i < types.size(); ++i )
+    getRule( types[ i ] ).m_include = true;
+  m_include = m_include || types.size();
+  m_active = true;
+}
+
+void FilterLog::Rules::setExclude( const std::string& msgTypes )
+{
+  std::vector < std::string > types = split( msgTypes, ',' );
+  for( size_t i = 0; i < types.size(); ++i )
+    getRule( types[ i ] ).m_exclude = true;
+  m_active = true;
+}
+
+void FilterLog::Rules::setSample( const std::string& samples )
+throw ( ConfigError )
+{
+  std::vector < std::string > pairs = split( samples, ',' );
+  for( size_t i = 0; i < pairs.size(); ++i )
+  {
+    std::string::size_type pos = pairs[ i ].find( ':' );
+    int sample = 0;
+    if( pos != std::string::npos )
+      IntConvertor::convert( string_strip( pairs[ i ].substr( pos + 1 ) ), sample );
+    if( sample < 1 )
+      throw ConfigError( "Invalid log sample: " + pairs[ i ] );
+
+    Rule& rule = getRule( string_strip( pairs[ i ].substr( 0, pos ) ) );
+    rule.m_sample = sample;
+    rule.m_count = 0;
+  }
+  m_active = true;
+}
+
+bool FilterLog::Rules::select( const std::string& value )
+{
+  if( !m_active ) return true;
+
+  // MsgType is the third field, right after BeginString and BodyLength
+  std::string::size_type begin = value.find( "\00135=" );
+  if( begin == std::string::npos ) return true;
+  begin += 4;
+  std::string::size_type end = value.find( '\001', begin );
+  if( end == std::string::npos ) return true;
+
+  Rule* pRule = findRule( value.data() + begin, end - begin );
+  if( !pRule ) return !m_include;
+  if( pRule->m_exclude ) return false;
+  if( m_include && !pRule->m_include ) return false;
+  if( pRule->m_sample <= 1 ) return true;
+
+  bool selected = pRule->m_count == 0;
+  if( ++pRule->m_count == pRule->m_sample ) pRule->m_count = 0;
+  return selected;
+}
+
+FilterLog::Rule& FilterLog::Rules::getRule( const std::string& msgType )
+{
+  Rule* pRule = findRule( msgType.data(), msgType.size() );
+  if( pRule ) return *pRule;
+
+  Rule rule;
+  rule.m_msgType = msgType;
+  rule.m_include = false;
+  rule.m_exclude = false;
+  rule.m_sample = 1;
+  rule.m_count = 0;
+  m_rules.push_back( rule );
+  return m_rules.back();
+}
+
+FilterLog::Rule* FilterLog::Rules::findRule( const char* msgType, size_t length )
+{
+  std::vector < Rule >::iterator i;
+  for( i = m_rules.begin(); i != m_rules.end(); ++i )
+  {
+    if( i->m_msgType.size() == length
+        && memcmp( i->m_msgType.data(), msgType, length ) == 0 )
+      return &*i;
+  }
+  return 0;
+}
+}
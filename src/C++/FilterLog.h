@@ -0,0 +1,129 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_FILTERLOG_H
+#define FIX_FILTERLOG_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Log.h"
+#include "SessionSettings.h"
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+/**
+ * Creates logs passing only the messages selected by the session settings
+ * on to the logs of another factory.
+ */
+class FilterLogFactory : public LogFactory
+{
+public:
+  FilterLogFactory( LogFactory& factory, const SessionSettings& settings )
+: m_factory( factory ), m_settings( settings ) {};
+
+  Log* create();
+  Log* create( const SessionID& );
+  void destroy( Log* log );
+
+private:
+  Log* create( Log* pLog, const Dictionary& settings );
+
+  LogFactory& m_factory;
+  SessionSettings m_settings;
+};
+
+/**
+ * Log passing only selected messages on to another log.
+ *
+ * Each direction has a list of MsgTypes to include, a list to exclude and
+ * a sample rate per MsgType.  With an include list only the listed types
+ * are logged, excluded types never are and a type sampled 1-in-N only has
+ * its first message and every Nth one after it logged.  The MsgType is
+ * taken from the raw message without parsing it, messages without one and
+ * events are always logged.
+ */
+class FilterLog : public Log
+{
+public:
+  FilterLog( Log* pLog );
+  virtual ~FilterLog() {}
+
+  /// Comma separated MsgTypes
+  void setIncomingInclude( const std::string& msgTypes );
+  void setIncomingExclude( const std::string& msgTypes );
+  /// Comma separated MsgType:N pairs
+  void setIncomingSample( const std::string& samples ) throw ( ConfigError );
+  void setOutgoingInclude( const std::string& msgTypes );
+  void setOutgoingExclude( const std::string& msgTypes );
+  void setOutgoingSample( const std::string& samples ) throw ( ConfigError );
+
+  void clear() { m_pLog->clear(); }
+  void backup() { m_pLog->backup(); }
+
+  void onIncoming( const std::string& value )
+  { if( m_incoming.select( value ) ) m_pLog->onIncoming( value ); }
+  void onOutgoing( const std::string& value )
+  { if( m_outgoing.select( value ) ) m_pLog->onOutgoing( value ); }
+  void onEvent( const std::string& value )
+  { m_pLog->onEvent( value ); }
+
+  Log* getLog() { return m_pLog; }
+
+private:
+  struct Rule
+  {
+    std::string m_msgType;
+    bool m_include;
+    bool m_exclude;
+    int m_sample;
+    int m_count;
+  };
+
+  class Rules
+  {
+  public:
+    Rules() : m_include( false ), m_active( false ) {}
+
+    void setInclude( const std::string& msgTypes );
+    void setExclude( const std::string& msgTypes );
+    void setSample( const std::string& samples ) throw ( ConfigError );
+    bool select( const std::string& value );
+
+  private:
+    Rule& getRule( const std::string& msgType );
+    Rule* findRule( const char* msgType, size_t length );
+
+    std::vector < Rule > m_rules;
+    bool m_include;
+    bool m_active;
+  };
+
+  Log* m_pLog;
+  Rules m_incoming;
+  Rules m_outgoing;
+};
+}
+
+#endif //FIX_FILTERLOG_H
@@ -125,6 +125,23 @@ void HttpConnection::processStream()
 
 void HttpConnection::processRequest( const HttpMessage& request )
 {
+  if( request.getRootString() == "/metrics" )
+  {
+    std::stringstream b;
+    processMetrics( request, b );
+    send( HttpMessage::createResponse( 200, "text/plain; version=0.0.4", b.str() ) );
+    disconnect();
+    return;
+  }
+  else if( request.getRootString() == "/stats.json" )
+  {
+    std::stringstream b;
+    processStatsJson( request, b );
+    send( HttpMessage::createResponse( 200, "application/json", b.str() ) );
+    disconnect();
+    return;
+  }
+
   int error = 200;
   std::stringstream h;
   std::stringstream b;
@@ -671,6 +688,129 @@ void HttpConnection::processRefreshSession
   }
 }
 
+static std::vector<Session*> getStatisticSessions()
+{
+  std::vector<Session*> result;
+  std::set<SessionID> sessions = Session::getSessions();
+  std::set<SessionID>::iterator i;
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    Session* pSession = Session::lookupSession( *i );
+    if( pSession ) result.push_back( pSession );
+  }
+  return result;
+}
+
+static std::string escapeText( const std::string& value )
+{
+  std::string result;
+  for( std::string::size_type i = 0; i < value.size(); ++i )
+  {
+    char c = value[i];
+    if( c == '"' || c == '\\' ) { result += '\\'; result += c; }
+    else if( c == '\n' ) result += "\\n";
+    else if( (unsigned char)c < 0x20 ) result += ' ';
+    else result += c;
+  }
+  return result;
+}
+
+void HttpConnection::processMetrics
+( const HttpMessage& request, std::stringstream& b )
+{
+  // statistics are read with relaxed atomics and the latency histograms
+  // are copied under their own lock, the session mutex is never taken
+  std::vector<Session*> sessions = getStatisticSessions();
+  std::vector<Session*>::iterator i;
+
+  for( int s = 0; s < SessionStatistics::STATISTICS; ++s )
+  {
+    SessionStatistics::Statistic statistic = (SessionStatistics::Statistic)s;
+    bool counter = SessionStatistics::isCounter( statistic );
+    std::string name = std::string( "quickfix_session_" )
+      + SessionStatistics::getName( statistic ) + ( counter ? "_total" : "" );
+    b << "# TYPE " << name << ( counter ? " counter" : " gauge" ) << "\n";
+    for( i = sessions.begin(); i != sessions.end(); ++i )
+    {
+      b << name << "{session=\""
+        << escapeText( (*i)->getSessionID().toString() ) << "\"} "
+        << (*i)->getStatistics().get( statistic ) << "\n";
+    }
+  }
+
+  const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+  b << "# TYPE quickfix_session_latency_nanoseconds summary\n";
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    SessionLatency& latency = (*i)->getLatency();
+    if( !latency.isEnabled() ) continue;
+    std::string session = escapeText( (*i)->getSessionID().toString() );
+
+    for( int s = 0; s < SessionLatency::STAGES; ++s )
+    {
+      SessionLatency::Stage stage = (SessionLatency::Stage)s;
+      LatencyHistogram histogram = latency.getHistogram( stage );
+      std::string labels = "session=\"" + session + "\",stage=\""
+        + SessionLatency::getStageName( stage ) + "\"";
+      for( size_t q = 0; q < sizeof(quantiles) / sizeof(quantiles[0]); ++q )
+      {
+        b << "quickfix_session_latency_nanoseconds{" << labels
+          << ",quantile=\"" << quantiles[q] << "\"} "
+          << histogram.getValueAtPercentile( quantiles[q] * 100 ) << "\n";
+      }
+      b << "quickfix_session_latency_nanoseconds_sum{" << labels << "} "
+        << histogram.getSum() << "\n";
+      b << "quickfix_session_latency_nanoseconds_count{" << labels << "} "
+        << histogram.getCount() << "\n";
+    }
+  }
+}
+
+void HttpConnection::processStatsJson
+( const HttpMessage& request, std::stringstream& b )
+{
+  std::vector<Session*> sessions = getStatisticSessions();
+  std::vector<Session*>::iterator i;
+
+  b << "{\"sessions\":[";
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    if( i != sessions.begin() ) b << ",";
+    b << "{\"session\":\"" << escapeText( (*i)->getSessionID().toString() ) << "\"";
+
+    SessionStatistics& statistics = (*i)->getStatistics();
+    for( int s = 0; s < SessionStatistics::STATISTICS; ++s )
+    {
+      SessionStatistics::Statistic statistic = (SessionStatistics::Statistic)s;
+      b << ",\"" << SessionStatistics::getName( statistic ) << "\":"
+        << statistics.get( statistic );
+    }
+
+    SessionLatency& latency = (*i)->getLatency();
+    if( latency.isEnabled() )
+    {
+      b << ",\"latency\":{";
+      for( int s = 0; s < SessionLatency::STAGES; ++s )
+      {
+        SessionLatency::Stage stage = (SessionLatency::Stage)s;
+        LatencyHistogram histogram = latency.getHistogram( stage );
+        if( s ) b << ",";
+        b << "\"" << SessionLatency::getStageName( stage ) << "\":{"
+          << "\"count\":" << histogram.getCount()
+          << ",\"min\":" << histogram.getMin()
+          << ",\"mean\":" << (int64_t)histogram.getMean()
+          << ",\"p50\":" << histogram.getValueAtPercentile( 50 )
+          << ",\"p99\":" << histogram.getValueAtPercentile( 99 )
+          << ",\"p999\":" << histogram.getValueAtPercentile( 99.9 )
+          << ",\"max\":" << histogram.getMax() << "}";
+      }
+      b << "}";
+    }
+    b << "}";
+  }
+  b << "]}";
+}
+
 void HttpConnection::showRow
 ( std::stringstream& s, const std::string& name, bool value, const std::string& url )
 {
@@ -83,7 +83,7 @@ throw( InvalidMessage )
   }
 }
 
-std::string HttpMessage::createResponse( int error, const std::string& text )
+std::string HttpMessage::getErrorString( int error )
 {
   std::string errorString;
   switch( error )
@@ -130,6 +130,12 @@ std::string HttpMessage::createResponse( int error, const std::string& text )
   case 505: errorString = "HTTP Version not supported"; break;
   default: errorString = "Unknown";
   }
+  return errorString;
+}
+
+std::string HttpMessage::createResponse( int error, const std::string& text )
+{
+  std::string errorString = getErrorString( error );
 
   std::stringstream response;
   response << "HTTP/1.1 " << error << " " << errorString << "\r\n"
@@ -146,4 +152,16 @@ std::string HttpMessage::createResponse( int error, const std::string& text )
   return response.str();
 }
 
+std::string HttpMessage::createResponse
+( int error, const std::string& contentType, const std::string& text )
+{
+  std::stringstream response;
+  response << "HTTP/1.1 " << error << " " << getErrorString( error ) << "\r\n"
+           << "Server: QuickFIX" << "\r\n"
+           << "Content-Type: " << contentType << "\r\n"
+           << "Content-Length: " << text.size() << "\r\n\r\n"
+           << text;
+  return response.str();
+}
+
 }
@@ -114,8 +114,13 @@ public:
   }  
 
   static std::string createResponse( int error = 0, const std::string& text = "" );
+  /// Response carrying text of any content type as is
+  static std::string createResponse
+  ( int error, const std::string& contentType, const std::string& text );
  
 private:
+  static std::string getErrorString( int error );
+
   std::string m_root;
   Parameters m_parameters;
 };
@@ -0,0 +1,949 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "JournalStore.h"
+#include "SessionID.h"
+#include "FieldConvertors.h"
+
+namespace FIX
+{
+static const char JOURNAL_MAGIC[ 8 ] = { 'Q', 'F', 'J', 'R', 'N', 'L', '1', 0 };
+static const char CHECKPOINT_MAGIC[ 8 ] = { 'Q', 'F', 'J', 'C', 'K', 'P', '2', 0 };
+static const int JOURNAL_DEFAULT_CHECKPOINT_RECORDS = 100000;
+static const int64_t JOURNAL_DEFAULT_SEGMENT_SIZE = 64 * 1024 * 1024;
+/// Segment, offset and length of a message location in a checkpoint
+static const size_t CHECKPOINT_LOCATION_SIZE = 16;
+static const size_t JOURNAL_READ_SIZE = 1024 * 1024;
+
+static void putInt( std::string& buffer, int32_t value )
+{
+  buffer.append( (const char*)&value, sizeof( value ) );
+}
+
+static void putInt64( std::string& buffer, int64_t value )
+{
+  buffer.append( (const char*)&value, sizeof( value ) );
+}
+
+static void putString( std::string& buffer, const std::string& value )
+{
+  putInt( buffer, (int32_t)value.size() );
+  buffer.append( value );
+}
+
+/// Reads back what the put functions wrote, failing past the end
+struct CheckpointReader
+{
+  CheckpointReader( const std::vector < char > & buffer )
+  : m_buffer( buffer ), m_pos( 0 ) {}
+
+  bool get( void* value, size_t size )
+  {
+    if( m_pos + size > m_buffer.size() ) return false;
+    if( size ) memcpy( value, &m_buffer[ m_pos ], size );
+    m_pos += size;
+    return true;
+  }
+
+  bool getString( std::string& value )
+  {
+    int32_t size = 0;
+    if( !get( &size, sizeof( size ) ) || size < 0
+        || m_pos + size > m_buffer.size() )
+      return false;
+    value.assign( m_buffer.begin() + m_pos, m_buffer.begin() + m_pos + size );
+    m_pos += size;
+    return true;
+  }
+
+  const std::vector < char > & m_buffer;
+  size_t m_pos;
+};
+
+Journal::Journal( const std::string& path, int checkpointRecords,
+                  int syncInterval, int64_t segmentSize ) throw ( IOException )
+: m_file( 0 ), m_segment( 0 ), m_end( 0 ),
+  m_segmentSize( segmentSize > 0 ? segmentSize : JOURNAL_DEFAULT_SEGMENT_SIZE ),
+  m_records( 0 ), m_checkpointRecords( checkpointRecords ), m_dirty( false ),
+  m_syncInterval( syncInterval ), m_threadid( 0 ),
+  m_running( false ), m_stop( 0 )
+{
+  file_mkdir( path.c_str() );
+  m_path = path.empty() ? "." : path;
+  m_checkpointFileName = file_appendpath( m_path, "store.checkpoint" );
+
+  try
+  {
+    load();
+  }
+  catch( IOException& )
+  {
+    Segments::const_iterator i;
+    for( i = m_segments.begin(); i != m_segments.end(); ++i )
+      if( i->second.m_file ) fclose( i->second.m_file );
+    throw;
+  }
+
+  if( m_syncInterval > 0 )
+    m_running = thread_spawn( &syncThread, this, m_threadid );
+}
+
+Journal::~Journal()
+{
+  if( m_running )
+  {
+    {
+      Locker l( m_mutex );
+      ++m_stop;
+    }
+    m_event.signal();
+    thread_join( m_threadid );
+  }
+
+  // a checkpoint on close keeps the next open from scanning the journal
+  try
+  {
+    checkpoint();
+  }
+  catch( IOException& ) {}
+
+  Segments::const_iterator i;
+  for( i = m_segments.begin(); i != m_segments.end(); ++i )
+    fclose( i->second.m_file );
+}
+
+void Journal::load() throw ( IOException )
+{
+  // store.[Number].journal
+  std::vector < std::string > names;
+  file_list( m_path.c_str(), names );
+  std::vector < std::string > ::const_iterator i;
+  for( i = names.begin(); i != names.end(); ++i )
+  {
+    if( i->size() <= 14 || i->compare( 0, 6, "store." ) != 0
+        || i->compare( i->size() - 8, 8, ".journal" ) != 0 )
+      continue;
+    int number = atoi( i->substr( 6, i->size() - 14 ).c_str() );
+    if( number <= 0 || *i != "store." + IntConvertor::convert( number ) + ".journal" )
+      continue;
+
+    Segment segment;
+    segment.m_file = 0;
+    segment.m_messages = 0;
+    m_segments[ number ] = segment;
+  }
+
+  if( m_segments.empty() )
+  {
+    // a checkpoint left behind refers to a journal that is gone
+    file_unlink( m_checkpointFileName.c_str() );
+    Segment segment;
+    segment.m_file = openSegment( 1, true );
+    segment.m_messages = 0;
+    m_segments[ 1 ] = segment;
+    m_segment = 1;
+    m_file = segment.m_file;
+    m_end = sizeof( JOURNAL_MAGIC );
+    return;
+  }
+
+  Segments::iterator segment;
+  for( segment = m_segments.begin(); segment != m_segments.end(); ++segment )
+    segment->second.m_file = openSegment( segment->first, false );
+
+  int first = m_segments.begin()->first;
+  int64_t offset = sizeof( JOURNAL_MAGIC );
+  if( !loadCheckpoint( first, offset ) )
+  {
+    first = m_segments.begin()->first;
+    offset = sizeof( JOURNAL_MAGIC );
+  }
+  scan( first, offset );
+}
+
+bool Journal::loadCheckpoint( int& segment, int64_t& offset )
+{
+  FILE* file = file_fopen( m_checkpointFileName.c_str(), "rb" );
+  if( !file ) return false;
+
+  std::vector < char > buffer;
+  long size = 0;
+  if( fseek( file, 0, SEEK_END ) == 0 )
+    size = ftell( file );
+  rewind( file );
+  if( size > 0 )
+  {
+    buffer.resize( size );
+    if( fread( &buffer[ 0 ], size, 1, file ) != 1 )
+      buffer.clear();
+  }
+  fclose( file );
+
+  CheckpointReader reader( buffer );
+  char magic[ sizeof( CHECKPOINT_MAGIC ) ];
+  int32_t number = 0;
+  int64_t end = 0;
+  int32_t count = 0;
+  bool valid = reader.get( magic, sizeof( magic ) )
+    && !memcmp( magic, CHECKPOINT_MAGIC, sizeof( CHECKPOINT_MAGIC ) )
+    && reader.get( &number, sizeof( number ) )
+    && reader.get( &end, sizeof( end ) )
+    && reader.get( &count, sizeof( count ) );
+
+  Segments::iterator i = m_segments.find( number );
+  valid = valid && i != m_segments.end()
+    && end >= (int64_t)sizeof( JOURNAL_MAGIC )
+    && !file_seek( i->second.m_file, 0, SEEK_END )
+    && end <= file_tell( i->second.m_file );
+
+  for( int32_t s = 0; valid && s < count; ++s )
+  {
+    std::string name, creationTime;
+    int32_t sender = 0, target = 0, first = 0, locations = 0;
+    valid = reader.getString( name )
+      && reader.get( &sender, sizeof( sender ) )
+      && reader.get( &target, sizeof( target ) )
+      && reader.getString( creationTime )
+      && reader.get( &first, sizeof( first ) )
+      && reader.get( &locations, sizeof( locations ) )
+      && locations >= 0
+      && reader.m_pos + locations * CHECKPOINT_LOCATION_SIZE <= buffer.size();
+    if( !valid ) break;
+
+    addSession( name );
+    Session& session = m_sessions.back();
+    session.m_nextSenderMsgSeqNum = sender;
+    session.m_nextTargetMsgSeqNum = target;
+    session.m_firstSeqNum = first;
+    session.m_locations.resize( locations );
+    for( int32_t l = 0; valid && l < locations; ++l )
+    {
+      Location& location = session.m_locations[ l ];
+      reader.get( &location.m_segment, sizeof( location.m_segment ) );
+      reader.get( &location.m_offset, sizeof( location.m_offset ) );
+      reader.get( &location.m_length, sizeof( location.m_length ) );
+      if( location.m_offset < 0 ) continue;
+
+      Segments::iterator segment = m_segments.find( location.m_segment );
+      valid = segment != m_segments.end();
+      if( valid ) ++segment->second.m_messages;
+    }
+    try
+    {
+      session.m_creationTime = UtcTimeStampConvertor::convert( creationTime, true );
+    }
+    catch( FieldConvertError& ) {}
+  }
+
+  if( valid )
+  {
+    segment = number;
+    offset = end;
+    return true;
+  }
+
+  // the journal alone is enough to recover from
+  m_sessions.clear();
+  m_ids.clear();
+  for( i = m_segments.begin(); i != m_segments.end(); ++i )
+    i->second.m_messages = 0;
+  return false;
+}
+
+void Journal::scan( int segment, int64_t offset ) throw ( IOException )
+{
+  Record record;
+  std::string data;
+  Segments::iterator i = m_segments.find( segment );
+  for( ; i != m_segments.end(); ++i )
+  {
+    m_segment = i->first;
+    m_file = i->second.m_file;
+    m_end = m_segment == segment ? offset : (int64_t)sizeof( JOURNAL_MAGIC );
+    if( file_seek( m_file, 0, SEEK_END ) )
+      throw IOException( "Unable to seek in file " + getSegmentName( m_segment ) );
+    int64_t size = file_tell( m_file );
+
+    // records are applied up to the first one that was not written
+    // completely, a later segment was only started after that
+    while( m_end + (int64_t)sizeof( Record ) <= size )
+    {
+      if( file_seek( m_file, m_end, SEEK_SET )
+          || fread( &record, sizeof( Record ), 1, m_file ) != 1 )
+        break;
+
+      int64_t dataOffset = m_end + sizeof( Record );
+      int sessions = (int)m_sessions.size();
+      if( record.m_type < SESSION || record.m_type > RESET
+          || record.m_length < 0 || dataOffset + record.m_length > size )
+        break;
+      if( record.m_type == SESSION ? record.m_session != sessions
+          : ( record.m_session < 0 || record.m_session >= sessions ) )
+        break;
+      if( record.m_type == MESSAGE && record.m_value <= 0 )
+        break;
+
+      if( record.m_type == SESSION || record.m_type == RESET )
+      {
+        data.resize( record.m_length );
+        if( record.m_length && fread( &data[ 0 ], record.m_length, 1, m_file ) != 1 )
+          break;
+      }
+
+      switch( record.m_type )
+      {
+      case SESSION:
+        addSession( data );
+        break;
+      case MESSAGE:
+        setLocation( m_sessions[ record.m_session ], record.m_value,
+                     m_segment, dataOffset, record.m_length );
+        break;
+      case SENDER:
+        m_sessions[ record.m_session ].m_nextSenderMsgSeqNum = record.m_value;
+        break;
+      case TARGET:
+        m_sessions[ record.m_session ].m_nextTargetMsgSeqNum = record.m_value;
+        break;
+      case RESET:
+        {
+          UtcTimeStamp creationTime;
+          try
+          {
+            creationTime = UtcTimeStampConvertor::convert( data, true );
+          }
+          catch( FieldConvertError& ) {}
+          resetSession( m_sessions[ record.m_session ], creationTime );
+        }
+        break;
+      }
+
+      m_end = dataOffset + record.m_length;
+      ++m_records;
+    }
+  }
+}
+
+void Journal::roll() throw ( IOException )
+{
+  // the checkpoint only syncs the segment it covers
+  if( !file_sync( m_file ) )
+    throw IOException( "Unable to sync file " + getSegmentName( m_segment ) );
+
+  int number = m_segment + 1;
+  Segment segment;
+  segment.m_file = openSegment( number, true );
+  segment.m_messages = 0;
+  m_segments[ number ] = segment;
+
+  m_segment = number;
+  m_file = segment.m_file;
+  m_end = sizeof( JOURNAL_MAGIC );
+}
+
+void Journal::drop( int segment )
+{
+  std::vector < int > dropped;
+  {
+    Locker l( m_mutex );
+    Segments::iterator i = m_segments.begin();
+    while( i != m_segments.end() && i->first < segment )
+    {
+      if( i->second.m_messages )
+      {
+        ++i;
+        continue;
+      }
+      fclose( i->second.m_file );
+      dropped.push_back( i->first );
+      m_segments.erase( i++ );
+    }
+  }
+
+  std::vector < int > ::const_iterator i;
+  for( i = dropped.begin(); i != dropped.end(); ++i )
+    file_unlink( getSegmentName( *i ).c_str() );
+}
+
+FILE* Journal::openSegment( int number, bool create ) throw ( IOException )
+{
+  std::string fileName = getSegmentName( number );
+  FILE* file = file_fopen( fileName.c_str(), create ? "wb+" : "rb+" );
+  if( !file )
+    throw IOException( "Could not open file: " + fileName );
+
+  if( create )
+  {
+    if( fwrite( JOURNAL_MAGIC, sizeof( JOURNAL_MAGIC ), 1, file ) != 1
+        || fflush( file ) )
+    {
+      fclose( file );
+      file_unlink( fileName.c_str() );
+      throw IOException( "Unable to write to file " + fileName );
+    }
+    return file;
+  }
+
+  char magic[ sizeof( JOURNAL_MAGIC ) ];
+  if( fread( magic, sizeof( magic ), 1, file ) != 1
+      || memcmp( magic, JOURNAL_MAGIC, sizeof( JOURNAL_MAGIC ) ) )
+  {
+    fclose( file );
+    throw IOException( "Unknown journal file format: " + fileName );
+  }
+  return file;
+}
+
+int64_t Journal::append( Type type, int session, int value,
+                         const char* data, size_t length ) throw ( IOException )
+{
+  if( m_end > (int64_t)sizeof( JOURNAL_MAGIC )
+      && m_end + (int64_t)( sizeof( Record ) + length ) > m_segmentSize )
+    roll();
+
+  Record record;
+  record.m_type = type;
+  record.m_session = session;
+  record.m_value = value;
+  record.m_length = (int32_t)length;
+
+  // a record that failed half way is overwritten by the next one
+  if( file_seek( m_file, m_end, SEEK_SET )
+      || fwrite( &record, sizeof( Record ), 1, m_file ) != 1
+      || ( length && fwrite( data, length, 1, m_file ) != 1 )
+      || fflush( m_file ) )
+    throw IOException( "Unable to write to file " + getSegmentName( m_segment ) );
+
+  int64_t offset = m_end + sizeof( Record );
+  m_end = offset + length;
+  m_dirty = true;
+  ++m_records;
+  return offset;
+}
+
+void Journal::written() throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    if( m_checkpointRecords <= 0 || m_records < m_checkpointRecords )
+      return;
+  }
+  checkpoint();
+}
+
+void Journal::addSession( const std::string& name )
+{
+  Session session;
+  session.m_name = name;
+  session.m_nextSenderMsgSeqNum = 1;
+  session.m_nextTargetMsgSeqNum = 1;
+  session.m_firstSeqNum = 0;
+  m_ids[ name ] = (int)m_sessions.size();
+  m_sessions.push_back( session );
+}
+
+void Journal::resetSession( Session& session, const UtcTimeStamp& creationTime )
+{
+  Locations::const_iterator i;
+  for( i = session.m_locations.begin(); i != session.m_locations.end(); ++i )
+    release( *i );
+
+  session.m_nextSenderMsgSeqNum = 1;
+  session.m_nextTargetMsgSeqNum = 1;
+  session.m_creationTime = creationTime;
+  session.m_firstSeqNum = 0;
+  Locations().swap( session.m_locations );
+}
+
+void Journal::setLocation( Session& session, int msgSeqNum,
+                           int segment, int64_t offset, int length )
+{
+  Location empty;
+  empty.m_offset = -1;
+  empty.m_segment = 0;
+  empty.m_length = 0;
+
+  Locations& locations = session.m_locations;
+  if ( locations.empty() )
+    session.m_firstSeqNum = msgSeqNum;
+  else if ( msgSeqNum < session.m_firstSeqNum )
+  {
+    locations.insert( locations.begin(),
+                      session.m_firstSeqNum - msgSeqNum, empty );
+    session.m_firstSeqNum = msgSeqNum;
+  }
+
+  std::size_t index = msgSeqNum - session.m_firstSeqNum;
+  if ( index >= locations.size() )
+    locations.resize( index + 1, empty );
+  release( locations[ index ] );
+  locations[ index ].m_offset = offset;
+  locations[ index ].m_segment = segment;
+  locations[ index ].m_length = length;
+  ++m_segments[ segment ].m_messages;
+}
+
+void Journal::release( const Location& location )
+{
+  if( location.m_offset < 0 ) return;
+  Segments::iterator i = m_segments.find( location.m_segment );
+  if( i != m_segments.end() ) --i->second.m_messages;
+}
+
+const Journal::Location* Journal::getLocation( const Session& session,
+                                               int msgSeqNum ) const
+{
+  const Locations& locations = session.m_locations;
+  if ( locations.empty() || msgSeqNum < session.m_firstSeqNum ) return 0;
+  std::size_t index = msgSeqNum - session.m_firstSeqNum;
+  if ( index >= locations.size() || locations[ index ].m_offset < 0 ) return 0;
+  return &locations[ index ];
+}
+
+Journal::Session& Journal::getSession( int id ) throw ( IOException )
+{
+  if( id < 0 || id >= (int)m_sessions.size() )
+    throw IOException( "Unknown journal session" );
+  return m_sessions[ id ];
+}
+
+std::string Journal::getSegmentName( int number ) const
+{
+  return file_appendpath
+    ( m_path, "store." + IntConvertor::convert( number ) + ".journal" );
+}
+
+int Journal::open( const std::string& name ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    SessionIDs::const_iterator i = m_ids.find( name );
+    if( i != m_ids.end() )
+      return i->second;
+
+    // a new session starts out the way a reset leaves it
+    int id = (int)m_sessions.size();
+    UtcTimeStamp creationTime;
+    std::string time = UtcTimeStampConvertor::convert( creationTime, true );
+    append( SESSION, id, 0, name.data(), name.size() );
+    append( RESET, id, 0, time.data(), time.size() );
+    addSession( name );
+    m_sessions.back().m_creationTime = creationTime;
+  }
+
+  written();
+  Locker l( m_mutex );
+  return m_ids[ name ];
+}
+
+bool Journal::set( int id, int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  if( msgSeqNum <= 0 ) return false;
+
+  {
+    Locker l( m_mutex );
+    Session& session = getSession( id );
+    int64_t offset = append( MESSAGE, id, msgSeqNum, msg.data(), msg.size() );
+    setLocation( session, msgSeqNum, m_segment, offset, (int)msg.size() );
+  }
+
+  written();
+  return true;
+}
+
+void Journal::getRange( int id, int begin, int end,
+                        MessageStoreVisitor& visitor ) throw ( IOException )
+{
+  // messages are read a chunk at a time and visited without the lock held
+  std::vector < char > buffer;
+  std::vector < std::pair < int, std::pair < size_t, size_t > > > chunk;
+  int msgSeqNum = begin;
+
+  while( true )
+  {
+    chunk.clear();
+    {
+      Locker l( m_mutex );
+      const Session& session = getSession( id );
+      if( session.m_locations.empty() ) return;
+      if( msgSeqNum < session.m_firstSeqNum ) msgSeqNum = session.m_firstSeqNum;
+      int last = session.m_firstSeqNum + (int)session.m_locations.size() - 1;
+      if( last > end ) last = end;
+
+      size_t size = 0;
+      for( ; msgSeqNum <= last && size < JOURNAL_READ_SIZE; ++msgSeqNum )
+      {
+        const Location* pLocation = getLocation( session, msgSeqNum );
+        if( !pLocation ) continue;
+
+        size_t length = pLocation->m_length;
+        if( buffer.size() < size + length + 1 )
+          buffer.resize( size + length + 1 );
+        FILE* file = m_segments[ pLocation->m_segment ].m_file;
+        if( file_seek( file, pLocation->m_offset, SEEK_SET ) )
+          throw IOException( "Unable to seek in file "
+                             + getSegmentName( pLocation->m_segment ) );
+        if( length && fread( &buffer[ size ], length, 1, file ) != 1 )
+          throw IOException( "Unable to read from file "
+                             + getSegmentName( pLocation->m_segment ) );
+
+        chunk.push_back( std::make_pair( msgSeqNum, std::make_pair( size, length ) ) );
+        size += length;
+      }
+    }
+    if( chunk.empty() ) return;
+
+    std::vector < std::pair < int, std::pair < size_t, size_t > > >
+      ::const_iterator i;
+    for( i = chunk.begin(); i != chunk.end(); ++i )
+    {
+      if( !visitor.onMessage( i->first, &buffer[ i->second.first ],
+                              i->second.second ) )
+        return;
+    }
+  }
+}
+
+int Journal::getNextSenderMsgSeqNum( int id )
+{
+  Locker l( m_mutex );
+  return getSession( id ).m_nextSenderMsgSeqNum;
+}
+
+int Journal::getNextTargetMsgSeqNum( int id )
+{
+  Locker l( m_mutex );
+  return getSession( id ).m_nextTargetMsgSeqNum;
+}
+
+void Journal::setNextSenderMsgSeqNum( int id, int value ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    Session& session = getSession( id );
+    append( SENDER, id, value, 0, 0 );
+    session.m_nextSenderMsgSeqNum = value;
+  }
+  written();
+}
+
+void Journal::setNextTargetMsgSeqNum( int id, int value ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    Session& session = getSession( id );
+    append( TARGET, id, value, 0, 0 );
+    session.m_nextTargetMsgSeqNum = value;
+  }
+  written();
+}
+
+UtcTimeStamp Journal::getCreationTime( int id )
+{
+  Locker l( m_mutex );
+  return getSession( id ).m_creationTime;
+}
+
+void Journal::reset( int id ) throw ( IOException )
+{
+  {
+    Locker l( m_mutex );
+    Session& session = getSession( id );
+    UtcTimeStamp creationTime;
+    std::string time = UtcTimeStampConvertor::convert( creationTime, true );
+    append( RESET, id, 0, time.data(), time.size() );
+    resetSession( session, creationTime );
+  }
+  written();
+}
+
+void Journal::checkpoint() throw ( IOException )
+{
+  Locker checkpointLocker( m_checkpointMutex );
+
+  // the state is copied under the lock and written without it
+  Sessions sessions;
+  int segment = 0;
+  int64_t end = 0;
+  FILE* journal = 0;
+  {
+    Locker l( m_mutex );
+    sessions = m_sessions;
+    segment = m_segment;
+    end = m_end;
+    journal = m_file;
+    m_records = 0;
+  }
+
+  // the checkpoint may only cover records that are on disk, earlier
+  // segments were synced when the next one was started
+  if( !file_sync( journal ) )
+    throw IOException( "Unable to sync file " + getSegmentName( segment ) );
+
+  std::string buffer;
+  buffer.append( CHECKPOINT_MAGIC, sizeof( CHECKPOINT_MAGIC ) );
+  putInt( buffer, segment );
+  putInt64( buffer, end );
+  putInt( buffer, (int32_t)sessions.size() );
+
+  Sessions::const_iterator i;
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    putString( buffer, i->m_name );
+    putInt( buffer, i->m_nextSenderMsgSeqNum );
+    putInt( buffer, i->m_nextTargetMsgSeqNum );
+    putString( buffer, UtcTimeStampConvertor::convert( i->m_creationTime, true ) );
+    putInt( buffer, i->m_firstSeqNum );
+    putInt( buffer, (int32_t)i->m_locations.size() );
+    buffer.reserve( buffer.size()
+                    + i->m_locations.size() * CHECKPOINT_LOCATION_SIZE );
+
+    Locations::const_iterator j;
+    for( j = i->m_locations.begin(); j != i->m_locations.end(); ++j )
+    {
+      putInt( buffer, j->m_segment );
+      putInt64( buffer, j->m_offset );
+      putInt( buffer, j->m_length );
+    }
+  }
+
+  std::string fileName = m_checkpointFileName + ".tmp";
+  FILE* file = file_fopen( fileName.c_str(), "wb" );
+  if( !file )
+    throw IOException( "Could not open file: " + fileName );
+  bool result = fwrite( buffer.data(), buffer.size(), 1, file ) == 1;
+  result = file_sync( file ) && result;
+  fclose( file );
+  if( !result )
+  {
+    file_unlink( fileName.c_str() );
+    throw IOException( "Unable to write to file " + fileName );
+  }
+
+  // segments are only dropped while a checkpoint covers them, so the
+  // old one is replaced at once where the platform allows it
+  if( file_rename( fileName.c_str(), m_checkpointFileName.c_str() ) )
+  {
+    file_unlink( m_checkpointFileName.c_str() );
+    if( file_rename( fileName.c_str(), m_checkpointFileName.c_str() ) )
+      throw IOException( "Unable to rename file " + fileName );
+  }
+
+  drop( segment );
+}
+
+void Journal::sync()
+{
+  // a segment is only dropped by a checkpoint
+  Locker checkpointLocker( m_checkpointMutex );
+
+  FILE* file = 0;
+  {
+    Locker l( m_mutex );
+    if( !m_dirty ) return;
+    m_dirty = false;
+    file = m_file;
+  }
+  file_sync( file );
+}
+
+size_t Journal::getSessionCount()
+{
+  Locker l( m_mutex );
+  return m_sessions.size();
+}
+
+int Journal::getRecords()
+{
+  Locker l( m_mutex );
+  return m_records;
+}
+
+size_t Journal::getSegmentCount()
+{
+  Locker l( m_mutex );
+  return m_segments.size();
+}
+
+THREAD_PROC Journal::syncThread( void* p )
+{
+  Journal* pJournal = static_cast < Journal* > ( p );
+  double timeout = pJournal->m_syncInterval / 1000000.0;
+
+  while( !pJournal->m_stop )
+  {
+    pJournal->m_event.wait( timeout );
+    pJournal->sync();
+  }
+  return 0;
+}
+
+JournalStoreFactory::~JournalStoreFactory()
+{
+  delete m_pJournal;
+}
+
+MessageStore* JournalStoreFactory::create( const SessionID& s )
+{
+  Locker l( m_mutex );
+
+  // the first session configures the journal shared by all of them
+  if( !m_pJournal )
+  {
+    std::string path = m_path;
+    int checkpointRecords = JOURNAL_DEFAULT_CHECKPOINT_RECORDS;
+    int syncInterval = 0;
+    int segmentSize = 0;
+    if( path.empty() )
+    {
+      Dictionary settings = m_settings.get( s );
+      path = settings.getString( JOURNAL_STORE_PATH );
+      if( settings.has( JOURNAL_STORE_CHECKPOINT_INTERVAL ) )
+        checkpointRecords = settings.getInt( JOURNAL_STORE_CHECKPOINT_INTERVAL );
+      if( settings.has( JOURNAL_STORE_SYNC_INTERVAL ) )
+        syncInterval = settings.getInt( JOURNAL_STORE_SYNC_INTERVAL );
+      if( settings.has( JOURNAL_STORE_SEGMENT_SIZE ) )
+        segmentSize = settings.getInt( JOURNAL_STORE_SEGMENT_SIZE );
+    }
+
+    try
+    {
+      m_pJournal = new Journal( path, checkpointRecords, syncInterval,
+                                segmentSize );
+    }
+    catch( IOException& e )
+    {
+      throw ConfigError( e.what() );
+    }
+  }
+
+  try
+  {
+    return new JournalStore( *m_pJournal, s );
+  }
+  catch( IOException& e )
+  {
+    throw ConfigError( e.what() );
+  }
+}
+
+void JournalStoreFactory::destroy( MessageStore* pStore )
+{
+  delete pStore;
+}
+
+JournalStore::JournalStore( Journal& journal, const SessionID& s )
+throw ( IOException )
+: m_journal( journal )
+{
+  const std::string& begin =
+    s.getBeginString().getString();
+  const std::string& sender =
+    s.getSenderCompID().getString();
+  const std::string& target =
+    s.getTargetCompID().getString();
+  const std::string& qualifier =
+    s.getSessionQualifier();
+
+  std::string sessionid = begin + "-" + sender + "-" + target;
+  if( qualifier.size() )
+    sessionid += "-" + qualifier;
+
+  m_session = m_journal.open( sessionid );
+}
+
+JournalStore::~JournalStore()
+{
+}
+
+bool JournalStore::set( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  return m_journal.set( m_session, msgSeqNum, msg );
+}
+
+void JournalStore::get( int begin, int end,
+                        std::vector < std::string > & result ) const
+throw ( IOException )
+{
+  result.clear();
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void JournalStore::getRange( int begin, int end,
+                             MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  m_journal.getRange( m_session, begin, end, visitor );
+}
+
+int JournalStore::getNextSenderMsgSeqNum() const throw ( IOException )
+{
+  return m_journal.getNextSenderMsgSeqNum( m_session );
+}
+
+int JournalStore::getNextTargetMsgSeqNum() const throw ( IOException )
+{
+  return m_journal.getNextTargetMsgSeqNum( m_session );
+}
+
+void JournalStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
+{
+  m_journal.setNextSenderMsgSeqNum( m_session, value );
+}
+
+void JournalStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
+{
+  m_journal.setNextTargetMsgSeqNum( m_session, value );
+}
+
+void JournalStore::incrNextSenderMsgSeqNum() throw ( IOException )
+{
+  setNextSenderMsgSeqNum( getNextSenderMsgSeqNum() + 1 );
+}
+
+void JournalStore::incrNextTargetMsgSeqNum() throw ( IOException )
+{
+  setNextTargetMsgSeqNum( getNextTargetMsgSeqNum() + 1 );
+}
+
+UtcTimeStamp JournalStore::getCreationTime() const throw ( IOException )
+{
+  return m_journal.getCreationTime( m_session );
+}
+
+void JournalStore::reset() throw ( IOException )
+{
+  m_journal.reset( m_session );
+}
+
+void JournalStore::refresh() throw ( IOException )
+{
+  // the journal in memory is always up to date
+}
+
+} //namespace FIX
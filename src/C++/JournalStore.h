@@ -0,0 +1,248 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_JOURNALSTORE_H
+#define FIX_JOURNALSTORE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "MessageStore.h"
+#include "SessionSettings.h"
+#include "Mutex.h"
+#include "Event.h"
+#include "AtomicCount.h"
+#include "Utility.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+/**
+ * One journal file shared by the stores of many sessions.
+ *
+ * Every change of every session is appended to the journal as a record of
+ * type, session, value and length followed by its data, the sessions keep
+ * their sequence numbers and message locations in memory.  After the given
+ * number of records the in memory state is written to a checkpoint file
+ * together with the journal offset it covers, opening the journal reads the
+ * checkpoint and only scans the records written after it.
+ *
+ * Records are flushed to the operating system as they are written.  With a
+ * sync interval a background thread syncs the journal to disk once per
+ * interval if it was written, committing the writes of all sessions at once.
+ *
+ * The journal is a series of segment files, a new segment is started once
+ * the current one would grow past the segment size.  After a checkpoint,
+ * segments before the one it covers are removed once none of their messages
+ * is referenced any more, because the session was reset or the message was
+ * stored again.  Their other records are part of the checkpoint then.
+ *
+ * The formats of the files are:<br>
+ * &nbsp;&nbsp;
+ *   [path]+store.[Number].journal<br>
+ * &nbsp;&nbsp;
+ *   [path]+store.checkpoint<br>
+ */
+class Journal
+{
+public:
+  /// Sync interval in microseconds, 0 leaves syncing to the operating system
+  Journal( const std::string& path, int checkpointRecords = 0,
+           int syncInterval = 0, int64_t segmentSize = 0 ) throw ( IOException );
+  ~Journal();
+
+  /// Returns the id of the named session, adding it if it is new
+  int open( const std::string& name ) throw ( IOException );
+
+  bool set( int, int, const std::string& ) throw ( IOException );
+  void getRange( int, int, int, MessageStoreVisitor& ) throw ( IOException );
+
+  int getNextSenderMsgSeqNum( int );
+  int getNextTargetMsgSeqNum( int );
+  void setNextSenderMsgSeqNum( int, int ) throw ( IOException );
+  void setNextTargetMsgSeqNum( int, int ) throw ( IOException );
+  UtcTimeStamp getCreationTime( int );
+  void reset( int ) throw ( IOException );
+
+  void checkpoint() throw ( IOException );
+  void sync();
+
+  size_t getSessionCount();
+  /// Records written since the last checkpoint
+  int getRecords();
+  /// Number of segment files currently part of the journal
+  size_t getSegmentCount();
+
+private:
+  enum Type
+  {
+    SESSION = 1, MESSAGE, SENDER, TARGET, RESET
+  };
+
+  struct Record
+  {
+    int32_t m_type;
+    int32_t m_session;
+    int32_t m_value;
+    int32_t m_length;
+  };
+
+  struct Location
+  {
+    int64_t m_offset;
+    int32_t m_segment;
+    int32_t m_length;
+  };
+
+  struct Segment
+  {
+    FILE* m_file;
+    /// Messages of the sessions still stored in the segment
+    int m_messages;
+  };
+
+  /// Message locations indexed by MsgSeqNum - m_firstSeqNum
+  typedef std::vector < Location > Locations;
+
+  struct Session
+  {
+    std::string m_name;
+    int m_nextSenderMsgSeqNum;
+    int m_nextTargetMsgSeqNum;
+    UtcTimeStamp m_creationTime;
+    int m_firstSeqNum;
+    Locations m_locations;
+  };
+
+  typedef std::vector < Session > Sessions;
+  typedef std::map < std::string, int > SessionIDs;
+  typedef std::map < int, Segment > Segments;
+
+  void load() throw ( IOException );
+  bool loadCheckpoint( int& segment, int64_t& offset );
+  void scan( int segment, int64_t offset ) throw ( IOException );
+  void roll() throw ( IOException );
+  void drop( int segment );
+  FILE* openSegment( int number, bool create ) throw ( IOException );
+  int64_t append( Type type, int session, int value,
+                  const char* data, size_t length ) throw ( IOException );
+  void written() throw ( IOException );
+  void addSession( const std::string& name );
+  void resetSession( Session& session, const UtcTimeStamp& creationTime );
+  void setLocation( Session& session, int msgSeqNum,
+                    int segment, int64_t offset, int length );
+  void release( const Location& location );
+  const Location* getLocation( const Session& session, int msgSeqNum ) const;
+  Session& getSession( int id ) throw ( IOException );
+  std::string getSegmentName( int number ) const;
+
+  static THREAD_PROC syncThread( void* p );
+
+  Sessions m_sessions;
+  SessionIDs m_ids;
+  Segments m_segments;
+
+  std::string m_path;
+  std::string m_checkpointFileName;
+  FILE* m_file;
+  int m_segment;
+  int64_t m_end;
+  int64_t m_segmentSize;
+  int m_records;
+  int m_checkpointRecords;
+  bool m_dirty;
+
+  int m_syncInterval;
+  thread_id m_threadid;
+  bool m_running;
+  /// Polled by the sync thread without a lock
+  atomic_count m_stop;
+  Event m_event;
+
+  Mutex m_mutex;
+  Mutex m_checkpointMutex;
+};
+
+/**
+ * Creates JournalStore instances sharing one Journal.
+ *
+ * The settings of the first session created configure the journal.
+ */
+class JournalStoreFactory : public MessageStoreFactory
+{
+public:
+  JournalStoreFactory( const SessionSettings& settings )
+: m_settings( settings ), m_pJournal( 0 ) {};
+  JournalStoreFactory( const std::string& path )
+: m_path( path ), m_pJournal( 0 ) {};
+  ~JournalStoreFactory();
+
+  MessageStore* create( const SessionID& );
+  void destroy( MessageStore* );
+
+  Journal* getJournal() { return m_pJournal; }
+
+private:
+  std::string m_path;
+  SessionSettings m_settings;
+  Journal* m_pJournal;
+  Mutex m_mutex;
+};
+/*! @} */
+
+/**
+ * Journal based implementation of MessageStore.
+ *
+ * The store is a view of one session in a Journal shared with the other
+ * sessions of the factory, all changes are appended to the journal.
+ */
+class JournalStore : public MessageStore
+{
+public:
+  JournalStore( Journal& journal, const SessionID& s ) throw ( IOException );
+  virtual ~JournalStore();
+
+  bool set( int, const std::string& ) throw ( IOException );
+  void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
+
+  int getNextSenderMsgSeqNum() const throw ( IOException );
+  int getNextTargetMsgSeqNum() const throw ( IOException );
+  void setNextSenderMsgSeqNum( int value ) throw ( IOException );
+  void setNextTargetMsgSeqNum( int value ) throw ( IOException );
+  void incrNextSenderMsgSeqNum() throw ( IOException );
+  void incrNextTargetMsgSeqNum() throw ( IOException );
+
+  UtcTimeStamp getCreationTime() const throw ( IOException );
+
+  void reset() throw ( IOException );
+  void refresh() throw ( IOException );
+
+private:
+  Journal& m_journal;
+  int m_session;
+};
+}
+
+#endif //FIX_JOURNALSTORE_H
@@ -0,0 +1,178 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "Latency.h"
+#include <algorithm>
+
+namespace FIX
+{
+static const int LINEAR_VALUES = 32;
+static const int SUB_BUCKETS = 16;
+static const int INDEXES = LINEAR_VALUES + ( 63 - 5 ) * SUB_BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+: m_counts( INDEXES, 0 ), m_count( 0 ), m_min( 0 ), m_max( 0 ), m_sum( 0 )
+{
+}
+
+void LatencyHistogram::record( int64_t value )
+{
+  if( value < 0 ) value = 0;
+  ++m_counts[ getIndex( value ) ];
+  if( !m_count || value < m_min ) m_min = value;
+  if( value > m_max ) m_max = value;
+  ++m_count;
+  m_sum += value;
+}
+
+void LatencyHistogram::reset()
+{
+  std::fill( m_counts.begin(), m_counts.end(), 0 );
+  m_count = 0;
+  m_min = 0;
+  m_max = 0;
+  m_sum = 0;
+}
+
+int64_t LatencyHistogram::getValueAtPercentile( double percentile ) const
+{
+  if( !m_count ) return 0;
+  int64_t rank = (int64_t)( percentile / 100.0 * (double)m_count + 0.5 );
+  if( rank < 1 ) rank = 1;
+
+  int64_t total = 0;
+  for( int i = 0; i < INDEXES; ++i )
+  {
+    total += m_counts[ i ];
+    if( total >= rank )
+      return std::min( getHighestValue( i ), m_max );
+  }
+  return m_max;
+}
+
+int LatencyHistogram::getIndex( int64_t value )
+{
+  if( value < LINEAR_VALUES ) return (int)value;
+
+  // the highest five bits select the sub bucket of the power of two
+  int exponent = 5;
+  while( exponent < 62 && ( value >> ( exponent + 1 ) ) ) ++exponent;
+  int subBucket = (int)( value >> ( exponent - 4 ) ) - SUB_BUCKETS;
+  return LINEAR_VALUES + ( exponent - 5 ) * SUB_BUCKETS + subBucket;
+}
+
+int64_t LatencyHistogram::getHighestValue( int index )
+{
+  if( index < LINEAR_VALUES ) return index;
+
+  int exponent = ( index - LINEAR_VALUES ) / SUB_BUCKETS + 5;
+  int64_t subBucket = ( index - LINEAR_VALUES ) % SUB_BUCKETS + SUB_BUCKETS;
+  return ( ( subBucket + 1 ) << ( exponent - 4 ) ) - 1;
+}
+
+/// Buckets of a stage followed by its count, minimum, maximum and sum
+static const int COUNT = INDEXES;
+static const int MIN = INDEXES + 1;
+static const int MAX = INDEXES + 2;
+static const int SUM = INDEXES + 3;
+static const int VALUES = INDEXES + 4;
+
+SessionLatency::~SessionLatency()
+{
+  delete [] m_pValues;
+}
+
+void SessionLatency::setEnabled( bool value )
+{
+  Locker l( m_mutex );
+  if( value && !m_pValues )
+    m_pValues = new StatisticValue[ STAGES * VALUES ];
+
+  // the values are in place before a record can see the histograms enabled
+  if( value && !m_enabled ) ++m_enabled;
+  else if( !value && m_enabled ) --m_enabled;
+}
+
+void SessionLatency::record( Stage stage, int64_t nanos )
+{
+  if( !m_enabled ) return;
+  if( nanos < 0 ) nanos = 0;
+
+  StatisticValue* values = m_pValues + stage * VALUES;
+  values[ LatencyHistogram::getIndex( nanos ) ].add( 1 );
+  if( !values[ COUNT ].get() || nanos < values[ MIN ].get() )
+    values[ MIN ].set( nanos );
+  if( nanos > values[ MAX ].get() )
+    values[ MAX ].set( nanos );
+  values[ SUM ].add( nanos );
+  values[ COUNT ].add( 1 );
+}
+
+LatencyHistogram SessionLatency::getHistogram( Stage stage )
+{
+  Locker l( m_mutex );
+  LatencyHistogram histogram;
+  if( !m_pValues ) return histogram;
+
+  // the count is taken from the buckets so percentiles add up
+  const StatisticValue* values = m_pValues + stage * VALUES;
+  for( int i = 0; i < INDEXES; ++i )
+  {
+    histogram.m_counts[ i ] = values[ i ].get();
+    histogram.m_count += histogram.m_counts[ i ];
+  }
+  histogram.m_min = values[ MIN ].get();
+  histogram.m_max = values[ MAX ].get();
+  histogram.m_sum = values[ SUM ].get();
+  return histogram;
+}
+
+void SessionLatency::reset()
+{
+  Locker l( m_mutex );
+  if( !m_pValues ) return;
+  for( int i = 0; i < STAGES * VALUES; ++i )
+    m_pValues[ i ].set( 0 );
+}
+
+const char* SessionLatency::getStageName( Stage stage )
+{
+  switch( stage )
+  {
+  case PARSE: return "parse";
+  case SET_STRING: return "setString";
+  case VALIDATE: return "validate";
+  case FROM_APP: return "fromApp";
+  case TO_APP: return "toApp";
+  case TO_STRING: return "toString";
+  case PERSIST: return "persist";
+  case LOG: return "log";
+  case SEND: return "send";
+  case NEXT: return "next";
+  case SEND_RAW: return "sendRaw";
+  default: return "unknown";
+  }
+}
+}
@@ -0,0 +1,152 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_LATENCY_H
+#define FIX_LATENCY_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Mutex.h"
+#include "AtomicCount.h"
+#include "SessionStatistics.h"
+#include "Utility.h"
+#include <vector>
+
+namespace FIX
+{
+/**
+ * HDR style histogram of latencies in nanoseconds.
+ *
+ * Values below 32 have a count each, larger ones are counted in 16 linear
+ * buckets per power of two, so every recorded value is reported with a
+ * relative error below 1/16 at a fixed size of 960 counts.
+ */
+class LatencyHistogram
+{
+public:
+  LatencyHistogram();
+
+  void record( int64_t value );
+  void reset();
+
+  int64_t getCount() const { return m_count; }
+  int64_t getMin() const { return m_count ? m_min : 0; }
+  int64_t getMax() const { return m_max; }
+  int64_t getSum() const { return m_sum; }
+  double getMean() const
+  { return m_count ? (double)m_sum / (double)m_count : 0; }
+  /// Highest value of the bucket holding the given percentile, 0 to 100
+  int64_t getValueAtPercentile( double percentile ) const;
+
+  static int getIndex( int64_t value );
+  static int64_t getHighestValue( int index );
+
+private:
+  friend class SessionLatency;
+
+  std::vector < int64_t > m_counts;
+  int64_t m_count;
+  int64_t m_min;
+  int64_t m_max;
+  int64_t m_sum;
+};
+
+/**
+ * Latency histograms of the processing stages of a session.
+ *
+ * Nothing is recorded until the histograms are enabled, the timers of a
+ * disabled session do not even read the clock.  Defining
+ * NO_LATENCY_HISTOGRAMS removes the timers from the engine altogether.
+ *
+ * Records take no lock, each count is a StatisticValue.  The stages of a
+ * session are recorded by the thread driving it, should two threads record
+ * the same stage at once the minimum or maximum may miss one of the values.
+ * Snapshots and resets are serialized by a mutex and may run alongside
+ * records, a snapshot taken meanwhile can be off by the values in flight.
+ */
+class SessionLatency
+{
+public:
+  enum Stage
+  {
+    PARSE, SET_STRING, VALIDATE, FROM_APP, TO_APP, TO_STRING, PERSIST,
+    LOG, SEND, NEXT, SEND_RAW, STAGES
+  };
+
+  SessionLatency() : m_pValues( 0 ), m_enabled( 0 ) {}
+  ~SessionLatency();
+
+  void setEnabled( bool value );
+  bool isEnabled() const { return m_enabled != 0; }
+
+  void record( Stage stage, int64_t nanos );
+  /// Copy of the histogram of a stage
+  LatencyHistogram getHistogram( Stage stage );
+  void reset();
+
+  static const char* getStageName( Stage stage );
+
+private:
+  SessionLatency( const SessionLatency& );
+  SessionLatency& operator=( const SessionLatency& );
+
+  /// Counts of all stages, allocated when first enabled and kept until
+  /// destruction so records never see them go away
+  StatisticValue* m_pValues;
+  atomic_count m_enabled;
+  Mutex m_mutex;
+};
+
+/// Measures the stages of a session one after the other
+class LatencyTimer
+{
+public:
+#ifndef NO_LATENCY_HISTOGRAMS
+  LatencyTimer( SessionLatency& latency )
+  : m_latency( latency ), m_start( latency.isEnabled() ? time_monotonic() : 0 ) {}
+
+  /// Starts measuring the next stage now
+  void restart()
+  { if( m_start ) m_start = time_monotonic(); }
+
+  /// Records the time since the start or the last stage
+  void stop( SessionLatency::Stage stage )
+  {
+    if( !m_start ) return;
+    int64_t now = time_monotonic();
+    m_latency.record( stage, now - m_start );
+    m_start = now;
+  }
+
+private:
+  SessionLatency& m_latency;
+  int64_t m_start;
+#else
+  LatencyTimer( SessionLatency& ) {}
+  void restart() {}
+  void stop( SessionLatency::Stage ) {}
+#endif
+};
+}
+
+#endif //FIX_LATENCY_H
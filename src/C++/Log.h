@@ -29,6 +29,7 @@
 #include "Message.h"
 #include "Mutex.h"
 #include "SessionSettings.h"
+#include "UtcTimeStampFormatter.h"
 #include <map>
 #include <vector>
 
@@ -132,7 +133,7 @@ public:
     if ( !m_incoming ) return ;
     Locker l( s_mutex );
     m_time.setCurrent();
-    std::cout << "<" << UtcTimeStampConvertor::convert(m_time, m_millisecondsInTimeStamp)
+    std::cout << "<" << m_formatter.format(m_time, m_millisecondsInTimeStamp ? 3 : 0)
               << ", " << m_prefix
               << ", " << "incoming>" << std::endl
               << "  (" << value << ")" << std::endl;
@@ -143,7 +144,7 @@ public:
     if ( !m_outgoing ) return ;
     Locker l( s_mutex );
     m_time.setCurrent();
-    std::cout << "<" << UtcTimeStampConvertor::convert(m_time, m_millisecondsInTimeStamp)
+    std::cout << "<" << m_formatter.format(m_time, m_millisecondsInTimeStamp ? 3 : 0)
               << ", " << m_prefix
               << ", " << "outgoing>" << std::endl
               << "  (" << value << ")" << std::endl;
@@ -154,7 +155,7 @@ public:
     if ( !m_event ) return ;
     Locker l( s_mutex );
     m_time.setCurrent();
-    std::cout << "<" << UtcTimeStampConvertor::convert(m_time, m_millisecondsInTimeStamp)
+    std::cout << "<" << m_formatter.format(m_time, m_millisecondsInTimeStamp ? 3 : 0)
               << ", " << m_prefix
               << ", " << "event>" << std::endl
               << "  (" << value << ")" << std::endl;
@@ -168,6 +169,7 @@ public:
 private:
   std::string m_prefix;
   UtcTimeStamp m_time;
+  UtcTimeStampFormatter m_formatter;
   bool m_incoming;
   bool m_outgoing;
   bool m_event;
@@ -125,6 +125,7 @@ Message::Message(const Message& copy)
 , m_trailer(copy.m_trailer)
 , m_validStructure(copy.m_validStructure)
 , m_tag(copy.m_tag)
+, m_receiveTime(copy.m_receiveTime)
 #ifdef HAVE_EMX
 , m_subMsgType(copy.m_subMsgType)
 #endif
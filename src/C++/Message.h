@@ -209,6 +209,15 @@ public:
     return m_validStructure;
   }
 
+  /**
+   * Time an incoming message was read off the socket.
+   * This is the kernel receive timestamp when SocketReceiveTimestamps
+   * is enabled, otherwise the time the engine framed it.  Empty for
+   * messages that were not received by a session.
+   */
+  const DateTime& getReceiveTime() const { return m_receiveTime; }
+  void setReceiveTime( const DateTime& value ) { m_receiveTime = value; }
+
   int bodyLength( int beginStringField = FIELD::BeginString, 
                   int bodyLengthField = FIELD::BodyLength, 
                   int checkSumField = FIELD::CheckSum ) const
@@ -246,6 +255,7 @@ public:
   { 
     m_tag = 0;
     m_validStructure = true;
+    m_receiveTime = DateTime();
     m_header.clear();
     FieldMap::clear();
     m_trailer.clear();
@@ -352,6 +362,7 @@ protected:
   mutable Trailer m_trailer;
   bool m_validStructure;
   int m_tag;
+  DateTime m_receiveTime;
 #ifdef HAVE_EMX
   std::string m_subMsgType;
 #endif
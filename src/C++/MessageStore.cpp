@@ -27,6 +27,26 @@
 
 namespace FIX
 {
+void MessageStore::getRange( int begin, int end,
+                             MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  std::vector < std::string > messages;
+  get( begin, end, messages );
+
+  std::vector < std::string >::const_iterator i;
+  for ( i = messages.begin(); i != messages.end(); ++i )
+  {
+    // the vector carries no sequence numbers, take them from the header
+    int msgSeqNum = 0;
+    std::string::size_type pos = i->find( "\00134=" );
+    if ( pos != std::string::npos )
+      msgSeqNum = atoi( i->c_str() + pos + 4 );
+    if ( !visitor.onMessage( msgSeqNum, i->data(), i->size() ) )
+      return;
+  }
+}
+
 MessageStore* MemoryStoreFactory::create( const SessionID& )
 {
   return new MemoryStore();
@@ -54,6 +74,18 @@ throw( IOException )
     messages.push_back( find->second );
 }
 
+void MemoryStore::getRange( int begin, int end,
+                            MessageStoreVisitor& visitor ) const
+throw( IOException )
+{
+  Messages::const_iterator i = m_messages.lower_bound( begin );
+  for ( ; i != m_messages.end() && i->first <= end; ++i )
+  {
+    if ( !visitor.onMessage( i->first, i->second.data(), i->second.size() ) )
+      return;
+  }
+}
+
 MessageStore* MessageStoreFactoryExceptionWrapper::create( const SessionID& sessionID, bool& threw, ConfigError& ex )
 {
   threw = false;
@@ -80,6 +112,13 @@ void MessageStoreExceptionWrapper::get( int begin, int end, std::vector < std::s
   catch ( IOException & e ) { threw = true; ex = e; }
 }
 
+void MessageStoreExceptionWrapper::getRange( int begin, int end, MessageStoreVisitor& visitor, bool& threw, IOException& ex ) const
+{
+  threw = false;
+  try { m_pStore->getRange( begin, end, visitor ); }
+  catch ( IOException & e ) { threw = true; ex = e; }
+}
+
 int MessageStoreExceptionWrapper::getNextSenderMsgSeqNum( bool& threw, IOException& ex ) const
 {
   threw = false;
@@ -59,6 +59,39 @@ public:
   void destroy( MessageStore* );
 };
 
+/**
+ * Receives the messages of a range read from a MessageStore.
+ *
+ * The data is only valid for the duration of the call, it points into
+ * the buffers of the store and is not null terminated.  The store must not
+ * be modified from within onMessage.
+ */
+class MessageStoreVisitor
+{
+public:
+  virtual ~MessageStoreVisitor() {}
+
+  /// Return false to stop reading the range
+  virtual bool onMessage( int msgSeqNum, const char* data, std::size_t length ) = 0;
+};
+
+/// Appends the visited messages to a vector
+class MessageStoreCollector : public MessageStoreVisitor
+{
+public:
+  MessageStoreCollector( std::vector < std::string > & messages )
+  : m_messages( messages ) {}
+
+  bool onMessage( int, const char* data, std::size_t length )
+  {
+    m_messages.push_back( std::string( data, length ) );
+    return true;
+  }
+
+private:
+  std::vector < std::string > & m_messages;
+};
+
 /**
  * This interface must be implemented to store and retrieve messages and
  * sequence numbers.
@@ -72,6 +105,13 @@ public:
   throw ( IOException ) = 0;
   virtual void get( int, int, std::vector < std::string > & ) const
   throw ( IOException ) = 0;
+  /**
+   * Passes the stored messages from begin to end to the visitor in
+   * MsgSeqNum order without copying them.  The default implementation
+   * is based on get, stores should read the whole range at once.
+   */
+  virtual void getRange( int begin, int end, MessageStoreVisitor& ) const
+  throw ( IOException );
 
   virtual int getNextSenderMsgSeqNum() const throw ( IOException ) = 0;
   virtual int getNextTargetMsgSeqNum() const throw ( IOException ) = 0;
@@ -84,6 +124,12 @@ public:
 
   virtual void reset() throw ( IOException ) = 0;
   virtual void refresh() throw ( IOException ) = 0;
+
+  /**
+   * Waits until every write accepted so far has reached the underlying
+   * storage.  Only stores that defer their writes need to implement this.
+   */
+  virtual void flush() throw ( IOException ) {}
 };
 /*! @} */
 
@@ -100,6 +146,7 @@ public:
 
   bool set( int, const std::string& ) throw ( IOException );
   void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
 
   int getNextSenderMsgSeqNum() const throw ( IOException )
   { return m_nextSenderMsgSeqNum; }
@@ -157,6 +204,7 @@ public:
 
   bool set( int, const std::string&, bool&, IOException& );
   void get( int, int, std::vector < std::string > &, bool&, IOException& ) const;
+  void getRange( int, int, MessageStoreVisitor&, bool&, IOException& ) const;
   int getNextSenderMsgSeqNum( bool&, IOException& ) const;
   int getNextTargetMsgSeqNum( bool&, IOException& ) const;
   void setNextSenderMsgSeqNum( int, bool&, IOException& );
@@ -0,0 +1,411 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "MmapStore.h"
+#include "SessionID.h"
+#include "Utility.h"
+
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#endif
+
+namespace FIX
+{
+static const char MMAP_STORE_MAGIC[ 8 ] = { 'Q', 'F', 'M', 'M', 'A', 'P', '1', 0 };
+static const size_t MMAP_STORE_DEFAULT_SIZE = 16 * 1024 * 1024;
+
+MmapStore::MappedFile::MappedFile()
+: m_pData( 0 ), m_size( 0 ),
+#ifdef _MSC_VER
+  m_file( INVALID_HANDLE_VALUE ), m_mapping( 0 )
+#else
+  m_file( -1 )
+#endif
+{
+}
+
+MmapStore::MappedFile::~MappedFile()
+{
+  close();
+}
+
+void MmapStore::MappedFile::open( const std::string& path, size_t size )
+throw ( IOException )
+{
+  close();
+  m_path = path;
+
+#ifdef _MSC_VER
+  m_file = CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                        FILE_SHARE_READ, 0, OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, 0 );
+  if( m_file == INVALID_HANDLE_VALUE )
+    throw IOException( "Could not open file: " + path );
+
+  LARGE_INTEGER fileSize;
+  if( !GetFileSizeEx( m_file, &fileSize ) )
+    throw IOException( "Could not get size of file: " + path );
+  m_size = (size_t)fileSize.QuadPart;
+#else
+  m_file = ::open( path.c_str(), O_RDWR | O_CREAT, 0644 );
+  if( m_file < 0 )
+    throw IOException( "Could not open file: " + path );
+
+  struct stat buf;
+  if( fstat( m_file, &buf ) != 0 )
+    throw IOException( "Could not get size of file: " + path );
+  m_size = (size_t)buf.st_size;
+#endif
+
+  if( m_size < size )
+    m_size = size;
+  map();
+}
+
+void MmapStore::MappedFile::resize( size_t size ) throw ( IOException )
+{
+  unmap();
+  m_size = size;
+  map();
+}
+
+void MmapStore::MappedFile::close()
+{
+  unmap();
+#ifdef _MSC_VER
+  if( m_file != INVALID_HANDLE_VALUE ) CloseHandle( m_file );
+  m_file = INVALID_HANDLE_VALUE;
+#else
+  if( m_file >= 0 ) ::close( m_file );
+  m_file = -1;
+#endif
+  m_size = 0;
+}
+
+void MmapStore::MappedFile::map() throw ( IOException )
+{
+#ifdef _MSC_VER
+  // the mapping extends the file to its size
+  ULARGE_INTEGER mapSize;
+  mapSize.QuadPart = m_size;
+  m_mapping = CreateFileMappingA( m_file, 0, PAGE_READWRITE,
+                                  mapSize.HighPart, mapSize.LowPart, 0 );
+  if( !m_mapping )
+    throw IOException( "Could not map file: " + m_path );
+  m_pData = (char*)MapViewOfFile( m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, m_size );
+  if( !m_pData )
+    throw IOException( "Could not map file: " + m_path );
+#else
+  struct stat buf;
+  if( fstat( m_file, &buf ) != 0 || (size_t)buf.st_size < m_size )
+  {
+    if( ftruncate( m_file, m_size ) != 0 )
+      throw IOException( "Could not extend file: " + m_path );
+  }
+  void* pData = mmap( 0, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0 );
+  if( pData == MAP_FAILED )
+    throw IOException( "Could not map file: " + m_path );
+  m_pData = (char*)pData;
+#endif
+}
+
+void MmapStore::MappedFile::unmap()
+{
+#ifdef _MSC_VER
+  if( m_pData ) UnmapViewOfFile( m_pData );
+  if( m_mapping ) CloseHandle( m_mapping );
+  m_mapping = 0;
+#else
+  if( m_pData ) munmap( m_pData, m_size );
+#endif
+  m_pData = 0;
+}
+
+MmapStore::MmapStore( std::string path, const SessionID& s, size_t size )
+: m_initialSize( size ? size : MMAP_STORE_DEFAULT_SIZE ),
+  m_dataEnd( 0 ), m_records( 0 )
+{
+  file_mkdir( path.c_str() );
+
+  if ( path.empty() ) path = ".";
+  const std::string& begin =
+    s.getBeginString().getString();
+  const std::string& sender =
+    s.getSenderCompID().getString();
+  const std::string& target =
+    s.getTargetCompID().getString();
+  const std::string& qualifier =
+    s.getSessionQualifier();
+
+  std::string sessionid = begin + "-" + sender + "-" + target;
+  if( qualifier.size() )
+    sessionid += "-" + qualifier;
+
+  std::string prefix
+    = file_appendpath(path, sessionid + ".");
+
+  m_dataFileName = prefix + "data";
+  m_indexFileName = prefix + "index";
+  m_sessionFileName = prefix + "session";
+
+  try
+  {
+    open( false );
+  }
+  catch ( IOException & e )
+  {
+    throw ConfigError( e.what() );
+  }
+}
+
+MmapStore::~MmapStore()
+{
+}
+
+void MmapStore::open( bool deleteFile )
+{
+  m_data.close();
+  m_index.close();
+
+  if ( deleteFile )
+  {
+    file_unlink( m_dataFileName.c_str() );
+    file_unlink( m_indexFileName.c_str() );
+    file_unlink( m_sessionFileName.c_str() );
+  }
+
+  m_data.open( m_dataFileName, m_initialSize );
+  size_t records = m_initialSize / 512;
+  if( records < 1024 ) records = 1024;
+  m_index.open( m_indexFileName,
+                sizeof( IndexHeader ) + records * sizeof( IndexRecord ) );
+
+  IndexHeader& indexHeader = header();
+  if( indexHeader.m_magic[ 0 ] == 0 )
+  {
+    memcpy( indexHeader.m_magic, MMAP_STORE_MAGIC, sizeof( MMAP_STORE_MAGIC ) );
+    indexHeader.m_nextSenderMsgSeqNum = 1;
+    indexHeader.m_nextTargetMsgSeqNum = 1;
+  }
+  else if( memcmp( indexHeader.m_magic, MMAP_STORE_MAGIC, sizeof( MMAP_STORE_MAGIC ) ) )
+    throw IOException( "Unknown index file format: " + m_indexFileName );
+
+  load();
+
+  FILE* sessionFile = file_fopen( m_sessionFileName.c_str(), "r" );
+  if ( sessionFile )
+  {
+    char time[ 22 ];
+#ifdef HAVE_FSCANF_S
+    int result = FILE_FSCANF( sessionFile, "%s", time, 22 );
+#else
+    int result = FILE_FSCANF( sessionFile, "%s", time );
+#endif
+    fclose( sessionFile );
+    if( result == 1 )
+      m_creationTime = UtcTimeStampConvertor::convert( time, true );
+    else
+      setSession();
+  }
+  else
+  {
+    m_creationTime.setCurrent();
+    setSession();
+  }
+}
+
+void MmapStore::load()
+{
+  m_dataEnd = 0;
+  m_records = 0;
+  m_recordIndex.clear();
+
+  // records are appended in order, an unused record has sequence number 0
+  const IndexRecord* pRecords = records();
+  size_t capacity = getRecordCapacity();
+  for( ; m_records < capacity; ++m_records )
+  {
+    const IndexRecord& record = pRecords[ m_records ];
+    if( record.m_msgSeqNum <= 0 || record.m_length < 0 ) break;
+    size_t end = (size_t)record.m_offset + record.m_length;
+    if( record.m_offset < 0 || end > m_data.getSize() ) break;
+
+    if( m_recordIndex.size() <= (size_t)record.m_msgSeqNum )
+      m_recordIndex.resize( record.m_msgSeqNum + 1, 0 );
+    m_recordIndex[ record.m_msgSeqNum ] = m_records + 1;
+    if( end > m_dataEnd ) m_dataEnd = end;
+  }
+}
+
+MessageStore* MmapStoreFactory::create( const SessionID& s )
+{
+  if ( m_path.size() ) return new MmapStore( m_path, s, m_size );
+
+  Dictionary settings = m_settings.get( s );
+  std::string path = settings.getString( MMAP_STORE_PATH );
+  size_t size = 0;
+  if( settings.has( MMAP_STORE_SIZE ) )
+    size = settings.getInt( MMAP_STORE_SIZE );
+  return new MmapStore( path, s, size );
+}
+
+void MmapStoreFactory::destroy( MessageStore* pStore )
+{
+  delete pStore;
+}
+
+bool MmapStore::set( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  if( msgSeqNum <= 0 ) return false;
+
+  size_t size = msg.size();
+  if( m_dataEnd + size > m_data.getSize() )
+  {
+    size_t capacity = m_data.getSize() * 2;
+    while( capacity < m_dataEnd + size ) capacity *= 2;
+    m_data.resize( capacity );
+  }
+  if( m_records == getRecordCapacity() )
+  {
+    m_index.resize( sizeof( IndexHeader )
+                    + getRecordCapacity() * 2 * sizeof( IndexRecord ) );
+  }
+
+  memcpy( m_data.getData() + m_dataEnd, msg.data(), size );
+
+  // the sequence number marks the record as used, store it last
+  IndexRecord& record = records()[ m_records ];
+  record.m_offset = m_dataEnd;
+  record.m_length = (int32_t)size;
+  record.m_msgSeqNum = msgSeqNum;
+
+  if( m_recordIndex.size() <= (size_t)msgSeqNum )
+    m_recordIndex.resize( msgSeqNum + 1, 0 );
+  m_recordIndex[ msgSeqNum ] = ++m_records;
+  m_dataEnd += size;
+  return true;
+}
+
+void MmapStore::get( int begin, int end,
+                     std::vector < std::string > & result ) const
+throw ( IOException )
+{
+  result.clear();
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void MmapStore::getRange( int begin, int end,
+                          MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  if( begin < 1 ) begin = 1;
+  if( end >= (int)m_recordIndex.size() ) end = (int)m_recordIndex.size() - 1;
+
+  const IndexRecord* pRecords = records();
+  const char* pData = m_data.getData();
+  for ( int i = begin; i <= end; ++i )
+  {
+    size_t index = m_recordIndex[ i ];
+    if( !index ) continue;
+    const IndexRecord& record = pRecords[ index - 1 ];
+    if( !visitor.onMessage( i, pData + record.m_offset, record.m_length ) )
+      return;
+  }
+}
+
+int MmapStore::getNextSenderMsgSeqNum() const throw ( IOException )
+{
+  return header().m_nextSenderMsgSeqNum;
+}
+
+int MmapStore::getNextTargetMsgSeqNum() const throw ( IOException )
+{
+  return header().m_nextTargetMsgSeqNum;
+}
+
+void MmapStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
+{
+  header().m_nextSenderMsgSeqNum = value;
+}
+
+void MmapStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
+{
+  header().m_nextTargetMsgSeqNum = value;
+}
+
+void MmapStore::incrNextSenderMsgSeqNum() throw ( IOException )
+{
+  ++header().m_nextSenderMsgSeqNum;
+}
+
+void MmapStore::incrNextTargetMsgSeqNum() throw ( IOException )
+{
+  ++header().m_nextTargetMsgSeqNum;
+}
+
+UtcTimeStamp MmapStore::getCreationTime() const throw ( IOException )
+{
+  return m_creationTime;
+}
+
+void MmapStore::reset() throw ( IOException )
+{
+  try
+  {
+    open( true );
+  }
+  catch( std::exception& e )
+  {
+    throw IOException( e.what() );
+  }
+}
+
+void MmapStore::refresh() throw ( IOException )
+{
+  try
+  {
+    open( false );
+  }
+  catch( std::exception& e )
+  {
+    throw IOException( e.what() );
+  }
+}
+
+void MmapStore::setSession()
+{
+  FILE* sessionFile = file_fopen( m_sessionFileName.c_str(), "w" );
+  if ( !sessionFile )
+    throw IOException( "Could not open session file: " + m_sessionFileName );
+  fprintf( sessionFile, "%s",
+           UtcTimeStampConvertor::convert( m_creationTime ).c_str() );
+  bool failed = ferror( sessionFile ) != 0;
+  if ( fclose( sessionFile ) || failed )
+    throw IOException( "Unable to write to file " + m_sessionFileName );
+}
+
+} //namespace FIX
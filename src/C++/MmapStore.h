@@ -0,0 +1,166 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_MMAPSTORE_H
+#define FIX_MMAPSTORE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "MessageStore.h"
+#include "SessionSettings.h"
+#include "Utility.h"
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+/// Creates a memory mapped file based implementation of MessageStore.
+class MmapStoreFactory : public MessageStoreFactory
+{
+public:
+  MmapStoreFactory( const SessionSettings& settings )
+: m_size( 0 ), m_settings( settings ) {};
+  MmapStoreFactory( const std::string& path, size_t size = 0 )
+: m_path( path ), m_size( size ) {};
+
+  MessageStore* create( const SessionID& );
+  void destroy( MessageStore* );
+private:
+  std::string m_path;
+  size_t m_size;
+  SessionSettings m_settings;
+};
+/*! @} */
+
+/**
+ * Memory mapped file based implementation of MessageStore.
+ *
+ * Three files are created by this implementation.  One for storing outgoing
+ * messages, one binary index holding the sequence numbers and message
+ * locations, and one for storing the session creation time.
+ *
+ * The formats of the files are:<br>
+ * &nbsp;&nbsp;
+ *   [path]+[BeginString]-[SenderCompID]-[TargetCompID].data<br>
+ * &nbsp;&nbsp;
+ *   [path]+[BeginString]-[SenderCompID]-[TargetCompID].index<br>
+ * &nbsp;&nbsp;
+ *   [path]+[BeginString]-[SenderCompID]-[TargetCompID].session<br>
+ *
+ * The data and index files are preallocated and mapped into memory, storing
+ * a message copies it into the data mapping and appends a fixed width
+ * record to the index mapping.  Both files double in size when full.
+ * Like FileStore, writes reach the operating system page cache and survive
+ * a process crash, they are not synced to disk.
+ */
+class MmapStore : public MessageStore
+{
+public:
+  MmapStore( std::string, const SessionID& s, size_t size = 0 );
+  virtual ~MmapStore();
+
+  bool set( int, const std::string& ) throw ( IOException );
+  void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
+
+  int getNextSenderMsgSeqNum() const throw ( IOException );
+  int getNextTargetMsgSeqNum() const throw ( IOException );
+  void setNextSenderMsgSeqNum( int value ) throw ( IOException );
+  void setNextTargetMsgSeqNum( int value ) throw ( IOException );
+  void incrNextSenderMsgSeqNum() throw ( IOException );
+  void incrNextTargetMsgSeqNum() throw ( IOException );
+
+  UtcTimeStamp getCreationTime() const throw ( IOException );
+
+  void reset() throw ( IOException );
+  void refresh() throw ( IOException );
+
+private:
+  /// A file mapped read write into memory
+  class MappedFile
+  {
+  public:
+    MappedFile();
+    ~MappedFile();
+
+    void open( const std::string& path, size_t size ) throw ( IOException );
+    void resize( size_t size ) throw ( IOException );
+    void close();
+
+    char* getData() const { return m_pData; }
+    size_t getSize() const { return m_size; }
+
+  private:
+    void map() throw ( IOException );
+    void unmap();
+
+    std::string m_path;
+    char* m_pData;
+    size_t m_size;
+#ifdef _MSC_VER
+    HANDLE m_file;
+    HANDLE m_mapping;
+#else
+    int m_file;
+#endif
+  };
+
+  struct IndexHeader
+  {
+    char m_magic[ 8 ];
+    int32_t m_nextSenderMsgSeqNum;
+    int32_t m_nextTargetMsgSeqNum;
+  };
+
+  struct IndexRecord
+  {
+    int64_t m_offset;
+    int32_t m_msgSeqNum;
+    int32_t m_length;
+  };
+
+  void open( bool deleteFile );
+  void load();
+  void setSession();
+  IndexHeader& header() const
+  { return *reinterpret_cast < IndexHeader* > ( m_index.getData() ); }
+  IndexRecord* records() const
+  { return reinterpret_cast < IndexRecord* > ( m_index.getData() + sizeof( IndexHeader ) ); }
+  size_t getRecordCapacity() const
+  { return ( m_index.getSize() - sizeof( IndexHeader ) ) / sizeof( IndexRecord ); }
+
+  MappedFile m_data;
+  MappedFile m_index;
+  size_t m_initialSize;
+  size_t m_dataEnd;
+  size_t m_records;
+  std::vector < size_t > m_recordIndex;
+  UtcTimeStamp m_creationTime;
+
+  std::string m_dataFileName;
+  std::string m_indexFileName;
+  std::string m_sessionFileName;
+};
+}
+
+#endif //FIX_MMAPSTORE_H
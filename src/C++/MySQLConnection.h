@@ -36,7 +36,12 @@
 #include <errmsg.h>
 #include "DatabaseConnectionID.h"
 #include "DatabaseConnectionPool.h"
+#include "FieldConvertors.h"
 #include "Mutex.h"
+#include <cstring>
+#include <deque>
+#include <map>
+#include <vector>
 
 #undef MYSQL_PORT
 
@@ -68,7 +73,11 @@ public:
         return true;
       m_status = mysql_errno( pConnection );
       m_reason = mysql_error( pConnection );
-      mysql_ping( pConnection );
+      // a failing query on a live connection would only fail again, a
+      // reconnect made by the ping shows in a new thread id
+      unsigned long thread = mysql_thread_id( pConnection );
+      if( mysql_ping( pConnection ) == 0 && mysql_thread_id( pConnection ) == thread )
+        break;
       retry++;
     } while( retry <= 1 );
     return success();
@@ -89,6 +98,18 @@ public:
     return m_reason;
   }
 
+  /// Returns the next row of the result, 0 after the last one
+  MYSQL_ROW fetch()
+  {
+    return m_result ? mysql_fetch_row( m_result ) : 0;
+  }
+
+  /// Lengths of the columns of the row last returned by fetch
+  unsigned long* lengths()
+  {
+    return mysql_fetch_lengths( m_result );
+  }
+
   char* getValue( int row, int column )
   {
     if( m_rows.empty() )
@@ -114,6 +135,95 @@ private:
   std::vector<MYSQL_ROW> m_rows;
 };
 
+/**
+ * A statement prepared once per connection and executed with bound
+ * parameters, so values are neither escaped nor parsed by the server.
+ * Parameters refer to the strings passed in, they must outlive execute.
+ */
+class MySQLStatement
+{
+public:
+  MySQLStatement( const std::string& statement )
+  : m_status( 0 ), m_statement( statement )
+  {}
+
+  void addParameter( const std::string& value )
+  {
+    m_data.push_back( value.data() );
+    m_lengths.push_back( value.size() );
+  }
+
+  void addParameter( int value )
+  {
+    m_values.push_back( IntConvertor::convert( value ) );
+    addParameter( m_values.back() );
+  }
+
+  void addNull()
+  {
+    m_data.push_back( 0 );
+    m_lengths.push_back( 0 );
+  }
+
+  bool execute( MYSQL_STMT* pStatement )
+  {
+    std::vector < MYSQL_BIND > binds( m_data.size() );
+    for( size_t i = 0; i < binds.size(); ++i )
+    {
+      memset( &binds[ i ], 0, sizeof( MYSQL_BIND ) );
+      binds[ i ].buffer_type = m_data[ i ] ? MYSQL_TYPE_STRING : MYSQL_TYPE_NULL;
+      binds[ i ].buffer = const_cast < char* > ( m_data[ i ] );
+      binds[ i ].buffer_length = m_lengths[ i ];
+      binds[ i ].length = &m_lengths[ i ];
+    }
+
+    if( ( binds.size() && mysql_stmt_bind_param( pStatement, &binds[ 0 ] ) )
+        || mysql_stmt_execute( pStatement ) )
+    {
+      setError( mysql_stmt_errno( pStatement ), mysql_stmt_error( pStatement ) );
+      return false;
+    }
+
+    m_status = 0;
+    return true;
+  }
+
+  void setError( int status, const std::string& reason )
+  {
+    m_status = status;
+    m_reason = reason;
+  }
+
+  bool success()
+  {
+    return m_status == 0;
+  }
+
+  const std::string& statement() const
+  {
+    return m_statement;
+  }
+
+  const std::string& reason()
+  {
+    return m_reason;
+  }
+
+  void throwException() throw( IOException )
+  {
+    if( !success() )
+      throw IOException( "Statement failed [" + m_statement + "] " + reason() );
+  }
+
+private:
+  int m_status;
+  std::string m_statement;
+  std::string m_reason;
+  std::vector < const char* > m_data;
+  std::vector < unsigned long > m_lengths;
+  std::deque < std::string > m_values;
+};
+
 class MySQLConnection
 {
 public:
@@ -134,6 +244,7 @@ public:
 
   ~MySQLConnection()
   {
+    clearStatements();
     if( m_pConnection )
       mysql_close( m_pConnection );
   }
@@ -161,7 +272,62 @@ public:
     return pQuery.execute( m_pConnection );
   }
 
+  bool execute( MySQLStatement& statement )
+  {
+    Locker locker( m_mutex );
+    int retry = 0;
+
+    do
+    {
+      MYSQL_STMT* pStatement = prepare( statement );
+      if( pStatement && statement.execute( pStatement ) )
+        return true;
+      // a constraint or other statement error leaves the connection and
+      // its prepared statements usable, only a lost connection loses them
+      unsigned long thread = mysql_thread_id( m_pConnection );
+      if( mysql_ping( m_pConnection ) == 0 && mysql_thread_id( m_pConnection ) == thread )
+        return false;
+      clearStatements();
+      retry++;
+    } while( retry <= 1 );
+    return false;
+  }
+
 private:
+  typedef std::map < std::string, MYSQL_STMT* > Statements;
+
+  MYSQL_STMT* prepare( MySQLStatement& statement )
+  {
+    const std::string& text = statement.statement();
+    Statements::iterator i = m_statements.find( text );
+    if( i != m_statements.end() )
+      return i->second;
+
+    MYSQL_STMT* pStatement = mysql_stmt_init( m_pConnection );
+    if( !pStatement )
+    {
+      statement.setError( mysql_errno( m_pConnection ), mysql_error( m_pConnection ) );
+      return 0;
+    }
+    if( mysql_stmt_prepare( pStatement, text.c_str(), text.size() ) )
+    {
+      statement.setError( mysql_stmt_errno( pStatement ), mysql_stmt_error( pStatement ) );
+      mysql_stmt_close( pStatement );
+      return 0;
+    }
+
+    m_statements[ text ] = pStatement;
+    return pStatement;
+  }
+
+  void clearStatements()
+  {
+    Statements::iterator i;
+    for( i = m_statements.begin(); i != m_statements.end(); ++i )
+      mysql_stmt_close( i->second );
+    m_statements.clear();
+  }
+
   void connect()
   {
     short port = m_connectionID.getPort();
@@ -181,6 +347,7 @@ private:
 
   MYSQL* m_pConnection;
   DatabaseConnectionID m_connectionID;
+  Statements m_statements;
   Mutex m_mutex;
 };
 
@@ -43,7 +43,8 @@ const short MySQLLogFactory::DEFAULT_PORT = 0;
 
 MySQLLog::MySQLLog
 ( const SessionID& s, const DatabaseConnectionID& d, MySQLConnectionPool* p )
-: m_pConnectionPool( p )
+: m_pConnectionPool( p ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pSessionID = new SessionID( s );
@@ -52,7 +53,8 @@ MySQLLog::MySQLLog
 
 MySQLLog::MySQLLog
 ( const DatabaseConnectionID& d, MySQLConnectionPool* p )
-: m_pConnectionPool( p ), m_pSessionID( 0 )
+: m_pConnectionPool( p ), m_pSessionID( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pConnection = m_pConnectionPool->create( d );
@@ -61,7 +63,8 @@ MySQLLog::MySQLLog
 MySQLLog::MySQLLog
 ( const SessionID& s, const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 )
+  : m_pConnectionPool( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pSessionID = new SessionID( s );
@@ -71,7 +74,8 @@ MySQLLog::MySQLLog
 MySQLLog::MySQLLog
 ( const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 ), m_pSessionID( 0 )
+  : m_pConnectionPool( 0 ), m_pSessionID( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   m_pConnection = new MySQLConnection( database, user, password, host, port );
 }
@@ -85,6 +89,7 @@ void MySQLLog::init()
 
 MySQLLog::~MySQLLog()
 {
+  writeBatch();
   if( m_pConnectionPool )
     m_pConnectionPool->destroy( m_pConnection );
   else
@@ -176,6 +181,16 @@ void MySQLLogFactory::initLog( const Dictionary& settings, MySQLLog& log )
 
   try { log.setEventTable( settings.getString( MYSQL_LOG_EVENT_TABLE ) ); }
   catch( ConfigError& ) {}
+
+  int batchSize = 0;
+  try { batchSize = settings.getInt( MYSQL_LOG_BATCH_SIZE ); }
+  catch( ConfigError& ) {}
+
+  int batchInterval = 0;
+  try { batchInterval = settings.getInt( MYSQL_LOG_BATCH_INTERVAL ); }
+  catch( ConfigError& ) {}
+
+  log.setBatch( batchSize, batchInterval );
 }
 
 void MySQLLogFactory::destroy( Log* pLog )
@@ -185,6 +200,10 @@ void MySQLLogFactory::destroy( Log* pLog )
 
 void MySQLLog::clear()
 {
+  m_pending.clear();
+  m_pendingLines = 0;
+  m_batchStart = 0;
+
   std::stringstream whereClause;
 
   whereClause << "WHERE ";
@@ -238,36 +257,75 @@ void MySQLLog::insert( const std::string& table, const std::string value )
   STRING_SPRINTF( sqlTime, "%d-%02d-%02d %02d:%02d:%02d",
            year, month, day, hour, minute, second );
 
-  char* valueCopy = new char[ (value.size() * 2) + 1 ];
-  mysql_escape_string( valueCopy, value.c_str(), value.size() );
+  std::vector < Line > & lines = m_pending[ table ];
+  lines.push_back( Line() );
+  lines.back().m_time = sqlTime;
+  lines.back().m_millis = millis;
+  lines.back().m_text = value;
+  ++m_pendingLines;
 
-  std::stringstream queryString;
-  queryString << "INSERT INTO " << table << " "
-  << "(time, time_milliseconds, beginstring, sendercompid, targetcompid, session_qualifier, text) "
-  << "VALUES ("
-  << "'" << sqlTime << "','" << millis << "',";
+  int64_t now = time_monotonic();
+  if( !m_batchStart ) m_batchStart = now;
 
-  if( m_pSessionID )
+  if( m_batchSize > 1 && m_pendingLines < m_batchSize
+      && ( !m_batchInterval
+           || now - m_batchStart < (int64_t)m_batchInterval * 1000000 ) )
+    return;
+
+  writeBatch();
+}
+
+void MySQLLog::writeBatch()
+{
+  Lines::const_iterator i;
+  for( i = m_pending.begin(); i != m_pending.end(); ++i )
   {
-    queryString
-    << "\"" << m_pSessionID->getBeginString().getValue() << "\","
-    << "\"" << m_pSessionID->getSenderCompID().getValue() << "\","
-    << "\"" << m_pSessionID->getTargetCompID().getValue() << "\",";
-    if( m_pSessionID->getSessionQualifier() == "" )
-      queryString << "NULL" << ",";
-    else
-      queryString << "\"" << m_pSessionID->getSessionQualifier() << "\",";
+    const std::vector < Line > & lines = i->second;
+    if( lines.empty() ) continue;
+
+    MySQLStatement statement( insertStatement( i->first, lines.size() ) );
+    std::vector < Line > ::const_iterator line;
+    for( line = lines.begin(); line != lines.end(); ++line )
+    {
+      statement.addParameter( line->m_time );
+      statement.addParameter( line->m_millis );
+      addSessionParameters( statement );
+      statement.addParameter( line->m_text );
+    }
+    m_pConnection->execute( statement );
   }
-  else
+
+  m_pending.clear();
+  m_pendingLines = 0;
+  m_batchStart = 0;
+}
+
+void MySQLLog::addSessionParameters( MySQLStatement& statement ) const
+{
+  if( !m_pSessionID )
   {
-    queryString << "NULL, NULL, NULL, NULL, ";
+    for( int i = 0; i < 4; ++i )
+      statement.addNull();
+    return;
   }
 
-  queryString << "\"" << valueCopy << "\")";
-  delete [] valueCopy;
+  statement.addParameter( m_pSessionID->getBeginString().getValue() );
+  statement.addParameter( m_pSessionID->getSenderCompID().getValue() );
+  statement.addParameter( m_pSessionID->getTargetCompID().getValue() );
+  if( m_pSessionID->getSessionQualifier() == "" )
+    statement.addNull();
+  else
+    statement.addParameter( m_pSessionID->getSessionQualifier() );
+}
 
-  MySQLQuery query( queryString.str() );
-  m_pConnection->execute( query );
+std::string MySQLLog::insertStatement( const std::string& table, size_t rows )
+{
+  std::string statement = "INSERT INTO " + table + " "
+    "(time, time_milliseconds, beginstring, sendercompid, targetcompid, session_qualifier, text) "
+    "VALUES ";
+  for( size_t i = 0; i < rows; ++i )
+    statement += i ? ",(?,?,?,?,?,?,?)" : "(?,?,?,?,?,?,?)";
+  return statement;
 }
 
 } //namespace FIX
@@ -36,11 +36,20 @@
 #include "SessionSettings.h"
 #include "MySQLConnection.h"
 #include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace FIX
 {
-/// MySQL based implementation of Log.
+/**
+ * MySQL based implementation of Log.
+ *
+ * Lines are written with prepared statements.  In batch mode they are
+ * written with one multi row statement per table once batch size lines
+ * are pending or the batch interval in milliseconds passed since the
+ * first pending line.  Pending lines are written when the log is destroyed.
+ */
 class MySQLLog : public Log
 {
 public:
@@ -61,6 +70,9 @@ public:
   { m_outgoingTable = outgoingTable; }
   void setEventTable( const std::string& eventTable )
   { m_eventTable = eventTable; }
+  /// Batches up to size lines, size 0 or 1 writes every line at once
+  void setBatch( int size, int interval )
+  { m_batchSize = size; m_batchInterval = interval; }
 
   void onIncoming( const std::string& value )
   { insert( m_incomingTable, value ); }
@@ -70,8 +82,20 @@ public:
   { insert( m_eventTable, value ); }
 
 private:
+  struct Line
+  {
+    std::string m_time;
+    int m_millis;
+    std::string m_text;
+  };
+
+  typedef std::map < std::string, std::vector < Line > > Lines;
+
   void init();
   void insert( const std::string& table, const std::string value );
+  void writeBatch();
+  void addSessionParameters( MySQLStatement& statement ) const;
+  static std::string insertStatement( const std::string& table, size_t rows );
 
   std::string m_incomingTable;
   std::string m_outgoingTable;
@@ -79,6 +103,11 @@ private:
   MySQLConnection* m_pConnection;
   MySQLConnectionPool* m_pConnectionPool;
   SessionID* m_pSessionID;
+  Lines m_pending;
+  int m_pendingLines;
+  int64_t m_batchStart;
+  int m_batchSize;
+  int m_batchInterval;
 };
 
 /// Creates a MySQL based implementation of Log.
@@ -45,7 +45,8 @@ const short MySQLStoreFactory::DEFAULT_PORT = 3306;
 
 MySQLStore::MySQLStore
 ( const SessionID& s, const DatabaseConnectionID& d, MySQLConnectionPool* p )
-  : m_pConnectionPool( p ), m_sessionID( s )
+  : m_seqNumsChanged( false ), m_batchStart( 0 ), m_batchSize( 0 ),
+    m_batchInterval( 0 ), m_pConnectionPool( p ), m_sessionID( s )
 {
   m_pConnection = m_pConnectionPool->create( d );
   populateCache();
@@ -54,7 +55,8 @@ MySQLStore::MySQLStore
 MySQLStore::MySQLStore
 ( const SessionID& s, const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 ), m_sessionID( s )
+  : m_seqNumsChanged( false ), m_batchStart( 0 ), m_batchSize( 0 ),
+    m_batchInterval( 0 ), m_pConnectionPool( 0 ), m_sessionID( s )
 {
   m_pConnection = new MySQLConnection( database, user, password, host, port );
   populateCache();
@@ -62,6 +64,12 @@ MySQLStore::MySQLStore
 
 MySQLStore::~MySQLStore()
 {
+  try
+  {
+    writeBatch();
+  }
+  catch( IOException& ) {}
+
   if( m_pConnectionPool )
     m_pConnectionPool->destroy( m_pConnection );
   else
@@ -157,8 +165,18 @@ MessageStore* MySQLStoreFactory::create( const SessionID& s, const Dictionary& s
   try { port = ( short ) settings.getInt( MYSQL_STORE_PORT ); }
   catch( ConfigError& ) {}
 
+  int batchSize = 0;
+  try { batchSize = settings.getInt( MYSQL_STORE_BATCH_SIZE ); }
+  catch( ConfigError& ) {}
+
+  int batchInterval = 0;
+  try { batchInterval = settings.getInt( MYSQL_STORE_BATCH_INTERVAL ); }
+  catch( ConfigError& ) {}
+
   DatabaseConnectionID id( database, user, password, host, port );
-  return new MySQLStore( s, id, m_connectionPoolPtr.get() );
+  MySQLStore* pStore = new MySQLStore( s, id, m_connectionPoolPtr.get() );
+  pStore->setBatch( batchSize, batchInterval );
+  return pStore;
 }
 
 void MySQLStoreFactory::destroy( MessageStore* pStore )
@@ -169,36 +187,8 @@ void MySQLStoreFactory::destroy( MessageStore* pStore )
 bool MySQLStore::set( int msgSeqNum, const std::string& msg )
 throw ( IOException )
 {
-  char* msgCopy = new char[ (msg.size() * 2) + 1 ];
-  mysql_escape_string( msgCopy, msg.c_str(), msg.size() );
-
-  std::stringstream queryString;
-  queryString << "INSERT INTO messages "
-  << "(beginstring, sendercompid, targetcompid, session_qualifier, msgseqnum, message) "
-  << "VALUES ("
-  << "\"" << m_sessionID.getBeginString().getValue() << "\","
-  << "\"" << m_sessionID.getSenderCompID().getValue() << "\","
-  << "\"" << m_sessionID.getTargetCompID().getValue() << "\","
-  << "\"" << m_sessionID.getSessionQualifier() << "\","
-  << msgSeqNum << ","
-  << "\"" << msgCopy << "\")";
-
-  delete [] msgCopy;
-
-  MySQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-  {
-    std::stringstream queryString2;
-    queryString2 << "UPDATE messages SET message=\"" << msg << "\" WHERE "
-    << "beginstring=" << "\"" << m_sessionID.getBeginString().getValue() << "\" and "
-    << "sendercompid=" << "\"" << m_sessionID.getSenderCompID().getValue() << "\" and "
-    << "targetcompid=" << "\"" << m_sessionID.getTargetCompID().getValue() << "\" and "
-    << "session_qualifier=" << "\"" << m_sessionID.getSessionQualifier() << "\" and "
-    << "msgseqnum=" << msgSeqNum;
-    MySQLQuery query2( queryString2.str() );
-    if( !m_pConnection->execute(query2) )
-      query2.throwException();
-  }
+  m_pending.push_back( std::make_pair( msgSeqNum, msg ) );
+  changed();
   return true;
 }
 
@@ -206,6 +196,8 @@ void MySQLStore::get( int begin, int end,
                       std::vector < std::string > & result ) const
 throw ( IOException )
 {
+  writeBatch();
+
   result.clear();
   std::stringstream queryString;
   queryString << "SELECT message FROM messages WHERE "
@@ -225,6 +217,35 @@ throw ( IOException )
     result.push_back( query.getValue( row, 0 ) );
 }
 
+void MySQLStore::getRange( int begin, int end,
+                      MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  writeBatch();
+
+  std::stringstream queryString;
+  queryString << "SELECT msgseqnum, message FROM messages WHERE "
+  << "beginstring=" << "\"" << m_sessionID.getBeginString().getValue() << "\" and "
+  << "sendercompid=" << "\"" << m_sessionID.getSenderCompID().getValue() << "\" and "
+  << "targetcompid=" << "\"" << m_sessionID.getTargetCompID().getValue() << "\" and "
+  << "session_qualifier=" << "\"" << m_sessionID.getSessionQualifier() << "\" and "
+  << "msgseqnum>=" << begin << " and " << "msgseqnum<=" << end << " "
+  << "ORDER BY msgseqnum";
+
+  MySQLQuery query( queryString.str() );
+  if( !m_pConnection->execute(query) )
+    query.throwException();
+
+  // visit the rows of the result in place instead of copying them
+  MYSQL_ROW row = 0;
+  while( (row = query.fetch()) )
+  {
+    unsigned long* lengths = query.lengths();
+    if( !visitor.onMessage( atoi( row[0] ), row[1], lengths[1] ) )
+      return;
+  }
+}
+
 int MySQLStore::getNextSenderMsgSeqNum() const throw ( IOException )
 {
   return m_cache.getNextSenderMsgSeqNum();
@@ -237,44 +258,30 @@ int MySQLStore::getNextTargetMsgSeqNum() const throw ( IOException )
 
 void MySQLStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
 {
-  std::stringstream queryString;
-  queryString << "UPDATE sessions SET outgoing_seqnum=" << value << " WHERE "
-  << "beginstring=" << "\"" << m_sessionID.getBeginString().getValue() << "\" and "
-  << "sendercompid=" << "\"" << m_sessionID.getSenderCompID().getValue() << "\" and "
-  << "targetcompid=" << "\"" << m_sessionID.getTargetCompID().getValue() << "\" and "
-  << "session_qualifier=" << "\"" << m_sessionID.getSessionQualifier() << "\"";
-  MySQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-    query.throwException();
   m_cache.setNextSenderMsgSeqNum( value );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void MySQLStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
 {
-  std::stringstream queryString;
-  queryString << "UPDATE sessions SET incoming_seqnum=" << value << " WHERE "
-  << "beginstring=" << "\"" << m_sessionID.getBeginString().getValue() << "\" and "
-  << "sendercompid=" << "\"" << m_sessionID.getSenderCompID().getValue() << "\" and "
-  << "targetcompid=" << "\"" << m_sessionID.getTargetCompID().getValue() << "\" and "
-  << "session_qualifier=" << "\"" << m_sessionID.getSessionQualifier() << "\"";
-
-  MySQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-    query.throwException();
-
   m_cache.setNextTargetMsgSeqNum( value );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void MySQLStore::incrNextSenderMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextSenderMsgSeqNum();
-  setNextSenderMsgSeqNum( m_cache.getNextSenderMsgSeqNum() );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void MySQLStore::incrNextTargetMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextTargetMsgSeqNum();
-  setNextTargetMsgSeqNum( m_cache.getNextTargetMsgSeqNum() );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 UtcTimeStamp MySQLStore::getCreationTime() const throw ( IOException )
@@ -284,6 +291,11 @@ UtcTimeStamp MySQLStore::getCreationTime() const throw ( IOException )
 
 void MySQLStore::reset() throw ( IOException )
 {
+  // the reset writes the sequence numbers itself
+  m_pending.clear();
+  m_seqNumsChanged = false;
+  m_batchStart = 0;
+
   std::stringstream queryString;
   queryString << "DELETE FROM messages WHERE "
   << "beginstring=" << "\"" << m_sessionID.getBeginString().getValue() << "\" and "
@@ -322,10 +334,84 @@ void MySQLStore::reset() throw ( IOException )
 
 void MySQLStore::refresh() throw ( IOException )
 {
+  writeBatch();
   m_cache.reset();
   populateCache(); 
 }
 
+void MySQLStore::flush() throw ( IOException )
+{
+  writeBatch();
+}
+
+void MySQLStore::changed() throw ( IOException )
+{
+  int64_t now = time_monotonic();
+  if( !m_batchStart ) m_batchStart = now;
+
+  if( m_batchSize > 1 && (int)m_pending.size() < m_batchSize
+      && ( !m_batchInterval
+           || now - m_batchStart < (int64_t)m_batchInterval * 1000000 ) )
+    return;
+
+  writeBatch();
+}
+
+void MySQLStore::writeBatch() const throw ( IOException )
+{
+  if( m_pending.size() )
+  {
+    MySQLStatement statement( insertStatement( m_pending.size() ) );
+    Messages::const_iterator i;
+    for( i = m_pending.begin(); i != m_pending.end(); ++i )
+    {
+      addSessionParameters( statement );
+      statement.addParameter( i->first );
+      statement.addParameter( i->second );
+    }
+
+    if( !m_pConnection->execute( statement ) )
+      statement.throwException();
+    m_pending.clear();
+  }
+
+  if( m_seqNumsChanged )
+  {
+    MySQLStatement statement
+      ( "UPDATE sessions SET incoming_seqnum=?, outgoing_seqnum=? WHERE "
+        "beginstring=? and sendercompid=? and targetcompid=? and session_qualifier=?" );
+    statement.addParameter( m_cache.getNextTargetMsgSeqNum() );
+    statement.addParameter( m_cache.getNextSenderMsgSeqNum() );
+    addSessionParameters( statement );
+
+    if( !m_pConnection->execute( statement ) )
+      statement.throwException();
+    m_seqNumsChanged = false;
+  }
+
+  m_batchStart = 0;
+}
+
+void MySQLStore::addSessionParameters( MySQLStatement& statement ) const
+{
+  statement.addParameter( m_sessionID.getBeginString().getValue() );
+  statement.addParameter( m_sessionID.getSenderCompID().getValue() );
+  statement.addParameter( m_sessionID.getTargetCompID().getValue() );
+  statement.addParameter( m_sessionID.getSessionQualifier() );
+}
+
+std::string MySQLStore::insertStatement( size_t rows )
+{
+  std::string statement = "INSERT INTO messages "
+    "(beginstring, sendercompid, targetcompid, session_qualifier, msgseqnum, message) "
+    "VALUES ";
+  for( size_t i = 0; i < rows; ++i )
+    statement += i ? ",(?,?,?,?,?,?)" : "(?,?,?,?,?,?)";
+
+  // a message stored again replaces the earlier one
+  return statement + " ON DUPLICATE KEY UPDATE message=VALUES(message)";
+}
+
 }
 
 #endif
@@ -37,6 +37,7 @@
 #include "MySQLConnection.h"
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace FIX
 {
@@ -104,7 +105,15 @@ private:
 };
 /*! @} */
 
-/// MySQL based implementation of MessageStore.
+/**
+ * MySQL based implementation of MessageStore.
+ *
+ * Changes are written with prepared statements.  In batch mode stored
+ * messages are written with one multi row statement, together with the
+ * latest sequence numbers, once batch size messages are pending or the
+ * batch interval in milliseconds passed since the first pending change.
+ * Reads, refresh and flush write what is pending first.
+ */
 class MySQLStore : public MessageStore
 {
 public:
@@ -115,6 +124,7 @@ public:
 
   bool set( int, const std::string& ) throw ( IOException );
   void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
 
   int getNextSenderMsgSeqNum() const throw ( IOException );
   int getNextTargetMsgSeqNum() const throw ( IOException );
@@ -127,11 +137,27 @@ public:
 
   void reset() throw ( IOException );
   void refresh() throw ( IOException );
+  void flush() throw ( IOException );
+
+  /// Batches up to size messages, size 0 or 1 writes every change at once
+  void setBatch( int size, int interval )
+  { m_batchSize = size; m_batchInterval = interval; }
 
 private:
+  typedef std::vector < std::pair < int, std::string > > Messages;
+
   void populateCache();
+  void changed() throw ( IOException );
+  void writeBatch() const throw ( IOException );
+  void addSessionParameters( MySQLStatement& statement ) const;
+  static std::string insertStatement( size_t rows );
 
   MemoryStore m_cache;
+  mutable Messages m_pending;
+  mutable bool m_seqNumsChanged;
+  mutable int64_t m_batchStart;
+  int m_batchSize;
+  int m_batchInterval;
   MySQLConnection* m_pConnection;
   MySQLConnectionPool* m_pConnectionPool;
   SessionID m_sessionID;
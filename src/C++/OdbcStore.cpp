@@ -231,6 +231,47 @@ throw ( IOException )
   }
 }
 
+void OdbcStore::getRange( int begin, int end,
+                      MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  std::stringstream queryString;
+  queryString << "SELECT msgseqnum, message FROM messages WHERE "
+  << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
+  << "sendercompid=" << "'" << m_sessionID.getSenderCompID().getValue() << "' and "
+  << "targetcompid=" << "'" << m_sessionID.getTargetCompID().getValue() << "' and "
+  << "session_qualifier=" << "'" << m_sessionID.getSessionQualifier() << "' and "
+  << "msgseqnum>=" << begin << " and " << "msgseqnum<=" << end << " "
+  << "ORDER BY msgseqnum";
+
+  OdbcQuery query( queryString.str() );
+
+  if( !m_pConnection->execute(query) )
+    query.throwException();
+
+  // the statement is a forward only cursor, rows are fetched one at a time
+  std::string message;
+  while( query.fetch() )
+  {
+    SQLINTEGER msgSeqNum = 0;
+    SQLLEN msgSeqNumLength;
+    SQLGetData( query.statement(), 1, SQL_C_SLONG, &msgSeqNum, 0, &msgSeqNumLength );
+
+    message.clear();
+    SQLVARCHAR messageBuffer[4096];
+    SQLLEN messageLength;
+
+    while( odbcSuccess(SQLGetData( query.statement(), 2, SQL_C_CHAR, &messageBuffer, 4095, &messageLength)) )
+    {  
+      messageBuffer[messageLength] = 0;
+      message += (char*)messageBuffer;
+    }
+
+    if( !visitor.onMessage( msgSeqNum, message.data(), message.size() ) )
+      return;
+  }
+}
+
 int OdbcStore::getNextSenderMsgSeqNum() const throw ( IOException )
 {
   return m_cache.getNextSenderMsgSeqNum();
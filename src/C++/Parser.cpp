@@ -30,19 +30,44 @@
 
 namespace FIX
 {
+static const char* find( const char* begin, const char* end,
+                         const char* pattern, size_t length )
+{
+  while( (size_t)(end - begin) >= length )
+  {
+    const char* p = (const char*)memchr( begin, *pattern, end - begin - length + 1 );
+    if( !p ) return 0;
+    if( memcmp( p, pattern, length ) == 0 ) return p;
+    begin = p + 1;
+  }
+  return 0;
+}
+
 bool Parser::extractLength( int& length, std::string::size_type& pos,
                             const std::string& buffer )
 throw( MessageParseError )
 {
-  if( !buffer.size() ) return false;
+  size_t end = 0;
+  if( !extractLength( length, end, buffer.data(), buffer.size() ) )
+    return false;
+  pos = end;
+  return true;
+}
+
+bool Parser::extractLength( int& length, size_t& pos,
+                            const char* buffer, size_t size )
+throw( MessageParseError )
+{
+  if( !size ) return false;
 
-  std::string::size_type startPos = buffer.find( "\0019=", 0 );
-  if( startPos == std::string::npos ) return false;
-  startPos += 3;
-  std::string::size_type endPos = buffer.find( "\001", startPos );
-  if( endPos == std::string::npos ) return false;
+  const char* end = buffer + size;
+  const char* start = find( buffer, end, "\0019=", 3 );
+  if( !start ) return false;
+  start += 3;
+  const char* stop = (const char*)memchr( start, '\001', end - start );
+  if( !stop ) return false;
 
-  std::string strLength( buffer, startPos, endPos - startPos );
+  std::string strLength( start, stop );
 
   try
   {
@@ -52,52 +77,88 @@ throw( MessageParseError )
   catch( FieldConvertError& )
   { throw MessageParseError(); }
 
-  pos = endPos + 1;
+  pos = stop - buffer + 1;
   return true;
 }
 
 bool Parser::readFixMessage( std::string& str )
 throw( MessageParseError )
 {
-  std::string::size_type pos = 0;
+  if( getStreamSize() < 2 ) return false;
 
-  if( m_buffer.length() < 2 ) return false;
-  pos = m_buffer.find( "8=" );
-  if( pos == std::string::npos ) return false;
-  m_buffer.erase( 0, pos );
+  const char* end = &m_buffer[0] + m_writePos;
+  const char* begin = find( &m_buffer[0] + m_readPos, end, "8=", 2 );
+  if( !begin ) return false;
+  m_readPos = begin - &m_buffer[0];
 
+  size_t size = end - begin;
+  size_t pos = 0;
   int length = 0;
 
   try
   {
-    if( extractLength(length, pos, m_buffer) )
+    if( extractLength(length, pos, begin, size) )
     {
       pos += length;
-      if( m_buffer.size() < pos )
+      if( size < pos )
         return false;
 
-      pos = m_buffer.find( "\00110=", pos-1 );
-      if( pos == std::string::npos ) return false;
-      pos += 4;
-      pos = m_buffer.find( "\001", pos );
-      if( pos == std::string::npos ) return false;
-      pos += 1;
+      const char* p = find( begin + pos - 1, end, "\00110=", 4 );
+      if( !p ) return false;
+      p += 4;
+      p = (const char*)memchr( p, '\001', end - p );
+      if( !p ) return false;
+      pos = p - begin + 1;
 
-      str.assign( m_buffer, 0, pos );
-      m_buffer.erase( 0, pos );
+      str.assign( begin, pos );
+      m_readPos += pos;
+      if( m_readPos == m_writePos )
+        m_readPos = m_writePos = 0;
       return true;
     }
   }
   catch( MessageParseError& e )
   {
-    if( length > 0 )
-      m_buffer.erase( 0, pos + length );
+    if( length > 0 && pos + length < size )
+      m_readPos += pos + length;
     else
-      m_buffer.erase();
+      m_readPos = m_writePos = 0;
 
     throw e;
   }
 
   return false;
 }
+
+void Parser::addToStream( const char* str, size_t len )
+{
+  reserve( len );
+  memcpy( &m_buffer[0] + m_writePos, str, len );
+  m_writePos += len;
+}
+
+char* Parser::getWriteBuffer( size_t& length )
+{
+  reserve( m_capacity );
+  length = m_buffer.size() - m_writePos;
+  return &m_buffer[0] + m_writePos;
+}
+
+void Parser::reserve( size_t length )
+{
+  if( m_buffer.size() - m_writePos >= length )
+    return;
+
+  // reclaim consumed bytes before growing
+  if( m_readPos )
+  {
+    size_t size = m_writePos - m_readPos;
+    memmove( &m_buffer[0], &m_buffer[0] + m_readPos, size );
+    m_readPos = 0;
+    m_writePos = size;
+  }
+
+  if( m_buffer.size() - m_writePos < length )
+    m_buffer.resize( m_writePos + length );
+}
 }
@@ -29,14 +29,24 @@
 #include "Exceptions.h"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdio>
 
 namespace FIX
 {
-/// Parses %FIX messages off an input stream.
+/**
+ * Parses %FIX messages off an input stream.
+ *
+ * Data may either be appended with addToStream or received directly
+ * into the stream by writing into the region returned by getWriteBuffer
+ * and committing it with commitWrite.  Consumed bytes are only reclaimed
+ * when more room is needed for the next write.
+ */
 class Parser
 {
 public:
-  Parser() {}
+  Parser( size_t capacity = BUFSIZ )
+  : m_readPos( 0 ), m_writePos( 0 ), m_capacity( capacity ) {}
   ~Parser() {}
 
   bool extractLength( int& length, std::string::size_type& pos,
@@ -45,13 +55,32 @@ public:
   bool readFixMessage( std::string& str )
   throw ( MessageParseError );
 
-  void addToStream( const char* str, size_t len )
-  { m_buffer.append( str, len ); }
+  void addToStream( const char* str, size_t len );
   void addToStream( const std::string& str )
-  { m_buffer.append( str ); }
+  { addToStream( str.data(), str.size() ); }
+
+  /// Returns room for at least getCapacity() bytes at the end of the stream
+  char* getWriteBuffer( size_t& length );
+  /// Makes length bytes written into the last write buffer readable
+  void commitWrite( size_t length )
+  { m_writePos += length; }
+
+  /// Minimum number of bytes available to each write
+  size_t getCapacity() const { return m_capacity; }
+  void setCapacity( size_t capacity ) { m_capacity = capacity ? capacity : 1; }
+  /// Number of received bytes not yet read as messages
+  size_t getStreamSize() const { return m_writePos - m_readPos; }
 
 private:
-  std::string m_buffer;
+  bool extractLength( int& length, size_t& pos,
+                      const char* buffer, size_t size )
+  throw ( MessageParseError );
+  void reserve( size_t length );
+
+  std::vector<char> m_buffer;
+  size_t m_readPos;
+  size_t m_writePos;
+  size_t m_capacity;
 };
 }
 #endif //FIX_PARSER_H
@@ -35,7 +35,11 @@
 #include <libpq-fe.h>
 #include "DatabaseConnectionID.h"
 #include "DatabaseConnectionPool.h"
+#include "FieldConvertors.h"
 #include "Mutex.h"
+#include <deque>
+#include <map>
+#include <vector>
 
 namespace FIX
 {
@@ -61,7 +65,9 @@ public:
       if( m_result ) PQclear( m_result );
       m_result = PQexec( pConnection, m_query.c_str() );
       m_status = PQresultStatus( m_result );
-      if( success() ) return true;
+      // a failing query on a good connection would only fail again
+      if( success() || PQstatus( pConnection ) == CONNECTION_OK )
+        return success();
       PQreset( pConnection );
       retry++;
     } while( retry <= 1 );
@@ -89,6 +95,11 @@ public:
     return PQgetvalue( m_result, row, column );
   }
 
+  int getLength( int row, int column )
+  {
+    return PQgetlength( m_result, row, column );
+  }
+
   void throwException() throw( IOException )
   {
     if( !success() )
@@ -101,12 +112,98 @@ private:
   std::string m_query; 
 };
 
+/**
+ * A statement prepared once per connection and executed with bound
+ * parameters, so values are neither escaped nor parsed by the server.
+ * Parameters refer to the strings passed in, they must outlive execute.
+ */
+class PostgreSQLStatement
+{
+public:
+  PostgreSQLStatement( const std::string& statement )
+  : m_result( 0 ), m_status( PGRES_COMMAND_OK ), m_statement( statement )
+  {}
+
+  ~PostgreSQLStatement()
+  {
+    if( m_result )
+      PQclear( m_result );
+  }
+
+  void addParameter( const std::string& value )
+  {
+    m_data.push_back( value.c_str() );
+  }
+
+  void addParameter( int value )
+  {
+    m_values.push_back( IntConvertor::convert( value ) );
+    addParameter( m_values.back() );
+  }
+
+  void addNull()
+  {
+    m_data.push_back( 0 );
+  }
+
+  bool execute( PGconn* pConnection, const std::string& name )
+  {
+    if( m_result ) PQclear( m_result );
+    m_result = PQexecPrepared( pConnection, name.c_str(), (int)m_data.size(),
+                               m_data.empty() ? 0 : &m_data[ 0 ], 0, 0, 0 );
+    m_status = PQresultStatus( m_result );
+    return success();
+  }
+
+  void setResult( PGresult* result )
+  {
+    if( m_result ) PQclear( m_result );
+    m_result = result;
+    m_status = PQresultStatus( m_result );
+  }
+
+  bool success()
+  {
+    return m_status == PGRES_TUPLES_OK
+      || m_status == PGRES_COMMAND_OK;
+  }
+
+  /// Number of rows changed by an INSERT, UPDATE or DELETE
+  int affected()
+  {
+    return m_result ? atoi( PQcmdTuples( m_result ) ) : 0;
+  }
+
+  const std::string& statement() const
+  {
+    return m_statement;
+  }
+
+  char* reason()
+  {
+    return m_result ? PQresultErrorMessage( m_result ) : (char*)"";
+  }
+
+  void throwException() throw( IOException )
+  {
+    if( !success() )
+      throw IOException( "Statement failed [" + m_statement + "] " + reason() );
+  }
+
+private:
+  PGresult* m_result;
+  ExecStatusType m_status;
+  std::string m_statement;
+  std::vector < const char* > m_data;
+  std::deque < std::string > m_values;
+};
+
 class PostgreSQLConnection
 {
 public:
   PostgreSQLConnection
   ( const DatabaseConnectionID& id )
-  : m_connectionID( id )
+  : m_connectionID( id ), m_backendPID( 0 )
   {
     connect();
   }
@@ -114,7 +211,7 @@ public:
   PostgreSQLConnection
   ( const std::string& database, const std::string& user,
     const std::string& password, const std::string& host, short port )
-  : m_connectionID( database, user, password, host, port )
+  : m_connectionID( database, user, password, host, port ), m_backendPID( 0 )
   {
     connect();
   }
@@ -149,7 +246,53 @@ public:
     return pQuery.execute( m_pConnection );
   }
 
+  bool execute( PostgreSQLStatement& statement )
+  {
+    Locker locker( m_mutex );
+    int retry = 0;
+
+    do
+    {
+      const std::string* pName = prepare( statement );
+      if( pName && statement.execute( m_pConnection, *pName ) )
+        return true;
+      // only a lost connection is worth a reset, not a failing statement
+      if( PQstatus( m_pConnection ) == CONNECTION_OK )
+        return false;
+      PQreset( m_pConnection );
+      retry++;
+    } while( retry <= 1 );
+    return false;
+  }
+
 private:
+  typedef std::map < std::string, std::string > Statements;
+
+  const std::string* prepare( PostgreSQLStatement& statement )
+  {
+    // prepared statements live as long as the server process, which a
+    // reset of the connection replaces
+    int backendPID = PQbackendPID( m_pConnection );
+    if( backendPID != m_backendPID )
+    {
+      m_statements.clear();
+      m_backendPID = backendPID;
+    }
+
+    const std::string& text = statement.statement();
+    Statements::iterator i = m_statements.find( text );
+    if( i != m_statements.end() )
+      return &i->second;
+
+    // statements are shared by all users of the connection, name them by count
+    std::string name = "quickfix_" + IntConvertor::convert( (int)m_statements.size() );
+    statement.setResult( PQprepare( m_pConnection, name.c_str(), text.c_str(), 0, 0 ) );
+    if( !statement.success() )
+      return 0;
+
+    return &( m_statements[ text ] = name );
+  }
+
   void connect()
   {
     short port = m_connectionID.getPort();
@@ -163,6 +306,8 @@ private:
 
   PGconn* m_pConnection;
   DatabaseConnectionID m_connectionID;
+  Statements m_statements;
+  int m_backendPID;
   Mutex m_mutex;
 };
 
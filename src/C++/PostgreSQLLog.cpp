@@ -43,7 +43,8 @@ const short PostgreSQLLogFactory::DEFAULT_PORT = 0;
 
 PostgreSQLLog::PostgreSQLLog
 ( const SessionID& s, const DatabaseConnectionID& d, PostgreSQLConnectionPool* p )
-: m_pConnectionPool( p )
+: m_pConnectionPool( p ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pSessionID = new SessionID( s );
@@ -52,7 +53,8 @@ PostgreSQLLog::PostgreSQLLog
 
 PostgreSQLLog::PostgreSQLLog
 ( const DatabaseConnectionID& d, PostgreSQLConnectionPool* p )
-: m_pConnectionPool( p ), m_pSessionID( 0 )
+: m_pConnectionPool( p ), m_pSessionID( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pConnection = m_pConnectionPool->create( d );
@@ -61,7 +63,8 @@ PostgreSQLLog::PostgreSQLLog
 PostgreSQLLog::PostgreSQLLog
 ( const SessionID& s, const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 )
+  : m_pConnectionPool( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pSessionID = new SessionID( s );
@@ -71,7 +74,8 @@ PostgreSQLLog::PostgreSQLLog
 PostgreSQLLog::PostgreSQLLog
 ( const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 ), m_pSessionID( 0 )
+  : m_pConnectionPool( 0 ), m_pSessionID( 0 ),
+  m_pendingLines( 0 ), m_batchStart( 0 ), m_batchSize( 0 ), m_batchInterval( 0 )
 {
   init();
   m_pConnection = new PostgreSQLConnection( database, user, password, host, port );
@@ -86,6 +90,7 @@ void PostgreSQLLog::init()
 
 PostgreSQLLog::~PostgreSQLLog()
 {
+  writeBatch();
   if( m_pConnectionPool )
     m_pConnectionPool->destroy( m_pConnection );
   else
@@ -177,6 +182,16 @@ void PostgreSQLLogFactory::initLog( const Dictionary& settings, PostgreSQLLog& l
 
   try { log.setEventTable( settings.getString( POSTGRESQL_LOG_EVENT_TABLE ) ); }
   catch( ConfigError& ) {}
+
+  int batchSize = 0;
+  try { batchSize = settings.getInt( POSTGRESQL_LOG_BATCH_SIZE ); }
+  catch( ConfigError& ) {}
+
+  int batchInterval = 0;
+  try { batchInterval = settings.getInt( POSTGRESQL_LOG_BATCH_INTERVAL ); }
+  catch( ConfigError& ) {}
+
+  log.setBatch( batchSize, batchInterval );
 }
 
 void PostgreSQLLogFactory::destroy( Log* pLog )
@@ -186,6 +201,10 @@ void PostgreSQLLogFactory::destroy( Log* pLog )
 
 void PostgreSQLLog::clear()
 {
+  m_pending.clear();
+  m_pendingLines = 0;
+  m_batchStart = 0;
+
   std::stringstream whereClause;
 
   whereClause << "WHERE ";
@@ -238,37 +257,81 @@ void PostgreSQLLog::insert( const std::string& table, const std::string value )
   char sqlTime[ 24 ];
   STRING_SPRINTF( sqlTime, "%d-%02d-%02d %02d:%02d:%02d.%003d",
            year, month, day, hour, minute, second, millis );
-  
-  char* valueCopy = new char[ (value.size() * 2) + 1 ];
-  PQescapeString( valueCopy, value.c_str(), value.size() );
 
-  std::stringstream queryString;
-  queryString << "INSERT INTO " << table << " "
-  << "(time, beginstring, sendercompid, targetcompid, session_qualifier, text) "
-  << "VALUES ("
-  << "'" << sqlTime << "',";
+  std::vector < Line > & lines = m_pending[ table ];
+  lines.push_back( Line() );
+  lines.back().m_time = sqlTime;
+  lines.back().m_text = value;
+  ++m_pendingLines;
 
-  if( m_pSessionID )
+  int64_t now = time_monotonic();
+  if( !m_batchStart ) m_batchStart = now;
+
+  if( m_batchSize > 1 && m_pendingLines < m_batchSize
+      && ( !m_batchInterval
+           || now - m_batchStart < (int64_t)m_batchInterval * 1000000 ) )
+    return;
+
+  writeBatch();
+}
+
+void PostgreSQLLog::writeBatch()
+{
+  Lines::const_iterator i;
+  for( i = m_pending.begin(); i != m_pending.end(); ++i )
   {
-    queryString
-    << "'" << m_pSessionID->getBeginString().getValue() << "',"
-    << "'" << m_pSessionID->getSenderCompID().getValue() << "',"
-    << "'" << m_pSessionID->getTargetCompID().getValue() << "',";
-    if( m_pSessionID->getSessionQualifier() == "" )
-      queryString << "NULL" << ",";
-    else
-      queryString << "'" << m_pSessionID->getSessionQualifier() << "',";
+    const std::vector < Line > & lines = i->second;
+    if( lines.empty() ) continue;
+
+    PostgreSQLStatement statement( insertStatement( i->first, lines.size() ) );
+    std::vector < Line > ::const_iterator line;
+    for( line = lines.begin(); line != lines.end(); ++line )
+    {
+      statement.addParameter( line->m_time );
+      addSessionParameters( statement );
+      statement.addParameter( line->m_text );
+    }
+    m_pConnection->execute( statement );
   }
-  else
+
+  m_pending.clear();
+  m_pendingLines = 0;
+  m_batchStart = 0;
+}
+
+void PostgreSQLLog::addSessionParameters( PostgreSQLStatement& statement ) const
+{
+  if( !m_pSessionID )
   {
-    queryString << "NULL, NULL, NULL, NULL, ";
+    for( int i = 0; i < 4; ++i )
+      statement.addNull();
+    return;
   }
 
-  queryString << "'" << valueCopy << "')";
-  delete [] valueCopy;
+  statement.addParameter( m_pSessionID->getBeginString().getValue() );
+  statement.addParameter( m_pSessionID->getSenderCompID().getValue() );
+  statement.addParameter( m_pSessionID->getTargetCompID().getValue() );
+  if( m_pSessionID->getSessionQualifier() == "" )
+    statement.addNull();
+  else
+    statement.addParameter( m_pSessionID->getSessionQualifier() );
+}
 
-  PostgreSQLQuery query( queryString.str() );
-  m_pConnection->execute( query );
+std::string PostgreSQLLog::insertStatement( const std::string& table, size_t rows )
+{
+  std::string statement = "INSERT INTO " + table + " "
+    "(time, beginstring, sendercompid, targetcompid, session_qualifier, text) "
+    "VALUES ";
+  for( size_t i = 0; i < rows; ++i )
+  {
+    statement += i ? ",(" : "(";
+    for( size_t j = 1; j <= 6; ++j )
+    {
+      statement += "$" + IntConvertor::convert( (int)( i * 6 + j ) );
+      statement += j < 6 ? "," : ")";
+    }
+  }
+  return statement;
 }
 
 } // namespace FIX
@@ -35,11 +35,20 @@
 #include "SessionSettings.h"
 #include "PostgreSQLConnection.h"
 #include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace FIX
 {
-/// PostgreSQL based implementation of Log.
+/**
+ * PostgreSQL based implementation of Log.
+ *
+ * Lines are written with prepared statements.  In batch mode they are
+ * written with one multi row statement per table once batch size lines
+ * are pending or the batch interval in milliseconds passed since the
+ * first pending line.  Pending lines are written when the log is destroyed.
+ */
 class PostgreSQLLog : public Log
 {
 public:
@@ -60,6 +69,9 @@ public:
   { m_outgoingTable = outgoingTable; }
   void setEventTable( const std::string& eventTable )
   { m_eventTable = eventTable; }
+  /// Batches up to size lines, size 0 or 1 writes every line at once
+  void setBatch( int size, int interval )
+  { m_batchSize = size; m_batchInterval = interval; }
 
   void onIncoming( const std::string& value )
   { insert( m_incomingTable, value ); }
@@ -69,8 +81,19 @@ public:
   { insert( m_eventTable, value ); }
 
 private:
+  struct Line
+  {
+    std::string m_time;
+    std::string m_text;
+  };
+
+  typedef std::map < std::string, std::vector < Line > > Lines;
+
   void init();
   void insert( const std::string& table, const std::string value );
+  void writeBatch();
+  void addSessionParameters( PostgreSQLStatement& statement ) const;
+  static std::string insertStatement( const std::string& table, size_t rows );
 
   std::string m_incomingTable;
   std::string m_outgoingTable;
@@ -78,6 +101,11 @@ private:
   PostgreSQLConnection* m_pConnection;
   PostgreSQLConnectionPool* m_pConnectionPool;
   SessionID* m_pSessionID;
+  Lines m_pending;
+  int m_pendingLines;
+  int64_t m_batchStart;
+  int m_batchSize;
+  int m_batchInterval;
 };
 
 /// Creates a MySQL based implementation of Log.
@@ -45,7 +45,8 @@ const short PostgreSQLStoreFactory::DEFAULT_PORT = 0;
 
 PostgreSQLStore::PostgreSQLStore
 ( const SessionID& s, const DatabaseConnectionID& d, PostgreSQLConnectionPool* p )
-: m_pConnectionPool( p ), m_sessionID( s )
+: m_seqNumsChanged( false ), m_batchStart( 0 ), m_batchSize( 0 ),
+  m_batchInterval( 0 ), m_pConnectionPool( p ), m_sessionID( s )
 {
   m_pConnection = m_pConnectionPool->create( d );
   populateCache();
@@ -54,7 +55,8 @@ PostgreSQLStore::PostgreSQLStore
 PostgreSQLStore::PostgreSQLStore
 ( const SessionID& s, const std::string& database, const std::string& user,
   const std::string& password, const std::string& host, short port )
-  : m_pConnectionPool( 0 ), m_sessionID( s )
+  : m_seqNumsChanged( false ), m_batchStart( 0 ), m_batchSize( 0 ),
+    m_batchInterval( 0 ), m_pConnectionPool( 0 ), m_sessionID( s )
 {
   m_pConnection = new PostgreSQLConnection( database, user, password, host, port );
   populateCache();
@@ -62,6 +64,12 @@ PostgreSQLStore::PostgreSQLStore
 
 PostgreSQLStore::~PostgreSQLStore()
 {
+  try
+  {
+    writeBatch();
+  }
+  catch( IOException& ) {}
+
   if( m_pConnectionPool )
     m_pConnectionPool->destroy( m_pConnection );
   else
@@ -157,8 +165,18 @@ MessageStore* PostgreSQLStoreFactory::create( const SessionID& s, const Dictiona
   try { port = ( short ) settings.getInt( POSTGRESQL_STORE_PORT ); }
   catch( ConfigError& ) {}
 
+  int batchSize = 0;
+  try { batchSize = settings.getInt( POSTGRESQL_STORE_BATCH_SIZE ); }
+  catch( ConfigError& ) {}
+
+  int batchInterval = 0;
+  try { batchInterval = settings.getInt( POSTGRESQL_STORE_BATCH_INTERVAL ); }
+  catch( ConfigError& ) {}
+
   DatabaseConnectionID id( database, user, password, host, port );
-  return new PostgreSQLStore( s, id, m_connectionPoolPtr.get() );
+  PostgreSQLStore* pStore = new PostgreSQLStore( s, id, m_connectionPoolPtr.get() );
+  pStore->setBatch( batchSize, batchInterval );
+  return pStore;
 }
 
 void PostgreSQLStoreFactory::destroy( MessageStore* pStore )
@@ -169,37 +187,8 @@ void PostgreSQLStoreFactory::destroy( MessageStore* pStore )
 bool PostgreSQLStore::set( int msgSeqNum, const std::string& msg )
 throw ( IOException )
 {
-  char* msgCopy = new char[ (msg.size() * 2) + 1 ];
-  PQescapeString( msgCopy, msg.c_str(), msg.size() );
-
-  std::stringstream queryString;
-  queryString << "INSERT INTO messages "
-  << "(beginstring, sendercompid, targetcompid, session_qualifier, msgseqnum, message) "
-  << "VALUES ("
-  << "'" << m_sessionID.getBeginString().getValue() << "',"
-  << "'" << m_sessionID.getSenderCompID().getValue() << "',"
-  << "'" << m_sessionID.getTargetCompID().getValue() << "',"
-  << "'" << m_sessionID.getSessionQualifier() << "',"
-  << msgSeqNum << ","
-  << "'" << msgCopy << "')";
-
-  delete [] msgCopy;
-
-  PostgreSQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-  {
-    std::stringstream queryString2;
-    queryString2 << "UPDATE messages SET message='" << msg << "' WHERE "
-    << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
-    << "sendercompid=" << "'" << m_sessionID.getSenderCompID().getValue() << "' and "
-    << "targetcompid=" << "'" << m_sessionID.getTargetCompID().getValue() << "' and "
-    << "session_qualifier=" << "'" << m_sessionID.getSessionQualifier() << "' and "
-    << "msgseqnum=" << msgSeqNum;
-    PostgreSQLQuery query2( queryString2.str() );
-    if( !m_pConnection->execute(query2) )
-      query2.throwException();
-  }
-
+  m_pending[ msgSeqNum ] = msg;
+  changed();
   return true;
 }
 
@@ -207,6 +196,8 @@ void PostgreSQLStore::get( int begin, int end,
                       std::vector < std::string > & result ) const
 throw ( IOException )
 {
+  writeBatch();
+
   result.clear();
   std::stringstream queryString;
   queryString << "SELECT message FROM messages WHERE "
@@ -226,6 +217,36 @@ throw ( IOException )
     result.push_back( query.getValue( row, 0 ) );
 }
 
+void PostgreSQLStore::getRange( int begin, int end,
+                      MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  writeBatch();
+
+  std::stringstream queryString;
+  queryString << "SELECT msgseqnum, message FROM messages WHERE "
+  << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
+  << "sendercompid=" << "'" << m_sessionID.getSenderCompID().getValue() << "' and "
+  << "targetcompid=" << "'" << m_sessionID.getTargetCompID().getValue() << "' and "
+  << "session_qualifier=" << "'" << m_sessionID.getSessionQualifier() << "' and "
+  << "msgseqnum>=" << begin << " and " << "msgseqnum<=" << end << " "
+  << "ORDER BY msgseqnum";
+
+  PostgreSQLQuery query( queryString.str() );
+  if( !m_pConnection->execute(query) )
+    query.throwException();
+
+  // visit the rows of the result in place instead of copying them
+  int rows = query.rows();
+  for( int row = 0; row < rows; row++ )
+  {
+    if( !visitor.onMessage( atoi( query.getValue( row, 0 ) ),
+                            query.getValue( row, 1 ),
+                            query.getLength( row, 1 ) ) )
+      return;
+  }
+}
+
 int PostgreSQLStore::getNextSenderMsgSeqNum() const throw ( IOException )
 {
   return m_cache.getNextSenderMsgSeqNum();
@@ -238,46 +259,30 @@ int PostgreSQLStore::getNextTargetMsgSeqNum() const throw ( IOException )
 
 void PostgreSQLStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
 {
-  std::stringstream queryString;
-  queryString << "UPDATE sessions SET outgoing_seqnum=" << value << " WHERE "
-  << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
-  << "sendercompid=" << "'" << m_sessionID.getSenderCompID().getValue() << "' and "
-  << "targetcompid=" << "'" << m_sessionID.getTargetCompID().getValue() << "' and "
-  << "session_qualifier=" << "'" << m_sessionID.getSessionQualifier() << "'";
-
-  PostgreSQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-    query.throwException();
-
   m_cache.setNextSenderMsgSeqNum( value );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void PostgreSQLStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
 {
-  std::stringstream queryString;
-  queryString << "UPDATE sessions SET incoming_seqnum=" << value << " WHERE "
-  << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
-  << "sendercompid=" << "'" << m_sessionID.getSenderCompID().getValue() << "' and "
-  << "targetcompid=" << "'" << m_sessionID.getTargetCompID().getValue() << "' and "
-  << "session_qualifier=" << "'" << m_sessionID.getSessionQualifier() << "'";
-
-  PostgreSQLQuery query( queryString.str() );
-  if( !m_pConnection->execute(query) )
-    query.throwException();
-
   m_cache.setNextTargetMsgSeqNum( value );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void PostgreSQLStore::incrNextSenderMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextSenderMsgSeqNum();
-  setNextSenderMsgSeqNum( m_cache.getNextSenderMsgSeqNum() );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 void PostgreSQLStore::incrNextTargetMsgSeqNum() throw ( IOException )
 {
   m_cache.incrNextTargetMsgSeqNum();
-  setNextTargetMsgSeqNum( m_cache.getNextTargetMsgSeqNum() );
+  m_seqNumsChanged = true;
+  changed();
 }
 
 UtcTimeStamp PostgreSQLStore::getCreationTime() const throw ( IOException )
@@ -287,6 +292,11 @@ UtcTimeStamp PostgreSQLStore::getCreationTime() const throw ( IOException )
 
 void PostgreSQLStore::reset() throw ( IOException )
 {
+  // the reset writes the sequence numbers itself
+  m_pending.clear();
+  m_seqNumsChanged = false;
+  m_batchStart = 0;
+
   std::stringstream queryString;
   queryString << "DELETE FROM messages WHERE "
   << "beginstring=" << "'" << m_sessionID.getBeginString().getValue() << "' and "
@@ -325,10 +335,93 @@ void PostgreSQLStore::reset() throw ( IOException )
 
 void PostgreSQLStore::refresh() throw ( IOException )
 {
+  writeBatch();
   m_cache.reset();
   populateCache(); 
 }
 
+void PostgreSQLStore::flush() throw ( IOException )
+{
+  writeBatch();
+}
+
+void PostgreSQLStore::changed() throw ( IOException )
+{
+  int64_t now = time_monotonic();
+  if( !m_batchStart ) m_batchStart = now;
+
+  if( m_batchSize > 1 && (int)m_pending.size() < m_batchSize
+      && ( !m_batchInterval
+           || now - m_batchStart < (int64_t)m_batchInterval * 1000000 ) )
+    return;
+
+  writeBatch();
+}
+
+void PostgreSQLStore::writeBatch() const throw ( IOException )
+{
+  if( m_pending.size() )
+  {
+    PostgreSQLStatement statement( insertStatement( m_pending.size() ) );
+    Messages::const_iterator i;
+    for( i = m_pending.begin(); i != m_pending.end(); ++i )
+    {
+      addSessionParameters( statement );
+      statement.addParameter( i->first );
+      statement.addParameter( i->second );
+    }
+
+    if( !m_pConnection->execute( statement ) )
+      statement.throwException();
+    m_pending.clear();
+  }
+
+  if( m_seqNumsChanged )
+  {
+    PostgreSQLStatement statement
+      ( "UPDATE sessions SET incoming_seqnum=$1, outgoing_seqnum=$2 WHERE "
+        "beginstring=$3 and sendercompid=$4 and targetcompid=$5 and session_qualifier=$6" );
+    statement.addParameter( m_cache.getNextTargetMsgSeqNum() );
+    statement.addParameter( m_cache.getNextSenderMsgSeqNum() );
+    addSessionParameters( statement );
+
+    if( !m_pConnection->execute( statement ) )
+      statement.throwException();
+    m_seqNumsChanged = false;
+  }
+
+  m_batchStart = 0;
+}
+
+void PostgreSQLStore::addSessionParameters( PostgreSQLStatement& statement ) const
+{
+  statement.addParameter( m_sessionID.getBeginString().getValue() );
+  statement.addParameter( m_sessionID.getSenderCompID().getValue() );
+  statement.addParameter( m_sessionID.getTargetCompID().getValue() );
+  statement.addParameter( m_sessionID.getSessionQualifier() );
+}
+
+std::string PostgreSQLStore::insertStatement( size_t rows )
+{
+  std::string statement = "INSERT INTO messages "
+    "(beginstring, sendercompid, targetcompid, session_qualifier, msgseqnum, message) "
+    "VALUES ";
+  for( size_t i = 0; i < rows; ++i )
+  {
+    statement += i ? ",(" : "(";
+    for( size_t j = 1; j <= 6; ++j )
+    {
+      statement += "$" + IntConvertor::convert( (int)( i * 6 + j ) );
+      statement += j < 6 ? "," : ")";
+    }
+  }
+
+  // a message stored again replaces the earlier one
+  return statement + " ON CONFLICT "
+    "(beginstring, sendercompid, targetcompid, session_qualifier, msgseqnum) "
+    "DO UPDATE SET message=EXCLUDED.message";
+}
+
 }
 
 #endif
@@ -35,7 +35,9 @@
 #include "SessionSettings.h"
 #include "PostgreSQLConnection.h"
 #include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace FIX
 {
@@ -103,7 +105,17 @@ private:
 };
 /*! @} */
 
-/// PostgreSQL based implementation of MessageStore.
+/**
+ * PostgreSQL based implementation of MessageStore.
+ *
+ * Changes are written with prepared statements.  In batch mode stored
+ * messages are written with one multi row statement, together with the
+ * latest sequence numbers, once batch size messages are pending or the
+ * batch interval in milliseconds passed since the first pending change.
+ * Reads, refresh and flush write what is pending first.  Messages stored
+ * again replace the earlier ones with INSERT ... ON CONFLICT, which needs
+ * PostgreSQL 9.5 or later.
+ */
 class PostgreSQLStore : public MessageStore
 {
 public:
@@ -114,6 +126,7 @@ public:
 
   bool set( int, const std::string& ) throw ( IOException );
   void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
 
   int getNextSenderMsgSeqNum() const throw ( IOException );
   int getNextTargetMsgSeqNum() const throw ( IOException );
@@ -126,11 +139,28 @@ public:
 
   void reset() throw ( IOException );
   void refresh() throw ( IOException );
+  void flush() throw ( IOException );
+
+  /// Batches up to size messages, size 0 or 1 writes every change at once
+  void setBatch( int size, int interval )
+  { m_batchSize = size; m_batchInterval = interval; }
 
 private:
+  /// A message stored twice in a batch is written once, upserts allow no duplicates
+  typedef std::map < int, std::string > Messages;
+
   void populateCache();
+  void changed() throw ( IOException );
+  void writeBatch() const throw ( IOException );
+  void addSessionParameters( PostgreSQLStatement& statement ) const;
+  static std::string insertStatement( size_t rows );
 
   MemoryStore m_cache;
+  mutable Messages m_pending;
+  mutable bool m_seqNumsChanged;
+  mutable int64_t m_batchStart;
+  int m_batchSize;
+  int m_batchInterval;
   PostgreSQLConnection* m_pConnection;
   PostgreSQLConnectionPool* m_pConnectionPool;
   SessionID m_sessionID;
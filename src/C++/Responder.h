@@ -27,6 +27,7 @@
 #endif
 
 #include <string>
+#include <cstddef>
 
 namespace FIX
 {
@@ -37,6 +38,10 @@ namespace FIX
     virtual ~Responder() {}
     virtual bool send( const std::string& ) = 0;
     virtual void disconnect() = 0;
+    /// Bytes accepted by send that have not been written yet
+    virtual size_t getSendQueueBytes() { return 0; }
+    /// Messages accepted by send that have not been written yet
+    virtual size_t getSendQueueMessages() { return 0; }
   };
 }
 
@@ -184,6 +184,10 @@ throw ( ConfigError )
       settings.getBool( SOCKET_REUSE_ADDRESS );
     if( settings.has(SOCKET_NODELAY) )
       settings.getBool( SOCKET_NODELAY );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY)
+        && settings.getInt( SOCKET_RECEIVE_BUFFER_CAPACITY ) <= 0 )
+      throw ConfigError( std::string(SOCKET_RECEIVE_BUFFER_CAPACITY)
+                         + " must be greater than zero" );
   }
 }
 
@@ -334,6 +338,12 @@ void SSLSocketAcceptor::onConnect( SocketServer& server, int a, int s )
   SSL_set_verify_result(ssl, X509_V_OK);
 
   SSLSocketConnection * sconn = new SSLSocketConnection( s, ssl, sessions, &server.getMonitor() );
+
+  // the session is unknown until logon, use the first one on the port
+  const Dictionary& settings = m_settings.get( *sessions.begin() );
+  if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY) )
+    sconn->setReceiveBufferCapacity( settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) );
+
   // SSL accept
   if (acceptSSLConnection(sconn->getSocket(), sconn->sslObject(), getLog(), m_verify) != 0)
   {
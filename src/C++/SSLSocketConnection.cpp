@@ -131,7 +131,7 @@ namespace FIX
 {
 SSLSocketConnection::SSLSocketConnection(int s, SSL *ssl, Sessions sessions,
                                     SocketMonitor* pMonitor )
-: m_socket( s ), m_ssl(ssl), m_sendLength( 0 ),
+: m_socket( s ), m_ssl(ssl), m_sendQueueBytes( 0 ), m_sendLength( 0 ),
   m_sessions(sessions), m_pSession( 0 ), m_pMonitor( pMonitor )
 {
   FD_ZERO( &m_fds );
@@ -141,7 +141,7 @@ SSLSocketConnection::SSLSocketConnection(int s, SSL *ssl, Sessions sessions,
 SSLSocketConnection::SSLSocketConnection(SSLSocketInitiator &i,
                                     const SessionID& sessionID, int s, SSL * ssl,
                                     SocketMonitor* pMonitor )
-: m_socket( s ), m_ssl(ssl), m_sendLength( 0 ),
+: m_socket( s ), m_ssl(ssl), m_sendQueueBytes( 0 ), m_sendLength( 0 ),
   m_pSession( i.getSession( sessionID, *this ) ),
   m_pMonitor( pMonitor ) 
 {
@@ -153,7 +153,11 @@ SSLSocketConnection::SSLSocketConnection(SSLSocketInitiator &i,
 SSLSocketConnection::~SSLSocketConnection()
 {
   if ( m_pSession )
+  {
+    m_pSession->getStatistics().set( SessionStatistics::SEND_QUEUE_MESSAGES, 0 );
+    m_pSession->getStatistics().set( SessionStatistics::SEND_QUEUE_BYTES, 0 );
     Session::unregisterSession( m_pSession->getSessionID() );
+  }
 
   ssl_socket_close(m_socket, m_ssl);
 
@@ -165,15 +169,49 @@ bool SSLSocketConnection::send( const std::string& msg )
   Locker l( m_mutex );
 
   m_sendQueue.push_back( msg );
-  processQueue();
+  m_sendQueueBytes += msg.length();
+  writeQueue();
+  updateStatistics();
   signal();
   return true;
 }
 
 bool SSLSocketConnection::processQueue()
+{
+  bool empty = false;
+  {
+    Locker l( m_mutex );
+    empty = writeQueue();
+    updateStatistics();
+  }
+
+  if( m_pSession )
+    m_pSession->checkSendQueue();
+  return empty;
+}
+
+void SSLSocketConnection::updateStatistics()
+{
+  if( !m_pSession ) return;
+  SessionStatistics& statistics = m_pSession->getStatistics();
+  statistics.set( SessionStatistics::SEND_QUEUE_MESSAGES, m_sendQueue.size() );
+  statistics.set( SessionStatistics::SEND_QUEUE_BYTES, m_sendQueueBytes );
+}
+
+size_t SSLSocketConnection::getSendQueueBytes()
 {
   Locker l( m_mutex );
+  return m_sendQueueBytes;
+}
 
+size_t SSLSocketConnection::getSendQueueMessages()
+{
+  Locker l( m_mutex );
+  return m_sendQueue.size();
+}
+
+bool SSLSocketConnection::writeQueue()
+{
   if( m_sendQueue.empty() ) return true;
 
   struct timeval timeout = { 0, 0 };
@@ -225,6 +263,7 @@ bool SSLSocketConnection::processQueue()
   }
 
   m_sendLength = 0;
+  m_sendQueueBytes -= msg.length();
   m_sendQueue.pop_front();
 
   return m_sendQueue.empty();
@@ -295,6 +334,8 @@ bool SSLSocketConnection::read(SSLSocketAcceptor &a, SocketServer& s )
       }
 
       Session::registerSession( m_pSession->getSessionID() );
+      // the logon may have arrived together with more messages
+      readMessages( s.getMonitor() );
       return true;
     }
     else
@@ -338,6 +379,8 @@ throw( SocketRecvFailed )
     errno = 0;
     ssize_t size = 0;
     int errCodeSSL = 0;
+    size_t length = 0;
+    char *buffer = m_parser.getWriteBuffer(length);
     ERR_clear_error();
 
     // Cannot do concurrent SSL write and read as ssl context has to be
@@ -345,7 +388,7 @@ throw( SocketRecvFailed )
     {
       Locker locker(m_mutex);
 
-      size = SSL_read(m_ssl, m_buffer, sizeof(m_buffer));
+      size = SSL_read(m_ssl, buffer, (int)length);
       if (size <= 0)
         errCodeSSL = SSL_get_error(m_ssl, size);
       else if (SSL_pending(m_ssl) > 0)
@@ -384,7 +427,7 @@ throw( SocketRecvFailed )
       }
     }
 
-    m_parser.addToStream(m_buffer, size);
+    m_parser.commitWrite(size);
   } while (pending);
 }
 
@@ -392,7 +435,11 @@ bool SSLSocketConnection::readMessage( std::string& msg )
 {
   try
   {
-    return m_parser.readFixMessage( msg );
+    if( !m_pSession ) return m_parser.readFixMessage( msg );
+    LatencyTimer timer( m_pSession->getLatency() );
+    if( !m_parser.readFixMessage( msg ) ) return false;
+    timer.stop( SessionLatency::PARSE );
+    return true;
   }
   catch ( MessageParseError& ) {}
   return true;
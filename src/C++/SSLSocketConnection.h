@@ -173,8 +173,15 @@ public:
 
   void onTimeout();
 
+  size_t getSendQueueBytes();
+  size_t getSendQueueMessages();
+
   SSL *sslObject() { return m_ssl; }
 
+  /// Minimum number of bytes handed to each receive
+  void setReceiveBufferCapacity( size_t capacity )
+  { m_parser.setCapacity( capacity ); }
+
 private:
   typedef std::deque<std::string, ALLOCATOR<std::string> >
     Queue;
@@ -184,14 +191,17 @@ private:
   bool readMessage( std::string& msg );
   void readMessages( SocketMonitor& s );
   bool send( const std::string& );
+  bool writeQueue();
+  /// Publishes the send queue depth, called with the mutex held
+  void updateStatistics();
   void disconnect();
 
   int m_socket;
   SSL *m_ssl;
-  char m_buffer[BUFSIZ];
 
   Parser m_parser;
   Queue m_sendQueue;
+  size_t m_sendQueueBytes;
   unsigned m_sendLength;
   Sessions m_sessions;
   Session* m_pSession;
@@ -191,6 +191,17 @@ throw ( ConfigError )
     m_sendBufSize = dict.getInt( SOCKET_SEND_BUFFER_SIZE );
   if( dict.has( SOCKET_RECEIVE_BUFFER_SIZE ) )
     m_rcvBufSize = dict.getInt( SOCKET_RECEIVE_BUFFER_SIZE );
+
+  std::set<SessionID> sessions = s.getSessions();
+  std::set<SessionID>::iterator i;
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    const Dictionary& settings = s.get( *i );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY)
+        && settings.getInt( SOCKET_RECEIVE_BUFFER_CAPACITY ) <= 0 )
+      throw ConfigError( std::string(SOCKET_RECEIVE_BUFFER_CAPACITY)
+                         + " must be greater than zero" );
+  }
 }
 
 void SSLSocketInitiator::onInitialize( const SessionSettings& s )
@@ -338,7 +349,11 @@ void SSLSocketInitiator::doConnect( const SessionID& s, const Dictionary& d )
     }
 
     setPending( s );
-    m_pendingConnections[ result ] = new SSLSocketConnection( *this, s, result, ssl, &m_connector.getMonitor() );
+    SSLSocketConnection* pConnection
+      = new SSLSocketConnection( *this, s, result, ssl, &m_connector.getMonitor() );
+    if( d.has(SOCKET_RECEIVE_BUFFER_CAPACITY) )
+      pConnection->setReceiveBufferCapacity( d.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) );
+    m_pendingConnections[ result ] = pConnection;
   }
   catch ( std::exception& ) {}
 }
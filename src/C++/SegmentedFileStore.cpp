@@ -0,0 +1,641 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "SegmentedFileStore.h"
+#include "SessionID.h"
+#include "FieldConvertors.h"
+#include <algorithm>
+
+namespace FIX
+{
+static const char SEGMENTS_MAGIC[ 8 ] = { 'Q', 'F', 'S', 'E', 'G', 'S', '1', 0 };
+static const size_t SEGMENT_DEFAULT_SIZE = 64 * 1024 * 1024;
+static const long SEGMENT_READ_SIZE = 1024 * 1024;
+
+SegmentedFileStoreCleaner::SegmentedFileStoreCleaner()
+: m_threadid( 0 ), m_running( false ), m_stop( 0 )
+{
+}
+
+SegmentedFileStoreCleaner::~SegmentedFileStoreCleaner()
+{
+  stop();
+}
+
+void SegmentedFileStoreCleaner::start()
+{
+  Locker l( m_mutex );
+  if( m_running ) return;
+  while( m_stop ) --m_stop;
+  m_running = thread_spawn( &cleanerThread, this, m_threadid );
+}
+
+void SegmentedFileStoreCleaner::stop()
+{
+  Locker l( m_mutex );
+  if( m_running )
+  {
+    if( !m_stop ) ++m_stop;
+    m_files.signal();
+    thread_join( m_threadid );
+    m_running = false;
+  }
+
+  File file;
+  while( m_files.pop( file ) )
+    clean( file.first, file.second );
+}
+
+void SegmentedFileStoreCleaner::remove( const std::string& file,
+                                        const std::string& archive )
+{
+  Locker l( m_mutex );
+  // the thread is started with the first file, none is started once stopped
+  if( !m_running && !m_stop )
+    start();
+
+  if( m_running )
+    m_files.push( File( file, archive ) );
+  else
+    clean( file, archive );
+}
+
+void SegmentedFileStoreCleaner::clean( const std::string& file,
+                                       const std::string& archive )
+{
+  // a file that could not be archived is kept
+  if( archive.size() )
+    file_rename( file.c_str(), archive.c_str() );
+  else
+    file_unlink( file.c_str() );
+}
+
+void SegmentedFileStoreCleaner::run()
+{
+  while( true )
+  {
+    File file;
+    if( m_files.pop( file ) )
+    {
+      clean( file.first, file.second );
+      continue;
+    }
+    if( m_stop ) return;
+    m_files.wait( 1 );
+  }
+}
+
+THREAD_PROC SegmentedFileStoreCleaner::cleanerThread( void* p )
+{
+  SegmentedFileStoreCleaner* pCleaner =
+    static_cast < SegmentedFileStoreCleaner* > ( p );
+  pCleaner->run();
+  return 0;
+}
+
+MessageStore* SegmentedFileStoreFactory::create( const SessionID& s )
+{
+  if ( m_path.size() )
+  {
+    return new SegmentedFileStore( m_path, s, m_segmentSize, m_retention,
+                                   m_archivePath, &m_cleaner );
+  }
+
+  Dictionary settings = m_settings.get( s );
+  std::string path = settings.getString( SEGMENTED_FILE_STORE_PATH );
+  size_t segmentSize = 0;
+  if( settings.has( SEGMENTED_FILE_STORE_SEGMENT_SIZE ) )
+    segmentSize = settings.getInt( SEGMENTED_FILE_STORE_SEGMENT_SIZE );
+  int retention = 0;
+  if( settings.has( SEGMENTED_FILE_STORE_RETENTION ) )
+    retention = settings.getInt( SEGMENTED_FILE_STORE_RETENTION );
+  std::string archivePath;
+  if( settings.has( SEGMENTED_FILE_STORE_ARCHIVE_PATH ) )
+    archivePath = settings.getString( SEGMENTED_FILE_STORE_ARCHIVE_PATH );
+
+  return new SegmentedFileStore( path, s, segmentSize, retention,
+                                 archivePath, &m_cleaner );
+}
+
+void SegmentedFileStoreFactory::destroy( MessageStore* pStore )
+{
+  delete pStore;
+}
+
+SegmentedFileStore::SegmentedFileStore( std::string path, const SessionID& s,
+                                        size_t segmentSize, int retention,
+                                        const std::string& archivePath,
+                                        SegmentedFileStoreCleaner* pCleaner )
+: m_firstSeqNum( 0 ), m_highestSeqNum( 0 ),
+  m_segmentSize( segmentSize ? segmentSize : SEGMENT_DEFAULT_SIZE ),
+  m_retention( retention ), m_archivePath( archivePath ),
+  m_pCleaner( pCleaner ),
+  m_headerFile( 0 ), m_file( 0 ), m_readFile( 0 ), m_readSegment( 0 )
+{
+  file_mkdir( path.c_str() );
+  if( m_archivePath.size() )
+    file_mkdir( m_archivePath.c_str() );
+
+  if ( path.empty() ) path = ".";
+  const std::string& begin =
+    s.getBeginString().getString();
+  const std::string& sender =
+    s.getSenderCompID().getString();
+  const std::string& target =
+    s.getTargetCompID().getString();
+  const std::string& qualifier =
+    s.getSessionQualifier();
+
+  m_sessionID = begin + "-" + sender + "-" + target;
+  if( qualifier.size() )
+    m_sessionID += "-" + qualifier;
+
+  m_path = path;
+  m_headerFileName = file_appendpath( path, m_sessionID + ".segments" );
+
+  try
+  {
+    open();
+  }
+  catch ( IOException & e )
+  {
+    throw ConfigError( e.what() );
+  }
+}
+
+SegmentedFileStore::~SegmentedFileStore()
+{
+  close();
+}
+
+void SegmentedFileStore::open()
+{
+  close();
+  m_segments.clear();
+  m_locations.clear();
+  m_firstSeqNum = 0;
+  m_highestSeqNum = 0;
+
+  size_t result = 0;
+  m_headerFile = file_fopen( m_headerFileName.c_str(), "rb+" );
+  if( m_headerFile )
+    result = fread( &m_header, 1, sizeof( Header ), m_headerFile );
+  else
+    m_headerFile = file_fopen( m_headerFileName.c_str(), "wb+" );
+  if( !m_headerFile )
+    throw IOException( "Could not open file: " + m_headerFileName );
+
+  if( result == 0 )
+  {
+    memcpy( m_header.m_magic, SEGMENTS_MAGIC, sizeof( SEGMENTS_MAGIC ) );
+    m_header.m_generation = 1;
+    m_header.m_firstSegment = 1;
+    m_header.m_lastSegment = 0;
+    m_header.m_nextSenderMsgSeqNum = 1;
+    m_header.m_nextTargetMsgSeqNum = 1;
+    m_creationTime.setCurrent();
+    writeHeader();
+    return;
+  }
+
+  if( result != sizeof( Header )
+      || memcmp( m_header.m_magic, SEGMENTS_MAGIC, sizeof( SEGMENTS_MAGIC ) ) )
+    throw IOException( "Unknown segments file format: " + m_headerFileName );
+
+  m_header.m_creationTime[ sizeof( m_header.m_creationTime ) - 1 ] = 0;
+  m_creationTime =
+    UtcTimeStampConvertor::convert( m_header.m_creationTime, true );
+
+  bool complete = false;
+  for( int number = m_header.m_firstSegment;
+       number <= m_header.m_lastSegment; ++number )
+  {
+    complete = load( number );
+  }
+  sweep();
+
+  // keep appending to the last segment unless its end is damaged
+  if( complete && m_segments.back().m_number == m_header.m_lastSegment )
+  {
+    std::string fileName = file_appendpath
+      ( m_path, getSegmentName( m_header.m_generation, m_header.m_lastSegment ) );
+    m_file = file_fopen( fileName.c_str(), "ab" );
+    if( !m_file )
+      throw IOException( "Could not open file: " + fileName );
+  }
+}
+
+void SegmentedFileStore::close()
+{
+  if( m_headerFile ) fclose( m_headerFile );
+  if( m_file ) fclose( m_file );
+  if( m_readFile ) fclose( m_readFile );
+  m_headerFile = m_file = m_readFile = 0;
+}
+
+bool SegmentedFileStore::load( int number )
+{
+  std::string fileName = file_appendpath
+    ( m_path, getSegmentName( m_header.m_generation, number ) );
+  FILE* file = file_fopen( fileName.c_str(), "rb" );
+  if( !file ) return false;
+
+  long size = 0;
+  if( fseek( file, 0, SEEK_END ) == 0 )
+    size = ftell( file );
+  rewind( file );
+
+  Segment segment;
+  segment.m_number = number;
+  segment.m_size = 0;
+  segment.m_lastSeqNum = 0;
+
+  // records are read up to the first one that was not written completely
+  RecordHeader record;
+  while( segment.m_size + (long)sizeof( RecordHeader ) <= size
+         && fread( &record, sizeof( RecordHeader ), 1, file ) == 1 )
+  {
+    long offset = segment.m_size + sizeof( RecordHeader );
+    if( record.m_msgSeqNum <= 0 || record.m_length < 0
+        || offset + record.m_length > size )
+      break;
+
+    Location location;
+    location.m_segment = number;
+    location.m_offset = offset;
+    location.m_length = record.m_length;
+    setLocation( record.m_msgSeqNum, location );
+
+    if( record.m_msgSeqNum > segment.m_lastSeqNum )
+      segment.m_lastSeqNum = record.m_msgSeqNum;
+    segment.m_size = offset + record.m_length;
+    if( fseek( file, segment.m_size, SEEK_SET ) )
+      break;
+  }
+  fclose( file );
+
+  if( segment.m_lastSeqNum > m_highestSeqNum )
+    m_highestSeqNum = segment.m_lastSeqNum;
+  m_segments.push_back( segment );
+  return segment.m_size == size;
+}
+
+void SegmentedFileStore::roll() throw ( IOException )
+{
+  if( m_file ) fclose( m_file );
+  m_file = 0;
+
+  int number = m_header.m_lastSegment + 1;
+  std::string fileName = file_appendpath
+    ( m_path, getSegmentName( m_header.m_generation, number ) );
+  m_file = file_fopen( fileName.c_str(), "wb" );
+  if( !m_file )
+    throw IOException( "Could not open file: " + fileName );
+
+  Segment segment;
+  segment.m_number = number;
+  segment.m_size = 0;
+  segment.m_lastSeqNum = 0;
+  m_segments.push_back( segment );
+  m_header.m_lastSegment = number;
+  retain();
+}
+
+void SegmentedFileStore::retain()
+{
+  std::vector < int > dropped;
+  while( m_retention > 0 && m_segments.size() > 1
+         && m_segments.front().m_lastSeqNum <= m_highestSeqNum - m_retention )
+  {
+    dropped.push_back( m_segments.front().m_number );
+    m_segments.pop_front();
+  }
+
+  // the metadata no longer refers to a segment before it is removed
+  m_header.m_firstSegment = m_segments.front().m_number;
+  writeHeader();
+
+  while( m_locations.size()
+         && m_locations.front().m_segment < m_header.m_firstSegment )
+  {
+    m_locations.pop_front();
+    ++m_firstSeqNum;
+  }
+
+  std::vector < int > ::const_iterator i;
+  for( i = dropped.begin(); i != dropped.end(); ++i )
+    remove( m_header.m_generation, *i );
+}
+
+void SegmentedFileStore::sweep()
+{
+  std::vector < std::string > names;
+  if( !file_list( m_path.c_str(), names ) ) return;
+
+  // [SessionID].[Generation].[Number].segment
+  std::string prefix = m_sessionID + ".";
+  std::string suffix = ".segment";
+  std::vector < std::string > ::const_iterator i;
+  for( i = names.begin(); i != names.end(); ++i )
+  {
+    if( i->size() <= prefix.size() + suffix.size()
+        || i->compare( 0, prefix.size(), prefix ) != 0
+        || i->compare( i->size() - suffix.size(), suffix.size(), suffix ) != 0 )
+      continue;
+
+    std::string numbers =
+      i->substr( prefix.size(), i->size() - prefix.size() - suffix.size() );
+    std::string::size_type dot = numbers.find( '.' );
+    if( dot == std::string::npos ) continue;
+    int g = atoi( numbers.substr( 0, dot ).c_str() );
+    int n = atoi( numbers.substr( dot + 1 ).c_str() );
+    if( getSegmentName( g, n ) != *i ) continue;
+
+    if( g != m_header.m_generation || n < m_header.m_firstSegment
+        || n > m_header.m_lastSegment )
+      remove( g, n );
+  }
+}
+
+void SegmentedFileStore::writeHeader() throw ( IOException )
+{
+  std::string creationTime = UtcTimeStampConvertor::convert( m_creationTime, true );
+  memset( m_header.m_creationTime, 0, sizeof( m_header.m_creationTime ) );
+  memcpy( m_header.m_creationTime, creationTime.data(),
+          std::min( creationTime.size(), sizeof( m_header.m_creationTime ) - 1 ) );
+
+  if( fseek( m_headerFile, 0, SEEK_SET )
+      || fwrite( &m_header, sizeof( Header ), 1, m_headerFile ) != 1
+      || fflush( m_headerFile ) )
+    throw IOException( "Unable to write to file " + m_headerFileName );
+}
+
+void SegmentedFileStore::remove( int generation, int number )
+{
+  if( m_readFile && m_readSegment == number )
+  {
+    fclose( m_readFile );
+    m_readFile = 0;
+  }
+
+  std::string name = getSegmentName( generation, number );
+  std::string archive;
+  if( m_archivePath.size() )
+    archive = file_appendpath( m_archivePath, name );
+
+  if( m_pCleaner )
+    m_pCleaner->remove( file_appendpath( m_path, name ), archive );
+  else
+    SegmentedFileStoreCleaner::clean( file_appendpath( m_path, name ), archive );
+}
+
+void SegmentedFileStore::setLocation( int msgSeqNum, const Location& location )
+{
+  Location empty;
+  empty.m_segment = 0;
+  empty.m_offset = -1;
+  empty.m_length = 0;
+
+  if ( m_locations.empty() )
+    m_firstSeqNum = msgSeqNum;
+  else if ( msgSeqNum < m_firstSeqNum )
+  {
+    m_locations.insert( m_locations.begin(), m_firstSeqNum - msgSeqNum, empty );
+    m_firstSeqNum = msgSeqNum;
+  }
+
+  std::size_t index = msgSeqNum - m_firstSeqNum;
+  if ( index >= m_locations.size() )
+    m_locations.resize( index + 1, empty );
+  m_locations[ index ] = location;
+}
+
+const SegmentedFileStore::Location* SegmentedFileStore::getLocation
+( int msgSeqNum ) const
+{
+  if ( m_locations.empty() || msgSeqNum < m_firstSeqNum ) return 0;
+  std::size_t index = msgSeqNum - m_firstSeqNum;
+  if ( index >= m_locations.size() ) return 0;
+  const Location& location = m_locations[ index ];
+  if ( location.m_offset < 0 || location.m_segment < m_header.m_firstSegment )
+    return 0;
+  return &location;
+}
+
+FILE* SegmentedFileStore::getReadFile( int number ) const throw ( IOException )
+{
+  if( m_readFile && m_readSegment == number )
+    return m_readFile;
+
+  if( m_readFile ) fclose( m_readFile );
+  std::string fileName = file_appendpath
+    ( m_path, getSegmentName( m_header.m_generation, number ) );
+  m_readFile = file_fopen( fileName.c_str(), "rb" );
+  if( !m_readFile )
+    throw IOException( "Could not open file: " + fileName );
+  m_readSegment = number;
+  return m_readFile;
+}
+
+std::string SegmentedFileStore::getSegmentName( int generation, int number ) const
+{
+  return m_sessionID + "." + IntConvertor::convert( generation )
+         + "." + IntConvertor::convert( number ) + ".segment";
+}
+
+bool SegmentedFileStore::set( int msgSeqNum, const std::string& msg )
+throw ( IOException )
+{
+  if( msgSeqNum <= 0 ) return false;
+
+  long length = (long)( sizeof( RecordHeader ) + msg.size() );
+  if( !m_file || ( m_segments.back().m_size
+                   && m_segments.back().m_size + length > (long)m_segmentSize ) )
+  {
+    roll();
+  }
+
+  Segment& segment = m_segments.back();
+  RecordHeader record;
+  record.m_msgSeqNum = msgSeqNum;
+  record.m_length = (int32_t)msg.size();
+
+  if( fwrite( &record, sizeof( RecordHeader ), 1, m_file ) != 1
+      || ( msg.size() && fwrite( msg.data(), msg.size(), 1, m_file ) != 1 )
+      || fflush( m_file ) )
+  {
+    // the segment may end in a partial record now, continue in a new one
+    fclose( m_file );
+    m_file = 0;
+    throw IOException( "Unable to write to file " + file_appendpath
+      ( m_path, getSegmentName( m_header.m_generation, segment.m_number ) ) );
+  }
+
+  Location location;
+  location.m_segment = segment.m_number;
+  location.m_offset = segment.m_size + sizeof( RecordHeader );
+  location.m_length = (long)msg.size();
+  setLocation( msgSeqNum, location );
+
+  segment.m_size += length;
+  if( msgSeqNum > segment.m_lastSeqNum )
+    segment.m_lastSeqNum = msgSeqNum;
+  if( msgSeqNum > m_highestSeqNum )
+    m_highestSeqNum = msgSeqNum;
+  return true;
+}
+
+void SegmentedFileStore::get( int begin, int end,
+                              std::vector < std::string > & result ) const
+throw ( IOException )
+{
+  result.clear();
+  MessageStoreCollector collector( result );
+  getRange( begin, end, collector );
+}
+
+void SegmentedFileStore::getRange( int begin, int end,
+                                   MessageStoreVisitor& visitor ) const
+throw ( IOException )
+{
+  if ( m_locations.empty() ) return;
+  if ( begin < m_firstSeqNum ) begin = m_firstSeqNum;
+  int last = m_firstSeqNum + (int)m_locations.size() - 1;
+  if ( end > last ) end = last;
+
+  // read runs of records stored back to back in a segment at once
+  std::vector < std::pair < int, Location > > chunk;
+  std::vector < char > buffer;
+  int msgSeqNum = begin;
+
+  while ( msgSeqNum <= end )
+  {
+    chunk.clear();
+    long start = 0, stop = 0;
+    for ( ; msgSeqNum <= end; ++msgSeqNum )
+    {
+      const Location* pLocation = getLocation( msgSeqNum );
+      if ( !pLocation ) continue;
+      if ( chunk.size() &&
+           ( pLocation->m_segment != chunk.back().second.m_segment
+             || pLocation->m_offset != stop + (long)sizeof( RecordHeader )
+             || stop - start >= SEGMENT_READ_SIZE ) )
+        break;
+      if ( chunk.empty() ) start = pLocation->m_offset;
+      stop = pLocation->m_offset + pLocation->m_length;
+      chunk.push_back( std::make_pair( msgSeqNum, *pLocation ) );
+    }
+    if ( chunk.empty() ) return;
+
+    FILE* file = getReadFile( chunk.front().second.m_segment );
+    buffer.resize( stop - start + 1 );
+    if ( fseek( file, start, SEEK_SET ) )
+      throw IOException( "Unable to seek in segment " + m_sessionID );
+    size_t result = fread( &buffer[ 0 ], sizeof( char ), stop - start, file );
+    if ( ferror( file ) || result != (size_t)( stop - start ) )
+      throw IOException( "Unable to read from segment " + m_sessionID );
+
+    std::vector < std::pair < int, Location > >::const_iterator i;
+    for ( i = chunk.begin(); i != chunk.end(); ++i )
+    {
+      if ( !visitor.onMessage( i->first, &buffer[ i->second.m_offset - start ],
+                               i->second.m_length ) )
+        return;
+    }
+  }
+}
+
+int SegmentedFileStore::getNextSenderMsgSeqNum() const throw ( IOException )
+{
+  return m_header.m_nextSenderMsgSeqNum;
+}
+
+int SegmentedFileStore::getNextTargetMsgSeqNum() const throw ( IOException )
+{
+  return m_header.m_nextTargetMsgSeqNum;
+}
+
+void SegmentedFileStore::setNextSenderMsgSeqNum( int value ) throw ( IOException )
+{
+  m_header.m_nextSenderMsgSeqNum = value;
+  writeHeader();
+}
+
+void SegmentedFileStore::setNextTargetMsgSeqNum( int value ) throw ( IOException )
+{
+  m_header.m_nextTargetMsgSeqNum = value;
+  writeHeader();
+}
+
+void SegmentedFileStore::incrNextSenderMsgSeqNum() throw ( IOException )
+{
+  ++m_header.m_nextSenderMsgSeqNum;
+  writeHeader();
+}
+
+void SegmentedFileStore::incrNextTargetMsgSeqNum() throw ( IOException )
+{
+  ++m_header.m_nextTargetMsgSeqNum;
+  writeHeader();
+}
+
+UtcTimeStamp SegmentedFileStore::getCreationTime() const throw ( IOException )
+{
+  return m_creationTime;
+}
+
+void SegmentedFileStore::reset() throw ( IOException )
+{
+  if( m_file ) fclose( m_file );
+  if( m_readFile ) fclose( m_readFile );
+  m_file = m_readFile = 0;
+
+  Segments segments;
+  segments.swap( m_segments );
+  m_locations.clear();
+  m_firstSeqNum = 0;
+  m_highestSeqNum = 0;
+
+  // switching to a new generation is all it takes, the old segments
+  // are removed once the metadata no longer refers to them
+  int generation = m_header.m_generation++;
+  m_header.m_firstSegment = 1;
+  m_header.m_lastSegment = 0;
+  m_header.m_nextSenderMsgSeqNum = 1;
+  m_header.m_nextTargetMsgSeqNum = 1;
+  m_creationTime.setCurrent();
+  writeHeader();
+
+  Segments::const_iterator i;
+  for( i = segments.begin(); i != segments.end(); ++i )
+    remove( generation, i->m_number );
+}
+
+void SegmentedFileStore::refresh() throw ( IOException )
+{
+  open();
+}
+
+} //namespace FIX
@@ -0,0 +1,227 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_SEGMENTEDFILESTORE_H
+#define FIX_SEGMENTEDFILESTORE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "MessageStore.h"
+#include "SessionSettings.h"
+#include "Mutex.h"
+#include "Queue.h"
+#include "AtomicCount.h"
+#include "Utility.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace FIX
+{
+/**
+ * Background thread removing or archiving segments a SegmentedFileStore
+ * no longer needs.
+ *
+ * Files still queued when the cleaner is stopped are removed by the caller.
+ */
+class SegmentedFileStoreCleaner
+{
+public:
+  SegmentedFileStoreCleaner();
+  ~SegmentedFileStoreCleaner();
+
+  void start();
+  void stop();
+
+  /// Moves the file to archive, an empty archive removes it
+  void remove( const std::string& file, const std::string& archive );
+  static void clean( const std::string& file, const std::string& archive );
+
+private:
+  typedef std::pair < std::string, std::string > File;
+
+  void run();
+  static THREAD_PROC cleanerThread( void* p );
+
+  Queue < File > m_files;
+  thread_id m_threadid;
+  bool m_running;
+  /// Polled by the cleaner thread without a lock
+  atomic_count m_stop;
+  Mutex m_mutex;
+};
+
+/// Creates a segmented file based implementation of MessageStore.
+class SegmentedFileStoreFactory : public MessageStoreFactory
+{
+public:
+  SegmentedFileStoreFactory( const SessionSettings& settings )
+: m_segmentSize( 0 ), m_retention( 0 ), m_settings( settings ) {};
+  SegmentedFileStoreFactory( const std::string& path, size_t segmentSize = 0,
+                             int retention = 0,
+                             const std::string& archivePath = "" )
+: m_path( path ), m_segmentSize( segmentSize ), m_retention( retention ),
+  m_archivePath( archivePath ) {};
+
+  MessageStore* create( const SessionID& );
+  void destroy( MessageStore* );
+private:
+  std::string m_path;
+  size_t m_segmentSize;
+  int m_retention;
+  std::string m_archivePath;
+  SessionSettings m_settings;
+  SegmentedFileStoreCleaner m_cleaner;
+};
+/*! @} */
+
+/**
+ * Segmented file based implementation of MessageStore.
+ *
+ * Messages are appended to a series of segment files, a new segment is
+ * started once the current one would grow past the segment size.  A binary
+ * metadata file holds the sequence numbers, the creation time and the range
+ * of segments that are part of the store.
+ *
+ * The formats of the files are:<br>
+ * &nbsp;&nbsp;
+ *   [path]+[BeginString]-[SenderCompID]-[TargetCompID].segments<br>
+ * &nbsp;&nbsp;
+ *   [path]+[BeginString]-[SenderCompID]-[TargetCompID].[Generation].[Number].segment<br>
+ *
+ * Each segment is a series of records of sequence number and length in
+ * native byte order followed by the message.  The index is rebuilt by
+ * scanning the segments on open, a partially written record at the end of
+ * a segment is ignored and writing continues in a new segment.
+ *
+ * With a retention of n messages, segments holding only messages more than
+ * n below the highest stored sequence number are dropped when a new segment
+ * is started.  A reset starts a new generation of segments by rewriting the
+ * metadata file, dropped segments and those of earlier generations are
+ * removed, or moved to the archive path, by the cleaner.  Segments of this
+ * session the metadata no longer refers to, left behind when the process
+ * ended before the cleaner got to them, are handed to the cleaner again
+ * on open.  Like FileStore,
+ * writes are flushed to the operating system after each change.
+ */
+class SegmentedFileStore : public MessageStore
+{
+public:
+  SegmentedFileStore( std::string, const SessionID& s, size_t segmentSize = 0,
+                      int retention = 0, const std::string& archivePath = "",
+                      SegmentedFileStoreCleaner* pCleaner = 0 );
+  virtual ~SegmentedFileStore();
+
+  bool set( int, const std::string& ) throw ( IOException );
+  void get( int, int, std::vector < std::string > & ) const throw ( IOException );
+  void getRange( int, int, MessageStoreVisitor& ) const throw ( IOException );
+
+  int getNextSenderMsgSeqNum() const throw ( IOException );
+  int getNextTargetMsgSeqNum() const throw ( IOException );
+  void setNextSenderMsgSeqNum( int value ) throw ( IOException );
+  void setNextTargetMsgSeqNum( int value ) throw ( IOException );
+  void incrNextSenderMsgSeqNum() throw ( IOException );
+  void incrNextTargetMsgSeqNum() throw ( IOException );
+
+  UtcTimeStamp getCreationTime() const throw ( IOException );
+
+  void reset() throw ( IOException );
+  void refresh() throw ( IOException );
+
+  int getGeneration() const { return m_header.m_generation; }
+  /// Number of segments currently part of the store
+  size_t getSegmentCount() const { return m_segments.size(); }
+
+private:
+  struct Header
+  {
+    char m_magic[ 8 ];
+    int32_t m_generation;
+    int32_t m_firstSegment;
+    int32_t m_lastSegment;
+    int32_t m_nextSenderMsgSeqNum;
+    int32_t m_nextTargetMsgSeqNum;
+    char m_creationTime[ 28 ];
+  };
+
+  struct RecordHeader
+  {
+    int32_t m_msgSeqNum;
+    int32_t m_length;
+  };
+
+  struct Segment
+  {
+    int m_number;
+    long m_size;
+    int m_lastSeqNum;
+  };
+
+  struct Location
+  {
+    int m_segment;
+    long m_offset;
+    long m_length;
+  };
+
+  typedef std::deque < Segment > Segments;
+  /// Message locations indexed by MsgSeqNum - m_firstSeqNum
+  typedef std::deque < Location > Locations;
+
+  void open();
+  void close();
+  bool load( int number );
+  void roll() throw ( IOException );
+  void retain();
+  void sweep();
+  void writeHeader() throw ( IOException );
+  void remove( int generation, int number );
+  void setLocation( int msgSeqNum, const Location& location );
+  const Location* getLocation( int msgSeqNum ) const;
+  FILE* getReadFile( int number ) const throw ( IOException );
+  std::string getSegmentName( int generation, int number ) const;
+
+  Header m_header;
+  UtcTimeStamp m_creationTime;
+  Segments m_segments;
+  Locations m_locations;
+  int m_firstSeqNum;
+  int m_highestSeqNum;
+
+  size_t m_segmentSize;
+  int m_retention;
+  std::string m_archivePath;
+  SegmentedFileStoreCleaner* m_pCleaner;
+
+  std::string m_path;
+  std::string m_sessionID;
+  std::string m_headerFileName;
+
+  FILE* m_headerFile;
+  FILE* m_file;
+  mutable FILE* m_readFile;
+  mutable int m_readSegment;
+};
+}
+
+#endif //FIX_SEGMENTEDFILESTORE_H
@@ -58,13 +58,22 @@ Session::Session( Application& application,
   m_resetOnLogout( false ), 
   m_resetOnDisconnect( false ),
   m_refreshOnLogon( false ),
+  m_flushStoreOnDisconnect( true ),
   m_timestampPrecision( 3 ),
   m_persistMessages( true ),
   m_validateLengthAndChecksum( true ),
+  m_resendToApp( true ),
+  m_sendQueueHighWaterBytes( 0 ),
+  m_sendQueueHighWaterMessages( 0 ),
+  m_sendQueueLowWaterBytes( 0 ),
+  m_sendQueueLowWaterMessages( 0 ),
+  m_sendBlocked( 0 ),
   m_dataDictionaryProvider( dataDictionaryProvider ),
   m_messageStoreFactory( messageStoreFactory ),
   m_pLogFactory( pLogFactory ),
-  m_pResponder( 0 )
+  m_pResponder( 0 ),
+  m_pTimerQueue( 0 ),
+  m_nextCheck( 0 )
 {
   m_state.heartBtInt( heartBtInt );
   m_state.initiate( heartBtInt != 0 );
@@ -72,7 +81,7 @@ Session::Session( Application& application,
   if ( m_pLogFactory )
     m_state.log( m_pLogFactory->create( m_sessionID ) );
 
-  if( !checkSessionTime(UtcTimeStamp()) )
+  if( !checkSessionTime(m_state.clock().getUtcTime()) )
     reset();
 
   addSession( *this );
@@ -88,33 +97,39 @@ Session::~Session()
     m_pLogFactory->destroy( m_state.log() );
 }
 
-void Session::insertSendingTime( Header& header )
+int Session::getSendingTimePrecision()
 {
-  UtcTimeStamp now;
   bool showMilliseconds = false;
   if( m_sessionID.getBeginString() == BeginString_FIXT11 )
     showMilliseconds = true;
   else
     showMilliseconds = m_sessionID.getBeginString() >= BeginString_FIX42;
 
-  header.setField( SendingTime(now, showMilliseconds ? m_timestampPrecision : 0) );
+  return showMilliseconds ? m_timestampPrecision : 0;
 }
 
-void Session::insertOrigSendingTime( Header& header, const UtcTimeStamp& when )
+char* Session::formatSendingTime( char* buffer )
 {
-  bool showMilliseconds = false;
-  if( m_sessionID.getBeginString() == BeginString_FIXT11 )
-    showMilliseconds = true;
-  else
-    showMilliseconds = m_sessionID.getBeginString() >= BeginString_FIX42;
+  Locker l(m_mutex);
+  return m_sendingTimeFormatter.format
+    ( buffer, m_state.clock().getUtcTime(), getSendingTimePrecision() );
+}
+
+void Session::insertSendingTime( Header& header )
+{
+  char sendingTime[ UtcTimeStampFormatter::MAX_LENGTH ];
+  char* end = formatSendingTime( sendingTime );
+  header.setField( FIELD::SendingTime, sendingTime, end - sendingTime );
+}
 
-  header.setField( OrigSendingTime(when, showMilliseconds ? m_timestampPrecision : 0) );
+void Session::insertOrigSendingTime( Header& header, const UtcTimeStamp& when )
+{
+  header.setField( OrigSendingTime(when, getSendingTimePrecision()) );
 }
 
 void Session::fill( Header& header )
 {
-  UtcTimeStamp now;
-  m_state.lastSentTime( now );
+  m_state.lastSentMonotonic( m_state.clock().getMonotonic() );
   header.setField( m_sessionID.getBeginString() );
   header.setField( m_sessionID.getSenderCompID() );
   header.setField( m_sessionID.getTargetCompID() );
@@ -124,7 +139,33 @@ void Session::fill( Header& header )
 
 void Session::next()
 {
-  next( UtcTimeStamp() );
+  UtcTimeStamp now = m_state.clock().getUtcTime();
+  next( now );
+
+  // check again when the session or logon time may change, and at least
+  // once a minute in case the wall clock is set
+  int64_t remaining = 60 * DateTime::NANOS_PER_SEC;
+  int64_t sessionTime = m_sessionTime.getTimeToChange( now );
+  int64_t logonTime = m_logonTime.getTimeToChange( now );
+  if ( sessionTime < remaining ) remaining = sessionTime;
+  if ( logonTime < remaining ) remaining = logonTime;
+  m_nextCheck = m_state.clock().getMonotonic() + remaining;
+  schedule();
+}
+
+void Session::setTimerQueue( TimerQueue* pTimerQueue )
+{
+  Locker l(m_mutex);
+  if ( m_pTimerQueue ) m_pTimerQueue->cancel( this );
+  m_pTimerQueue = pTimerQueue;
+  schedule();
+}
+
+void Session::schedule()
+{
+  Locker l(m_mutex);
+  if ( m_pTimerQueue && m_pResponder )
+    m_pTimerQueue->schedule( this, getNextTimeout() );
 }
 
 void Session::next( const UtcTimeStamp& timeStamp )
@@ -275,6 +316,7 @@ void Session::nextLogon( const Message& logon, const UtcTimeStamp& timeStamp )
 
   if ( isLoggedOn() )
     m_application.onLogon( m_sessionID );
+  schedule();
 }
 
 void Session::nextHeartbeat( const Message& heartbeat, const UtcTimeStamp& timeStamp )
@@ -312,6 +354,7 @@ void Session::nextLogout( const Message& logout, const UtcTimeStamp& timeStamp )
 void Session::nextReject( const Message& reject, const UtcTimeStamp& timeStamp )
 {
   if ( !verify( reject, false, true ) ) return ;
+  getStatistics().add( SessionStatistics::REJECTS_RECEIVED );
   m_state.incrNextTargetMsgSeqNum();
   nextQueued( timeStamp );
 }
@@ -346,6 +389,7 @@ void Session::nextResendRequest( const Message& resendRequest, const UtcTimeStam
   if ( !verify( resendRequest, false, false ) ) return ;
 
   Locker l( m_mutex );
+  getStatistics().add( SessionStatistics::RESEND_REQUESTS_SERVED );
 
   BeginSeqNo beginSeqNo;
   EndSeqNo endSeqNo;
@@ -372,121 +416,286 @@ void Session::nextResendRequest( const Message& resendRequest, const UtcTimeStam
     return;
   }
 
-  std::vector < std::string > messages;
-  m_state.get( beginSeqNo, endSeqNo, messages );
+  Resender resender( *this, beginSeqNo );
+  int begin = beginSeqNo;
+  do
+  {
+    m_state.getRange( begin, endSeqNo, resender );
+    begin = resender.getMsgSeqNum() + 1;
+  }
+  while ( resender.flush() && begin <= endSeqNo );
 
-  std::vector < std::string > ::iterator i;
-  MsgSeqNum msgSeqNum(0);
-  MsgType msgType;
-  int begin = 0;
-  int current = beginSeqNo;
-  std::string messageString;
+  MsgSeqNum msgSeqNum( resender.getMsgSeqNum() );
+  if ( resender.getBegin() )
+  {
+    generateSequenceReset( resender.getBegin(), msgSeqNum + 1 );
+  }
 
-  for ( i = messages.begin(); i != messages.end(); ++i )
+  if ( endSeqNo > msgSeqNum )
   {
-    std::auto_ptr<FIX::Message> pMsg;
-    std::string strMsgType;
-    const DataDictionary& sessionDD =
-      m_dataDictionaryProvider.getSessionDataDictionary(m_sessionID.getBeginString());
-    if (sessionDD.isMessageFieldsOrderPreserved())
+    endSeqNo = EndSeqNo(endSeqNo + 1);
+    int next = m_state.getNextSenderMsgSeqNum();
+    if( endSeqNo > next )
+      endSeqNo = EndSeqNo(next);
+    generateSequenceReset( beginSeqNo, endSeqNo );
+  }
+
+  resendRequest.getHeader().getField( msgSeqNum );
+  if( !isTargetTooHigh(msgSeqNum) && !isTargetTooLow(msgSeqNum) )
+    m_state.incrNextTargetMsgSeqNum();
+}
+
+bool Session::Resender::onMessage( int msgSeqNum, const char* data, std::size_t length )
+{
+  m_stored.push_back( std::string( data, length ) );
+  m_bytes += length;
+  m_msgSeqNum = msgSeqNum;
+  return !isFull();
+}
+
+bool Session::Resender::flush()
+{
+  bool full = isFull();
+
+  std::vector < std::string > ::const_iterator i;
+  for ( i = m_stored.begin(); i != m_stored.end(); ++i )
+    resend( *i );
+
+  m_stored.clear();
+  m_bytes = 0;
+  return full;
+}
+
+void Session::Resender::resend( const std::string& stored )
+{
+  int msgSeqNum = 0;
+  bool admin = false;
+  bool sent = true;
+
+  if ( m_session.m_resendToApp
+       || !m_session.resendRaw( stored.data(), stored.size(), msgSeqNum, admin,
+                                m_body, m_messageString ) )
+  {
+    std::auto_ptr<Message> pMsg( m_session.newStoredMessage( stored ) );
+    Message & msg = *pMsg;
+
+    MsgSeqNum storedMsgSeqNum;
+    MsgType msgType;
+    msg.getHeader().getField( storedMsgSeqNum );
+    msg.getHeader().getField( msgType );
+    msgSeqNum = storedMsgSeqNum;
+    admin = Message::isAdminMsgType( msgType );
+
+    if ( !admin )
     {
-      std::string::size_type equalSign = (*i).find("\00135=");
-      equalSign += 4;
-      std::string::size_type soh = (*i).find_first_of('\001', equalSign);
-      strMsgType = (*i).substr(equalSign, soh - equalSign);
-#ifdef HAVE_EMX
-      if (FIX::Message::isAdminMsgType(strMsgType) == false)
-      {
-        equalSign = (*i).find("\0019426=", soh);
-        if (equalSign == std::string::npos)
-          throw FIX::IOException("EMX message type (9426) not found");
-
-        equalSign += 6;
-        soh = (*i).find_first_of('\001', equalSign);
-        if (soh == std::string::npos)
-          throw FIX::IOException("EMX message type (9426) soh char not found");
-        strMsgType.assign((*i).substr(equalSign, soh - equalSign));
-      }
-#endif
+      sent = m_session.resend( msg );
+      if ( sent ) msg.toString( m_messageString );
     }
+  }
 
-    if( m_sessionID.isFIXT() )
-    {
-      Message msg;
-      msg.setStringHeader(*i);
-      ApplVerID applVerID;
-      if( !msg.getHeader().getFieldIfSet(applVerID) )
-        applVerID = m_senderDefaultApplVerID;
+  if( (m_current != msgSeqNum) && !m_begin )
+    m_begin = m_current;
 
-      const DataDictionary& applicationDD =
-          m_dataDictionaryProvider.getApplicationDataDictionary(applVerID);
-      if (strMsgType.empty())
-        pMsg.reset( new Message( *i, sessionDD, applicationDD, m_validateLengthAndChecksum ));
-      else
-      {
-        const message_order & hdrOrder = sessionDD.getHeaderOrderedFields();
-        const message_order & trlOrder = sessionDD.getTrailerOrderedFields();
-        const message_order & msgOrder = applicationDD.getMessageOrderedFields(strMsgType);
-        pMsg.reset( new Message( hdrOrder, trlOrder, msgOrder, *i, sessionDD, applicationDD, m_validateLengthAndChecksum ));
-      }
+  if ( admin )
+  {
+    if ( !m_begin ) m_begin = msgSeqNum;
+  }
+  else
+  {
+    if ( sent )
+    {
+      if ( m_begin )
+        m_session.generateSequenceReset( m_begin, msgSeqNum );
+      m_session.send( m_messageString );
+      m_session.m_state.onEvent( "Resending Message: "
+                                 + IntConvertor::convert( msgSeqNum ) );
+      m_begin = 0;
     }
     else
+    { if ( !m_begin ) m_begin = msgSeqNum; }
+  }
+  m_current = msgSeqNum + 1;
+}
+
+bool Session::resendRaw( const char* data, std::size_t length, int& msgSeqNum,
+                         bool& admin, std::string& body, std::string& result )
+{
+  struct Field
+  {
+    int tag;
+    const char* begin;
+    const char* end;
+  };
+
+  // locate the header fields, anything unusual takes the parsing path
+  static const int MAX_HEADER_FIELDS = 32;
+  Field fields[ MAX_HEADER_FIELDS ];
+  int count = 0;
+  const char* end = data + length;
+  const char* pos = data;
+  const char* sendingTime = 0;
+  std::size_t sendingTimeLength = 0;
+  msgSeqNum = 0;
+
+  while ( true )
+  {
+    if ( pos >= end ) return false;
+    const char* equals = (const char*)memchr( pos, '=', end - pos );
+    if ( !equals || equals == pos ) return false;
+    int tag = 0;
+    for ( const char* p = pos; p < equals; ++p )
     {
-      if (strMsgType.empty())
-        pMsg.reset( new Message( *i, sessionDD, m_validateLengthAndChecksum ));
-      else
-      {
-        const message_order & hdrOrder = sessionDD.getHeaderOrderedFields();
-        const message_order & trlOrder = sessionDD.getTrailerOrderedFields();
-        const message_order & msgOrder = sessionDD.getMessageOrderedFields(strMsgType);
-        pMsg.reset(new Message(hdrOrder, trlOrder, msgOrder, *i, sessionDD, m_validateLengthAndChecksum ));
-      }
+      if ( *p < '0' || *p > '9' ) return false;
+      tag = tag * 10 + ( *p - '0' );
     }
+    const char* value = equals + 1;
+    const char* soh = (const char*)memchr( value, '\001', end - value );
+    if ( !soh ) return false;
 
-    Message & msg = *pMsg;
+    static const int first[] =
+      { FIELD::BeginString, FIELD::BodyLength, FIELD::MsgType };
+    if ( count < 3 && tag != first[ count ] ) return false;
+    if ( count >= 3 && !Message::isHeaderField( tag ) ) break;
+    if ( count == MAX_HEADER_FIELDS ) return false;
 
-    msg.getHeader().getField( msgSeqNum );
-    msg.getHeader().getField( msgType );
+    switch ( tag )
+    {
+    case FIELD::MsgType:
+      admin = Message::isAdminMsgType( MsgType( std::string( value, soh ) ) );
+      break;
+    case FIELD::MsgSeqNum:
+      msgSeqNum = atoi( std::string( value, soh ).c_str() );
+      break;
+    case FIELD::SendingTime:
+      sendingTime = value;
+      sendingTimeLength = soh - value;
+      break;
+    // data and repeating group fields need the dictionaries
+    case FIELD::SecureDataLen:
+    case FIELD::XmlDataLen:
+    case FIELD::XmlData:
+    case FIELD::NoHops:
+      return false;
+    }
 
-    if( (current != msgSeqNum) && !begin )
-      begin = current;
+    Field& field = fields[ count++ ];
+    field.tag = tag;
+    field.begin = pos;
+    field.end = soh + 1;
+    pos = soh + 1;
+  }
 
-    if ( Message::isAdminMsgType( msgType ) )
+  const char* trailer = end - 7;
+  if ( msgSeqNum <= 0 || !sendingTime || trailer < pos
+       || memcmp( trailer, "10=", 3 ) != 0 || end[ -1 ] != '\001' )
+    return false;
+  if ( admin ) return true;
+
+  // keep the header in tag order, as Message::toString would
+  char now[ UtcTimeStampFormatter::MAX_LENGTH ];
+  char* nowEnd = formatSendingTime( now );
+  bool possDupFlag = false, origSendingTime = false;
+
+  body.clear();
+  for ( int i = 2; i < count; ++i )
+  {
+    int tag = fields[ i ].tag;
+    if ( tag == FIELD::PossDupFlag || tag == FIELD::OrigSendingTime )
+      continue;
+    if ( i > 2 && !possDupFlag && tag > FIELD::PossDupFlag )
     {
-      if ( !begin ) begin = msgSeqNum;
+      body += "43=Y\001";
+      possDupFlag = true;
     }
-    else
+    if ( i > 2 && !origSendingTime && tag > FIELD::OrigSendingTime )
     {
-      if ( resend( msg ) )
-      {
-        if ( begin ) generateSequenceReset( begin, msgSeqNum );
-        send( msg.toString(messageString) );
-        m_state.onEvent( "Resending Message: "
-                         + IntConvertor::convert( msgSeqNum ) );
-        begin = 0;
-      }
-      else
-      { if ( !begin ) begin = msgSeqNum; }
+      body.append( "122=" ).append( sendingTime, sendingTimeLength ) += '\001';
+      origSendingTime = true;
     }
-    current = msgSeqNum + 1;
+    if ( tag == FIELD::SendingTime )
+      body.append( "52=" ).append( now, nowEnd ) += '\001';
+    else
+      body.append( fields[ i ].begin, fields[ i ].end );
   }
-  if ( begin )
+  if ( !possDupFlag )
+    body += "43=Y\001";
+  if ( !origSendingTime )
+    body.append( "122=" ).append( sendingTime, sendingTimeLength ) += '\001';
+  body.append( pos, trailer );
+
+  result.assign( fields[ 0 ].begin, fields[ 0 ].end );
+  result.append( "9=" ).append( IntConvertor::convert( (int)body.size() ) ) += '\001';
+  result += body;
+
+  int checkSum = 0;
+  for ( std::string::const_iterator c = result.begin(); c != result.end(); ++c )
+    checkSum += (unsigned char)*c;
+  result.append( "10=" ).append( CheckSumConvertor::convert( checkSum % 256 ) ) += '\001';
+  return true;
+}
+
+Message * Session::newStoredMessage(const std::string & messageString) const
+{
+  std::auto_ptr<FIX::Message> pMsg;
+  std::string strMsgType;
+  const DataDictionary& sessionDD =
+    m_dataDictionaryProvider.getSessionDataDictionary(m_sessionID.getBeginString());
+  if (sessionDD.isMessageFieldsOrderPreserved())
   {
-    generateSequenceReset( begin, msgSeqNum + 1 );
+    std::string::size_type equalSign = messageString.find("\00135=");
+    equalSign += 4;
+    std::string::size_type soh = messageString.find_first_of('\001', equalSign);
+    strMsgType = messageString.substr(equalSign, soh - equalSign);
+#ifdef HAVE_EMX
+    if (FIX::Message::isAdminMsgType(strMsgType) == false)
+    {
+      equalSign = messageString.find("\0019426=", soh);
+      if (equalSign == std::string::npos)
+        throw FIX::IOException("EMX message type (9426) not found");
+
+      equalSign += 6;
+      soh = messageString.find_first_of('\001', equalSign);
+      if (soh == std::string::npos)
+        throw FIX::IOException("EMX message type (9426) soh char not found");
+      strMsgType.assign(messageString.substr(equalSign, soh - equalSign));
+    }
+#endif
   }
 
-  if ( endSeqNo > msgSeqNum )
+  if( m_sessionID.isFIXT() )
   {
-    endSeqNo = EndSeqNo(endSeqNo + 1);
-    int next = m_state.getNextSenderMsgSeqNum();
-    if( endSeqNo > next )
-      endSeqNo = EndSeqNo(next);
-    generateSequenceReset( beginSeqNo, endSeqNo );
+    Message msg;
+    msg.setStringHeader(messageString);
+    ApplVerID applVerID;
+    if( !msg.getHeader().getFieldIfSet(applVerID) )
+      applVerID = m_senderDefaultApplVerID;
+
+    const DataDictionary& applicationDD =
+        m_dataDictionaryProvider.getApplicationDataDictionary(applVerID);
+    if (strMsgType.empty())
+      pMsg.reset( new Message( messageString, sessionDD, applicationDD, m_validateLengthAndChecksum ));
+    else
+    {
+      const message_order & hdrOrder = sessionDD.getHeaderOrderedFields();
+      const message_order & trlOrder = sessionDD.getTrailerOrderedFields();
+      const message_order & msgOrder = applicationDD.getMessageOrderedFields(strMsgType);
+      pMsg.reset( new Message( hdrOrder, trlOrder, msgOrder, messageString, sessionDD, applicationDD, m_validateLengthAndChecksum ));
+    }
+  }
+  else
+  {
+    if (strMsgType.empty())
+      pMsg.reset( new Message( messageString, sessionDD, m_validateLengthAndChecksum ));
+    else
+    {
+      const message_order & hdrOrder = sessionDD.getHeaderOrderedFields();
+      const message_order & trlOrder = sessionDD.getTrailerOrderedFields();
+      const message_order & msgOrder = sessionDD.getMessageOrderedFields(strMsgType);
+      pMsg.reset(new Message(hdrOrder, trlOrder, msgOrder, messageString, sessionDD, m_validateLengthAndChecksum ));
+    }
   }
 
-  resendRequest.getHeader().getField( msgSeqNum );
-  if( !isTargetTooHigh(msgSeqNum) && !isTargetTooLow(msgSeqNum) )
-    m_state.incrNextTargetMsgSeqNum();
+  return pMsg.release();
 }
 
 Message * Session::newMessage(const std::string & msgType) const
@@ -527,9 +736,61 @@ bool Session::send( Message& message )
   return sendRaw( message );
 }
 
+Session::SendResult Session::trySend( Message& message )
+{
+  Locker l( m_mutex );
+
+  if( isSendQueueFull() )
+  {
+    if( !m_sendBlocked ) ++m_sendBlocked;
+    return WouldBlock;
+  }
+  return send( message ) ? Sent : NotSent;
+}
+
+void Session::checkSendQueue()
+{
+  if( !m_sendBlocked ) return;
+
+  {
+    Locker l( m_mutex );
+    if( !m_sendBlocked || !m_pResponder ) return;
+
+    size_t lowBytes = m_sendQueueLowWaterBytes
+      ? m_sendQueueLowWaterBytes : m_sendQueueHighWaterBytes / 2;
+    size_t lowMessages = m_sendQueueLowWaterMessages
+      ? m_sendQueueLowWaterMessages : m_sendQueueHighWaterMessages / 2;
+
+    if( m_pResponder->getSendQueueBytes() > lowBytes
+        && m_sendQueueHighWaterBytes )
+      return;
+    if( m_pResponder->getSendQueueMessages() > lowMessages
+        && m_sendQueueHighWaterMessages )
+      return;
+
+    --m_sendBlocked;
+  }
+
+  m_application.onSendQueueDrained( m_sessionID );
+}
+
+bool Session::isSendQueueFull()
+{
+  if( !m_pResponder ) return false;
+
+  if( m_sendQueueHighWaterBytes
+      && m_pResponder->getSendQueueBytes() >= m_sendQueueHighWaterBytes )
+    return true;
+  if( m_sendQueueHighWaterMessages
+      && m_pResponder->getSendQueueMessages() >= m_sendQueueHighWaterMessages )
+    return true;
+  return false;
+}
+
 bool Session::sendRaw( Message& message, int num )
 {
   Locker l( m_mutex );
+  LatencyTimer total( m_latency );
 
   try
   {
@@ -546,7 +807,9 @@ bool Session::sendRaw( Message& message, int num )
 
     if ( Message::isAdminMsgType( msgType ) )
     {
+      LatencyTimer timer( m_latency );
       m_application.toAdmin( message, m_sessionID );
+      timer.stop( SessionLatency::TO_APP );
 
       if( msgType == "A" && !m_state.receivedReset() )
       {
@@ -561,7 +824,9 @@ bool Session::sendRaw( Message& message, int num )
         m_state.sentReset( resetSeqNumFlag );
       }
 
+      timer.restart();
       message.toString( messageString );
+      timer.stop( SessionLatency::TO_STRING );
 
       if( !num )
         persist( message, messageString );
@@ -582,8 +847,11 @@ bool Session::sendRaw( Message& message, int num )
 
       try
       {
+        LatencyTimer timer( m_latency );
         m_application.toApp( message, m_sessionID );
+        timer.stop( SessionLatency::TO_APP );
         message.toString( messageString );
+        timer.stop( SessionLatency::TO_STRING );
 
         if( !num )
           persist( message, messageString );
@@ -594,6 +862,7 @@ bool Session::sendRaw( Message& message, int num )
       catch ( DoNotSend& ) { return false; }
     }
 
+    total.stop( SessionLatency::SEND_RAW );
     return true;
   }
   catch ( IOException& e )
@@ -606,8 +875,17 @@ bool Session::sendRaw( Message& message, int num )
 bool Session::send( const std::string& string )
 {
   if ( !m_pResponder ) return false;
+  LatencyTimer timer( m_latency );
   m_state.onOutgoing( string );
-  return m_pResponder->send( string );
+  timer.stop( SessionLatency::LOG );
+  bool result = m_pResponder->send( string );
+  timer.stop( SessionLatency::SEND );
+  if ( result )
+  {
+    getStatistics().add( SessionStatistics::MESSAGES_SENT );
+    getStatistics().add( SessionStatistics::BYTES_SENT, string.size() );
+  }
+  return result;
 }
 
 void Session::disconnect()
@@ -622,6 +900,9 @@ void Session::disconnect()
     m_pResponder = 0;
   }
 
+  if ( m_pTimerQueue )
+    m_pTimerQueue->cancel( this );
+
   if ( m_state.receivedLogon() || m_state.sentLogon() )
   {
     m_state.receivedLogon( false );
@@ -634,6 +915,11 @@ void Session::disconnect()
   m_state.sentReset( false );
   m_state.clearQueue();
   m_state.logoutReason();
+  if ( m_flushStoreOnDisconnect )
+  {
+    try { m_state.flush(); }
+    catch ( IOException& e ) { m_state.onEvent( e.what() ); }
+  }
   if ( m_resetOnDisconnect )
     m_state.reset();
 
@@ -663,11 +949,13 @@ bool Session::resend( Message& message )
 void Session::persist( const Message& message,  const std::string& messageString ) 
 throw ( IOException )
 {
+  LatencyTimer timer( m_latency );
   MsgSeqNum msgSeqNum;
   message.getHeader().getField( msgSeqNum );
   if( m_persistMessages )
     m_state.set( msgSeqNum, messageString );
   m_state.incrNextSenderMsgSeqNum();
+  timer.stop( SessionLatency::PERSIST );
 }
 
 void Session::generateLogon()
@@ -688,8 +976,7 @@ void Session::generateLogon()
     logon.setField( ResetSeqNumFlag(true) );
 
   fill( logon.getHeader() );
-  UtcTimeStamp now;
-  m_state.lastReceivedTime( now );
+  m_state.lastReceivedMonotonic( m_state.clock().getMonotonic() );
   m_state.testRequest( 0 );
   m_state.sentLogon( true );
   sendRaw( logon );
@@ -757,6 +1044,7 @@ void Session::generateSequenceReset
   sequenceReset.getHeader().setField( MsgSeqNum( beginSeqNo ) );
   sequenceReset.setField( GapFillFlag( true ) );
   sendRaw( sequenceReset, beginSeqNo );
+  getStatistics().add( SessionStatistics::GAP_FILLS_SENT );
   m_state.onEvent( "Sent SequenceReset TO: "
                    + IntConvertor::convert( newSeqNo ) );
 }
@@ -897,6 +1185,7 @@ void Session::generateReject( const Message& message, int err, int field )
     throw std::runtime_error( "Tried to send a reject while not logged on" );
 
   sendRaw( reject );
+  getStatistics().add( SessionStatistics::REJECTS_SENT );
 }
 
 void Session::generateReject( const Message& message, const std::string& str )
@@ -924,6 +1213,7 @@ void Session::generateReject( const Message& message, const std::string& str )
 
   reject.setField( Text( str ) );
   sendRaw( reject );
+  getStatistics().add( SessionStatistics::REJECTS_SENT );
   m_state.onEvent( "Message " + msgSeqNum.getString()
                    + " Rejected: " + str );
 }
@@ -991,6 +1281,7 @@ void Session::generateBusinessReject( const Message& message, int err, int field
     m_state.onEvent( "Message " + msgSeqNum.getString() + " Rejected" );
 
   sendRaw( reject );
+  getStatistics().add( SessionStatistics::REJECTS_SENT );
 }
 
 void Session::generateLogout( const std::string& text )
@@ -1004,6 +1295,7 @@ void Session::generateLogout( const std::string& text )
     logout.setField( Text( text ) );
   sendRaw( logout );
   m_state.sentLogout( true );
+  schedule();
 }
 
 void Session::populateRejectReason( Message& reject, int field,
@@ -1095,9 +1387,13 @@ bool Session::verify( const Message& msg, bool checkTooHigh,
     return false;
   }
 
-  UtcTimeStamp now;
-  m_state.lastReceivedTime( now );
-  m_state.testRequest( 0 );
+  m_state.lastReceivedMonotonic( m_state.clock().getMonotonic() );
+  if ( m_state.testRequest() )
+  {
+    // the heartbeat may now be due before the test request timer
+    m_state.testRequest( 0 );
+    schedule();
+  }
 
   fromCallback( pMsgType ? *pMsgType : MsgType(), msg, m_sessionID );
   return true;
@@ -1137,10 +1433,12 @@ bool Session::validLogonState( const MsgType& msgType )
 void Session::fromCallback( const MsgType& msgType, const Message& msg,
                             const SessionID& sessionID )
 {
+  LatencyTimer timer( m_latency );
   if ( Message::isAdminMsgType( msgType ) )
     m_application.fromAdmin( msg, m_sessionID );
   else
     m_application.fromApp( msg, m_sessionID );
+  timer.stop( SessionLatency::FROM_APP );
 }
 
 void Session::doBadTime( const Message& msg )
@@ -1266,21 +1564,39 @@ bool Session::nextQueued( int num, const UtcTimeStamp& timeStamp )
 
 void Session::next( const std::string& msg, const UtcTimeStamp& timeStamp, bool queued )
 {
+  LatencyTimer total( m_latency );
+  if( !queued )
+  {
+    getStatistics().add( SessionStatistics::MESSAGES_RECEIVED );
+    getStatistics().add( SessionStatistics::BYTES_RECEIVED, msg.size() );
+  }
+
   try
   {
+    LatencyTimer timer( m_latency );
     m_state.onIncoming( msg );
+    timer.stop( SessionLatency::LOG );
     const DataDictionary& sessionDD = 
       m_dataDictionaryProvider.getSessionDataDictionary(m_sessionID.getBeginString());
     if( m_sessionID.isFIXT() )
     {
       const DataDictionary& applicationDD =
         m_dataDictionaryProvider.getApplicationDataDictionary(m_senderDefaultApplVerID);
-      next( Message( msg, sessionDD, applicationDD, m_validateLengthAndChecksum ), timeStamp, queued );
+      timer.restart();
+      Message message( msg, sessionDD, applicationDD, m_validateLengthAndChecksum );
+      timer.stop( SessionLatency::SET_STRING );
+      message.setReceiveTime( timeStamp );
+      next( message, timeStamp, queued );
     }
     else
     {
-      next( Message( msg, sessionDD, m_validateLengthAndChecksum ), timeStamp, queued );
+      timer.restart();
+      Message message( msg, sessionDD, m_validateLengthAndChecksum );
+      timer.stop( SessionLatency::SET_STRING );
+      message.setReceiveTime( timeStamp );
+      next( message, timeStamp, queued );
     }
+    total.stop( SessionLatency::NEXT );
   }
   catch( InvalidMessage& e )
   {
@@ -1332,6 +1648,7 @@ void Session::next( const Message& message, const UtcTimeStamp& timeStamp, bool
     const DataDictionary& sessionDataDictionary = 
         m_dataDictionaryProvider.getSessionDataDictionary(m_sessionID.getBeginString());
 
+    LatencyTimer timer( m_latency );
     if( m_sessionID.isFIXT() && message.isApp() )
     {
       ApplVerID applVerID = m_targetDefaultApplVerID;
@@ -1344,6 +1661,7 @@ void Session::next( const Message& message, const UtcTimeStamp& timeStamp, bool
     {
       sessionDataDictionary.validate( message );
     }
+    timer.stop( SessionLatency::VALIDATE );
 
     if ( msgType == MsgType_Logon )
       nextLogon( message, timeStamp );
@@ -1452,6 +1770,16 @@ throw( SessionNotFound )
   catch ( FieldNotFound& ) { throw SessionNotFound(); }
 }
 
+Session::SendResult Session::trySendToTarget
+( Message& message, const SessionID& sessionID )
+throw( SessionNotFound )
+{
+  message.setSessionID( sessionID );
+  Session* pSession = lookupSession( sessionID );
+  if ( !pSession ) throw SessionNotFound();
+  return pSession->trySend( message );
+}
+
 bool Session::sendToTarget( Message& message, const SessionID& sessionID )
 throw( SessionNotFound )
 {
@@ -34,7 +34,11 @@
 #include "DataDictionaryProvider.h"
 #include "Application.h"
 #include "Mutex.h"
+#include "AtomicCount.h"
 #include "Log.h"
+#include "Latency.h"
+#include "TimerQueue.h"
+#include "UtcTimeStampFormatter.h"
 #include <utility>
 #include <map>
 #include <queue>
@@ -45,6 +49,9 @@ namespace FIX
 class Session
 {
 public:
+  /// Outcome of trySend
+  enum SendResult { Sent, WouldBlock, NotSent };
+
   Session( Application&, MessageStoreFactory&,
            const SessionID&,
            const DataDictionaryProvider&,
@@ -53,9 +60,9 @@ public:
   virtual ~Session();
 
   void logon() 
-  { m_state.enabled( true ); m_state.logoutReason( "" ); }
+  { m_state.enabled( true ); m_state.logoutReason( "" ); check(); }
   void logout( const std::string& reason = "" ) 
-  { m_state.enabled( false ); m_state.logoutReason( reason ); }
+  { m_state.enabled( false ); m_state.logoutReason( reason ); check(); }
   bool isEnabled() 
   { return m_state.enabled(); }
 
@@ -82,6 +89,8 @@ public:
   static bool sendToTarget( Message& message,
                             const std::string& qualifier = "" )
   throw( SessionNotFound );
+  static SendResult trySendToTarget( Message& message, const SessionID& sessionID )
+  throw( SessionNotFound );
   static bool sendToTarget( Message& message, const SessionID& sessionID )
   throw( SessionNotFound );
   static bool sendToTarget( Message&,
@@ -159,6 +168,10 @@ public:
   void setLogoutTimeout ( int value )
     { m_state.logoutTimeout( value ); }
 
+  /// Heartbeat interval in seconds, 0 until an acceptor is logged on
+  int getHeartBtInt()
+    { return m_state.heartBtInt(); }
+
   bool getResetOnLogon()
     { return m_resetOnLogon; }
   void setResetOnLogon ( bool value )
@@ -179,6 +192,11 @@ public:
   void setRefreshOnLogon( bool value )
     { m_refreshOnLogon = value; } 
 
+  bool getFlushStoreOnDisconnect()
+    { return m_flushStoreOnDisconnect; }
+  void setFlushStoreOnDisconnect( bool value )
+    { m_flushStoreOnDisconnect = value; }
+
   bool getMillisecondsInTimeStamp()
     { return (m_timestampPrecision == 3); }
   void setMillisecondsInTimeStamp ( bool value )
@@ -207,14 +225,44 @@ public:
   void setValidateLengthAndChecksum ( bool value )
     { m_validateLengthAndChecksum = value; }
 
+  bool getResendToApp()
+    { return m_resendToApp; }
+  void setResendToApp ( bool value )
+    { m_resendToApp = value; }
+
+  size_t getSendQueueHighWaterBytes()
+    { return m_sendQueueHighWaterBytes; }
+  void setSendQueueHighWaterBytes ( size_t value )
+    { m_sendQueueHighWaterBytes = value; }
+
+  size_t getSendQueueHighWaterMessages()
+    { return m_sendQueueHighWaterMessages; }
+  void setSendQueueHighWaterMessages ( size_t value )
+    { m_sendQueueHighWaterMessages = value; }
+
+  size_t getSendQueueLowWaterBytes()
+    { return m_sendQueueLowWaterBytes; }
+  void setSendQueueLowWaterBytes ( size_t value )
+    { m_sendQueueLowWaterBytes = value; }
+
+  size_t getSendQueueLowWaterMessages()
+    { return m_sendQueueLowWaterMessages; }
+  void setSendQueueLowWaterMessages ( size_t value )
+    { m_sendQueueLowWaterMessages = value; }
+
   void setResponder( Responder* pR )
   {
-    if( !checkSessionTime(UtcTimeStamp()) )
+    if( !checkSessionTime(m_state.clock().getUtcTime()) )
       reset();
     m_pResponder = pR;
+    schedule();
   }
 
   bool send( Message& );
+  /// Like send, but returns WouldBlock instead of queueing past the high water mark
+  SendResult trySend( Message& );
+  /// Called by responders as their send queue shrinks
+  void checkSendQueue();
   void next();
   void next( const UtcTimeStamp& timeStamp );
   void next( const std::string&, const UtcTimeStamp& timeStamp, bool queued = false );
@@ -226,19 +274,76 @@ public:
 
   Log* getLog() { return &m_state; }
   const MessageStore* getStore() { return &m_state; }
+  /// Latency histograms of the processing stages, see SessionLatency
+  SessionLatency& getLatency() { return m_latency; }
+  /// Counters and gauges that may be read without the session mutex
+  SessionStatistics& getStatistics() { return m_state.statistics(); }
+  /// Source of time for the timers and timestamps, the system clock by default
+  void setClock( Clock* pClock ) { m_state.clock( pClock ); }
+  Clock& getClock() { return m_state.clock(); }
+  /// Monotonic time next() has something to do, see Clock
+  int64_t getNextTimeout() const { return m_state.nextTimeout( m_nextCheck ); }
+  /// Queue the deadlines of the session are scheduled on while it has a responder
+  void setTimerQueue( TimerQueue* pTimerQueue );
 
 private:
   typedef std::map < SessionID, Session* > Sessions;
   typedef std::set < SessionID > SessionIDs;
 
+  /**
+   * Collects the stored messages of a ResendRequest as they are read.
+   *
+   * The store is locked while it is read, so the messages are only copied
+   * there.  flush prepares them once the read returns, calling toApp and
+   * serializing them again, and sends them.  Reading stops when a batch is
+   * full and resumes after the last message collected.
+   */
+  class Resender : public MessageStoreVisitor
+  {
+  public:
+    Resender( Session& session, int beginSeqNo )
+    : m_session( session ), m_begin( 0 ),
+      m_current( beginSeqNo ), m_msgSeqNum( 0 ), m_bytes( 0 ) {}
+
+    bool onMessage( int msgSeqNum, const char* data, std::size_t length );
+    /// Sends the messages collected, returns false if the batch was not full
+    bool flush();
+
+    int getBegin() const { return m_begin; }
+    int getMsgSeqNum() const { return m_msgSeqNum; }
+
+  private:
+    bool isFull() const
+    { return m_stored.size() >= 64 || m_bytes >= 65536; }
+    void resend( const std::string& stored );
+
+    Session& m_session;
+    int m_begin;
+    int m_current;
+    int m_msgSeqNum;
+    std::size_t m_bytes;
+    std::vector < std::string > m_stored;
+    std::string m_messageString;
+    std::string m_body;
+  };
+  friend class Resender;
+
+  void check() { m_nextCheck = 0; schedule(); }
+  void schedule();
+
   static bool addSession( Session& );
   static void removeSession( Session& );
 
   bool send( const std::string& );
   bool sendRaw( Message&, int msgSeqNum = 0 );
   bool resend( Message& message );
+  bool resendRaw( const char* data, std::size_t length, int& msgSeqNum,
+                  bool& admin, std::string& body, std::string& result );
+  bool isSendQueueFull();
   void persist( const Message&, const std::string& ) throw ( IOException );
 
+  int getSendingTimePrecision();
+  char* formatSendingTime( char* buffer );
   void insertSendingTime( Header& );
   void insertOrigSendingTime( Header&,
                               const UtcTimeStamp& when = UtcTimeStamp () );
@@ -247,7 +352,7 @@ private:
   bool isGoodTime( const SendingTime& sendingTime )
   {
     if ( !m_checkLatency ) return true;
-    UtcTimeStamp now;
+    UtcTimeStamp now = m_state.clock().getUtcTime();
     return labs( now - sendingTime ) <= m_maxLatency;
   }
   bool checkSessionTime( const UtcTimeStamp& timeStamp )
@@ -312,6 +417,7 @@ private:
   bool get( int s, Message& m ) const;
 
   Message * newMessage(const std::string & msgType) const;
+  Message * newStoredMessage(const std::string & messageString) const;
 
   Application& m_application;
   SessionID m_sessionID;
@@ -328,15 +434,27 @@ private:
   bool m_resetOnLogout;
   bool m_resetOnDisconnect;
   bool m_refreshOnLogon;
+  bool m_flushStoreOnDisconnect;
   int m_timestampPrecision;
   bool m_persistMessages;
   bool m_validateLengthAndChecksum;
+  bool m_resendToApp;
+  size_t m_sendQueueHighWaterBytes;
+  size_t m_sendQueueHighWaterMessages;
+  size_t m_sendQueueLowWaterBytes;
+  size_t m_sendQueueLowWaterMessages;
+  /// Set and cleared under m_mutex, checkSendQueue looks at it without
+  atomic_count m_sendBlocked;
 
   SessionState m_state;
   DataDictionaryProvider m_dataDictionaryProvider;
   MessageStoreFactory& m_messageStoreFactory;
   LogFactory* m_pLogFactory;
   Responder* m_pResponder;
+  TimerQueue* m_pTimerQueue;
+  int64_t m_nextCheck;
+  SessionLatency m_latency;
+  UtcTimeStampFormatter m_sendingTimeFormatter;
   Mutex m_mutex;
 
   static Sessions s_sessions;
@@ -120,6 +120,18 @@ Session* SessionFactory::create( const SessionID& sessionID,
     if ( heartBtInt <= 0 ) throw ConfigError( "Heartbeat must be greater than zero" );
   }
 
+  // the water marks are kept unsigned, a negative one would wrap around
+  static const char* const sendQueueWaterMarks[] =
+  { SEND_QUEUE_HIGH_WATER_BYTES, SEND_QUEUE_HIGH_WATER_MESSAGES,
+    SEND_QUEUE_LOW_WATER_BYTES, SEND_QUEUE_LOW_WATER_MESSAGES };
+  for ( int i = 0; i < 4; ++i )
+  {
+    if ( settings.has( sendQueueWaterMarks[ i ] )
+         && settings.getInt( sendQueueWaterMarks[ i ] ) < 0 )
+      throw ConfigError( std::string( sendQueueWaterMarks[ i ] )
+                         + " must not be negative" );
+  }
+
   std::auto_ptr<Session> pSession;
   pSession.reset( new Session( m_application, m_messageStoreFactory,
     sessionID, dataDictionaryProvider, sessionTimeRange,
@@ -188,14 +200,28 @@ Session* SessionFactory::create( const SessionID& sessionID,
     pSession->setResetOnDisconnect( settings.getBool( RESET_ON_DISCONNECT ) );
   if ( settings.has( REFRESH_ON_LOGON ) )
     pSession->setRefreshOnLogon( settings.getBool( REFRESH_ON_LOGON ) );
+  if ( settings.has( FLUSH_STORE_ON_DISCONNECT ) )
+    pSession->setFlushStoreOnDisconnect( settings.getBool( FLUSH_STORE_ON_DISCONNECT ) );
   if ( settings.has( MILLISECONDS_IN_TIMESTAMP ) )
     pSession->setMillisecondsInTimeStamp( settings.getBool( MILLISECONDS_IN_TIMESTAMP ) );
   if ( settings.has( TIMESTAMP_PRECISION ) )
     pSession->setTimestampPrecision(settings.getInt( TIMESTAMP_PRECISION ) );
   if ( settings.has( PERSIST_MESSAGES ) )
     pSession->setPersistMessages( settings.getBool( PERSIST_MESSAGES ) );
+  if ( settings.has( RESEND_TO_APP ) )
+    pSession->setResendToApp( settings.getBool( RESEND_TO_APP ) );
   if ( settings.has( VALIDATE_LENGTH_AND_CHECKSUM ) )
     pSession->setValidateLengthAndChecksum( settings.getBool( VALIDATE_LENGTH_AND_CHECKSUM ) );
+  if ( settings.has( SEND_QUEUE_HIGH_WATER_BYTES ) )
+    pSession->setSendQueueHighWaterBytes( settings.getInt( SEND_QUEUE_HIGH_WATER_BYTES ) );
+  if ( settings.has( SEND_QUEUE_HIGH_WATER_MESSAGES ) )
+    pSession->setSendQueueHighWaterMessages( settings.getInt( SEND_QUEUE_HIGH_WATER_MESSAGES ) );
+  if ( settings.has( SEND_QUEUE_LOW_WATER_BYTES ) )
+    pSession->setSendQueueLowWaterBytes( settings.getInt( SEND_QUEUE_LOW_WATER_BYTES ) );
+  if ( settings.has( SEND_QUEUE_LOW_WATER_MESSAGES ) )
+    pSession->setSendQueueLowWaterMessages( settings.getInt( SEND_QUEUE_LOW_WATER_MESSAGES ) );
+  if ( settings.has( LATENCY_HISTOGRAMS ) )
+    pSession->getLatency().setEnabled( settings.getBool( LATENCY_HISTOGRAMS ) );
    
   return pSession.release();
 }
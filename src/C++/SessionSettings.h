@@ -68,6 +68,16 @@ const char SOCKET_CONNECT_SOURCE_PORT[] = "SocketConnectSourcePort";
 const char SOCKET_NODELAY[] = "SocketNodelay";
 const char SOCKET_SEND_BUFFER_SIZE[] = "SendBufferSize";
 const char SOCKET_RECEIVE_BUFFER_SIZE[] = "ReceiveBufferSize";
+const char SOCKET_RECEIVE_BUFFER_CAPACITY[] = "SocketReceiveBufferCapacity";
+const char SOCKET_RECEIVE_TIMESTAMPS[] = "SocketReceiveTimestamps";
+const char SEND_QUEUE_HIGH_WATER_BYTES[] = "SendQueueHighWaterBytes";
+const char SEND_QUEUE_HIGH_WATER_MESSAGES[] = "SendQueueHighWaterMessages";
+const char SEND_QUEUE_LOW_WATER_BYTES[] = "SendQueueLowWaterBytes";
+const char SEND_QUEUE_LOW_WATER_MESSAGES[] = "SendQueueLowWaterMessages";
+const char LATENCY_HISTOGRAMS[] = "LatencyHistograms";
+const char SOCKET_BUSY_POLL[] = "SocketBusyPoll";
+const char SOCKET_BUSY_POLL_TIMEOUT[] = "SocketBusyPollTimeout";
+const char THREAD_AFFINITY[] = "ThreadAffinity";
 const char RECONNECT_INTERVAL[] = "ReconnectInterval";
 const char VALIDATE_LENGTH_AND_CHECKSUM[] = "ValidateLengthAndChecksum";
 const char VALIDATE_FIELDS_OUT_OF_ORDER[] = "ValidateFieldsOutOfOrder";
@@ -78,23 +88,53 @@ const char PRESERVE_MESSAGE_FIELDS_ORDER[] = "PreserveMessageFieldsOrder";
 const char LOGON_TIMEOUT[] = "LogonTimeout";
 const char LOGOUT_TIMEOUT[] = "LogoutTimeout";
 const char FILE_STORE_PATH[] = "FileStorePath";
+const char FILE_STORE_SYNC_MODE[] = "FileStoreSyncMode";
+const char FILE_STORE_SYNC_MESSAGES[] = "FileStoreSyncMessages";
+const char FILE_STORE_SYNC_INTERVAL[] = "FileStoreSyncInterval";
+const char MMAP_STORE_PATH[] = "MmapStorePath";
+const char MMAP_STORE_SIZE[] = "MmapStoreSize";
+const char SEGMENTED_FILE_STORE_PATH[] = "SegmentedFileStorePath";
+const char SEGMENTED_FILE_STORE_SEGMENT_SIZE[] = "SegmentedFileStoreSegmentSize";
+const char SEGMENTED_FILE_STORE_RETENTION[] = "SegmentedFileStoreRetention";
+const char SEGMENTED_FILE_STORE_ARCHIVE_PATH[] = "SegmentedFileStoreArchivePath";
+const char JOURNAL_STORE_PATH[] = "JournalStorePath";
+const char JOURNAL_STORE_CHECKPOINT_INTERVAL[] = "JournalStoreCheckpointInterval";
+const char JOURNAL_STORE_SYNC_INTERVAL[] = "JournalStoreSyncInterval";
+const char JOURNAL_STORE_SEGMENT_SIZE[] = "JournalStoreSegmentSize";
 const char MYSQL_STORE_USECONNECTIONPOOL[] = "MySQLStoreUseConnectionPool";
 const char MYSQL_STORE_DATABASE[] = "MySQLStoreDatabase";
 const char MYSQL_STORE_USER[] = "MySQLStoreUser";
 const char MYSQL_STORE_PASSWORD[] = "MySQLStorePassword";
 const char MYSQL_STORE_HOST[] = "MySQLStoreHost";
 const char MYSQL_STORE_PORT[] = "MySQLStorePort";
+const char MYSQL_STORE_BATCH_SIZE[] = "MySQLStoreBatchSize";
+const char MYSQL_STORE_BATCH_INTERVAL[] = "MySQLStoreBatchInterval";
 const char POSTGRESQL_STORE_USECONNECTIONPOOL[] = "PostgreSQLStoreUseConnectionPool";
 const char POSTGRESQL_STORE_DATABASE[] = "PostgreSQLStoreDatabase";
 const char POSTGRESQL_STORE_USER[] = "PostgreSQLStoreUser";
 const char POSTGRESQL_STORE_PASSWORD[] = "PostgreSQLStorePassword";
 const char POSTGRESQL_STORE_HOST[] = "PostgreSQLStoreHost";
 const char POSTGRESQL_STORE_PORT[] = "PostgreSQLStorePort";
+const char POSTGRESQL_STORE_BATCH_SIZE[] = "PostgreSQLStoreBatchSize";
+const char POSTGRESQL_STORE_BATCH_INTERVAL[] = "PostgreSQLStoreBatchInterval";
 const char ODBC_STORE_USER[] = "OdbcStoreUser";
 const char ODBC_STORE_PASSWORD[] = "OdbcStorePassword";
 const char ODBC_STORE_CONNECTION_STRING[] = "OdbcStoreConnectionString";
 const char FILE_LOG_PATH[] = "FileLogPath";
 const char FILE_LOG_BACKUP_PATH[] = "FileLogBackupPath";
+const char FILE_LOG_ASYNC[] = "FileLogAsync";
+const char FILE_LOG_BUFFER_SIZE[] = "FileLogBufferSize";
+const char FILE_LOG_OVERFLOW[] = "FileLogOverflow";
+const char FILE_LOG_ROTATE_SIZE[] = "FileLogRotateSize";
+const char FILE_LOG_ROTATE_INTERVAL[] = "FileLogRotateInterval";
+const char FILE_LOG_ROTATE_COMMAND[] = "FileLogRotateCommand";
+const char BINARY_LOG_PATH[] = "BinaryLogPath";
+const char FILTER_LOG_INCOMING_INCLUDE[] = "FilterLogIncomingInclude";
+const char FILTER_LOG_INCOMING_EXCLUDE[] = "FilterLogIncomingExclude";
+const char FILTER_LOG_INCOMING_SAMPLE[] = "FilterLogIncomingSample";
+const char FILTER_LOG_OUTGOING_INCLUDE[] = "FilterLogOutgoingInclude";
+const char FILTER_LOG_OUTGOING_EXCLUDE[] = "FilterLogOutgoingExclude";
+const char FILTER_LOG_OUTGOING_SAMPLE[] = "FilterLogOutgoingSample";
 const char SCREEN_LOG_SHOW_INCOMING[] = "ScreenLogShowIncoming";
 const char SCREEN_LOG_SHOW_OUTGOING[] = "ScreenLogShowOutgoing";
 const char SCREEN_LOG_SHOW_EVENTS[] = "ScreenLogShowEvents";
@@ -107,6 +147,8 @@ const char MYSQL_LOG_PORT[] = "MySQLLogPort";
 const char MYSQL_LOG_INCOMING_TABLE[] = "MySQLLogIncomingTable";
 const char MYSQL_LOG_OUTGOING_TABLE[] = "MySQLLogOutgoingTable";
 const char MYSQL_LOG_EVENT_TABLE[] = "MySQLLogEventTable";
+const char MYSQL_LOG_BATCH_SIZE[] = "MySQLLogBatchSize";
+const char MYSQL_LOG_BATCH_INTERVAL[] = "MySQLLogBatchInterval";
 const char POSTGRESQL_LOG_USECONNECTIONPOOL[] = "PostgreSQLLogUseConnectionPool";
 const char POSTGRESQL_LOG_DATABASE[] = "PostgreSQLLogDatabase";
 const char POSTGRESQL_LOG_USER[] = "PostgreSQLLogUser";
@@ -116,6 +158,8 @@ const char POSTGRESQL_LOG_PORT[] = "PostgreSQLLogPort";
 const char POSTGRESQL_LOG_INCOMING_TABLE[] = "PostgreSQLLogIncomingTable";
 const char POSTGRESQL_LOG_OUTGOING_TABLE[] = "PostgreSQLLogOutgoingTable";
 const char POSTGRESQL_LOG_EVENT_TABLE[] = "PostgreSQLLogEventTable";
+const char POSTGRESQL_LOG_BATCH_SIZE[] = "PostgreSQLLogBatchSize";
+const char POSTGRESQL_LOG_BATCH_INTERVAL[] = "PostgreSQLLogBatchInterval";
 const char ODBC_LOG_USER[] = "OdbcLogUser";
 const char ODBC_LOG_PASSWORD[] = "OdbcLogPassword";
 const char ODBC_LOG_CONNECTION_STRING[] = "OdbcLogConnectionString";
@@ -126,10 +170,12 @@ const char RESET_ON_LOGON[] = "ResetOnLogon";
 const char RESET_ON_LOGOUT[] = "ResetOnLogout";
 const char RESET_ON_DISCONNECT[] = "ResetOnDisconnect";
 const char REFRESH_ON_LOGON[] = "RefreshOnLogon";
+const char FLUSH_STORE_ON_DISCONNECT[] = "FlushStoreOnDisconnect";
 const char MILLISECONDS_IN_TIMESTAMP[] = "MillisecondsInTimeStamp";
 const char TIMESTAMP_PRECISION[] = "TimestampPrecision";
 const char HTTP_ACCEPT_PORT[] = "HttpAcceptPort";
 const char PERSIST_MESSAGES[] = "PersistMessages";
+const char RESEND_TO_APP[] = "ResendToApp";
 const char SERVER_CERT_FILE[] = "ServerCertificateFile";
 const char SERVER_CERT_KEY_FILE[] = "ServerCertificateKeyFile";
 const char CLIENT_CERT_FILE[] = "ClientCertificateFile";
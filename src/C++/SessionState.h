@@ -30,6 +30,9 @@
 #include "MessageStore.h"
 #include "Log.h"
 #include "Mutex.h"
+#include "SessionStatistics.h"
+#include "Clock.h"
+#include <math.h>
 
 namespace FIX
 {
@@ -45,7 +48,10 @@ public:
   m_sentReset( false ), m_receivedReset( false ),
   m_initiate( false ), m_logonTimeout( 10 ), 
   m_logoutTimeout( 2 ), m_testRequest( 0 ),
-  m_pStore( 0 ), m_pLog( 0 ) {}
+  m_pStore( 0 ), m_pLog( 0 ), m_pClock( &Clock::getSystem() )
+  {
+    m_lastSentMonotonic = m_lastReceivedMonotonic = m_pClock->getMonotonic();
+  }
 
   bool enabled() const { return m_enabled; }
   void enabled( bool value ) { m_enabled = value; }
@@ -87,7 +93,7 @@ public:
   { m_resendRange = std::make_pair( begin, end ); }
 
   MessageStore* store() { return m_pStore; }
-  void store( MessageStore* pValue ) { m_pStore = pValue; }
+  void store( MessageStore* pValue ) { m_pStore = pValue; updateSeqNums(); }
   Log* log() { return m_pLog ? m_pLog : &m_nullLog; }
   void log( Log* pValue ) { m_pLog = pValue; }
 
@@ -98,55 +104,90 @@ public:
   const HeartBtInt& heartBtInt() const
   { return m_heartBtInt; }
 
+  /// Clock of the timers, the last sent and received times restart on it
+  void clock( Clock* pValue )
+  {
+    m_pClock = pValue;
+    m_lastSentMonotonic = m_lastReceivedMonotonic = m_pClock->getMonotonic();
+  }
+  Clock& clock() const { return *m_pClock; }
+
+  /// Monotonic time a message was last sent, see Clock
+  void lastSentMonotonic( int64_t value )
+  { m_lastSentMonotonic = value; }
+  int64_t lastSentMonotonic() const
+  { return m_lastSentMonotonic; }
+
+  /// Monotonic time a message was last received, see Clock
+  void lastReceivedMonotonic( int64_t value )
+  { m_lastReceivedMonotonic = value; }
+  int64_t lastReceivedMonotonic() const
+  { return m_lastReceivedMonotonic; }
+
+  /// @deprecated UTC time derived from lastSentMonotonic
   void lastSentTime( const UtcTimeStamp& value )
-  { m_lastSentTime = value; }
-  UtcTimeStamp& lastSentTime()
-  { return m_lastSentTime; }
-  const UtcTimeStamp& lastSentTime() const
-  { return m_lastSentTime; }
+  { m_lastSentMonotonic = toMonotonic( value ); }
+  UtcTimeStamp lastSentTime() const
+  { return toUtcTime( m_lastSentMonotonic ); }
 
+  /// @deprecated UTC time derived from lastReceivedMonotonic
   void lastReceivedTime( const UtcTimeStamp& value )
-  { m_lastReceivedTime = value; }
-  UtcTimeStamp& lastReceivedTime()
-  { return m_lastReceivedTime; }
-  const UtcTimeStamp& lastReceivedTime() const
-  { return m_lastReceivedTime; }
+  { m_lastReceivedMonotonic = toMonotonic( value ); }
+  UtcTimeStamp lastReceivedTime() const
+  { return toUtcTime( m_lastReceivedMonotonic ); }
 
   bool shouldSendLogon() const { return initiate() && !sentLogon(); }
   bool alreadySentLogon() const { return initiate() && sentLogon(); }
   bool logonTimedOut() const
   {
-    UtcTimeStamp now;
-    return now - lastReceivedTime() >= logonTimeout();
+    return sinceReceived() >= logonTimeout();
   }
   bool logoutTimedOut() const
   {
-    UtcTimeStamp now;
-    return sentLogout() && ( ( now - lastSentTime() ) >= logoutTimeout() );
+    return sentLogout() && ( sinceSent() >= logoutTimeout() );
   }
   bool withinHeartBeat() const
   {
-    UtcTimeStamp now;
-    return ( ( now - lastSentTime() ) < heartBtInt() ) &&
-           ( ( now - lastReceivedTime() ) < heartBtInt() );
+    return ( sinceSent() < heartBtInt() ) &&
+           ( sinceReceived() < heartBtInt() );
   }
   bool timedOut() const
   {
-    UtcTimeStamp now;
-    return ( now - lastReceivedTime() ) >= ( 2.4 * ( double ) heartBtInt() );
+    return sinceReceived() >= ( 2.4 * ( double ) heartBtInt() );
   }
   bool needHeartbeat() const
   {
-    UtcTimeStamp now;
-    return ( ( now - lastSentTime() ) >= heartBtInt() ) && !testRequest();
+    return ( sinceSent() >= heartBtInt() ) && !testRequest();
   }
   bool needTestRequest() const
   {
-    UtcTimeStamp now;
-    return ( now - lastReceivedTime() ) >=
+    return sinceReceived() >=
            ( ( 1.2 * ( ( double ) testRequest() + 1 ) ) * ( double ) heartBtInt() );
   }
 
+  /// Earliest monotonic time one of the checks above changes, at most limit
+  int64_t nextTimeout( int64_t limit ) const
+  {
+    int64_t result = limit;
+    if ( !receivedLogon() )
+    {
+      if ( alreadySentLogon() )
+        result = earliest( result, m_lastReceivedMonotonic, logonTimeout() );
+      return result;
+    }
+
+    double heartBeat = heartBtInt();
+    if ( heartBeat == 0 ) return result;
+
+    if ( sentLogout() )
+      result = earliest( result, m_lastSentMonotonic, logoutTimeout() );
+    if ( !testRequest() )
+      result = earliest( result, m_lastSentMonotonic, heartBeat );
+    result = earliest( result, m_lastReceivedMonotonic,
+                       1.2 * ( ( double ) testRequest() + 1 ) * heartBeat );
+    return earliest( result, m_lastReceivedMonotonic, 2.4 * heartBeat );
+  }
+
   std::string logoutReason() const 
   { Locker l( m_mutex ); return m_logoutReason; }
   void logoutReason( const std::string& value ) 
@@ -174,24 +215,29 @@ public:
   void get( int b, int e, std::vector < std::string > &m ) const
   throw ( IOException )
   { Locker l( m_mutex ); m_pStore->get( b, e, m ); }
+  void getRange( int b, int e, MessageStoreVisitor& v ) const
+  throw ( IOException )
+  { Locker l( m_mutex ); m_pStore->getRange( b, e, v ); }
   int getNextSenderMsgSeqNum() const throw ( IOException )
   { Locker l( m_mutex ); return m_pStore->getNextSenderMsgSeqNum(); }
   int getNextTargetMsgSeqNum() const throw ( IOException )
   { Locker l( m_mutex ); return m_pStore->getNextTargetMsgSeqNum(); }
   void setNextSenderMsgSeqNum( int n ) throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->setNextSenderMsgSeqNum( n ); }
+  { Locker l( m_mutex ); m_pStore->setNextSenderMsgSeqNum( n ); updateSeqNums(); }
   void setNextTargetMsgSeqNum( int n ) throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->setNextTargetMsgSeqNum( n ); }
+  { Locker l( m_mutex ); m_pStore->setNextTargetMsgSeqNum( n ); updateSeqNums(); }
   void incrNextSenderMsgSeqNum() throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->incrNextSenderMsgSeqNum(); }
+  { Locker l( m_mutex ); m_pStore->incrNextSenderMsgSeqNum(); updateSeqNums(); }
   void incrNextTargetMsgSeqNum() throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->incrNextTargetMsgSeqNum(); }
+  { Locker l( m_mutex ); m_pStore->incrNextTargetMsgSeqNum(); updateSeqNums(); }
   UtcTimeStamp getCreationTime() const throw ( IOException )
   { Locker l( m_mutex ); return m_pStore->getCreationTime(); }
   void reset() throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->reset(); }
+  { Locker l( m_mutex ); m_pStore->reset(); updateSeqNums(); }
   void refresh() throw ( IOException )
-  { Locker l( m_mutex ); m_pStore->refresh(); }
+  { Locker l( m_mutex ); m_pStore->refresh(); updateSeqNums(); }
+  void flush() throw ( IOException )
+  { Locker l( m_mutex ); m_pStore->flush(); }
 
   void clear()
   { if ( !m_pLog ) return ; Locker l( m_mutex ); m_pLog->clear(); }
@@ -204,7 +250,77 @@ public:
   void onEvent( const std::string& string )
   { if ( !m_pLog ) return ; Locker l( m_mutex ); m_pLog->onEvent( string ); }
 
+  SessionStatistics& statistics() { return m_statistics; }
+
 private:
+  /// Seconds since a message was last sent
+  double sinceSent() const
+  {
+    return (double)( m_pClock->getMonotonic() - m_lastSentMonotonic )
+           / DateTime::NANOS_PER_SEC;
+  }
+  /// Seconds since a message was last received
+  double sinceReceived() const
+  {
+    return (double)( m_pClock->getMonotonic() - m_lastReceivedMonotonic )
+           / DateTime::NANOS_PER_SEC;
+  }
+
+  static int64_t nanosOfDay( const DateTime& value )
+  {
+    return value.getHour() * DateTime::NANOS_PER_HOUR
+           + value.getMinute() * DateTime::NANOS_PER_MIN
+           + value.getSecond() * DateTime::NANOS_PER_SEC
+           + value.getNanosecond();
+  }
+
+  /// UTC time of a monotonic time, by its distance to the current time
+  UtcTimeStamp toUtcTime( int64_t monotonic ) const
+  {
+    int64_t elapsed = m_pClock->getMonotonic() - monotonic;
+    UtcTimeStamp result = m_pClock->getUtcTime();
+    int date = result.getJulianDate() - (int)( elapsed / DateTime::NANOS_PER_DAY );
+    int64_t time = nanosOfDay( result ) - elapsed % DateTime::NANOS_PER_DAY;
+    if( time < 0 )
+    {
+      time += DateTime::NANOS_PER_DAY;
+      --date;
+    }
+    else if( time >= DateTime::NANOS_PER_DAY )
+    {
+      time -= DateTime::NANOS_PER_DAY;
+      ++date;
+    }
+    result.set( date, time );
+    return result;
+  }
+
+  /// Monotonic time of a UTC time, by its distance to the current time
+  int64_t toMonotonic( const UtcTimeStamp& value ) const
+  {
+    UtcTimeStamp now = m_pClock->getUtcTime();
+    int64_t elapsed =
+      (int64_t)( now.getJulianDate() - value.getJulianDate() ) * DateTime::NANOS_PER_DAY
+      + nanosOfDay( now ) - nanosOfDay( value );
+    return m_pClock->getMonotonic() - elapsed;
+  }
+
+  static int64_t earliest( int64_t result, int64_t time, double seconds )
+  {
+    int64_t deadline = time + ( int64_t ) ceil( seconds * DateTime::NANOS_PER_SEC );
+    return deadline < result ? deadline : result;
+  }
+
+  /// Mirrors the sequence numbers of the store for readers without the lock
+  void updateSeqNums()
+  {
+    if ( !m_pStore ) return ;
+    m_statistics.set( SessionStatistics::NEXT_SENDER_MSG_SEQ_NUM,
+                      m_pStore->getNextSenderMsgSeqNum() );
+    m_statistics.set( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM,
+                      m_pStore->getNextTargetMsgSeqNum() );
+  }
+
   bool m_enabled;
   bool m_receivedLogon;
   bool m_sentLogout;
@@ -217,13 +333,15 @@ private:
   int m_testRequest;
   ResendRange m_resendRange;
   HeartBtInt m_heartBtInt;
-  UtcTimeStamp m_lastSentTime;
-  UtcTimeStamp m_lastReceivedTime;
+  int64_t m_lastSentMonotonic;
+  int64_t m_lastReceivedMonotonic;
   std::string m_logoutReason;
   Messages m_queue;
   MessageStore* m_pStore;
   Log* m_pLog;
   NullLog m_nullLog;
+  SessionStatistics m_statistics;
+  Clock* m_pClock;
   mutable Mutex m_mutex;
 };
 }
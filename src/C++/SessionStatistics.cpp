@@ -0,0 +1,63 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "SessionStatistics.h"
+
+namespace FIX
+{
+void SessionStatistics::reset()
+{
+  for( int i = 0; i < STATISTICS; ++i )
+  {
+    if( isCounter( (Statistic)i ) )
+      m_values[ i ].set( 0 );
+  }
+}
+
+const char* SessionStatistics::getName( Statistic statistic )
+{
+  switch( statistic )
+  {
+  case MESSAGES_RECEIVED: return "messages_received";
+  case MESSAGES_SENT: return "messages_sent";
+  case BYTES_RECEIVED: return "bytes_received";
+  case BYTES_SENT: return "bytes_sent";
+  case REJECTS_RECEIVED: return "rejects_received";
+  case REJECTS_SENT: return "rejects_sent";
+  case RESEND_REQUESTS_SERVED: return "resend_requests_served";
+  case GAP_FILLS_SENT: return "gap_fills_sent";
+  case NEXT_SENDER_MSG_SEQ_NUM: return "next_sender_msg_seq_num";
+  case NEXT_TARGET_MSG_SEQ_NUM: return "next_target_msg_seq_num";
+  case SEND_QUEUE_MESSAGES: return "send_queue_messages";
+  case SEND_QUEUE_BYTES: return "send_queue_bytes";
+  default: return "unknown";
+  }
+}
+
+bool SessionStatistics::isCounter( Statistic statistic )
+{
+  return statistic < NEXT_SENDER_MSG_SEQ_NUM;
+}
+}
@@ -0,0 +1,123 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_SESSIONSTATISTICS_H
+#define FIX_SESSIONSTATISTICS_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Utility.h"
+
+#if !defined(_MSC_VER) && !defined(__GNUC__)
+#include "Mutex.h"
+#endif
+
+namespace FIX
+{
+/**
+ * 64 bit value updated and read with relaxed atomics.
+ *
+ * Readers see every update eventually but no ordering with respect to other
+ * memory, which is all a statistic needs.  There is no compare and swap, a
+ * single value can be kept this way but structures where several words must
+ * change together, such as the queues of AsyncStore and the asynchronous
+ * FileLog, stay behind a mutex.
+ */
+class StatisticValue
+{
+public:
+  StatisticValue() : m_value( 0 ) {}
+
+#ifdef _MSC_VER
+  void add( int64_t value )
+  { ::InterlockedExchangeAdd64( &m_value, value ); }
+  void set( int64_t value )
+  { ::InterlockedExchange64( &m_value, value ); }
+  int64_t get() const
+  { return ::InterlockedCompareExchange64( const_cast<LONGLONG volatile*>( &m_value ), 0, 0 ); }
+#elif defined(__GNUC__)
+  void add( int64_t value )
+  { __atomic_fetch_add( &m_value, value, __ATOMIC_RELAXED ); }
+  void set( int64_t value )
+  { __atomic_store_n( &m_value, value, __ATOMIC_RELAXED ); }
+  int64_t get() const
+  { return __atomic_load_n( &m_value, __ATOMIC_RELAXED ); }
+#else
+  void add( int64_t value )
+  { Locker l( m_mutex ); m_value += value; }
+  void set( int64_t value )
+  { Locker l( m_mutex ); m_value = value; }
+  int64_t get() const
+  { Locker l( m_mutex ); return m_value; }
+#endif
+
+private:
+  StatisticValue( const StatisticValue& );
+  StatisticValue& operator=( const StatisticValue& );
+
+#ifdef _MSC_VER
+  LONGLONG volatile m_value;
+#elif defined(__GNUC__)
+  int64_t m_value;
+#else
+  mutable Mutex m_mutex;
+  int64_t m_value;
+#endif
+};
+
+/**
+ * Counters and gauges of a session.
+ *
+ * The session and its connection update them as they go, readers such as
+ * the HttpServer never take the session mutex to look at them.
+ */
+class SessionStatistics
+{
+public:
+  enum Statistic
+  {
+    MESSAGES_RECEIVED, MESSAGES_SENT, BYTES_RECEIVED, BYTES_SENT,
+    REJECTS_RECEIVED, REJECTS_SENT, RESEND_REQUESTS_SERVED, GAP_FILLS_SENT,
+    NEXT_SENDER_MSG_SEQ_NUM, NEXT_TARGET_MSG_SEQ_NUM,
+    SEND_QUEUE_MESSAGES, SEND_QUEUE_BYTES, STATISTICS
+  };
+
+  void add( Statistic statistic, int64_t value = 1 )
+  { m_values[ statistic ].add( value ); }
+  void set( Statistic statistic, int64_t value )
+  { m_values[ statistic ].set( value ); }
+  int64_t get( Statistic statistic ) const
+  { return m_values[ statistic ].get(); }
+  /// Clears the counters, gauges keep their value
+  void reset();
+
+  static const char* getName( Statistic statistic );
+  /// Counters only ever grow, gauges go up and down
+  static bool isCounter( Statistic statistic );
+
+private:
+  StatisticValue m_values[ STATISTICS ];
+};
+}
+
+#endif //FIX_SESSIONSTATISTICS_H
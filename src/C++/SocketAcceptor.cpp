@@ -27,6 +27,7 @@
 #include "Session.h"
 #include "Settings.h"
 #include "Utility.h"
+#include "Clock.h"
 #include "Exceptions.h"
 
 namespace FIX
@@ -48,6 +49,9 @@ SocketAcceptor::SocketAcceptor( Application& application,
 
 SocketAcceptor::~SocketAcceptor()
 {
+  // the sessions outlive the queue, they are destroyed by Acceptor
+  setTimerQueue( 0 );
+
   SocketConnections::iterator iter;
   for ( iter = m_connections.begin(); iter != m_connections.end(); ++iter )
     delete iter->second;
@@ -66,6 +70,12 @@ throw ( ConfigError )
       settings.getBool( SOCKET_REUSE_ADDRESS );
     if( settings.has(SOCKET_NODELAY) )
       settings.getBool( SOCKET_NODELAY );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY)
+        && settings.getInt( SOCKET_RECEIVE_BUFFER_CAPACITY ) <= 0 )
+      throw ConfigError( std::string(SOCKET_RECEIVE_BUFFER_CAPACITY)
+                         + " must be greater than zero" );
+    if( settings.has(SOCKET_RECEIVE_TIMESTAMPS) )
+      settings.getBool( SOCKET_RECEIVE_TIMESTAMPS );
   }
 }
 
@@ -73,6 +83,7 @@ void SocketAcceptor::onInitialize( const SessionSettings& s )
 throw ( RuntimeError )
 {
   short port = 0;
+  setTimerQueue( &m_timers );
 
   try
   {
@@ -110,7 +121,7 @@ throw ( RuntimeError )
 
 void SocketAcceptor::onStart()
 {
-  while ( !isStopped() && m_pServer && m_pServer->block( *this ) ) {}
+  while ( !isStopped() && m_pServer && m_pServer->block( *this, false, getTimeout() ) ) {}
 
   if( !m_pServer )
     return;
@@ -121,7 +132,7 @@ void SocketAcceptor::onStart()
   ::time( &start );
   while ( isLoggedOn() )
   {
-    m_pServer->block( *this );
+    m_pServer->block( *this, false, getTimeout() );
     if( ::time(&now) -5 >= start )
       break;
   }
@@ -170,7 +181,15 @@ void SocketAcceptor::onConnect( SocketServer& server, int a, int s )
   if ( i != m_connections.end() ) return;
   int port = server.socketToPort( a );
   Sessions sessions = m_portToSessions[port];
-  m_connections[ s ] = new SocketConnection( s, sessions, &server.getMonitor() );
+  SocketConnection* pConnection = new SocketConnection( s, sessions, &server.getMonitor() );
+  m_connections[ s ] = pConnection;
+
+  // the session is unknown until logon, use the first one on the port
+  const Dictionary& settings = m_settings.get( *sessions.begin() );
+  if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY) )
+    pConnection->setReceiveBufferCapacity( settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) );
+  if( settings.has(SOCKET_RECEIVE_TIMESTAMPS) )
+    pConnection->setReceiveTimestamps( settings.getBool(SOCKET_RECEIVE_TIMESTAMPS) );
 
   std::stringstream stream;
   stream << "Accepted connection from " << socket_peername( s ) << " on port " << port;
@@ -215,8 +234,18 @@ void SocketAcceptor::onError( SocketServer& )
 
 void SocketAcceptor::onTimeout( SocketServer& )
 {
-  SocketConnections::iterator i;
-  for ( i = m_connections.begin(); i != m_connections.end(); ++i )
-    i->second->onTimeout();
+  m_timers.process( Clock::getSystem().getMonotonic() );
+}
+
+void SocketAcceptor::setTimerQueue( TimerQueue* pTimerQueue )
+{
+  std::set<SessionID>::const_iterator i;
+  for ( i = getSessions().begin(); i != getSessions().end(); ++i )
+    getSession( *i )->setTimerQueue( pTimerQueue );
+}
+
+double SocketAcceptor::getTimeout()
+{
+  return m_timers.getTimeout( Clock::getSystem().getMonotonic() );
 }
 }
@@ -29,6 +29,7 @@
 #include "Acceptor.h"
 #include "SocketServer.h"
 #include "SocketConnection.h"
+#include "TimerQueue.h"
 
 namespace FIX
 {
@@ -65,9 +66,13 @@ private:
   void onError( SocketServer& );
   void onTimeout( SocketServer& );
 
+  void setTimerQueue( TimerQueue* );
+  double getTimeout();
+
   SocketServer* m_pServer;
   PortToSessions m_portToSessions;
   SocketConnections m_connections;
+  TimerQueue m_timers;
 };
 /*! @} */
 }
@@ -34,7 +34,8 @@ namespace FIX
 {
 SocketConnection::SocketConnection( int s, Sessions sessions,
                                     SocketMonitor* pMonitor )
-: m_socket( s ), m_sendLength( 0 ),
+: m_socket( s ), m_receiveTimestamps( false ),
+  m_sendOffset( 0 ), m_sendLength( 0 ),
   m_sessions(sessions), m_pSession( 0 ), m_pMonitor( pMonitor )
 {
   FD_ZERO( &m_fds );
@@ -44,7 +45,8 @@ SocketConnection::SocketConnection( int s, Sessions sessions,
 SocketConnection::SocketConnection( SocketInitiator& i,
                                     const SessionID& sessionID, int s,
                                     SocketMonitor* pMonitor )
-: m_socket( s ), m_sendLength( 0 ),
+: m_socket( s ), m_receiveTimestamps( false ),
+  m_sendOffset( 0 ), m_sendLength( 0 ),
   m_pSession( i.getSession( sessionID, *this ) ),
   m_pMonitor( pMonitor ) 
 {
@@ -56,47 +58,103 @@ SocketConnection::SocketConnection( SocketInitiator& i,
 SocketConnection::~SocketConnection()
 {
   if ( m_pSession )
+  {
+    m_pSession->getStatistics().set( SessionStatistics::SEND_QUEUE_MESSAGES, 0 );
+    m_pSession->getStatistics().set( SessionStatistics::SEND_QUEUE_BYTES, 0 );
     Session::unregisterSession( m_pSession->getSessionID() );
+  }
+}
+
+void SocketConnection::setReceiveTimestamps( bool value )
+{
+  m_receiveTimestamps = value && socket_settimestamping( m_socket );
 }
 
 bool SocketConnection::send( const std::string& msg )
 {
   Locker l( m_mutex );
 
-  m_sendQueue.push_back( msg );
-  processQueue();
+  // queued messages share one buffer, the queue only keeps their lengths
+  m_sendBuffer.append( msg );
+  m_sendQueue.push_back( msg.length() );
+  writeQueue();
+  updateStatistics();
   signal();
   return true;
 }
 
 bool SocketConnection::processQueue()
 {
-  Locker l( m_mutex );
+  bool empty = false;
+  {
+    Locker l( m_mutex );
+    empty = writeQueue();
+    updateStatistics();
+  }
 
+  if( m_pSession )
+    m_pSession->checkSendQueue();
+  return empty;
+}
+
+bool SocketConnection::writeQueue()
+{
   if( !m_sendQueue.size() ) return true;
 
   struct timeval timeout = { 0, 0 };
   fd_set writeset = m_fds;
   if( select( 1 + m_socket, 0, &writeset, 0, &timeout ) <= 0 )
     return false;
-    
-  const std::string& msg = m_sendQueue.front();
 
   ssize_t result = socket_send
-    ( m_socket, msg.c_str() + m_sendLength, msg.length() - m_sendLength );
+    ( m_socket, m_sendBuffer.data() + m_sendOffset,
+      m_sendBuffer.size() - m_sendOffset );
 
   if( result > 0 )
+  {
+    m_sendOffset += result;
     m_sendLength += result;
+    while( m_sendQueue.size() && m_sendLength >= m_sendQueue.front() )
+    {
+      m_sendLength -= m_sendQueue.front();
+      m_sendQueue.pop_front();
+    }
 
-  if( m_sendLength == msg.length() )
-  {
-    m_sendLength = 0;
-    m_sendQueue.pop_front();
+    if( !m_sendQueue.size() )
+    {
+      m_sendBuffer.clear();
+      m_sendOffset = 0;
+    }
+    else if( m_sendOffset > m_sendBuffer.size() / 2 )
+    {
+      m_sendBuffer.erase( 0, m_sendOffset );
+      m_sendOffset = 0;
+    }
   }
 
   return !m_sendQueue.size();
 }
 
+void SocketConnection::updateStatistics()
+{
+  if( !m_pSession ) return;
+  SessionStatistics& statistics = m_pSession->getStatistics();
+  statistics.set( SessionStatistics::SEND_QUEUE_MESSAGES, m_sendQueue.size() );
+  statistics.set( SessionStatistics::SEND_QUEUE_BYTES, m_sendBuffer.size() - m_sendOffset );
+}
+
+size_t SocketConnection::getSendQueueBytes()
+{
+  Locker l( m_mutex );
+  return m_sendBuffer.size() - m_sendOffset;
+}
+
+size_t SocketConnection::getSendQueueMessages()
+{
+  Locker l( m_mutex );
+  return m_sendQueue.size();
+}
+
 void SocketConnection::disconnect()
 {
   if ( m_pMonitor )
@@ -154,7 +212,7 @@ bool SocketConnection::read( SocketAcceptor& a, SocketServer& s )
       if( m_pSession )
         m_pSession = a.getSession( msg, *this );
       if( m_pSession )
-        m_pSession->next( msg, UtcTimeStamp() );
+        m_pSession->next( msg, m_receiveTimestamps ? m_receiveTime : UtcTimeStamp() );
       if( !m_pSession )
       {
         s.getMonitor().drop( m_socket );
@@ -162,6 +220,8 @@ bool SocketConnection::read( SocketAcceptor& a, SocketServer& s )
       }
 
       Session::registerSession( m_pSession->getSessionID() );
+      // the logon may have arrived together with more messages
+      readMessages( s.getMonitor() );
       return true;
     }
     else
@@ -197,16 +257,33 @@ bool SocketConnection::isValidSession()
 void SocketConnection::readFromSocket()
 throw( SocketRecvFailed )
 {
-  ssize_t size = socket_recv( m_socket, m_buffer, sizeof(m_buffer) );
+  size_t length = 0;
+  char* buffer = m_parser.getWriteBuffer( length );
+  ssize_t size = 0;
+  if( m_receiveTimestamps )
+  {
+    int64_t timestamp = 0;
+    size = socket_recv( m_socket, buffer, length, timestamp );
+    if( size > 0 && timestamp )
+      m_receiveTime = UtcTimeStamp( (time_t)(timestamp / 1000000000), (int)(timestamp % 1000000000), 9 );
+    else if( size > 0 )
+      m_receiveTime.setCurrent();
+  }
+  else
+    size = socket_recv( m_socket, buffer, length );
   if( size <= 0 ) throw SocketRecvFailed( size );
-  m_parser.addToStream( m_buffer, size );
+  m_parser.commitWrite( size );
 }
 
 bool SocketConnection::readMessage( std::string& msg )
 {
   try
   {
-    return m_parser.readFixMessage( msg );
+    if( !m_pSession ) return m_parser.readFixMessage( msg );
+    LatencyTimer timer( m_pSession->getLatency() );
+    if( !m_parser.readFixMessage( msg ) ) return false;
+    timer.stop( SessionLatency::PARSE );
+    return true;
   }
   catch ( MessageParseError& ) {}
   return true;
@@ -221,7 +298,7 @@ void SocketConnection::readMessages( SocketMonitor& s )
   {
     try
     {
-      m_pSession->next( msg, UtcTimeStamp() );
+      m_pSession->next( msg, m_receiveTimestamps ? m_receiveTime : UtcTimeStamp() );
     }
     catch ( InvalidMessage& )
     {
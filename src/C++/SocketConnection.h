@@ -32,6 +32,7 @@
 #include "SocketMonitor.h"
 #include "Utility.h"
 #include "Mutex.h"
+#include "FieldTypes.h"
 #include <set>
 
 namespace FIX
@@ -75,8 +76,17 @@ public:
 
   void onTimeout();
 
+  size_t getSendQueueBytes();
+  size_t getSendQueueMessages();
+
+  /// Minimum number of bytes handed to each receive
+  void setReceiveBufferCapacity( size_t capacity )
+  { m_parser.setCapacity( capacity ); }
+  /// Stamp incoming messages with the kernel receive time
+  void setReceiveTimestamps( bool value );
+
 private:
-  typedef std::deque<std::string, ALLOCATOR<std::string> >
+  typedef std::deque<size_t, ALLOCATOR<size_t> >
     Queue;
 
   bool isValidSession();
@@ -84,14 +94,20 @@ private:
   bool readMessage( std::string& msg );
   void readMessages( SocketMonitor& s );
   bool send( const std::string& );
+  bool writeQueue();
+  /// Publishes the send queue depth, called with the mutex held
+  void updateStatistics();
   void disconnect();
 
   int m_socket;
-  char m_buffer[BUFSIZ];
 
   Parser m_parser;
+  bool m_receiveTimestamps;
+  UtcTimeStamp m_receiveTime;
+  std::string m_sendBuffer;
+  size_t m_sendOffset;
   Queue m_sendQueue;
-  unsigned m_sendLength;
+  size_t m_sendLength;
   Sessions m_sessions;
   Session* m_pSession;
   SocketMonitor* m_pMonitor;
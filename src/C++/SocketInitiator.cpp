@@ -26,6 +26,7 @@
 #include "SocketInitiator.h"
 #include "Session.h"
 #include "Settings.h"
+#include "Clock.h"
 
 namespace FIX
 {
@@ -54,6 +55,9 @@ throw( ConfigError )
 
 SocketInitiator::~SocketInitiator()
 {
+  // the sessions outlive the queue, they are destroyed by Initiator
+  setTimerQueue( 0 );
+
   SocketConnections::iterator i;
   for (i = m_connections.begin();
        i != m_connections.end(); ++i)
@@ -77,6 +81,19 @@ throw ( ConfigError )
     m_sendBufSize = dict.getInt( SOCKET_SEND_BUFFER_SIZE );
   if( dict.has( SOCKET_RECEIVE_BUFFER_SIZE ) )
     m_rcvBufSize = dict.getInt( SOCKET_RECEIVE_BUFFER_SIZE );
+
+  std::set<SessionID> sessions = s.getSessions();
+  std::set<SessionID>::iterator i;
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    const Dictionary& settings = s.get( *i );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY)
+        && settings.getInt( SOCKET_RECEIVE_BUFFER_CAPACITY ) <= 0 )
+      throw ConfigError( std::string(SOCKET_RECEIVE_BUFFER_CAPACITY)
+                         + " must be greater than zero" );
+    if( settings.has(SOCKET_RECEIVE_TIMESTAMPS) )
+      settings.getBool( SOCKET_RECEIVE_TIMESTAMPS );
+  }
 }
 
 void SocketInitiator::onInitialize( const SessionSettings& s )
@@ -89,7 +106,7 @@ void SocketInitiator::onStart()
   connect();
 
   while ( !isStopped() ) {
-    m_connector.block( *this, false, 1.0 );
+    m_connector.block( *this, false, getTimeout() );
     onTimeout( m_connector );
   }
 
@@ -99,7 +116,7 @@ void SocketInitiator::onStart()
   ::time( &start );
   while ( isLoggedOn() )
   {
-    m_connector.block( *this );
+    m_connector.block( *this, false, getTimeout() );
     if( ::time(&now) -5 >= start )
       break;
   }
@@ -148,8 +165,13 @@ void SocketInitiator::doConnect( const SessionID& s, const Dictionary& d )
     int result = m_connector.connect( address, port, m_noDelay, m_sendBufSize, m_rcvBufSize, sourceAddress, sourcePort );
     setPending( s );
 
-    m_pendingConnections[ result ] 
+    SocketConnection* pConnection
       = new SocketConnection( *this, s, result, &m_connector.getMonitor() );
+    if( d.has(SOCKET_RECEIVE_BUFFER_CAPACITY) )
+      pConnection->setReceiveBufferCapacity( d.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) );
+    if( d.has(SOCKET_RECEIVE_TIMESTAMPS) )
+      pConnection->setReceiveTimestamps( d.getBool(SOCKET_RECEIVE_TIMESTAMPS) );
+    m_pendingConnections[ result ] = pConnection;
   }
   catch ( std::exception& ) {}
 }
@@ -163,6 +185,8 @@ void SocketInitiator::onConnect( SocketConnector&, int s )
   m_connections[s] = pSocketConnection;
   m_pendingConnections.erase( i );
   setConnected( pSocketConnection->getSession()->getSessionID() );
+  // pending sessions have a responder but no timers until they connect
+  pSocketConnection->getSession()->setTimerQueue( &m_timers );
   pSocketConnection->onTimeout();
 }
 
@@ -202,6 +226,7 @@ void SocketInitiator::onDisconnect( SocketConnector&, int s )
   if ( pSession )
   {
     pSession->disconnect();
+    pSession->setTimerQueue( 0 );
     setDisconnected( pSession->getSessionID() );
   }
 
@@ -226,9 +251,19 @@ void SocketInitiator::onTimeout( SocketConnector& )
     m_lastConnect = now;
   }
 
-  SocketConnections::iterator i;
-  for ( i = m_connections.begin(); i != m_connections.end(); ++i )
-    i->second->onTimeout();
+  m_timers.process( Clock::getSystem().getMonotonic() );
+}
+
+void SocketInitiator::setTimerQueue( TimerQueue* pTimerQueue )
+{
+  std::set<SessionID>::const_iterator i;
+  for ( i = getSessions().begin(); i != getSessions().end(); ++i )
+    getSession( *i )->setTimerQueue( pTimerQueue );
+}
+
+double SocketInitiator::getTimeout()
+{
+  return m_timers.getTimeout( Clock::getSystem().getMonotonic() );
 }
 
 void SocketInitiator::getHost( const SessionID& s, const Dictionary& d,
@@ -29,6 +29,7 @@
 #include "Initiator.h"
 #include "SocketConnector.h"
 #include "SocketConnection.h"
+#include "TimerQueue.h"
 
 namespace FIX
 {
@@ -62,6 +63,9 @@ private:
   void onError( SocketConnector& );
   void onTimeout( SocketConnector& );
 
+  void setTimerQueue( TimerQueue* );
+  double getTimeout();
+
   void getHost( const SessionID&, const Dictionary&, std::string&, short&, std::string&, short& );
 
   SessionSettings m_settings;
@@ -69,6 +73,7 @@ private:
   SocketConnector m_connector;
   SocketConnections m_pendingConnections;
   SocketConnections m_connections;
+  TimerQueue m_timers;
   time_t m_lastConnect;
   int m_reconnectInterval;
   bool m_noDelay;
@@ -24,6 +24,7 @@
 #endif
 
 #include "SocketMonitor.h"
+#include "Clock.h"
 #include "Utility.h"
 #include <exception>
 #include <set>
@@ -47,7 +48,7 @@ SocketMonitor::SocketMonitor( int timeout )
   m_timeval.tv_sec = 0;
   m_timeval.tv_usec = 0;
 #ifndef SELECT_DECREMENTS_TIME
-  m_ticks = clock();
+  m_ticks = Clock::getSystem().getMonotonic();
 #endif
 }
 
@@ -124,29 +125,37 @@ inline timeval* SocketMonitor::getTimeval( bool poll, double timeout )
     return &m_timeval;
   }
 
-  timeout = m_timeout;
-
-  if ( !timeout )
+  if ( !m_timeout )
     return 0;
+
+  // an earlier deadline of the caller shortens the wait, see TimerQueue
+  int64_t limit = (int64_t)( m_timeout * DateTime::NANOS_PER_SEC );
+  if ( timeout > 0 && timeout < m_timeout )
+    limit = (int64_t)( timeout * DateTime::NANOS_PER_SEC );
 #ifdef SELECT_MODIFIES_TIMEVAL
-  if ( !m_timeval.tv_sec && !m_timeval.tv_usec && timeout )
-    m_timeval.tv_sec = timeout;
-  return &m_timeval;
+  if ( !m_timeval.tv_sec && !m_timeval.tv_usec )
+    m_timeval.tv_sec = m_timeout;
+  int64_t remaining = (int64_t)m_timeval.tv_sec * DateTime::NANOS_PER_SEC
+                      + (int64_t)m_timeval.tv_usec * 1000;
+  if ( remaining > limit )
+    remaining = limit;
 #else
-  double elapsed = ( double ) ( clock() - m_ticks ) / ( double ) CLOCKS_PER_SEC;
-  if ( elapsed >= timeout || elapsed == 0.0 )
-  {
-    m_ticks = clock();
-    m_timeval.tv_sec = 0;
-    m_timeval.tv_usec = (long)(timeout * 1000000);
-  }
+  // measure on the monotonic clock, clock() only counts the cpu time
+  // of the process and hardly moves while it waits in select
+  int64_t now = Clock::getSystem().getMonotonic();
+  int64_t elapsed = now - m_ticks;
+  int64_t remaining = (int64_t)m_timeout * DateTime::NANOS_PER_SEC;
+  if ( elapsed >= remaining || elapsed == 0 )
+    m_ticks = now;
   else
-  {
-    m_timeval.tv_sec = 0;
-    m_timeval.tv_usec = (long)( ( timeout - elapsed ) * 1000000 );
-  }
-  return &m_timeval;
+    remaining -= elapsed;
+  if ( remaining > limit )
+    remaining = limit;
 #endif
+
+  m_timeval.tv_sec = (long)( remaining / DateTime::NANOS_PER_SEC );
+  m_timeval.tv_usec = (long)( ( remaining % DateTime::NANOS_PER_SEC ) / 1000 );
+  return &m_timeval;
 }
 
 bool SocketMonitor::sleepIfEmpty( bool poll )
@@ -37,6 +37,7 @@ typedef int socklen_t;
 #include <arpa/inet.h>
 #endif
 
+#include "Utility.h"
 #include <set>
 #include <queue>
 #include <time.h>
@@ -81,7 +82,7 @@ private:
   int m_timeout;
   timeval m_timeval;
 #ifndef SELECT_DECREMENTS_TIME
-  clock_t m_ticks;
+  int64_t m_ticks;
 #endif
 
   int m_signal;
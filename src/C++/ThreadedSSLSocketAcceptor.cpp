@@ -179,6 +179,22 @@ void ThreadedSSLSocketAcceptor::onConfigure(const SessionSettings &s) throw(
       settings.getBool(SOCKET_REUSE_ADDRESS);
     if (settings.has(SOCKET_NODELAY))
       settings.getBool(SOCKET_NODELAY);
+    if (settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY) &&
+        settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) <= 0)
+      throw ConfigError(std::string(SOCKET_RECEIVE_BUFFER_CAPACITY) +
+                        " must be greater than zero");
+    if (settings.has(SOCKET_BUSY_POLL))
+      settings.getBool(SOCKET_BUSY_POLL);
+    if (settings.has(SOCKET_BUSY_POLL_TIMEOUT))
+      settings.getInt(SOCKET_BUSY_POLL_TIMEOUT);
+    if (settings.has(THREAD_AFFINITY))
+      settings.getInt(THREAD_AFFINITY);
+    // messages are written as they are sent, there is no queue to count
+    if (settings.has(SEND_QUEUE_HIGH_WATER_MESSAGES) ||
+        settings.has(SEND_QUEUE_LOW_WATER_MESSAGES))
+      throw ConfigError(std::string(SEND_QUEUE_HIGH_WATER_MESSAGES) + " and " +
+                        SEND_QUEUE_LOW_WATER_MESSAGES +
+                        " are not supported by threaded connections");
   }
 }
 
@@ -379,6 +395,21 @@ THREAD_PROC ThreadedSSLSocketAcceptor::socketAcceptorThread(void *p)
     SSL_set_app_data(ssl, pAcceptor->revocationStore());
     SSL_set_verify_result(ssl, X509_V_OK);
 
+    // the session is unknown until logon, use the first one on the port
+    const Dictionary &settings = pAcceptor->m_settings.get(*sessions.begin());
+    if (settings.has(SOCKET_BUSY_POLL) && settings.getBool(SOCKET_BUSY_POLL))
+    {
+      pConnection->setBusyPoll(true,
+                               settings.has(SOCKET_BUSY_POLL_TIMEOUT)
+                                   ? settings.getInt(SOCKET_BUSY_POLL_TIMEOUT)
+                                   : 0);
+    }
+    if (settings.has(THREAD_AFFINITY))
+      pConnection->setThreadAffinity(settings.getInt(THREAD_AFFINITY));
+    if (settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY))
+      pConnection->setReceiveBufferCapacity(
+          settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY));
+
     ConnectionThreadInfo *info =
         new ConnectionThreadInfo(pAcceptor, pConnection);
 
@@ -125,6 +125,7 @@
 #include "ThreadedSSLSocketInitiator.h"
 #include "Session.h"
 #include "Utility.h"
+#include "Clock.h"
 
 namespace FIX
 {
@@ -132,7 +133,9 @@ ThreadedSSLSocketConnection::ThreadedSSLSocketConnection(int s, SSL *ssl,
                                                          Sessions sessions,
                                                          Log *pLog)
     : m_socket(s), m_ssl(ssl), m_pLog(pLog), m_sessions(sessions),
-      m_pSession(0), m_disconnect(false)
+      m_pSession(0), m_disconnect(false), m_threadPrepared(false),
+      m_busyPoll(false), m_busyPollTimeout(0), m_threadAffinity(-1),
+      m_nextStatistics(0)
 {
   FD_ZERO(&m_fds);
   FD_SET(m_socket, &m_fds);
@@ -142,7 +145,9 @@ ThreadedSSLSocketConnection::ThreadedSSLSocketConnection(
     const SessionID &sessionID, int s, SSL *ssl, const std::string &address,
     short port, Log *pLog)
     : m_socket(s), m_ssl(ssl), m_address(address), m_port(port), m_pLog(pLog),
-      m_pSession(Session::lookupSession(sessionID)), m_disconnect(false)
+      m_pSession(Session::lookupSession(sessionID)), m_disconnect(false),
+      m_threadPrepared(false), m_busyPoll(false), m_busyPollTimeout(0),
+      m_threadAffinity(-1), m_nextStatistics(0)
 {
   FD_ZERO(&m_fds);
   FD_SET(m_socket, &m_fds);
@@ -162,6 +167,7 @@ ThreadedSSLSocketConnection::~ThreadedSSLSocketConnection()
 bool ThreadedSSLSocketConnection::send(const std::string &msg)
 {
   int totalSent = 0;
+  int64_t deadline = 0;
 
   while (totalSent < (int)msg.length())
   {
@@ -185,6 +191,21 @@ bool ThreadedSSLSocketConnection::send(const std::string &msg)
       if ((errCodeSSL == SSL_ERROR_WANT_READ) ||
           (errCodeSSL == SSL_ERROR_WANT_WRITE))
       {
+        if (m_busyPoll)
+        {
+          // a busy polled socket is nonblocking, the session lock is held
+          // here so wait for it rather than spin, at most one heartbeat
+          int64_t now = Clock::getSystem().getMonotonic();
+          if (!deadline)
+          {
+            int heartBtInt = m_pSession ? m_pSession->getHeartBtInt() : 0;
+            deadline = now + (heartBtInt > 0 ? heartBtInt : 1) *
+                                 DateTime::NANOS_PER_SEC;
+          }
+          if (now >= deadline ||
+              !waitSocket(errCodeSSL == SSL_ERROR_WANT_WRITE, deadline - now))
+            return false;
+        }
         errno = EINTR;
         sent = 0;
       }
@@ -208,6 +229,18 @@ bool ThreadedSSLSocketConnection::send(const std::string &msg)
   return true;
 }
 
+bool ThreadedSSLSocketConnection::waitSocket(bool write, int64_t timeout)
+{
+  fd_set fds = m_fds;
+  struct timeval tv;
+  tv.tv_sec = (long)(timeout / DateTime::NANOS_PER_SEC);
+  tv.tv_usec = (long)((timeout % DateTime::NANOS_PER_SEC) / 1000);
+  // a timeout is caught by the deadline in send
+  int result = write ? select(1 + m_socket, 0, &fds, 0, &tv)
+                     : select(1 + m_socket, &fds, 0, 0, &tv);
+  return result >= 0 || errno == EINTR;
+}
+
 bool ThreadedSSLSocketConnection::connect()
 {
   return socket_connect(getSocket(), m_address.c_str(), m_port) >= 0;
@@ -219,15 +252,88 @@ void ThreadedSSLSocketConnection::disconnect()
   ssl_socket_close(m_socket, m_ssl);
 }
 
+void ThreadedSSLSocketConnection::prepareThread()
+{
+  m_threadPrepared = true;
+  Log *pLog = m_pSession ? m_pSession->getLog() : m_pLog;
+
+  if (m_threadAffinity >= 0 && !thread_setaffinity(m_threadAffinity) && pLog)
+    pLog->onEvent("Unable to set thread affinity to CPU " +
+                  IntConvertor::convert(m_threadAffinity));
+
+  if (!m_busyPoll)
+    return;
+
+  socket_setnonblock(m_socket);
+#ifdef SO_BUSY_POLL
+  if (m_busyPollTimeout > 0 &&
+      socket_setsockopt(m_socket, SO_BUSY_POLL, m_busyPollTimeout) < 0 && pLog)
+    pLog->onEvent("Unable to set SO_BUSY_POLL on socket");
+#endif
+}
+
+int64_t ThreadedSSLSocketConnection::checkTimers()
+{
+  if (!m_pSession)
+    return DateTime::NANOS_PER_SEC;
+
+  int64_t now = Clock::getSystem().getMonotonic();
+  int64_t deadline = m_pSession->getNextTimeout();
+  if (deadline <= now)
+  {
+    m_pSession->next();
+    deadline = m_pSession->getNextTimeout();
+  }
+
+  // wait for the next deadline, at least a millisecond and at most a second
+  int64_t remaining = deadline - now;
+  if (remaining < 1000000)
+    remaining = 1000000;
+  if (remaining > DateTime::NANOS_PER_SEC)
+    remaining = DateTime::NANOS_PER_SEC;
+  return remaining;
+}
+
+void ThreadedSSLSocketConnection::updateStatistics()
+{
+  // a busy polled connection comes by constantly, spare it the ioctl
+  int64_t now = Clock::getSystem().getMonotonic();
+  if (now < m_nextStatistics)
+    return;
+  m_nextStatistics = now + 1000000;
+
+  // messages are written as they are sent, only the kernel queues bytes
+  SessionStatistics &statistics = m_pSession->getStatistics();
+  statistics.set(SessionStatistics::SEND_QUEUE_MESSAGES, 0);
+  statistics.set(SessionStatistics::SEND_QUEUE_BYTES, getSendQueueBytes());
+}
+
 bool ThreadedSSLSocketConnection::read()
 {
-  struct timeval timeout = {1, 0};
+  // the handshake and connect run blocking, switch modes on the first read
+  if (!m_threadPrepared)
+    prepareThread();
+
   fd_set readset = m_fds;
 
   try
   {
-    // Wait for input (1 second timeout)
-    int result = select(1 + m_socket, &readset, 0, 0, &timeout);
+    if (m_pSession)
+    {
+      m_pSession->checkSendQueue();
+      updateStatistics();
+    }
+
+    int result = 1;
+    int64_t remaining = checkTimers();
+    if (!m_busyPoll)
+    {
+      // Wait for input until the next timer of the session expires
+      struct timeval timeout;
+      timeout.tv_sec = (long)(remaining / DateTime::NANOS_PER_SEC);
+      timeout.tv_usec = (long)((remaining % DateTime::NANOS_PER_SEC) / 1000);
+      result = select(1 + m_socket, &readset, 0, 0, &timeout);
+    }
 
     if (result > 0) // Something to read
     {
@@ -239,6 +345,8 @@ bool ThreadedSSLSocketConnection::read()
         errno = 0;
         int size = 0;
         int errCodeSSL = 0;
+        size_t length = 0;
+        char *buffer = m_parser.getWriteBuffer(length);
         ERR_clear_error();
 
         // Cannot do concurrent SSL write and read as ssl context has to be
@@ -246,7 +354,7 @@ bool ThreadedSSLSocketConnection::read()
         {
           Locker locker(m_mutex);
 
-          size = SSL_read(m_ssl, m_buffer, sizeof(m_buffer));
+          size = SSL_read(m_ssl, buffer, (int)length);
           if (size <= 0)
             errCodeSSL = SSL_get_error(m_ssl, size);
           else if (SSL_pending(m_ssl) > 0)
@@ -285,12 +393,12 @@ bool ThreadedSSLSocketConnection::read()
           }
         }
 
-        m_parser.addToStream(m_buffer, size);
+        m_parser.commitWrite(size);
       } while (pending);
     }
-    else if (result == 0 && m_pSession) // Timeout
+    else if (result == 0) // Timeout
     {
-      m_pSession->next();
+      checkTimers();
     }
     else if (result < 0) // Error
     {
@@ -328,7 +436,13 @@ bool ThreadedSSLSocketConnection::readMessage(std::string &msg) throw(
 {
   try
   {
-    return m_parser.readFixMessage(msg);
+    if (!m_pSession)
+      return m_parser.readFixMessage(msg);
+    LatencyTimer timer(m_pSession->getLatency());
+    if (!m_parser.readFixMessage(msg))
+      return false;
+    timer.stop(SessionLatency::PARSE);
+    return true;
   }
   catch (MessageParseError &)
   {
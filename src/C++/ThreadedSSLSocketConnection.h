@@ -158,17 +158,40 @@ public:
   bool read();
   SSL *sslObject() { return m_ssl; }
 
+  /// Bytes written by send that the kernel has not transmitted yet
+  size_t getSendQueueBytes() { return socket_pending_send(m_socket); }
+
+  /// Spin on a nonblocking socket instead of waiting in select
+  void setBusyPoll(bool value, int timeout = 0)
+  {
+    m_busyPoll = value;
+    m_busyPollTimeout = timeout;
+  }
+  /// Pin the connection thread to a CPU, -1 leaves it unpinned
+  void setThreadAffinity(int cpu) { m_threadAffinity = cpu; }
+  /// Minimum number of bytes handed to each receive
+  void setReceiveBufferCapacity(size_t capacity)
+  {
+    m_parser.setCapacity(capacity);
+  }
+
 private:
   typedef std::pair< int, SSL * > SocketKey;
 
+  void prepareThread();
+  /// Calls next when a timer of the session expired, returns nanoseconds to wait
+  int64_t checkTimers();
+  /// Publishes the send queue statistics, at most once a millisecond
+  void updateStatistics();
   bool readMessage(std::string &msg) throw(SocketRecvFailed);
   void processStream();
   bool send(const std::string &);
+  /// Waits up to timeout nanoseconds until the socket can be read or written
+  bool waitSocket(bool write, int64_t timeout);
   bool setSession(const std::string &msg);
 
   int m_socket;
   SSL *m_ssl;
-  char m_buffer[BUFSIZ];
 
   std::string m_address;
   int m_port;
@@ -180,6 +203,12 @@ private:
   bool m_disconnect;
   fd_set m_fds;
 
+  bool m_threadPrepared;
+  bool m_busyPoll;
+  int m_busyPollTimeout;
+  int m_threadAffinity;
+  int64_t m_nextStatistics;
+
   Mutex m_mutex;
 };
 }
@@ -180,6 +180,29 @@ void ThreadedSSLSocketInitiator::onConfigure(const SessionSettings &s) throw(
     m_sendBufSize = dict.getInt(SOCKET_SEND_BUFFER_SIZE);
   if (dict.has(SOCKET_RECEIVE_BUFFER_SIZE))
     m_rcvBufSize = dict.getInt(SOCKET_RECEIVE_BUFFER_SIZE);
+
+  std::set< SessionID > sessions = s.getSessions();
+  std::set< SessionID >::iterator i;
+  for (i = sessions.begin(); i != sessions.end(); ++i)
+  {
+    const Dictionary &settings = s.get(*i);
+    if (settings.has(SOCKET_BUSY_POLL))
+      settings.getBool(SOCKET_BUSY_POLL);
+    if (settings.has(SOCKET_BUSY_POLL_TIMEOUT))
+      settings.getInt(SOCKET_BUSY_POLL_TIMEOUT);
+    if (settings.has(THREAD_AFFINITY))
+      settings.getInt(THREAD_AFFINITY);
+    if (settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY) &&
+        settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) <= 0)
+      throw ConfigError(std::string(SOCKET_RECEIVE_BUFFER_CAPACITY) +
+                        " must be greater than zero");
+    // messages are written as they are sent, there is no queue to count
+    if (settings.has(SEND_QUEUE_HIGH_WATER_MESSAGES) ||
+        settings.has(SEND_QUEUE_LOW_WATER_MESSAGES))
+      throw ConfigError(std::string(SEND_QUEUE_HIGH_WATER_MESSAGES) + " and " +
+                        SEND_QUEUE_LOW_WATER_MESSAGES +
+                        " are not supported by threaded connections");
+  }
 }
 
 void ThreadedSSLSocketInitiator::onInitialize(const SessionSettings &s) throw(
@@ -322,6 +345,18 @@ void ThreadedSSLSocketInitiator::doConnect(const SessionID &s,
     ThreadedSSLSocketConnection *pConnection = new ThreadedSSLSocketConnection(
         s, socket, ssl, address, port, getLog());
 
+    if (d.has(SOCKET_BUSY_POLL) && d.getBool(SOCKET_BUSY_POLL))
+    {
+      pConnection->setBusyPoll(true, d.has(SOCKET_BUSY_POLL_TIMEOUT)
+                                         ? d.getInt(SOCKET_BUSY_POLL_TIMEOUT)
+                                         : 0);
+    }
+    if (d.has(THREAD_AFFINITY))
+      pConnection->setThreadAffinity(d.getInt(THREAD_AFFINITY));
+    if (d.has(SOCKET_RECEIVE_BUFFER_CAPACITY))
+      pConnection->setReceiveBufferCapacity(
+          d.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY));
+
     ThreadPair *pair = new ThreadPair(this, pConnection);
 
     {
@@ -64,6 +64,24 @@ throw ( ConfigError )
       settings.getBool( SOCKET_REUSE_ADDRESS );
     if( settings.has(SOCKET_NODELAY) )
       settings.getBool( SOCKET_NODELAY );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY)
+        && settings.getInt( SOCKET_RECEIVE_BUFFER_CAPACITY ) <= 0 )
+      throw ConfigError( std::string(SOCKET_RECEIVE_BUFFER_CAPACITY)
+                         + " must be greater than zero" );
+    if( settings.has(SOCKET_RECEIVE_TIMESTAMPS) )
+      settings.getBool( SOCKET_RECEIVE_TIMESTAMPS );
+    if( settings.has(SOCKET_BUSY_POLL) )
+      settings.getBool( SOCKET_BUSY_POLL );
+    if( settings.has(SOCKET_BUSY_POLL_TIMEOUT) )
+      settings.getInt( SOCKET_BUSY_POLL_TIMEOUT );
+    if( settings.has(THREAD_AFFINITY) )
+      settings.getInt( THREAD_AFFINITY );
+    // messages are written as they are sent, there is no queue to count
+    if( settings.has(SEND_QUEUE_HIGH_WATER_MESSAGES)
+        || settings.has(SEND_QUEUE_LOW_WATER_MESSAGES) )
+      throw ConfigError( std::string(SEND_QUEUE_HIGH_WATER_MESSAGES) + " and "
+                         + SEND_QUEUE_LOW_WATER_MESSAGES
+                         + " are not supported by threaded connections" );
   }
 }
 
@@ -215,6 +233,20 @@ THREAD_PROC ThreadedSocketAcceptor::socketAcceptorThread( void* p )
       new ThreadedSocketConnection
         ( socket, sessions, pAcceptor->getLog() );
 
+    // the session is unknown until logon, use the first one on the port
+    const Dictionary& settings = pAcceptor->m_settings.get( *sessions.begin() );
+    if( settings.has(SOCKET_BUSY_POLL) && settings.getBool(SOCKET_BUSY_POLL) )
+    {
+      pConnection->setBusyPoll( true, settings.has(SOCKET_BUSY_POLL_TIMEOUT) ?
+        settings.getInt(SOCKET_BUSY_POLL_TIMEOUT) : 0 );
+    }
+    if( settings.has(THREAD_AFFINITY) )
+      pConnection->setThreadAffinity( settings.getInt(THREAD_AFFINITY) );
+    if( settings.has(SOCKET_RECEIVE_BUFFER_CAPACITY) )
+      pConnection->setReceiveBufferCapacity( settings.getInt(SOCKET_RECEIVE_BUFFER_CAPACITY) );
+    if( settings.has(SOCKET_RECEIVE_TIMESTAMPS) )
+      pConnection->setReceiveTimestamps( settings.getBool(SOCKET_RECEIVE_TIMESTAMPS) );
+
     ConnectionThreadInfo* info = new ConnectionThreadInfo( pAcceptor, pConnection );
 
     {
@@ -28,6 +28,7 @@
 #include "ThreadedSocketInitiator.h"
 #include "Session.h"
 #include "Utility.h"
+#include "Clock.h"
 
 namespace FIX
 {
@@ -35,7 +36,10 @@ ThreadedSocketConnection::ThreadedSocketConnection
 ( int s, Sessions sessions, Log* pLog )
 : m_socket( s ), m_pLog( pLog ),
   m_sessions( sessions ), m_pSession( 0 ),
-  m_disconnect( false )
+  m_disconnect( false ), m_threadPrepared( false ),
+  m_busyPoll( false ), m_busyPollTimeout( 0 ),
+  m_threadAffinity( -1 ), m_nextStatistics( 0 ),
+  m_receiveTimestamps( false )
 {
   FD_ZERO( &m_fds );
   FD_SET( m_socket, &m_fds );
@@ -50,7 +54,10 @@ ThreadedSocketConnection::ThreadedSocketConnection
     m_sourceAddress( sourceAddress ), m_sourcePort( sourcePort ),
     m_pLog( pLog ),
     m_pSession( Session::lookupSession( sessionID ) ),
-    m_disconnect( false )
+    m_disconnect( false ), m_threadPrepared( false ),
+    m_busyPoll( false ), m_busyPollTimeout( 0 ),
+    m_threadAffinity( -1 ), m_nextStatistics( 0 ),
+    m_receiveTimestamps( false )
 {
   FD_ZERO( &m_fds );
   FD_SET( m_socket, &m_fds );
@@ -66,19 +73,50 @@ ThreadedSocketConnection::~ThreadedSocketConnection()
   }
 }
 
+void ThreadedSocketConnection::setReceiveTimestamps( bool value )
+{
+  m_receiveTimestamps = value && socket_settimestamping( m_socket );
+}
+
 bool ThreadedSocketConnection::send( const std::string& msg )
 {
   int totalSent = 0;
+  int64_t deadline = 0;
   while(totalSent < (int)msg.length())
   {
-    ssize_t sent = socket_send( m_socket, msg.c_str() + totalSent, msg.length() );
-    if(sent < 0) return false;
+    ssize_t sent = socket_send( m_socket, msg.c_str() + totalSent, msg.length() - totalSent );
+    if(sent < 0)
+    {
+      if( !m_busyPoll || !socket_wouldblock() ) return false;
+
+      // a busy polled socket is nonblocking, the session lock is held here
+      // so wait for it to drain rather than spin, at most one heartbeat
+      int64_t now = Clock::getSystem().getMonotonic();
+      if( !deadline )
+      {
+        int heartBtInt = m_pSession ? m_pSession->getHeartBtInt() : 0;
+        deadline = now + ( heartBtInt > 0 ? heartBtInt : 1 ) * DateTime::NANOS_PER_SEC;
+      }
+      if( now >= deadline || !waitWritable( deadline - now ) )
+        return false;
+      continue;
+    }
     totalSent += sent;
   }
 
   return true;
 }
 
+bool ThreadedSocketConnection::waitWritable( int64_t timeout )
+{
+  fd_set writeset = m_fds;
+  struct timeval tv;
+  tv.tv_sec = (long)( timeout / DateTime::NANOS_PER_SEC );
+  tv.tv_usec = (long)( ( timeout % DateTime::NANOS_PER_SEC ) / 1000 );
+  // a timeout is caught by the deadline in send
+  return select( 1 + m_socket, 0, &writeset, 0, &tv ) >= 0 || errno == EINTR;
+}
+
 bool ThreadedSocketConnection::connect()
 {
   // do the bind in the thread as name resolution may block
@@ -94,26 +132,110 @@ void ThreadedSocketConnection::disconnect()
   socket_close( m_socket );
 }
 
+void ThreadedSocketConnection::prepareThread()
+{
+  m_threadPrepared = true;
+  Log* pLog = m_pSession ? m_pSession->getLog() : m_pLog;
+
+  if( m_threadAffinity >= 0 && !thread_setaffinity( m_threadAffinity ) && pLog )
+    pLog->onEvent( "Unable to set thread affinity to CPU " 
+                   + IntConvertor::convert( m_threadAffinity ) );
+
+  if( !m_busyPoll )
+    return;
+
+  socket_setnonblock( m_socket );
+#ifdef SO_BUSY_POLL
+  if( m_busyPollTimeout > 0 
+      && socket_setsockopt( m_socket, SO_BUSY_POLL, m_busyPollTimeout ) < 0 
+      && pLog )
+    pLog->onEvent( "Unable to set SO_BUSY_POLL on socket" );
+#endif
+}
+
+int64_t ThreadedSocketConnection::checkTimers()
+{
+  if( !m_pSession ) return DateTime::NANOS_PER_SEC;
+
+  int64_t now = Clock::getSystem().getMonotonic();
+  int64_t deadline = m_pSession->getNextTimeout();
+  if( deadline <= now )
+  {
+    m_pSession->next();
+    deadline = m_pSession->getNextTimeout();
+  }
+
+  // wait for the next deadline, at least a millisecond and at most a second
+  int64_t remaining = deadline - now;
+  if( remaining < 1000000 ) remaining = 1000000;
+  if( remaining > DateTime::NANOS_PER_SEC ) remaining = DateTime::NANOS_PER_SEC;
+  return remaining;
+}
+
+void ThreadedSocketConnection::updateStatistics()
+{
+  // a busy polled connection comes by constantly, spare it the ioctl
+  int64_t now = Clock::getSystem().getMonotonic();
+  if( now < m_nextStatistics ) return;
+  m_nextStatistics = now + 1000000;
+
+  // messages are written as they are sent, only the kernel queues bytes
+  SessionStatistics& statistics = m_pSession->getStatistics();
+  statistics.set( SessionStatistics::SEND_QUEUE_MESSAGES, 0 );
+  statistics.set( SessionStatistics::SEND_QUEUE_BYTES, getSendQueueBytes() );
+}
+
 bool ThreadedSocketConnection::read()
 {
-  struct timeval timeout = { 1, 0 };
+  // the handshake and connect run blocking, switch modes on the first read
+  if( !m_threadPrepared )
+    prepareThread();
+
   fd_set readset = m_fds;
 
   try
   {
-    // Wait for input (1 second timeout)
-    int result = select( 1 + m_socket, &readset, 0, 0, &timeout );
+    if( m_pSession )
+    {
+      m_pSession->checkSendQueue();
+      updateStatistics();
+    }
+
+    int result = 1;
+    int64_t remaining = checkTimers();
+    if( !m_busyPoll )
+    {
+      // Wait for input until the next timer of the session expires
+      struct timeval timeout;
+      timeout.tv_sec = (long)( remaining / DateTime::NANOS_PER_SEC );
+      timeout.tv_usec = (long)( ( remaining % DateTime::NANOS_PER_SEC ) / 1000 );
+      result = select( 1 + m_socket, &readset, 0, 0, &timeout );
+    }
 
     if( result > 0 ) // Something to read
     {
       // We can read without blocking
-      ssize_t size = socket_recv( m_socket, m_buffer, sizeof(m_buffer) );
+      size_t length = 0;
+      char* buffer = m_parser.getWriteBuffer( length );
+      ssize_t size = 0;
+      if( m_receiveTimestamps )
+      {
+        int64_t timestamp = 0;
+        size = socket_recv( m_socket, buffer, length, timestamp );
+        if( size > 0 && timestamp )
+          m_receiveTime = UtcTimeStamp( (time_t)(timestamp / 1000000000), (int)(timestamp % 1000000000), 9 );
+        else if( size > 0 )
+          m_receiveTime.setCurrent();
+      }
+      else
+        size = socket_recv( m_socket, buffer, length );
+      if ( size < 0 && m_busyPoll && socket_wouldblock() ) { return true; }
       if ( size <= 0 ) { throw SocketRecvFailed( size ); }
-      m_parser.addToStream( m_buffer, size );
+      m_parser.commitWrite( size );
     }
-    else if( result == 0 && m_pSession ) // Timeout
+    else if( result == 0 ) // Timeout
     {
-      m_pSession->next();
+      checkTimers();
     }
     else if( result < 0 ) // Error
     {
@@ -147,7 +269,11 @@ throw( SocketRecvFailed )
 {
   try
   {
-    return m_parser.readFixMessage( msg );
+    if( !m_pSession ) return m_parser.readFixMessage( msg );
+    LatencyTimer timer( m_pSession->getLatency() );
+    if( !m_parser.readFixMessage( msg ) ) return false;
+    timer.stop( SessionLatency::PARSE );
+    return true;
   }
   catch ( MessageParseError& ) {}
   return true;
@@ -165,7 +291,7 @@ void ThreadedSocketConnection::processStream()
     }
     try
     {
-      m_pSession->next( msg, UtcTimeStamp() );
+      m_pSession->next( msg, m_receiveTimestamps ? m_receiveTime : UtcTimeStamp() );
     }
     catch( InvalidMessage& )
     {
@@ -29,6 +29,7 @@
 #include "Parser.h"
 #include "Responder.h"
 #include "SessionID.h"
+#include "FieldTypes.h"
 #include <set>
 #include <map>
 
@@ -59,14 +60,34 @@ public:
   void disconnect();
   bool read();
 
+  /// Bytes written by send that the kernel has not transmitted yet
+  size_t getSendQueueBytes() { return socket_pending_send( m_socket ); }
+
+  /// Spin on a nonblocking socket instead of waiting in select
+  void setBusyPoll( bool value, int timeout = 0 )
+  { m_busyPoll = value; m_busyPollTimeout = timeout; }
+  /// Pin the connection thread to a CPU, -1 leaves it unpinned
+  void setThreadAffinity( int cpu ) { m_threadAffinity = cpu; }
+  /// Minimum number of bytes handed to each receive
+  void setReceiveBufferCapacity( size_t capacity )
+  { m_parser.setCapacity( capacity ); }
+  /// Stamp incoming messages with the kernel receive time
+  void setReceiveTimestamps( bool value );
+
 private:
+  void prepareThread();
+  /// Calls next when a timer of the session expired, returns nanoseconds to wait
+  int64_t checkTimers();
+  /// Publishes the send queue statistics, at most once a millisecond
+  void updateStatistics();
   bool readMessage( std::string& msg ) throw( SocketRecvFailed );
   void processStream();
   bool send( const std::string& );
+  /// Waits up to timeout nanoseconds for room in the send buffer
+  bool waitWritable( int64_t timeout );
   bool setSession( const std::string& msg );
 
   int m_socket;
-  char m_buffer[BUFSIZ];
 
   std::string m_address;
   int m_port;
@@ -79,6 +100,15 @@ private:
   Session* m_pSession;
   bool m_disconnect;
   fd_set m_fds;
+
+  bool m_threadPrepared;
+  bool m_busyPoll;
+  int m_busyPollTimeout;
+  int m_threadAffinity;
+  int64_t m_nextStatistics;
+
+  bool m_receiveTimestamps;
+  UtcTimeStamp m_receiveTime;
 };
 }
 
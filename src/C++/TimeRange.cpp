@@ -34,7 +34,7 @@ namespace FIX
                         int endDay )
   : m_startTime( startTime ), m_endTime( endTime ),
     m_startDay( startDay ), m_endDay( endDay ),
-    m_useLocalTime( false )
+    m_useLocalTime( false ), m_sameRangeTime( 0 )
   {
     if( startDay > 0
         && endDay > 0
@@ -49,7 +49,7 @@ namespace FIX
                         int endDay )
   : m_startTime( startTime ), m_endTime( endTime ),
     m_startDay( startDay ), m_endDay( endDay ),
-    m_useLocalTime( true )
+    m_useLocalTime( true ), m_sameRangeTime( 0 )
   {
     if( startDay > 0
         && endDay > 0
@@ -58,6 +58,137 @@ namespace FIX
     { m_endTime = m_startTime; }
   }
 
+  TimeRange::TimeRange( const TimeRange& copy )
+  : m_startTime( copy.m_startTime ), m_endTime( copy.m_endTime ),
+    m_startDay( copy.m_startDay ), m_endDay( copy.m_endDay ),
+    m_useLocalTime( copy.m_useLocalTime ), m_sameRangeTime( 0 )
+  {
+  }
+
+  TimeRange& TimeRange::operator=( const TimeRange& rhs )
+  {
+    if( this == &rhs ) return *this;
+
+    Locker l( m_mutex );
+    m_startTime = rhs.m_startTime;
+    m_endTime = rhs.m_endTime;
+    m_startDay = rhs.m_startDay;
+    m_endDay = rhs.m_endDay;
+    m_useLocalTime = rhs.m_useLocalTime;
+    m_range = Window();
+    m_sameRange = Window();
+    m_sameRangeTime = 0;
+    return *this;
+  }
+
+  bool TimeRange::isInRange( const UtcTimeStamp& dateTime )
+  {
+    int64_t time = toNanos( dateTime );
+    Locker l( m_mutex );
+    if( m_range.contains( time ) )
+      return m_range.m_result;
+
+    m_range.m_result = checkInRange( dateTime );
+    m_range.m_begin = time;
+    m_range.m_end = getNextChange( dateTime, 0 );
+    return m_range.m_result;
+  }
+
+  int64_t TimeRange::getTimeToChange( const UtcTimeStamp& dateTime )
+  {
+    int64_t time = toNanos( dateTime );
+    Locker l( m_mutex );
+    if( !m_range.contains( time ) )
+      isInRange( dateTime );
+    return m_range.m_end - time;
+  }
+
+  bool TimeRange::isInSameRange( const UtcTimeStamp& time1, const UtcTimeStamp& time2 )
+  {
+    int64_t time = toNanos( time1 );
+    int64_t other = toNanos( time2 );
+    Locker l( m_mutex );
+    if( other == m_sameRangeTime && m_sameRange.contains( time ) )
+      return m_sameRange.m_result;
+
+    m_sameRange.m_result = checkInSameRange( time1, time2 );
+    m_sameRange.m_begin = time;
+    m_sameRange.m_end = getNextChange( time1, &time2 );
+    m_sameRangeTime = other;
+    return m_sameRange.m_result;
+  }
+
+  int64_t TimeRange::getNextChange( const UtcTimeStamp& time,
+                                    const UtcTimeStamp* pOther ) const
+  {
+    const int64_t second = DateTime::NANOS_PER_SEC;
+    const int64_t day = DateTime::NANOS_PER_DAY;
+
+    // the results only change where the time of day passes the start, the
+    // end or midnight, seen at whole seconds for local time
+    int64_t utc = toNanos( time );
+    int64_t offset = getOffset( time );
+    int64_t zoned = utc + offset;
+    int64_t midnight = zoned - ( ( zoned % day ) + day ) % day;
+    int64_t start = m_startTime.m_time;
+    int64_t end = m_endTime.m_time;
+
+    int64_t changes[ 11 ];
+    int count = 0;
+    changes[ count++ ] = midnight + start;
+    changes[ count++ ] = midnight + ( start + second - 1 ) / second * second;
+    changes[ count++ ] = midnight + end + 1;
+    changes[ count++ ] = midnight + end / second * second + second;
+    changes[ count++ ] = midnight + day;
+
+    // isInSameRange measures whole seconds from the other time as well
+    if( pOther )
+    {
+      int64_t other = toNanos( *pOther ) + getOffset( *pOther );
+      int64_t otherSecond = other - ( ( other % second ) + second ) % second;
+      int64_t otherMidnight = other - ( ( other % day ) + day ) % day;
+      int64_t length = ( DateTime::SECONDS_PER_DAY - ( m_startTime - m_endTime ) ) * second;
+      int64_t sessionStart = otherMidnight + start / second * second;
+
+      changes[ count++ ] = other;
+      changes[ count++ ] = other + 1;
+      changes[ count++ ] = otherSecond + second;
+      changes[ count++ ] = otherSecond - length + second;
+      changes[ count++ ] = sessionStart + length;
+      changes[ count++ ] = sessionStart + length - day;
+    }
+
+    int64_t next = midnight + day;
+    for( int i = 0; i < count; ++i )
+    {
+      if( changes[ i ] > zoned && changes[ i ] < next )
+        next = changes[ i ];
+    }
+    next -= offset;
+
+    // the offset of local time holds until the next quarter hour at least
+    if( m_useLocalTime )
+    {
+      const int64_t quarter = 15 * 60 * second;
+      int64_t limit = utc - ( ( utc % quarter ) + quarter ) % quarter + quarter;
+      if( limit < next ) next = limit;
+    }
+    return next;
+  }
+
+  int64_t TimeRange::getOffset( const DateTime& time ) const
+  {
+    if( !m_useLocalTime ) return 0;
+    LocalTimeStamp local( time.getTimeT() );
+    return toNanos( local ) - (int64_t)time.getTimeT() * DateTime::NANOS_PER_SEC;
+  }
+
+  int64_t TimeRange::toNanos( const DateTime& time )
+  {
+    return (int64_t)( time.getJulianDate() - DateTime::JULIAN_19700101 )
+           * DateTime::NANOS_PER_DAY + time.m_time;
+  }
+
   bool TimeRange::isInRange( const DateTime& start,
                              const DateTime& end,
                              const DateTime& time )
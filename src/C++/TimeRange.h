@@ -27,10 +27,17 @@
 #endif
 
 #include "FieldTypes.h"
+#include "Mutex.h"
 
 namespace FIX
 {
-/// Keeps track of when session is active
+/**
+ * Keeps track of when session is active
+ *
+ * The checks of UtcTimeStamps remember the span of time their result holds
+ * for, up to the next start, end or midnight, and only evaluate the range
+ * again once a time falls outside of it.
+ */
 class TimeRange
 {
 public:
@@ -40,6 +47,9 @@ public:
   TimeRange( const LocalTimeOnly& startTime, const LocalTimeOnly& endTime,
                int startDay = -1, int endDay = -1 );
 
+  TimeRange( const TimeRange& copy );
+  TimeRange& operator=( const TimeRange& rhs );
+
   static bool isInRange( const UtcTimeOnly& start,
                          const UtcTimeOnly& end,
                          const DateTime& time )
@@ -191,53 +201,76 @@ public:
         ( m_startTime, m_endTime, m_startDay, m_endDay, dateTime, day );
   }
 
-  bool isInRange( const UtcTimeStamp& dateTime )
+  bool isInRange( const UtcTimeStamp& dateTime );
+
+  /// Nanoseconds from dateTime until isInRange may change
+  int64_t getTimeToChange( const UtcTimeStamp& dateTime );
+
+  bool isInRange( const LocalTimeStamp& dateTime )
   {
-    if( m_useLocalTime )
+    if( !m_useLocalTime )
     {
-      LocalTimeStamp localDateTime( dateTime.getTimeT() );
-      return isInRange( localDateTime, localDateTime.getWeekDay() );
+      LocalTimeStamp utcDateTime( dateTime.getTimeT() );
+      return isInRange( utcDateTime, utcDateTime.getWeekDay() );
     }
 
     return isInRange( dateTime, dateTime.getWeekDay() );
   }
 
-  bool isInRange( const LocalTimeStamp& dateTime )
+  bool isInSameRange( const UtcTimeStamp& time1, const UtcTimeStamp& time2 );
+
+  bool isInSameRange( const LocalTimeStamp& time1, const LocalTimeStamp& time2 )
   {
     if( !m_useLocalTime )
     {
-      LocalTimeStamp utcDateTime( dateTime.getTimeT() );
-      return isInRange( utcDateTime, utcDateTime.getWeekDay() );
+      UtcTimeStamp utcTime1( time1.getTimeT() );
+      UtcTimeStamp utcTime2( time2.getTimeT() );
+      return isInSameRange( (DateTime)utcTime1, (DateTime)utcTime2 );
     }
 
-    return isInRange( dateTime, dateTime.getWeekDay() );
+    return isInSameRange( (DateTime)time1, (DateTime)time2 );
   }
 
-  bool isInSameRange( const UtcTimeStamp& time1, const UtcTimeStamp& time2 )
+private:
+  /// A result and the span of time it holds for, in nanoseconds since the epoch
+  struct Window
+  {
+    Window() : m_begin( 0 ), m_end( 0 ), m_result( false ) {}
+    bool contains( int64_t time ) const
+    { return time >= m_begin && time < m_end; }
+
+    int64_t m_begin;
+    int64_t m_end;
+    bool m_result;
+  };
+
+  bool checkInRange( const UtcTimeStamp& dateTime )
   {
     if( m_useLocalTime )
     {
-      LocalTimeStamp localTime1( time1.getTimeT() );
-      LocalTimeStamp localTime2( time2.getTimeT() );
-      return isInSameRange( (DateTime)localTime1, (DateTime)localTime2 );
+      LocalTimeStamp localDateTime( dateTime.getTimeT() );
+      return isInRange( localDateTime, localDateTime.getWeekDay() );
     }
 
-    return isInSameRange( (DateTime)time1, (DateTime)time2 );
+    return isInRange( dateTime, dateTime.getWeekDay() );
   }
 
-  bool isInSameRange( const LocalTimeStamp& time1, const LocalTimeStamp& time2 )
+  bool checkInSameRange( const UtcTimeStamp& time1, const UtcTimeStamp& time2 )
   {
-    if( !m_useLocalTime )
+    if( m_useLocalTime )
     {
-      UtcTimeStamp utcTime1( time1.getTimeT() );
-      UtcTimeStamp utcTime2( time2.getTimeT() );
-      return isInSameRange( (DateTime)utcTime1, (DateTime)utcTime2 );
+      LocalTimeStamp localTime1( time1.getTimeT() );
+      LocalTimeStamp localTime2( time2.getTimeT() );
+      return isInSameRange( (DateTime)localTime1, (DateTime)localTime2 );
     }
 
     return isInSameRange( (DateTime)time1, (DateTime)time2 );
   }
 
-private:
+  int64_t getNextChange( const UtcTimeStamp& time, const UtcTimeStamp* pOther ) const;
+  int64_t getOffset( const DateTime& time ) const;
+  static int64_t toNanos( const DateTime& time );
+
   bool isInSameRange( const DateTime& time1, const DateTime& time2 )
   {
     if( m_startDay < 0 && m_endDay < 0 )
@@ -252,6 +285,11 @@ private:
   int m_startDay;
   int m_endDay;
   bool m_useLocalTime;
+
+  Window m_range;
+  Window m_sameRange;
+  int64_t m_sameRangeTime;
+  Mutex m_mutex;
 };
 }
 
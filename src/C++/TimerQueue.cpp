@@ -0,0 +1,111 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "TimerQueue.h"
+#include "Session.h"
+
+namespace FIX
+{
+void TimerQueue::schedule( Session* pSession, int64_t deadline )
+{
+  Locker l( m_mutex );
+  Deadlines::iterator i = m_deadlines.find( pSession );
+  if( i != m_deadlines.end() )
+  {
+    if( i->second <= deadline ) return;
+    i->second = deadline;
+  }
+  else
+    m_deadlines[ pSession ] = deadline;
+  m_heap.push( Entry( deadline, pSession ) );
+}
+
+void TimerQueue::cancel( Session* pSession )
+{
+  Locker l( m_mutex );
+  m_deadlines.erase( pSession );
+  dropReplaced();
+}
+
+void TimerQueue::pop( int64_t now, std::vector < Session* >& sessions )
+{
+  Locker l( m_mutex );
+  dropReplaced();
+  while( m_heap.size() && m_heap.top().first <= now )
+  {
+    m_deadlines.erase( m_heap.top().second );
+    sessions.push_back( m_heap.top().second );
+    m_heap.pop();
+    dropReplaced();
+  }
+}
+
+void TimerQueue::process( int64_t now )
+{
+  std::vector < Session* > sessions;
+  pop( now, sessions );
+
+  std::vector < Session* >::iterator i;
+  for( i = sessions.begin(); i != sessions.end(); ++i )
+  {
+    // the deadline may have moved on since it was scheduled
+    int64_t deadline = (*i)->getNextTimeout();
+    if( deadline > now )
+      schedule( *i, deadline );
+    else
+      (*i)->next();
+  }
+}
+
+double TimerQueue::getTimeout( int64_t now )
+{
+  Locker l( m_mutex );
+  dropReplaced();
+  if( !m_heap.size() ) return 0;
+
+  // wake up at least a millisecond from now, zero means no timeout
+  int64_t remaining = m_heap.top().first - now;
+  if( remaining < 1000000 ) remaining = 1000000;
+  return (double)remaining / 1000000000;
+}
+
+size_t TimerQueue::size()
+{
+  Locker l( m_mutex );
+  return m_deadlines.size();
+}
+
+bool TimerQueue::isCurrent( const Entry& entry ) const
+{
+  Deadlines::const_iterator i = m_deadlines.find( entry.second );
+  return i != m_deadlines.end() && i->second == entry.first;
+}
+
+void TimerQueue::dropReplaced()
+{
+  while( m_heap.size() && !isCurrent( m_heap.top() ) )
+    m_heap.pop();
+}
+}
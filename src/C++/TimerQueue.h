@@ -0,0 +1,79 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_TIMERQUEUE_H
+#define FIX_TIMERQUEUE_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "Mutex.h"
+#include "Utility.h"
+#include <queue>
+#include <map>
+#include <vector>
+
+namespace FIX
+{
+class Session;
+
+/**
+ * Deadlines of the timers of sessions, earliest first.
+ *
+ * A session has at most one deadline in the queue.  Scheduling an earlier
+ * one replaces it, a later one is ignored, as the session is called when
+ * the earlier deadline expires and schedules itself again from there.
+ * Replaced and cancelled deadlines stay in the heap until they come to the
+ * top.  Sessions may schedule from any thread, deadlines are monotonic
+ * times of the system Clock.
+ */
+class TimerQueue
+{
+public:
+  void schedule( Session* pSession, int64_t deadline );
+  void cancel( Session* pSession );
+
+  /// Removes the sessions whose deadline is at or before now
+  void pop( int64_t now, std::vector < Session* >& sessions );
+  /// Calls next on the sessions whose timers expired at now
+  void process( int64_t now );
+
+  /// Seconds to wait for the earliest deadline, 0 when nothing is scheduled
+  double getTimeout( int64_t now );
+  size_t size();
+
+private:
+  typedef std::pair < int64_t, Session* > Entry;
+  typedef std::priority_queue < Entry, std::vector < Entry >,
+                                std::greater < Entry > > Heap;
+  typedef std::map < Session*, int64_t > Deadlines;
+
+  bool isCurrent( const Entry& entry ) const;
+  void dropReplaced();
+
+  Heap m_heap;
+  Deadlines m_deadlines;
+  Mutex m_mutex;
+};
+}
+
+#endif //FIX_TIMERQUEUE_H
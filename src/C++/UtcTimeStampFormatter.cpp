@@ -0,0 +1,77 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include "UtcTimeStampFormatter.h"
+#include "FieldConvertors.h"
+#include <string.h>
+
+namespace FIX
+{
+UtcTimeStampFormatter::UtcTimeStampFormatter()
+: m_date( 0 ), m_second( -1 )
+{
+}
+
+char* UtcTimeStampFormatter::format( char* buffer, const UtcTimeStamp& value,
+                                     int precision )
+{
+  int64_t second = value.m_time / DateTime::NANOS_PER_SEC;
+  if( value.m_date != m_date || second != m_second )
+  {
+    memcpy( m_prefix, UtcTimeStampConvertor::convert( value, 0 ).data(), 17 );
+    m_date = value.m_date;
+    m_second = second;
+  }
+
+  memcpy( buffer, m_prefix, 17 );
+  if( precision <= 0 )
+    return buffer + 17;
+  if( precision > 9 )
+    precision = 9;
+
+  buffer[ 17 ] = '.';
+  char* end = buffer + 18 + precision;
+  unsigned int fraction = value.getFraction( precision );
+  for( char* p = end - 1; p > buffer + 17; --p )
+  {
+    *p = (char)( '0' + fraction % 10 );
+    fraction /= 10;
+  }
+  return end;
+}
+
+std::string UtcTimeStampFormatter::format( const UtcTimeStamp& value, int precision )
+{
+  char buffer[ MAX_LENGTH ];
+  return std::string( buffer, format( buffer, value, precision ) );
+}
+
+void UtcTimeStampFormatter::append( std::string& result, const UtcTimeStamp& value,
+                                    int precision )
+{
+  char buffer[ MAX_LENGTH ];
+  result.append( buffer, format( buffer, value, precision ) );
+}
+}
@@ -0,0 +1,62 @@
+/* -*- C++ -*- */
+
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifndef FIX_UTCTIMESTAMPFORMATTER_H
+#define FIX_UTCTIMESTAMPFORMATTER_H
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 4290 )
+#endif
+
+#include "FieldTypes.h"
+#include <string>
+
+namespace FIX
+{
+/**
+ * Formats timestamps like UtcTimeStampConvertor, reusing the date and time
+ * of the previous call when it falls in the same second.
+ *
+ * Only the fraction is written for every call, the YYYYMMDD-HH:MM:SS
+ * prefix is converted once a second.  A formatter is not synchronized,
+ * callers share one under their own lock.
+ */
+class UtcTimeStampFormatter
+{
+public:
+  /// Length of a timestamp with nanoseconds
+  enum { MAX_LENGTH = 27 };
+
+  UtcTimeStampFormatter();
+
+  /// Writes value with precision digits of the second at buffer, returns the end
+  char* format( char* buffer, const UtcTimeStamp& value, int precision );
+  std::string format( const UtcTimeStamp& value, int precision );
+  void append( std::string& result, const UtcTimeStamp& value, int precision );
+
+private:
+  int m_date;
+  int64_t m_second;
+  char m_prefix[ 17 ];
+};
+}
+
+#endif //FIX_UTCTIMESTAMPFORMATTER_H
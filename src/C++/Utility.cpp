@@ -29,6 +29,16 @@
 #include <stropts.h>
 #include <sys/conf.h>
 #endif
+#if defined(__linux__)
+#include <sched.h>
+#include <linux/sockios.h>
+#endif
+#ifdef _MSC_VER
+#include <io.h>
+#else
+#include <sys/wait.h>
+#include <dirent.h>
+#endif
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
@@ -172,6 +182,56 @@ ssize_t socket_recv( int s, char* buf, size_t length )
   return recv( s, buf, length, 0 );
 }
 
+ssize_t socket_recv( int s, char* buf, size_t length, int64_t& timestamp )
+{
+  timestamp = 0;
+#if !defined(_MSC_VER) && ( defined(SO_TIMESTAMPNS) || defined(SO_TIMESTAMP) )
+  iovec iov;
+  iov.iov_base = buf;
+  iov.iov_len = length;
+
+  union
+  {
+    cmsghdr align;
+    char buffer[ CMSG_SPACE(sizeof(timespec)) + CMSG_SPACE(sizeof(timeval)) ];
+  } control;
+
+  msghdr msg;
+  memset( &msg, 0, sizeof(msg) );
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buffer;
+  msg.msg_controllen = sizeof(control.buffer);
+
+  ssize_t result = recvmsg( s, &msg, 0 );
+  if( result <= 0 ) return result;
+
+  for( cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c) )
+  {
+    if( c->cmsg_level != SOL_SOCKET ) continue;
+#ifdef SCM_TIMESTAMPNS
+    if( c->cmsg_type == SCM_TIMESTAMPNS )
+    {
+      timespec ts;
+      memcpy( &ts, CMSG_DATA(c), sizeof(ts) );
+      timestamp = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    }
+#endif
+#ifdef SCM_TIMESTAMP
+    if( c->cmsg_type == SCM_TIMESTAMP )
+    {
+      timeval tv;
+      memcpy( &tv, CMSG_DATA(c), sizeof(tv) );
+      timestamp = (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+    }
+#endif
+  }
+  return result;
+#else
+  return recv( s, buf, length, 0 );
+#endif
+}
+
 ssize_t socket_send( int s, const char* msg, size_t length )
 {
   return send( s, msg, length, 0 );
@@ -261,7 +321,7 @@ int socket_setfcntlflag( int s, int arg )
 {
   int oldValue = socket_getfcntlflag( s, arg );
   oldValue |= arg;
-  return socket_fcntl( s, F_SETFL, arg );
+  return socket_fcntl( s, F_SETFL, oldValue );
 }
 #endif
 
@@ -274,6 +334,38 @@ void socket_setnonblock( int socket )
   socket_setfcntlflag( socket, O_NONBLOCK );
 #endif
 }
+
+bool socket_settimestamping( int s )
+{
+#if defined(_MSC_VER)
+  return false;
+#elif defined(SO_TIMESTAMPNS)
+  return socket_setsockopt( s, SO_TIMESTAMPNS ) == 0;
+#elif defined(SO_TIMESTAMP)
+  return socket_setsockopt( s, SO_TIMESTAMP ) == 0;
+#else
+  return false;
+#endif
+}
+
+bool socket_wouldblock()
+{
+#ifdef _MSC_VER
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+size_t socket_pending_send( int s )
+{
+#if defined(SIOCOUTQ)
+  int pending = 0;
+  if( ioctl( s, SIOCOUTQ, &pending ) == 0 && pending > 0 )
+    return pending;
+#endif
+  return 0;
+}
 bool socket_isValid( int socket )
 {
 #ifdef _MSC_VER
@@ -413,6 +505,21 @@ tm time_localtime( const time_t* t)
 #endif
 }
 
+int64_t time_monotonic()
+{
+#ifdef _MSC_VER
+  return (int64_t)GetTickCount64() * 1000000;
+#elif defined(CLOCK_MONOTONIC)
+  timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  timeval tv;
+  gettimeofday( &tv, 0 );
+  return (int64_t)tv.tv_sec * 1000000000 + (int64_t)tv.tv_usec * 1000;
+#endif
+}
+
 bool thread_spawn( THREAD_START_ROUTINE func, void* var, thread_id& thread )
 {
 #ifdef _MSC_VER
@@ -463,6 +570,37 @@ thread_id thread_self()
 #endif
 }
 
+bool thread_setaffinity( int cpu )
+{
+  if( cpu < 0 ) return false;
+#ifdef _MSC_VER
+  if( cpu >= (int)(sizeof(DWORD_PTR) * 8) ) return false;
+  return SetThreadAffinityMask( GetCurrentThread(), (DWORD_PTR)1 << cpu ) != 0;
+#elif defined(__linux__)
+  if( cpu >= CPU_SETSIZE ) return false;
+  cpu_set_t set;
+  CPU_ZERO( &set );
+  CPU_SET( cpu, &set );
+  return pthread_setaffinity_np( pthread_self(), sizeof(set), &set ) == 0;
+#else
+  return false;
+#endif
+}
+
+int thread_concurrency()
+{
+#ifdef _MSC_VER
+  SYSTEM_INFO info;
+  GetSystemInfo( &info );
+  return info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+  long count = sysconf( _SC_NPROCESSORS_ONLN );
+  return count > 0 ? (int)count : 1;
+#else
+  return 1;
+#endif
+}
+
 void process_sleep( double s )
 {
 #ifdef _MSC_VER
@@ -477,6 +615,86 @@ void process_sleep( double s )
 #endif
 }
 
+#ifdef _MSC_VER
+static std::string process_quote( const std::string& arg )
+{
+  if( arg.size() && arg.find_first_of( " \t\"" ) == std::string::npos )
+    return arg;
+
+  // backslashes are only special in front of a quote
+  std::string result = "\"";
+  std::string::size_type backslashes = 0;
+  std::string::const_iterator i;
+  for( i = arg.begin(); i != arg.end(); ++i )
+  {
+    if( *i == '\\' )
+    {
+      ++backslashes;
+      continue;
+    }
+    if( *i == '"' )
+      backslashes = backslashes * 2 + 1;
+    result.append( backslashes, '\\' );
+    result += *i;
+    backslashes = 0;
+  }
+  result.append( backslashes * 2, '\\' );
+  return result + "\"";
+}
+#endif
+
+int process_run( const std::vector < std::string > & args )
+{
+  if( args.empty() ) return -1;
+#ifdef _MSC_VER
+  std::string commandLine;
+  std::vector < std::string > ::const_iterator i;
+  for( i = args.begin(); i != args.end(); ++i )
+  {
+    if( i != args.begin() ) commandLine += ' ';
+    commandLine += process_quote( *i );
+  }
+  std::vector < char > buffer( commandLine.begin(), commandLine.end() );
+  buffer.push_back( 0 );
+
+  STARTUPINFOA startup;
+  ZeroMemory( &startup, sizeof( startup ) );
+  startup.cb = sizeof( startup );
+  PROCESS_INFORMATION info;
+  if( !CreateProcessA( 0, &buffer[ 0 ], 0, 0, FALSE, 0, 0, 0, &startup, &info ) )
+    return -1;
+
+  WaitForSingleObject( info.hProcess, INFINITE );
+  DWORD code = 0;
+  int result = GetExitCodeProcess( info.hProcess, &code ) ? (int)code : -1;
+  CloseHandle( info.hThread );
+  CloseHandle( info.hProcess );
+  return result;
+#else
+  // the child may only exec, so everything is prepared before the fork
+  std::vector < char* > argv;
+  std::vector < std::string > ::const_iterator i;
+  for( i = args.begin(); i != args.end(); ++i )
+    argv.push_back( const_cast < char* > ( i->c_str() ) );
+  argv.push_back( 0 );
+
+  pid_t pid = fork();
+  if( pid < 0 ) return -1;
+  if( pid == 0 )
+  {
+    execvp( argv[ 0 ], &argv[ 0 ] );
+    _exit( 127 );
+  }
+
+  int status = 0;
+  while( waitpid( pid, &status, 0 ) < 0 )
+  {
+    if( errno != EINTR ) return -1;
+  }
+  return WIFEXITED( status ) ? WEXITSTATUS( status ) : -1;
+#endif
+}
+
 std::string file_separator()
 {
 #ifdef _MSC_VER
@@ -522,6 +740,49 @@ void file_fclose( FILE* file )
   fclose( file );
 }
 
+bool file_sync( FILE* file )
+{
+  if( fflush( file ) ) return false;
+#ifdef _MSC_VER
+  return _commit( _fileno( file ) ) == 0;
+#elif defined(__APPLE__)
+  return fsync( fileno( file ) ) == 0;
+#else
+  return fdatasync( fileno( file ) ) == 0;
+#endif
+}
+
+int file_seek( FILE* file, int64_t offset, int origin )
+{
+#ifdef _MSC_VER
+  return _fseeki64( file, offset, origin );
+#else
+  // an offset that does not fit in off_t would seek somewhere else
+  if( (int64_t)(off_t)offset != offset ) return -1;
+  return fseeko( file, (off_t)offset, origin );
+#endif
+}
+
+int64_t file_tell( FILE* file )
+{
+#ifdef _MSC_VER
+  return _ftelli64( file );
+#else
+  return (int64_t)ftello( file );
+#endif
+}
+
+bool file_truncate( FILE* file, int64_t size )
+{
+  if( fflush( file ) ) return false;
+#ifdef _MSC_VER
+  return _chsize_s( _fileno( file ), size ) == 0;
+#else
+  if( (int64_t)(off_t)size != size ) return false;
+  return ftruncate( fileno( file ), (off_t)size ) == 0;
+#endif
+}
+
 bool file_exists( const char* path )
 {
   std::ifstream stream;
@@ -543,6 +804,29 @@ void file_unlink( const char* path )
 #endif
 }
 
+bool file_list( const char* path, std::vector < std::string > & names )
+{
+  names.clear();
+#ifdef _MSC_VER
+  WIN32_FIND_DATAA data;
+  std::string pattern = file_appendpath( path, "*" );
+  HANDLE find = FindFirstFileA( pattern.c_str(), &data );
+  if( find == INVALID_HANDLE_VALUE ) return false;
+  do
+  {
+    names.push_back( data.cFileName );
+  } while( FindNextFileA( find, &data ) );
+  FindClose( find );
+#else
+  DIR* dir = opendir( path );
+  if( !dir ) return false;
+  while( dirent* entry = readdir( dir ) )
+    names.push_back( entry->d_name );
+  closedir( dir );
+#endif
+  return true;
+}
+
 int file_rename( const char* oldpath, const char* newpath )
 {
   return rename( oldpath, newpath );
@@ -93,7 +93,14 @@ typedef int ssize_t;
 /////////////////////////////////////////////
 #endif
 
+#if defined(_MSC_VER) && (_MSC_VER < 1600)
+ #include "stdint_msvc.h"
+#else
+ #include <stdint.h>
+#endif
+
 #include <string>
+#include <vector>
 #include <cstring>
 #include <cctype>
 #include <ctime>
@@ -141,6 +148,7 @@ int socket_createConnector();
 int socket_connect( int s, const char* address, int port );
 int socket_accept( int s );
 ssize_t socket_recv( int s, char* buf, size_t length );
+ssize_t socket_recv( int s, char* buf, size_t length, int64_t& timestamp );
 ssize_t socket_send( int s, const char* msg, size_t length );
 void socket_close( int s );
 bool socket_fionread( int s, int& bytes );
@@ -154,6 +162,9 @@ int socket_getfcntlflag( int s, int arg );
 int socket_setfcntlflag( int s, int arg );
 #endif
 void socket_setnonblock( int s );
+bool socket_wouldblock();
+size_t socket_pending_send( int s );
+bool socket_settimestamping( int s );
 bool socket_isValid( int socket );
 #ifndef _MSC_VER
 bool socket_isBad( int s );
@@ -167,6 +178,7 @@ std::pair<int, int> socket_createpair();
 
 tm time_gmtime( const time_t* t );
 tm time_localtime( const time_t* t );
+int64_t time_monotonic();
 
 #if(_MSC_VER >= 1900)
 typedef _beginthreadex_proc_type THREAD_START_ROUTINE;
@@ -190,15 +202,25 @@ bool thread_spawn( THREAD_START_ROUTINE func, void* var );
 void thread_join( thread_id thread );
 void thread_detach( thread_id thread );
 thread_id thread_self();
+bool thread_setaffinity( int cpu );
+int thread_concurrency();
 
 void process_sleep( double s );
+/// Runs args[0] with the arguments without a shell, returns its exit code or -1
+int process_run( const std::vector < std::string > & args );
 
 std::string file_separator();
 void file_mkdir( const char* path );
 FILE* file_fopen( const char* path, const char* mode );
 void file_fclose( FILE* file );
+bool file_sync( FILE* file );
+int file_seek( FILE* file, int64_t offset, int origin );
+int64_t file_tell( FILE* file );
+bool file_truncate( FILE* file, int64_t size );
 bool file_exists( const char* path );
 void file_unlink( const char* path );
+/// Names of the entries in the directory path
+bool file_list( const char* path, std::vector < std::string > & names );
 int file_rename( const char* oldpath, const char* newpath );
 std::string file_appendpath( const std::string& path, const std::string& file );
 }
@@ -0,0 +1,218 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <AsyncStore.h>
+#include <AtomicCount.h>
+#include "MessageStoreTestCase.h"
+
+using namespace FIX;
+
+SUITE(AsyncStoreTests)
+{
+
+class FailingStore : public MemoryStore
+{
+public:
+  FailingStore() : failures( 0 ) {}
+
+  bool set( int msgSeqNum, const std::string& msg ) throw ( IOException )
+  {
+    if( failures > 0 )
+    {
+      --failures;
+      throw IOException( "set failed" );
+    }
+    return MemoryStore::set( msgSeqNum, msg );
+  }
+
+  /// Number of sets still to fail
+  atomic_count failures;
+};
+
+/// Keeps the stores alive after destroy so tests can look at them
+class FailingStoreFactory : public MessageStoreFactory
+{
+public:
+  ~FailingStoreFactory()
+  {
+    for( size_t i = 0; i < stores.size(); ++i )
+      delete stores[ i ];
+  }
+
+  MessageStore* create( const SessionID& )
+  {
+    stores.push_back( new FailingStore );
+    return stores.back();
+  }
+  void destroy( MessageStore* ) {}
+
+  std::vector < FailingStore* > stores;
+};
+
+struct asyncStoreFixture
+{
+  asyncStoreFixture()
+  : factory( failingFactory )
+  {
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+
+    object = factory.create( sessionID );
+    store = failingFactory.stores.back();
+  }
+
+  ~asyncStoreFixture()
+  {
+    if( object ) factory.destroy( object );
+  }
+
+  FailingStoreFactory failingFactory;
+  AsyncStoreFactory factory;
+  MessageStore* object;
+  FailingStore* store;
+};
+
+TEST_FIXTURE(asyncStoreFixture, setGet)
+{
+  CHECK_MESSAGE_STORE_SET_GET;
+}
+
+TEST_FIXTURE(asyncStoreFixture, setGetWithQuote)
+{
+  CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
+}
+
+TEST_FIXTURE(asyncStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
+TEST_FIXTURE(asyncStoreFixture, other)
+{
+  CHECK_MESSAGE_STORE_OTHER
+}
+
+TEST_FIXTURE(asyncStoreFixture, writesOnFlush)
+{
+  for( int i = 1; i <= 100; ++i )
+  {
+    object->set( i, "message" + IntConvertor::convert( i ) );
+    object->incrNextSenderMsgSeqNum();
+  }
+  object->setNextTargetMsgSeqNum( 20 );
+  factory.flush();
+
+  CHECK_EQUAL( 0, static_cast < AsyncStore* > ( object )->getPending() );
+  CHECK_EQUAL( 101, store->getNextSenderMsgSeqNum() );
+  CHECK_EQUAL( 20, store->getNextTargetMsgSeqNum() );
+  std::vector < std::string > messages;
+  store->get( 1, 100, messages );
+  CHECK_EQUAL( 100U, messages.size() );
+  CHECK_EQUAL( "message100", messages.back() );
+}
+
+TEST_FIXTURE(asyncStoreFixture, readsUnwrittenMessages)
+{
+  object->set( 1, "one" );
+  object->set( 2, "two" );
+  object->set( 3, "three" );
+  object->flush();
+
+  // whoever writes first fails, the message stays readable until retried
+  ++store->failures;
+  object->set( 2, "replaced" );
+  object->incrNextSenderMsgSeqNum();
+  CHECK_EQUAL( 1, static_cast < AsyncStore* > ( object )->getPending() );
+  CHECK_EQUAL( 2, object->getNextSenderMsgSeqNum() );
+
+  std::vector < std::string > messages;
+  object->get( 1, 4, messages );
+  CHECK_EQUAL( 3U, messages.size() );
+  CHECK_EQUAL( "one", messages[ 0 ] );
+  CHECK_EQUAL( "replaced", messages[ 1 ] );
+  CHECK_EQUAL( "three", messages[ 2 ] );
+
+  MessageStoreRangeRecorder recorder( 2 );
+  object->getRange( 1, 4, recorder );
+  CHECK_EQUAL( 2U, recorder.messages.size() );
+  CHECK_EQUAL( "replaced", recorder.messages[ 1 ] );
+
+  CHECK_THROW( object->flush(), IOException );
+  object->set( 4, "four" );
+  object->flush();
+  CHECK_EQUAL( 0, static_cast < AsyncStore* > ( object )->getPending() );
+  CHECK_EQUAL( 2, store->getNextSenderMsgSeqNum() );
+  store->get( 1, 4, messages );
+  CHECK_EQUAL( 4U, messages.size() );
+  CHECK_EQUAL( "replaced", messages[ 1 ] );
+  CHECK_EQUAL( "four", messages[ 3 ] );
+}
+
+TEST_FIXTURE(asyncStoreFixture, resetDropsUnwrittenMessages)
+{
+  ++store->failures;
+  object->set( 1, "one" );
+  object->incrNextSenderMsgSeqNum();
+
+  object->reset();
+  CHECK_EQUAL( 0, static_cast < AsyncStore* > ( object )->getPending() );
+  CHECK_EQUAL( 1, object->getNextSenderMsgSeqNum() );
+  object->flush();
+
+  std::vector < std::string > messages;
+  object->get( 1, 1, messages );
+  CHECK_EQUAL( 0U, messages.size() );
+  CHECK_EQUAL( 1, store->getNextSenderMsgSeqNum() );
+}
+
+TEST_FIXTURE(asyncStoreFixture, destroyWritesQueuedChanges)
+{
+  for( int i = 1; i <= 100; ++i )
+    object->set( i, "message" );
+  object->setNextSenderMsgSeqNum( 101 );
+
+  factory.destroy( object );
+  object = 0;
+
+  std::vector < std::string > messages;
+  store->get( 1, 100, messages );
+  CHECK_EQUAL( 100U, messages.size() );
+  CHECK_EQUAL( 101, store->getNextSenderMsgSeqNum() );
+}
+
+TEST_FIXTURE(asyncStoreFixture, writesOnCallerAfterStop)
+{
+  factory.stop();
+  object->set( 1, "one" );
+  object->incrNextSenderMsgSeqNum();
+
+  std::vector < std::string > messages;
+  store->get( 1, 1, messages );
+  CHECK_EQUAL( 1U, messages.size() );
+  CHECK_EQUAL( 2, store->getNextSenderMsgSeqNum() );
+}
+
+}
@@ -0,0 +1,178 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <BinaryLog.h>
+#include <Utility.h>
+#include <stdio.h>
+
+using namespace FIX;
+
+SUITE(BinaryLogTests)
+{
+
+struct binaryLogFixture
+{
+  binaryLogFixture()
+  {
+    file_unlink( "log/binary/messages.binlog" );
+    factory = new BinaryLogFactory( "log/binary" );
+  }
+
+  ~binaryLogFixture()
+  {
+    delete factory;
+    file_unlink( "log/binary/messages.binlog" );
+  }
+
+  BinaryLogFactory* factory;
+};
+
+TEST_FIXTURE(binaryLogFixture, readsBackEntries)
+{
+  SessionID sessionID1( BeginString( "FIX.4.2" ),
+                        SenderCompID( "BINARY" ), TargetCompID( "TEST1" ) );
+  SessionID sessionID2( BeginString( "FIX.4.2" ),
+                        SenderCompID( "BINARY" ), TargetCompID( "TEST2" ) );
+
+  UtcTimeStamp before;
+  Log* log1 = factory->create( sessionID1 );
+  Log* log2 = factory->create( sessionID2 );
+  log1->onIncoming( "8=FIX.4.2\0019=5\00135=A\00110=000\001" );
+  log2->onOutgoing( "OUTGOING" );
+  log1->onEvent( "EVENT" );
+  log2->onIncoming( "" );
+  factory->destroy( log1 );
+  factory->destroy( log2 );
+  UtcTimeStamp after;
+
+  BinaryLogReader reader( "log/binary/messages.binlog" );
+  BinaryLogReader::Entry entry;
+
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "FIX.4.2-BINARY-TEST1", entry.m_session );
+  CHECK_EQUAL( BinaryLogFile::INCOMING, entry.m_type );
+  CHECK_EQUAL( "8=FIX.4.2\0019=5\00135=A\00110=000\001", entry.m_value );
+  CHECK( !( entry.m_time < before ) );
+  CHECK( !( after < entry.m_time ) );
+
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "FIX.4.2-BINARY-TEST2", entry.m_session );
+  CHECK_EQUAL( BinaryLogFile::OUTGOING, entry.m_type );
+  CHECK_EQUAL( "OUTGOING", entry.m_value );
+
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "FIX.4.2-BINARY-TEST1", entry.m_session );
+  CHECK_EQUAL( BinaryLogFile::EVENT, entry.m_type );
+  CHECK_EQUAL( "EVENT", entry.m_value );
+
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "FIX.4.2-BINARY-TEST2", entry.m_session );
+  CHECK_EQUAL( "", entry.m_value );
+
+  CHECK( !reader.next( entry ) );
+}
+
+TEST_FIXTURE(binaryLogFixture, ignoresPartialEntry)
+{
+  Log* log = factory->create();
+  log->onIncoming( "INCOMING1" );
+  log->onIncoming( "INCOMING2" );
+  factory->destroy( log );
+  delete factory;
+  factory = 0;
+
+  FILE* file = file_fopen( "log/binary/messages.binlog", "r+b" );
+  fseek( file, -3, SEEK_END );
+  fwrite( "X", 1, 1, file );
+  fclose( file );
+  file = file_fopen( "log/binary/messages.binlog", "ab" );
+  fwrite( "\x20\x00", 1, 2, file );
+  fclose( file );
+
+  BinaryLogReader reader( "log/binary/messages.binlog" );
+  BinaryLogReader::Entry entry;
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "GLOBAL", entry.m_session );
+  CHECK_EQUAL( "INCOMING1", entry.m_value );
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "INCOMIXG2", entry.m_value );
+  CHECK( !reader.next( entry ) );
+}
+
+TEST_FIXTURE(binaryLogFixture, truncatesTornEntry)
+{
+  Log* log = factory->create();
+  log->onIncoming( "INCOMING1" );
+  log->onIncoming( "INCOMING2" );
+  factory->destroy( log );
+  delete factory;
+  factory = 0;
+
+  // a crash part way through an entry with a huge length
+  BinaryLogFile::Header header = { 0xFFFFFFF0, 0, BinaryLogFile::INCOMING, 0, 0 };
+  FILE* file = file_fopen( "log/binary/messages.binlog", "ab" );
+  fwrite( &header, sizeof(header), 1, file );
+  fwrite( "TORN", 1, 4, file );
+  fclose( file );
+
+  {
+    BinaryLogReader reader( "log/binary/messages.binlog" );
+    BinaryLogReader::Entry entry;
+    CHECK( reader.next( entry ) );
+    CHECK( reader.next( entry ) );
+    CHECK_EQUAL( "INCOMING2", entry.m_value );
+    CHECK( !reader.next( entry ) );
+  }
+
+  factory = new BinaryLogFactory( "log/binary" );
+  log = factory->create();
+  log->onIncoming( "INCOMING3" );
+  factory->destroy( log );
+
+  BinaryLogReader reader( "log/binary/messages.binlog" );
+  BinaryLogReader::Entry entry;
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "INCOMING1", entry.m_value );
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "INCOMING2", entry.m_value );
+  CHECK( reader.next( entry ) );
+  CHECK_EQUAL( "GLOBAL", entry.m_session );
+  CHECK_EQUAL( "INCOMING3", entry.m_value );
+  CHECK( !reader.next( entry ) );
+}
+
+TEST(rejectsOtherFiles)
+{
+  file_mkdir( "log" );
+  FILE* file = file_fopen( "log/notbinary.log", "wb" );
+  fwrite( "NOT A BINARY LOG", 1, 16, file );
+  fclose( file );
+  CHECK_THROW( BinaryLogReader( "log/notbinary.log" ), ConfigError );
+  file_unlink( "log/notbinary.log" );
+}
+
+}
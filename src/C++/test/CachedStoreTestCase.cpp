@@ -0,0 +1,150 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <CachedStore.h>
+#include "MessageStoreTestCase.h"
+
+using namespace FIX;
+
+SUITE(CachedStoreTests)
+{
+
+struct cachedStoreFixture
+{
+  cachedStoreFixture( size_t messages = 100, size_t bytes = 4096 )
+  : factory( memoryFactory, messages, bytes )
+  {
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+
+    object = factory.create( sessionID );
+  }
+
+  ~cachedStoreFixture()
+  {
+    factory.destroy( object );
+  }
+
+  MemoryStoreFactory memoryFactory;
+  CachedStoreFactory factory;
+  MessageStore* object;
+};
+
+struct smallCachedStoreFixture : cachedStoreFixture
+{
+  smallCachedStoreFixture() : cachedStoreFixture( 100, 1000 ) {}
+};
+
+std::string createMessage( int i )
+{
+  return std::string( 10 + i % 40, (char)( 'a' + i % 26 ) );
+}
+
+TEST_FIXTURE(cachedStoreFixture, setGet)
+{
+  CHECK_MESSAGE_STORE_SET_GET;
+}
+
+TEST_FIXTURE(cachedStoreFixture, setGetWithQuote)
+{
+  CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
+}
+
+TEST_FIXTURE(cachedStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
+TEST_FIXTURE(cachedStoreFixture, other)
+{
+  CHECK_MESSAGE_STORE_OTHER
+}
+
+TEST_FIXTURE(cachedStoreFixture, keepsMostRecentMessages)
+{
+  for( int i = 1; i <= 300; ++i )
+    object->set( i, createMessage( i ) );
+
+  std::vector < std::string > messages;
+  object->get( 201, 300, messages );
+  CHECK_EQUAL( 100U, messages.size() );
+  CHECK_EQUAL( createMessage( 201 ), messages.front() );
+  CHECK_EQUAL( createMessage( 300 ), messages.back() );
+  object->get( 250, 400, messages );
+  CHECK_EQUAL( 51U, messages.size() );
+  CHECK_EQUAL( 2, factory.getHits() );
+  CHECK_EQUAL( 0, factory.getMisses() );
+
+  // older messages come from the wrapped store
+  object->get( 1, 300, messages );
+  CHECK_EQUAL( 300U, messages.size() );
+  CHECK_EQUAL( createMessage( 1 ), messages.front() );
+  CHECK_EQUAL( 1, factory.getMisses() );
+
+  object->reset();
+  object->get( 1, 300, messages );
+  CHECK_EQUAL( 0U, messages.size() );
+  CHECK_EQUAL( 2, factory.getMisses() );
+}
+
+TEST_FIXTURE(smallCachedStoreFixture, wrapsAroundByteLimit)
+{
+  // messages of 10 to 49 bytes only partly fit in 1000 bytes
+  for( int i = 1; i <= 500; ++i )
+  {
+    object->set( i, createMessage( i ) );
+
+    MessageStoreRangeRecorder recorder;
+    object->getRange( i - 20, i, recorder );
+    CHECK_EQUAL( (size_t)std::min( i, 21 ), recorder.messages.size() );
+    for( size_t j = 0; j < recorder.messages.size(); ++j )
+      CHECK_EQUAL( createMessage( recorder.msgSeqNums[ j ] ), recorder.messages[ j ] );
+  }
+  CHECK( factory.getHits() > 400 );
+  CHECK( factory.getMisses() > 0 );
+}
+
+TEST_FIXTURE(cachedStoreFixture, restartsOnSequenceGap)
+{
+  for( int i = 1; i <= 10; ++i )
+    object->set( i, createMessage( i ) );
+
+  // a replaced message must not be served from the old run
+  object->set( 5, "replaced" );
+  std::vector < std::string > messages;
+  object->get( 5, 10, messages );
+  CHECK_EQUAL( 6U, messages.size() );
+  CHECK_EQUAL( "replaced", messages.front() );
+  CHECK_EQUAL( createMessage( 10 ), messages.back() );
+  CHECK_EQUAL( 1, factory.getMisses() );
+
+  object->get( 5, 5, messages );
+  CHECK_EQUAL( 1U, messages.size() );
+  CHECK_EQUAL( 1, factory.getHits() );
+}
+
+}
@@ -0,0 +1,58 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <Clock.h>
+
+using namespace FIX;
+
+SUITE(ClockTests)
+{
+
+TEST(systemUtcTime)
+{
+  UtcTimeStamp before;
+  UtcTimeStamp now = Clock::getSystem().getUtcTime();
+  UtcTimeStamp after;
+
+  CHECK( labs( now - before ) <= 1 );
+  CHECK( labs( after - now ) <= 1 );
+  CHECK( now.getJulianDate() - before.getJulianDate() <= 1 );
+  CHECK( now.getNanosecond() < DateTime::NANOS_PER_SEC );
+}
+
+TEST(systemMonotonic)
+{
+  Clock& clock = Clock::getSystem();
+  int64_t first = clock.getMonotonic();
+  process_sleep( 0.05 );
+  int64_t second = clock.getMonotonic();
+
+  CHECK( second > first );
+  CHECK( second - first < 10 * DateTime::NANOS_PER_SEC );
+}
+
+}
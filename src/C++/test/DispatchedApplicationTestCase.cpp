@@ -0,0 +1,135 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <DispatchedApplication.h>
+#include <Values.h>
+#include <map>
+#include <vector>
+
+using namespace FIX;
+
+SUITE(DispatchedApplicationTests)
+{
+
+class RecordingApplication : public NullApplication
+{
+public:
+  RecordingApplication() : logons( 0 ), logouts( 0 ) {}
+
+  void onLogon( const SessionID& )
+  { Locker l( mutex ); logons++; }
+  void onLogout( const SessionID& )
+  { Locker l( mutex ); logouts++; }
+
+  void fromApp( const Message& message, const SessionID& sessionID )
+  throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType )
+  {
+    MsgSeqNum msgSeqNum;
+    message.getHeader().getField( msgSeqNum );
+    Locker l( mutex );
+    received[ sessionID ].push_back( msgSeqNum );
+    threads[ sessionID ].push_back( thread_self() );
+  }
+
+  std::map < SessionID, std::vector < int > > received;
+  std::map < SessionID, std::vector < thread_id > > threads;
+  int logons;
+  int logouts;
+  Mutex mutex;
+};
+
+Message createMessage( int seq )
+{
+  Message message;
+  message.getHeader().setField( MsgType( MsgType_NewOrderSingle ) );
+  message.getHeader().setField( MsgSeqNum( seq ) );
+  return message;
+}
+
+TEST(deliversInOrderPerSession)
+{
+  RecordingApplication recorder;
+  SessionID session1( BeginString_FIX42, "SENDER", "TARGET1" );
+  SessionID session2( BeginString_FIX42, "SENDER", "TARGET2" );
+
+  DispatchedApplication object( recorder, 4 );
+  CHECK_EQUAL( 4, object.getThreads() );
+
+  object.onCreate( session1 );
+  object.onCreate( session2 );
+  object.onLogon( session1 );
+  object.onLogon( session2 );
+  for( int i = 1; i <= 1000; ++i )
+  {
+    object.fromApp( createMessage( i ), session1 );
+    object.fromApp( createMessage( i ), session2 );
+  }
+  object.onLogout( session1 );
+  object.stop();
+
+  CHECK_EQUAL( 2, recorder.logons );
+  CHECK_EQUAL( 1, recorder.logouts );
+  CHECK_EQUAL( 1000, (int)recorder.received[ session1 ].size() );
+  CHECK_EQUAL( 1000, (int)recorder.received[ session2 ].size() );
+
+  for( int i = 0; i < 1000; ++i )
+  {
+    CHECK_EQUAL( i + 1, recorder.received[ session1 ][ i ] );
+    CHECK_EQUAL( i + 1, recorder.received[ session2 ][ i ] );
+    CHECK( recorder.threads[ session1 ][ i ] != thread_self() );
+  }
+}
+
+TEST(deliversOnCallerAfterStop)
+{
+  RecordingApplication recorder;
+  SessionID sessionID( BeginString_FIX42, "SENDER", "TARGET" );
+
+  DispatchedApplication object( recorder, 1 );
+  object.stop();
+  CHECK_EQUAL( 0, object.getThreads() );
+
+  object.fromApp( createMessage( 1 ), sessionID );
+  CHECK_EQUAL( 1, (int)recorder.received[ sessionID ].size() );
+  CHECK( recorder.threads[ sessionID ][ 0 ] == thread_self() );
+}
+
+TEST(swallowsApplicationExceptions)
+{
+  RecordingApplication recorder;
+  SessionID sessionID( BeginString_FIX42, "SENDER", "TARGET" );
+
+  DispatchedApplication object( recorder, 1 );
+  object.fromApp( Message(), sessionID );
+  object.fromApp( createMessage( 2 ), sessionID );
+  object.stop();
+
+  CHECK_EQUAL( 1, (int)recorder.received[ sessionID ].size() );
+  CHECK_EQUAL( 2, recorder.received[ sessionID ][ 0 ] );
+}
+
+}
@@ -0,0 +1,92 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <Event.h>
+#include <Clock.h>
+#include <FieldTypes.h>
+
+using namespace FIX;
+
+SUITE(EventTests)
+{
+
+static double elapsed( int64_t start )
+{
+  return (double)( Clock::getSystem().getMonotonic() - start )
+         / DateTime::NANOS_PER_SEC;
+}
+
+static THREAD_PROC signalLater( void* p )
+{
+  process_sleep( 0.1 );
+  static_cast < Event* > ( p )->signal();
+  return 0;
+}
+
+TEST(waitTimesOut)
+{
+  Event object;
+  int64_t start = Clock::getSystem().getMonotonic();
+  object.wait( 0.2 );
+  CHECK( elapsed( start ) >= 0.15 );
+  CHECK( elapsed( start ) < 5 );
+}
+
+TEST(signalBeforeWaitIsKept)
+{
+  Event object;
+  object.signal();
+  int64_t start = Clock::getSystem().getMonotonic();
+  object.wait( 10 );
+  CHECK( elapsed( start ) < 5 );
+}
+
+TEST(waitResetsSignal)
+{
+  Event object;
+  object.signal();
+  object.signal();
+  object.wait( 10 );
+
+  int64_t start = Clock::getSystem().getMonotonic();
+  object.wait( 0.2 );
+  CHECK( elapsed( start ) >= 0.15 );
+}
+
+TEST(signalWakesWait)
+{
+  Event object;
+  thread_id thread;
+  int64_t start = Clock::getSystem().getMonotonic();
+  CHECK( thread_spawn( &signalLater, &object, thread ) );
+  object.wait( 10 );
+  CHECK( elapsed( start ) >= 0.05 );
+  CHECK( elapsed( start ) < 5 );
+  thread_join( thread );
+}
+
+}
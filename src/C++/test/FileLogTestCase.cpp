@@ -114,4 +114,201 @@ TEST_FIXTURE(generateFileNameFixture, generateFileName)
   CHECK( file_exists("log/backup/FIX.4.2-GENERATEFILENAME-TEST.event.backup.4.log") );
   CHECK( file_exists("log/backup/FIX.4.2-GENERATEFILENAME-TEST.messages.backup.4.log") );
 }
+
+std::vector < std::string > readLog( const std::string& fileName )
+{
+  std::vector < std::string > lines;
+  std::ifstream stream( fileName.c_str() );
+  std::string line;
+  while( std::getline( stream, line ) )
+    lines.push_back( line.substr( line.find( " : " ) + 3 ) );
+  return lines;
+}
+
+struct asyncFileLogFixture
+{
+  asyncFileLogFixture()
+  : sessionID( BeginString( "FIX.4.2" ),
+               SenderCompID( "ASYNC" ), TargetCompID( "TEST" ) )
+  {
+    deleteLogSession( "ASYNC", "TEST" );
+    object = new FileLog( "log", sessionID );
+  }
+
+  ~asyncFileLogFixture()
+  {
+    delete object;
+    deleteLogSession( "ASYNC", "TEST" );
+  }
+
+  std::vector < std::string > messages()
+  {
+    return readLog( "log/FIX.4.2-ASYNC-TEST.messages.current.log" );
+  }
+
+  SessionID sessionID;
+  FileLog* object;
+};
+
+TEST_FIXTURE(asyncFileLogFixture, asyncWritesInBackground)
+{
+  FileLogWriter writer( 10 );
+  writer.start();
+  object->setAsync( &writer, 4096 );
+
+  for( int i = 0; i < 100; ++i )
+    object->onIncoming( "MESSAGE" + IntConvertor::convert( i ) );
+  object->onEvent( "EVENT" );
+
+  // the writer gets to it without being asked
+  for( int i = 0; i < 500 && messages().size() < 100; ++i )
+    process_sleep( 0.01 );
+
+  std::vector < std::string > lines = messages();
+  CHECK_EQUAL( 100U, lines.size() );
+  if( lines.size() == 100 )
+  {
+    CHECK_EQUAL( "MESSAGE0", lines[ 0 ] );
+    CHECK_EQUAL( "MESSAGE99", lines[ 99 ] );
+  }
+
+  object->flush();
+  lines = readLog( "log/FIX.4.2-ASYNC-TEST.event.current.log" );
+  CHECK_EQUAL( 1U, lines.size() );
+
+  delete object;
+  object = 0;
+}
+
+TEST_FIXTURE(asyncFileLogFixture, asyncOverflow)
+{
+  // the writer is never started, only full buffers and flush write
+  FileLogWriter writer;
+
+  object->setAsync( &writer, 256, FileLog::OVERFLOW_BLOCK );
+  for( int i = 0; i < 50; ++i )
+    object->onOutgoing( "BLOCK" + IntConvertor::convert( i ) );
+  CHECK( messages().size() > 0 );
+  object->flush();
+  CHECK_EQUAL( 50U, messages().size() );
+
+  object->setAsync( &writer, 256, FileLog::OVERFLOW_SPILL );
+  for( int i = 0; i < 50; ++i )
+    object->onOutgoing( "SPILL" + IntConvertor::convert( i ) );
+  CHECK_EQUAL( 50U, messages().size() );
+  object->flush();
+  CHECK_EQUAL( 100U, messages().size() );
+
+  object->setAsync( &writer, 256, FileLog::OVERFLOW_DROP );
+  for( int i = 0; i < 50; ++i )
+    object->onOutgoing( "DROP" + IntConvertor::convert( i ) );
+  CHECK( object->getDropped() > 0 );
+  object->flush();
+  CHECK_EQUAL( (size_t)( 150 - object->getDropped() ), messages().size() );
+  CHECK_EQUAL( "DROP0", messages()[ 100 ] );
+
+  object->setAsync( 0 );
+  object->onOutgoing( "SYNC" );
+  CHECK_EQUAL( "SYNC", messages().back() );
+}
+
+#ifdef _MSC_VER
+#define REMOVE_COMMAND "cmd /c del"
+#else
+#define REMOVE_COMMAND "rm -f"
+#endif
+
+struct rotatingFileLogFixture
+{
+  rotatingFileLogFixture()
+  : sessionID( BeginString( "FIX.4.2" ),
+               SenderCompID( "ROTATE" ), TargetCompID( "TEST" ) ),
+    archiver( REMOVE_COMMAND )
+  {
+    deleteLogSession( "ROTATE", "TEST" );
+    object = new FileLog( "log", sessionID );
+  }
+
+  ~rotatingFileLogFixture()
+  {
+    delete object;
+    archiver.stop();
+    deleteLogSession( "ROTATE", "TEST" );
+  }
+
+  std::vector < std::string > messages()
+  {
+    return readLog( "log/FIX.4.2-ROTATE-TEST.messages.current.log" );
+  }
+
+  SessionID sessionID;
+  FileLogArchiver archiver;
+  FileLog* object;
+};
+
+TEST_FIXTURE(rotatingFileLogFixture, rotateBySize)
+{
+  object->setRotation( 100, 0, &archiver );
+  CHECK( file_exists( "log/FIX.4.2-ROTATE-TEST.messages.next.log" ) );
+
+  // each entry takes 32 bytes, every fourth one starts new files
+  for( int i = 0; i < 10; ++i )
+    object->onOutgoing( "ROTATE" + IntConvertor::convert( i ) );
+  CHECK_EQUAL( 2, object->getRotations() );
+  CHECK_EQUAL( 2U, messages().size() );
+  CHECK_EQUAL( "ROTATE8", messages()[ 0 ] );
+
+  delete object;
+  object = 0;
+  CHECK( !file_exists( "log/FIX.4.2-ROTATE-TEST.messages.next.log" ) );
+  CHECK( !file_exists( "log/FIX.4.2-ROTATE-TEST.event.next.log" ) );
+}
+
+TEST_FIXTURE(rotatingFileLogFixture, rotateByInterval)
+{
+  object->setRotation( 0, 1, &archiver );
+  object->onOutgoing( "BEFORE" );
+  process_sleep( 1.1 );
+  object->onOutgoing( "AFTER" );
+  CHECK_EQUAL( 1, object->getRotations() );
+  CHECK_EQUAL( 1U, messages().size() );
+  CHECK_EQUAL( "AFTER", messages()[ 0 ] );
+}
+
+TEST_FIXTURE(rotatingFileLogFixture, rotateAsync)
+{
+  FileLogWriter writer;
+  object->setAsync( &writer );
+  object->setRotation( 100, 0, &archiver );
+  for( int i = 0; i < 10; ++i )
+    object->onOutgoing( "ROTATE" + IntConvertor::convert( i ) );
+  object->flush();
+  CHECK_EQUAL( 1, object->getRotations() );
+  CHECK_EQUAL( 0U, messages().size() );
+
+  object->onOutgoing( "FIRST" );
+  object->rotate();
+  object->onOutgoing( "SECOND" );
+  object->flush();
+  CHECK_EQUAL( 2, object->getRotations() );
+  CHECK_EQUAL( 1U, messages().size() );
+  CHECK_EQUAL( "SECOND", messages()[ 0 ] );
+  object->setAsync( 0 );
+}
+
+#ifndef _MSC_VER
+TEST(archiverRunsWithoutShell)
+{
+  file_mkdir( "log" );
+  std::string file = "log/archive \"; touch log/injected; \".log";
+  { std::ofstream stream( file.c_str() ); }
+  file_unlink( "log/injected" );
+
+  FileLogArchiver archiver( " rm  -f " );
+  archiver.archive( file );
+  archiver.stop();
+  CHECK( !file_exists( file.c_str() ) );
+  CHECK( !file_exists( "log/injected" ) );
+}
+#endif
 }
@@ -28,6 +28,7 @@
 #include <TestHelper.h>
 #include <FileStore.h>
 #include "MessageStoreTestCase.h"
+#include <sstream>
 
 using namespace FIX;
 
@@ -88,6 +89,11 @@ TEST_FIXTURE(resetBeforeAndAfterFileStoreFixture, setGet)
   CHECK_MESSAGE_STORE_SET_GET;
 }
 
+TEST_FIXTURE(resetBeforeAndAfterFileStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
 TEST_FIXTURE(resetBeforeAndAfterFileStoreFixture, setGetWithQuote)
 {
   CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
@@ -108,4 +114,137 @@ TEST_FIXTURE(resetAfterFileStoreFixture, refresh)
   CHECK_MESSAGE_STORE_RELOAD
 }
 
+TEST(getSyncMode)
+{
+  CHECK_EQUAL( FileStore::SYNC_NONE, FileStore::getSyncMode( "none" ) );
+  CHECK_EQUAL( FileStore::SYNC_FLUSH, FileStore::getSyncMode( "Flush" ) );
+  CHECK_EQUAL( FileStore::SYNC_BATCH, FileStore::getSyncMode( "BATCH" ) );
+  CHECK_EQUAL( FileStore::SYNC_ALWAYS, FileStore::getSyncMode( "sync" ) );
+  CHECK_THROW( FileStore::getSyncMode( "fsync" ), ConfigError );
+}
+
+TEST(syncModesPersist)
+{
+  SessionID sessionID( BeginString( "FIX.4.2" ),
+                       SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+  FileStore::SyncMode modes[] =
+    { FileStore::SYNC_NONE, FileStore::SYNC_BATCH, FileStore::SYNC_ALWAYS };
+
+  for( int i = 0; i < 3; ++i )
+  {
+    deleteSession( "SETGET", "TEST" );
+    FileStoreFlusher flusher( 2, 100 );
+    flusher.start();
+
+    FIX42::Heartbeat heartbeat;
+    heartbeat.getHeader().setField( MsgSeqNum( 1 ) );
+    {
+      FileStore store( "store", sessionID, modes[ i ], &flusher );
+      store.set( 1, heartbeat.toString() );
+      store.incrNextSenderMsgSeqNum();
+
+      std::vector < std::string > messages;
+      store.get( 1, 1, messages );
+      CHECK_EQUAL( 1U, messages.size() );
+    }
+
+    FileStore store( "store", sessionID );
+    CHECK_EQUAL( 2, store.getNextSenderMsgSeqNum() );
+    std::vector < std::string > messages;
+    store.get( 1, 1, messages );
+    CHECK_EQUAL( 1U, messages.size() );
+    if( messages.size() )
+      CHECK_EQUAL( heartbeat.toString(), messages[ 0 ] );
+    store.reset();
+  }
+
+  CHECK_THROW( FileStore( "store", sessionID, FileStore::SYNC_BATCH ), ConfigError );
+}
+
+TEST(batchSessionsShareFlusherSettings)
+{
+  SessionSettings settings;
+  std::string input =
+    "[DEFAULT]\n"
+    "ConnectionType=initiator\n"
+    "FileStorePath=store\n"
+    "FileStoreSyncMode=batch\n"
+    "FileStoreSyncInterval=1000\n"
+    "[SESSION]\n"
+    "BeginString=FIX.4.2\n"
+    "SenderCompID=SETGET\n"
+    "TargetCompID=TEST\n"
+    "[SESSION]\n"
+    "BeginString=FIX.4.2\n"
+    "SenderCompID=SETGET\n"
+    "TargetCompID=SAME\n"
+    "[SESSION]\n"
+    "BeginString=FIX.4.2\n"
+    "SenderCompID=SETGET\n"
+    "TargetCompID=OTHER\n"
+    "FileStoreSyncInterval=10\n";
+  std::stringstream stream( input );
+  stream >> settings;
+
+  FileStoreFactory factory( settings );
+  MessageStore* pFirst = factory.create( SessionID( BeginString( "FIX.4.2" ),
+    SenderCompID( "SETGET" ), TargetCompID( "TEST" ) ) );
+  MessageStore* pSame = factory.create( SessionID( BeginString( "FIX.4.2" ),
+    SenderCompID( "SETGET" ), TargetCompID( "SAME" ) ) );
+  CHECK_THROW( factory.create( SessionID( BeginString( "FIX.4.2" ),
+    SenderCompID( "SETGET" ), TargetCompID( "OTHER" ) ) ), ConfigError );
+
+  factory.destroy( pFirst );
+  factory.destroy( pSame );
+  deleteSession( "SETGET", "TEST" );
+  deleteSession( "SETGET", "SAME" );
+}
+
+TEST(migratesTextHeader)
+{
+  SessionID sessionID( BeginString( "FIX.4.2" ),
+                       SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+  deleteSession( "SETGET", "TEST" );
+  { FileStore store( "store", sessionID ); }
+
+  // body and header as written by the text index format
+  {
+    std::ofstream body( "store/FIX.4.2-SETGET-TEST.body" );
+    body << "first" << "second" << "third";
+    std::ofstream header( "store/FIX.4.2-SETGET-TEST.header" );
+    header << "1,0,5 2,5,6 3,11,5 2,11,5 ";
+  }
+
+  std::vector < std::string > messages;
+  {
+    FileStore store( "store", sessionID );
+    store.get( 1, 3, messages );
+    CHECK_EQUAL( 3U, messages.size() );
+    if( messages.size() == 3 )
+    {
+      CHECK_EQUAL( "first", messages[ 0 ] );
+      CHECK_EQUAL( "third", messages[ 1 ] );
+      CHECK_EQUAL( "third", messages[ 2 ] );
+    }
+    store.set( 4, "fourth" );
+  }
+
+  std::ifstream header( "store/FIX.4.2-SETGET-TEST.header" );
+  char magic[ 8 ];
+  header.read( magic, sizeof( magic ) );
+  CHECK_EQUAL( "QFINDEX1", std::string( magic, sizeof( magic ) ) );
+
+  FileStore store( "store", sessionID );
+  store.get( 1, 4, messages );
+  CHECK_EQUAL( 4U, messages.size() );
+  if( messages.size() == 4 )
+  {
+    CHECK_EQUAL( "first", messages[ 0 ] );
+    CHECK_EQUAL( "fourth", messages[ 3 ] );
+  }
+  store.reset();
+  store.get( 1, 4, messages );
+  CHECK( messages.empty() );
+}
+
 }
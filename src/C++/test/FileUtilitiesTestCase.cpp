@@ -48,4 +48,21 @@ TEST(appendpath)
   CHECK_EQUAL( "path\\file", file_appendpath("path\\", "file") );
 }
 
+TEST(seekPastTwoGigabytes)
+{
+  FILE* file = file_fopen( "FileUtilitiesTests.seek", "wb+" );
+  CHECK( file != 0 );
+  if( !file ) return;
+
+  // seeking past the end does not write anything
+  int64_t offset = (int64_t)3 * 1024 * 1024 * 1024;
+  CHECK_EQUAL( 0, file_seek( file, offset, SEEK_SET ) );
+  CHECK( offset == file_tell( file ) );
+  CHECK_EQUAL( 0, file_seek( file, 0, SEEK_END ) );
+  CHECK( 0 == file_tell( file ) );
+
+  file_fclose( file );
+  file_unlink( "FileUtilitiesTests.seek" );
+}
+
 }
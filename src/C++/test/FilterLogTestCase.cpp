@@ -0,0 +1,151 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <FilterLog.h>
+#include <sstream>
+
+using namespace FIX;
+
+SUITE(FilterLogTests)
+{
+
+class RecordingLog : public Log
+{
+public:
+  void clear() { incoming.clear(); outgoing.clear(); events.clear(); }
+  void backup() {}
+  void onIncoming( const std::string& value ) { incoming.push_back( value ); }
+  void onOutgoing( const std::string& value ) { outgoing.push_back( value ); }
+  void onEvent( const std::string& value ) { events.push_back( value ); }
+
+  std::vector < std::string > incoming;
+  std::vector < std::string > outgoing;
+  std::vector < std::string > events;
+};
+
+class RecordingLogFactory : public LogFactory
+{
+public:
+  Log* create() { return new RecordingLog; }
+  Log* create( const SessionID& ) { return new RecordingLog; }
+  void destroy( Log* log ) { delete log; }
+};
+
+std::string message( const std::string& msgType )
+{
+  return "8=FIX.4.2\0019=12\00135=" + msgType + "\00134=1\00110=000\001";
+}
+
+struct filterLogFixture
+{
+  filterLogFixture()
+  : sessionID( BeginString( "FIX.4.2" ),
+               SenderCompID( "FILTER" ), TargetCompID( "TEST" ) )
+  {
+    std::string input =
+      "[DEFAULT]\n"
+      "ConnectionType=acceptor\n"
+      "FilterLogIncomingExclude=0,1\n"
+      "FilterLogIncomingSample=W:3\n"
+      "FilterLogOutgoingInclude=D,F\n"
+      "[SESSION]\n"
+      "BeginString=FIX.4.2\n"
+      "SenderCompID=FILTER\n"
+      "TargetCompID=TEST\n";
+    std::stringstream stream( input );
+    stream >> settings;
+
+    factory = new FilterLogFactory( recordingFactory, settings );
+    object = static_cast < FilterLog* > ( factory->create( sessionID ) );
+    log = static_cast < RecordingLog* > ( object->getLog() );
+  }
+
+  ~filterLogFixture()
+  {
+    factory->destroy( object );
+    delete factory;
+  }
+
+  SessionID sessionID;
+  SessionSettings settings;
+  RecordingLogFactory recordingFactory;
+  FilterLogFactory* factory;
+  FilterLog* object;
+  RecordingLog* log;
+};
+
+TEST_FIXTURE(filterLogFixture, excludeIncoming)
+{
+  object->onIncoming( message( "0" ) );
+  object->onIncoming( message( "1" ) );
+  object->onIncoming( message( "A" ) );
+  object->onIncoming( message( "10" ) );
+  CHECK_EQUAL( 2U, log->incoming.size() );
+  CHECK_EQUAL( message( "A" ), log->incoming[ 0 ] );
+  CHECK_EQUAL( message( "10" ), log->incoming[ 1 ] );
+}
+
+TEST_FIXTURE(filterLogFixture, sampleIncoming)
+{
+  for( int i = 0; i < 7; ++i )
+    object->onIncoming( message( "W" ) + IntConvertor::convert( i ) );
+  CHECK_EQUAL( 3U, log->incoming.size() );
+  CHECK_EQUAL( message( "W" ) + "0", log->incoming[ 0 ] );
+  CHECK_EQUAL( message( "W" ) + "3", log->incoming[ 1 ] );
+  CHECK_EQUAL( message( "W" ) + "6", log->incoming[ 2 ] );
+}
+
+TEST_FIXTURE(filterLogFixture, includeOutgoing)
+{
+  object->onOutgoing( message( "0" ) );
+  object->onOutgoing( message( "D" ) );
+  object->onOutgoing( message( "W" ) );
+  object->onOutgoing( message( "F" ) );
+  CHECK_EQUAL( 2U, log->outgoing.size() );
+  CHECK_EQUAL( message( "D" ), log->outgoing[ 0 ] );
+  CHECK_EQUAL( message( "F" ), log->outgoing[ 1 ] );
+}
+
+TEST_FIXTURE(filterLogFixture, passesUnfiltered)
+{
+  object->onEvent( "EVENT" );
+  object->onIncoming( "NOT A MESSAGE" );
+  object->onOutgoing( "NOT A MESSAGE" );
+  CHECK_EQUAL( 1U, log->events.size() );
+  CHECK_EQUAL( 1U, log->incoming.size() );
+  CHECK_EQUAL( 1U, log->outgoing.size() );
+}
+
+TEST(invalidSample)
+{
+  FilterLog object( 0 );
+  CHECK_THROW( object.setIncomingSample( "0" ), ConfigError );
+  CHECK_THROW( object.setOutgoingSample( "0:0" ), ConfigError );
+  CHECK_THROW( object.setOutgoingSample( "0:X" ), ConfigError );
+  object.setOutgoingSample( " 0 : 10 , 1:5" );
+}
+}
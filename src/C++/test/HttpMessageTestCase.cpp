@@ -79,4 +79,14 @@ TEST(setString)
   CHECK_THROW( object.setString( strBad3 ), InvalidMessage );
 }
 
+TEST(createResponseWithContentType)
+{
+  CHECK_EQUAL( "HTTP/1.1 200 OK\r\n"
+               "Server: QuickFIX\r\n"
+               "Content-Type: application/json\r\n"
+               "Content-Length: 2\r\n\r\n"
+               "{}",
+               HttpMessage::createResponse( 200, "application/json", "{}" ) );
+}
+
 }
@@ -0,0 +1,309 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <TestHelper.h>
+#include <JournalStore.h>
+#include "MessageStoreTestCase.h"
+
+using namespace FIX;
+
+SUITE(JournalStoreTests)
+{
+
+void deleteJournal()
+{
+  std::vector < std::string > names;
+  file_list( "store/journal", names );
+  std::vector < std::string > ::const_iterator i;
+  for( i = names.begin(); i != names.end(); ++i )
+  {
+    if( i->find( ".journal" ) != std::string::npos )
+      file_unlink( file_appendpath( "store/journal", *i ).c_str() );
+  }
+  file_unlink( "store/journal/store.checkpoint" );
+}
+
+struct journalStoreFixture
+{
+  journalStoreFixture( bool resetBefore, bool resetAfter )
+  {
+    if( resetBefore )
+      deleteJournal();
+
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+
+    factory = new JournalStoreFactory( "store/journal" );
+    object = factory->create( sessionID );
+
+    this->resetAfter = resetAfter;
+  }
+
+  ~journalStoreFixture()
+  {
+    factory->destroy( object );
+    delete factory;
+
+    if( resetAfter )
+      deleteJournal();
+  }
+
+  JournalStoreFactory* factory;
+  MessageStore* object;
+  bool resetAfter;
+};
+
+struct resetBeforeJournalStoreFixture : journalStoreFixture
+{
+  resetBeforeJournalStoreFixture() : journalStoreFixture( true, false ) {}
+};
+
+struct resetAfterJournalStoreFixture : journalStoreFixture
+{
+  resetAfterJournalStoreFixture() : journalStoreFixture( false, true ) {}
+};
+
+struct resetBeforeAndAfterJournalStoreFixture : journalStoreFixture
+{
+  resetBeforeAndAfterJournalStoreFixture() : journalStoreFixture( true, true ) {}
+};
+
+struct noResetJournalStoreFixture : journalStoreFixture
+{
+  noResetJournalStoreFixture() : journalStoreFixture( false, false ) {}
+};
+
+TEST_FIXTURE(resetBeforeAndAfterJournalStoreFixture, setGet)
+{
+  CHECK_MESSAGE_STORE_SET_GET;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterJournalStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterJournalStoreFixture, setGetWithQuote)
+{
+  CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
+}
+
+TEST_FIXTURE(resetBeforeJournalStoreFixture, other)
+{
+  CHECK_MESSAGE_STORE_OTHER
+}
+
+TEST_FIXTURE(noResetJournalStoreFixture, reload)
+{
+  CHECK_MESSAGE_STORE_REFRESH
+}
+
+TEST_FIXTURE(resetAfterJournalStoreFixture, refresh)
+{
+  CHECK_MESSAGE_STORE_RELOAD
+}
+
+struct journalFixture
+{
+  journalFixture()
+  : first( BeginString( "FIX.4.2" ),
+           SenderCompID( "FIRST" ), TargetCompID( "TEST" ) ),
+    second( BeginString( "FIX.4.2" ),
+            SenderCompID( "SECOND" ), TargetCompID( "TEST" ) )
+  {
+    deleteJournal();
+  }
+
+  ~journalFixture()
+  {
+    deleteJournal();
+  }
+
+  std::string message( int msgSeqNum, const std::string& text )
+  {
+    FIX42::ExecutionReport executionReport;
+    executionReport.getHeader().setField( MsgSeqNum( msgSeqNum ) );
+    executionReport.setField( Text( text ) );
+    return executionReport.toString();
+  }
+
+  SessionID first;
+  SessionID second;
+};
+
+TEST_FIXTURE(journalFixture, sharesJournalAcrossSessions)
+{
+  {
+    JournalStoreFactory factory( "store/journal" );
+    MessageStore* pFirst = factory.create( first );
+    MessageStore* pSecond = factory.create( second );
+    CHECK_EQUAL( 2U, factory.getJournal()->getSessionCount() );
+
+    for( int i = 1; i <= 10; ++i )
+    {
+      pFirst->set( i, message( i, "first" ) );
+      pSecond->set( i, message( i, "second" ) );
+    }
+    pFirst->setNextSenderMsgSeqNum( 11 );
+    pSecond->setNextTargetMsgSeqNum( 7 );
+
+    // a store created again continues the same session
+    factory.destroy( pFirst );
+    pFirst = factory.create( first );
+    CHECK_EQUAL( 2U, factory.getJournal()->getSessionCount() );
+    CHECK_EQUAL( 11, pFirst->getNextSenderMsgSeqNum() );
+
+    pSecond->reset();
+    pSecond->set( 1, message( 1, "reset" ) );
+
+    factory.destroy( pFirst );
+    factory.destroy( pSecond );
+  }
+
+  JournalStoreFactory factory( "store/journal" );
+  MessageStore* pFirst = factory.create( first );
+  MessageStore* pSecond = factory.create( second );
+
+  std::vector < std::string > messages;
+  pFirst->get( 1, 10, messages );
+  CHECK_EQUAL( 10U, messages.size() );
+  if( messages.size() == 10 )
+    CHECK_EQUAL( message( 10, "first" ), messages[ 9 ] );
+  CHECK_EQUAL( 11, pFirst->getNextSenderMsgSeqNum() );
+
+  pSecond->get( 1, 10, messages );
+  CHECK_EQUAL( 1U, messages.size() );
+  if( messages.size() == 1 )
+    CHECK_EQUAL( message( 1, "reset" ), messages[ 0 ] );
+  CHECK_EQUAL( 1, pSecond->getNextTargetMsgSeqNum() );
+
+  factory.destroy( pFirst );
+  factory.destroy( pSecond );
+}
+
+TEST_FIXTURE(journalFixture, rebuildsFromJournal)
+{
+  {
+    Journal journal( "store/journal", 10 );
+    int session = journal.open( "FIX.4.2-FIRST-TEST" );
+    for( int i = 1; i <= 25; ++i )
+      journal.set( session, i, message( i, "first" ) );
+    journal.setNextSenderMsgSeqNum( session, 26 );
+
+    // checkpoints are written as records are added
+    CHECK( journal.getRecords() < 10 );
+  }
+
+  // without a checkpoint the whole journal is scanned
+  file_unlink( "store/journal/store.checkpoint" );
+
+  JournalStoreFactory factory( "store/journal" );
+  MessageStore* pFirst = factory.create( first );
+  CHECK_EQUAL( 26, pFirst->getNextSenderMsgSeqNum() );
+
+  MessageStoreRangeRecorder recorder;
+  pFirst->getRange( 1, 100, recorder );
+  CHECK_EQUAL( 25U, recorder.messages.size() );
+  if( recorder.messages.size() == 25 )
+  {
+    CHECK_EQUAL( 25, recorder.msgSeqNums[ 24 ] );
+    CHECK_EQUAL( message( 25, "first" ), recorder.messages[ 24 ] );
+  }
+  factory.destroy( pFirst );
+}
+
+TEST_FIXTURE(journalFixture, ignoresPartialRecord)
+{
+  {
+    Journal journal( "store/journal" );
+    int session = journal.open( "FIX.4.2-FIRST-TEST" );
+    journal.set( session, 1, message( 1, "first" ) );
+  }
+
+  // a record header whose data never made it to the file
+  FILE* file = file_fopen( "store/journal/store.1.journal", "ab" );
+  int32_t record[ 4 ] = { 2, 0, 2, 1000 };
+  fwrite( record, sizeof( record ), 1, file );
+  fclose( file );
+
+  {
+    Journal journal( "store/journal" );
+    int session = journal.open( "FIX.4.2-FIRST-TEST" );
+    journal.set( session, 2, message( 2, "first" ) );
+  }
+  file_unlink( "store/journal/store.checkpoint" );
+
+  Journal journal( "store/journal" );
+  int session = journal.open( "FIX.4.2-FIRST-TEST" );
+  MessageStoreRangeRecorder recorder;
+  journal.getRange( session, 1, 10, recorder );
+  CHECK_EQUAL( 2U, recorder.messages.size() );
+  if( recorder.messages.size() == 2 )
+    CHECK_EQUAL( message( 2, "first" ), recorder.messages[ 1 ] );
+}
+
+TEST_FIXTURE(journalFixture, dropsUnreferencedSegments)
+{
+  {
+    Journal journal( "store/journal", 0, 0, 4096 );
+    int first = journal.open( "FIX.4.2-FIRST-TEST" );
+    int second = journal.open( "FIX.4.2-SECOND-TEST" );
+    journal.set( second, 1, message( 1, "second" ) );
+    for( int i = 1; i <= 300; ++i )
+      journal.set( first, i, message( i, "first" ) );
+    size_t segments = journal.getSegmentCount();
+    CHECK( segments > 2 );
+
+    // the reset frees all segments but the one the second session uses
+    journal.reset( first );
+    journal.set( first, 1, message( 1, "reset" ) );
+    journal.setNextSenderMsgSeqNum( first, 2 );
+    journal.checkpoint();
+    CHECK_EQUAL( 2U, journal.getSegmentCount() );
+    CHECK( file_exists( "store/journal/store.1.journal" ) );
+    CHECK( !file_exists( "store/journal/store.2.journal" ) );
+  }
+
+  Journal journal( "store/journal", 0, 0, 4096 );
+  int first = journal.open( "FIX.4.2-FIRST-TEST" );
+  int second = journal.open( "FIX.4.2-SECOND-TEST" );
+  CHECK_EQUAL( 2, journal.getNextSenderMsgSeqNum( first ) );
+
+  MessageStoreRangeRecorder recorder;
+  journal.getRange( first, 1, 300, recorder );
+  CHECK_EQUAL( 1U, recorder.messages.size() );
+  if( recorder.messages.size() == 1 )
+    CHECK_EQUAL( message( 1, "reset" ), recorder.messages[ 0 ] );
+
+  MessageStoreRangeRecorder secondRecorder;
+  journal.getRange( second, 1, 100, secondRecorder );
+  CHECK_EQUAL( 1U, secondRecorder.messages.size() );
+  if( secondRecorder.messages.size() == 1 )
+    CHECK_EQUAL( message( 1, "second" ), secondRecorder.messages[ 0 ] );
+}
+
+}
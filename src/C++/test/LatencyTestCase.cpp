@@ -0,0 +1,120 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <Latency.h>
+
+using namespace FIX;
+
+SUITE(LatencyTests)
+{
+
+TEST(histogramIndexes)
+{
+  for( int64_t value = 0; value < 32; ++value )
+    CHECK_EQUAL( value, LatencyHistogram::getHighestValue( LatencyHistogram::getIndex( value ) ) );
+
+  // every value falls into a bucket less than 1/16 wide
+  int64_t values[] = { 32, 33, 63, 64, 1000, 123456, 999999999, 1LL << 40, 0x7FFFFFFFFFFFFFFFLL };
+  for( size_t i = 0; i < sizeof( values ) / sizeof( values[ 0 ] ); ++i )
+  {
+    int index = LatencyHistogram::getIndex( values[ i ] );
+    int64_t highest = LatencyHistogram::getHighestValue( index );
+    CHECK( highest >= values[ i ] );
+    CHECK( highest - values[ i ] <= values[ i ] / 16 );
+    CHECK( index == 0 || LatencyHistogram::getHighestValue( index - 1 ) < values[ i ] );
+  }
+}
+
+TEST(histogramPercentiles)
+{
+  LatencyHistogram histogram;
+  CHECK_EQUAL( 0, histogram.getValueAtPercentile( 50 ) );
+
+  for( int64_t value = 1; value <= 1000; ++value )
+    histogram.record( value * 1000 );
+  CHECK_EQUAL( 1000, histogram.getCount() );
+  CHECK_EQUAL( 1000, histogram.getMin() );
+  CHECK_EQUAL( 1000000, histogram.getMax() );
+  CHECK_CLOSE( 500500.0, histogram.getMean(), 0.001 );
+
+  int64_t median = histogram.getValueAtPercentile( 50 );
+  CHECK( median >= 500000 && median <= 500000 + 500000 / 16 );
+  int64_t p99 = histogram.getValueAtPercentile( 99 );
+  CHECK( p99 >= 990000 && p99 <= 1000000 );
+  CHECK_EQUAL( 1000000, histogram.getValueAtPercentile( 100 ) );
+
+  histogram.reset();
+  CHECK_EQUAL( 0, histogram.getCount() );
+  CHECK_EQUAL( 0, histogram.getMax() );
+}
+
+TEST(sessionLatency)
+{
+  SessionLatency latency;
+  latency.record( SessionLatency::PARSE, 10 );
+  CHECK_EQUAL( 0, latency.getHistogram( SessionLatency::PARSE ).getCount() );
+
+  latency.setEnabled( true );
+  latency.record( SessionLatency::PARSE, 10 );
+  latency.record( SessionLatency::PARSE, 20 );
+  latency.record( SessionLatency::SEND, 30 );
+  CHECK_EQUAL( 2, latency.getHistogram( SessionLatency::PARSE ).getCount() );
+  CHECK_EQUAL( 20, latency.getHistogram( SessionLatency::PARSE ).getMax() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::SEND ).getCount() );
+  CHECK_EQUAL( "parse", std::string( SessionLatency::getStageName( SessionLatency::PARSE ) ) );
+  CHECK_EQUAL( "sendRaw", std::string( SessionLatency::getStageName( SessionLatency::SEND_RAW ) ) );
+}
+
+TEST(sessionLatencyResetAndDisable)
+{
+  SessionLatency latency;
+  latency.setEnabled( true );
+  latency.record( SessionLatency::NEXT, 40 );
+  latency.record( SessionLatency::NEXT, 5 );
+  LatencyHistogram histogram = latency.getHistogram( SessionLatency::NEXT );
+  CHECK_EQUAL( 2, histogram.getCount() );
+  CHECK_EQUAL( 5, histogram.getMin() );
+  CHECK_EQUAL( 40, histogram.getMax() );
+  CHECK_EQUAL( 45, histogram.getSum() );
+  CHECK_EQUAL( 40, histogram.getValueAtPercentile( 100 ) );
+
+  // disabling keeps what was recorded, nothing more is added
+  latency.setEnabled( false );
+  CHECK( !latency.isEnabled() );
+  latency.record( SessionLatency::NEXT, 1000 );
+  CHECK_EQUAL( 2, latency.getHistogram( SessionLatency::NEXT ).getCount() );
+
+  latency.reset();
+  histogram = latency.getHistogram( SessionLatency::NEXT );
+  CHECK_EQUAL( 0, histogram.getCount() );
+  CHECK_EQUAL( 0, histogram.getMax() );
+
+  latency.setEnabled( true );
+  latency.record( SessionLatency::NEXT, 7 );
+  CHECK_EQUAL( 7, latency.getHistogram( SessionLatency::NEXT ).getMin() );
+}
+}
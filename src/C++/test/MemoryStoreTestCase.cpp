@@ -26,6 +26,7 @@
 
 #include <UnitTest++.h>
 #include <MessageStore.h>
+#include "MessageStoreTestCase.h"
 
 namespace FIX
 {
@@ -49,4 +50,9 @@ struct memoryStoreFixture
   MessageStore* object;
 };
 
+TEST_FIXTURE(memoryStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
 }
@@ -22,6 +22,26 @@
 #include <fix42/NewOrderSingle.h>
 #include <fix42/ExecutionReport.h>
 #include <MessageStore.h>
+
+#ifndef MESSAGE_STORE_RANGE_RECORDER
+#define MESSAGE_STORE_RANGE_RECORDER
+class MessageStoreRangeRecorder : public FIX::MessageStoreVisitor
+{
+public:
+  MessageStoreRangeRecorder( std::size_t limit = 0 ) : limit( limit ) {}
+
+  bool onMessage( int msgSeqNum, const char* data, std::size_t length )
+  {
+    msgSeqNums.push_back( msgSeqNum );
+    messages.push_back( std::string( data, length ) );
+    return !limit || messages.size() < limit;
+  }
+
+  std::vector < int > msgSeqNums;
+  std::vector < std::string > messages;
+  std::size_t limit;
+};
+#endif
 #include <SessionID.h>
 
 #define CHECK_MESSAGE_STORE_SET_GET                         \
@@ -52,6 +72,40 @@
   CHECK_EQUAL( heartbeat.toString(), messages[ 0 ] );       \
   CHECK_EQUAL( newOrderSingle.toString(), messages[ 1 ] );
 
+#define CHECK_MESSAGE_STORE_GET_RANGE                       \
+  FIX42::Logon logon;                                       \
+  logon.getHeader().setField( MsgSeqNum( 1 ) );             \
+  object->set( 1, logon.toString() );                       \
+                                                            \
+  FIX42::Heartbeat heartbeat;                               \
+  heartbeat.getHeader().setField( MsgSeqNum( 2 ) );         \
+  object->set( 2, heartbeat.toString() );                   \
+                                                            \
+  FIX42::NewOrderSingle newOrderSingle;                     \
+  newOrderSingle.getHeader().setField( MsgSeqNum( 4 ) );    \
+  object->set( 4, newOrderSingle.toString() );              \
+                                                            \
+  MessageStoreRangeRecorder all;                            \
+  object->getRange( 2, 6, all );                            \
+  CHECK_EQUAL( 2U, all.messages.size() );                   \
+  if( all.messages.size() == 2 )                            \
+  {                                                         \
+    CHECK_EQUAL( 2, all.msgSeqNums[ 0 ] );                  \
+    CHECK_EQUAL( heartbeat.toString(), all.messages[ 0 ] ); \
+    CHECK_EQUAL( 4, all.msgSeqNums[ 1 ] );                  \
+    CHECK_EQUAL( newOrderSingle.toString(), all.messages[ 1 ] ); \
+  }                                                         \
+                                                            \
+  MessageStoreRangeRecorder first( 1 );                     \
+  object->getRange( 1, 4, first );                          \
+  CHECK_EQUAL( 1U, first.messages.size() );                 \
+  if( first.messages.size() == 1 )                          \
+    CHECK_EQUAL( logon.toString(), first.messages[ 0 ] );   \
+                                                            \
+  MessageStoreRangeRecorder none;                           \
+  object->getRange( 5, 9, none );                           \
+  CHECK_EQUAL( 0U, none.messages.size() );
+
 #define CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE        \
   FIX42::ExecutionReport singleQuote;                 \
   singleQuote.setField( Text("Some Text") );          \
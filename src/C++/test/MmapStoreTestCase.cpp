@@ -0,0 +1,157 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <TestHelper.h>
+#include <MmapStore.h>
+#include "MessageStoreTestCase.h"
+
+using namespace FIX;
+
+SUITE(MmapStoreTests)
+{
+
+void deleteMmapSession( std::string sender, std::string target )
+{
+  file_unlink( ( "store/FIX.4.2-" + sender + "-" + target + ".data" ).c_str() );
+  file_unlink( ( "store/FIX.4.2-" + sender + "-" + target + ".index" ).c_str() );
+  file_unlink( ( "store/FIX.4.2-" + sender + "-" + target + ".session" ).c_str() );
+}
+
+struct mmapStoreFixture
+{
+  mmapStoreFixture( bool resetBefore, bool resetAfter )
+  : factory( "store", 4096 )
+  {
+    if( resetBefore )
+      deleteMmapSession( "SETGET", "TEST" );
+
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+
+    object = factory.create( sessionID );
+
+    this->resetAfter = resetAfter;
+  }
+
+  ~mmapStoreFixture()
+  {
+    factory.destroy( object );
+
+    if( resetAfter )
+      deleteMmapSession( "SETGET", "TEST" );
+  }
+
+  MmapStoreFactory factory;
+  MessageStore* object;
+  bool resetAfter;
+};
+
+struct resetBeforeMmapStoreFixture : mmapStoreFixture
+{
+  resetBeforeMmapStoreFixture() : mmapStoreFixture( true, false ) {}
+};
+
+struct resetAfterMmapStoreFixture : mmapStoreFixture
+{
+  resetAfterMmapStoreFixture() : mmapStoreFixture( false, true ) {}
+};
+
+struct resetBeforeAndAfterMmapStoreFixture : mmapStoreFixture
+{
+  resetBeforeAndAfterMmapStoreFixture() : mmapStoreFixture( true, true ) {}
+};
+
+struct noResetMmapStoreFixture : mmapStoreFixture
+{
+  noResetMmapStoreFixture() : mmapStoreFixture( false, false ) {}
+};
+
+TEST_FIXTURE(resetBeforeAndAfterMmapStoreFixture, setGet)
+{
+  CHECK_MESSAGE_STORE_SET_GET;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterMmapStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterMmapStoreFixture, setGetWithQuote)
+{
+  CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
+}
+
+TEST_FIXTURE(resetBeforeMmapStoreFixture, other)
+{
+  CHECK_MESSAGE_STORE_OTHER
+}
+
+TEST_FIXTURE(noResetMmapStoreFixture, reload)
+{
+  CHECK_MESSAGE_STORE_REFRESH
+}
+
+TEST_FIXTURE(resetAfterMmapStoreFixture, refresh)
+{
+  CHECK_MESSAGE_STORE_RELOAD
+}
+
+TEST_FIXTURE(resetBeforeAndAfterMmapStoreFixture, growsAndReloads)
+{
+  // the 4096 byte data file and 1024 record index have to be extended
+  std::vector < std::string > expected;
+  for( int i = 1; i <= 2000; ++i )
+  {
+    FIX42::Heartbeat heartbeat;
+    heartbeat.getHeader().setField( MsgSeqNum( i ) );
+    expected.push_back( heartbeat.toString() );
+    CHECK( object->set( i, expected.back() ) );
+  }
+  object->setNextSenderMsgSeqNum( 2001 );
+
+  // a later set of the same sequence number replaces the message
+  FIX42::NewOrderSingle newOrderSingle;
+  newOrderSingle.getHeader().setField( MsgSeqNum( 10 ) );
+  object->set( 10, newOrderSingle.toString() );
+  expected[ 9 ] = newOrderSingle.toString();
+
+  std::vector < std::string > messages;
+  object->get( 1, 2000, messages );
+  CHECK( expected == messages );
+
+  object->refresh();
+  CHECK_EQUAL( 2001, object->getNextSenderMsgSeqNum() );
+  object->get( 0, 5000, messages );
+  CHECK( expected == messages );
+
+  object->reset();
+  CHECK_EQUAL( 1, object->getNextSenderMsgSeqNum() );
+  object->get( 1, 2000, messages );
+  CHECK_EQUAL( 0U, messages.size() );
+}
+
+}
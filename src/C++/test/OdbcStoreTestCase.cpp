@@ -85,6 +85,11 @@ TEST_FIXTURE(resetOdbcStoreFixture, setGet)
   CHECK_MESSAGE_STORE_SET_GET;
 }
 
+TEST_FIXTURE(resetOdbcStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
 TEST_FIXTURE(resetOdbcStoreFixture, setGetWithQuote)
 {
   //CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
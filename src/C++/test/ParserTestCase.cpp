@@ -31,6 +31,8 @@
 #include <SocketConnector.h>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 
 using namespace FIX;
 
@@ -149,6 +151,59 @@ TEST(readMessagesByteByByte)
   }
 }
 
+TEST(readMessagesFromWriteBuffer)
+{
+  Parser object( 16 );
+  std::string fixMsg1 = "8=FIX.4.2\0019=12\00135=A\001108=30\00110=31\001";
+  std::string fixMsg2 = "8=FIX.4.2\0019=17\00135=4\00136=88\001123=Y\00110=34\001";
+  std::string stream = fixMsg1 + fixMsg2 + fixMsg1;
+  std::vector<std::string> messages;
+  std::string readFixMsg;
+
+  std::string::size_type pos = 0;
+  while( pos < stream.size() )
+  {
+    size_t length = 0;
+    char* buffer = object.getWriteBuffer( length );
+    CHECK( length >= 16 );
+    length = std::min( (size_t)7, stream.size() - pos );
+    memcpy( buffer, stream.data() + pos, length );
+    object.commitWrite( length );
+    pos += length;
+
+    while( object.readFixMessage( readFixMsg ) )
+      messages.push_back( readFixMsg );
+  }
+
+  CHECK_EQUAL( 3U, messages.size() );
+  CHECK_EQUAL( fixMsg1, messages[0] );
+  CHECK_EQUAL( fixMsg2, messages[1] );
+  CHECK_EQUAL( fixMsg1, messages[2] );
+  CHECK_EQUAL( 0U, object.getStreamSize() );
+}
+
+TEST(writeBufferKeepsPartialMessage)
+{
+  Parser object( 32 );
+  std::string fixMsg = "8=FIX.4.2\0019=12\00135=A\001108=30\00110=31\001";
+  std::string readFixMsg;
+
+  object.addToStream( "garbage" + fixMsg + fixMsg.substr( 0, 20 ) );
+  CHECK( object.readFixMessage( readFixMsg ) );
+  CHECK_EQUAL( fixMsg, readFixMsg );
+  CHECK( !object.readFixMessage( readFixMsg ) );
+  CHECK_EQUAL( 20U, object.getStreamSize() );
+
+  std::string rest = fixMsg.substr( 20 );
+  size_t length = 0;
+  char* buffer = object.getWriteBuffer( length );
+  CHECK( length >= rest.size() );
+  memcpy( buffer, rest.data(), rest.size() );
+  object.commitWrite( rest.size() );
+  CHECK( object.readFixMessage( readFixMsg ) );
+  CHECK_EQUAL( fixMsg, readFixMsg );
+}
+
 struct readMessageWithBadLengthFixture
 {
   readMessageWithBadLengthFixture()
@@ -85,6 +85,11 @@ TEST_FIXTURE(resetPostgreSQLStoreFixture, setGet)
   CHECK_MESSAGE_STORE_SET_GET;
 }
 
+TEST_FIXTURE(resetPostgreSQLStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
 TEST_FIXTURE(resetPostgreSQLStoreFixture, setGetWithQuote)
 {
   //CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
@@ -95,6 +100,26 @@ TEST_FIXTURE(resetPostgreSQLStoreFixture, other)
   CHECK_MESSAGE_STORE_OTHER
 }
 
+TEST_FIXTURE(resetPostgreSQLStoreFixture, batchReplacesMessages)
+{
+  PostgreSQLStore* store = static_cast < PostgreSQLStore* > ( object );
+  store->setBatch( 10, 0 );
+
+  // stored twice within a batch and once more in the next one
+  CHECK( store->set( 1, "first" ) );
+  CHECK( store->set( 2, "second" ) );
+  CHECK( store->set( 1, "replaced" ) );
+  store->flush();
+  CHECK( store->set( 2, "again" ) );
+  store->flush();
+
+  std::vector < std::string > messages;
+  store->get( 1, 2, messages );
+  CHECK_EQUAL( 2U, messages.size() );
+  CHECK_EQUAL( "replaced", messages[ 0 ] );
+  CHECK_EQUAL( "again", messages[ 1 ] );
+}
+
 TEST_FIXTURE(noResetPostgreSQLStoreFixture, reload)
 {
   CHECK_MESSAGE_STORE_RELOAD
@@ -0,0 +1,257 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <TestHelper.h>
+#include <SegmentedFileStore.h>
+#include "MessageStoreTestCase.h"
+#include <fstream>
+
+using namespace FIX;
+
+SUITE(SegmentedFileStoreTests)
+{
+
+struct segmentedFileStoreFixture
+{
+  segmentedFileStoreFixture( bool resetBefore, bool resetAfter )
+  : factory( "store" )
+  {
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "SETGET" ), TargetCompID( "TEST" ) );
+
+    object = factory.create( sessionID );
+    if( resetBefore )
+      object->reset();
+
+    this->resetAfter = resetAfter;
+  }
+
+  ~segmentedFileStoreFixture()
+  {
+    if( resetAfter )
+      object->reset();
+    factory.destroy( object );
+
+    if( resetAfter )
+      file_unlink( "store/FIX.4.2-SETGET-TEST.segments" );
+  }
+
+  SegmentedFileStoreFactory factory;
+  MessageStore* object;
+  bool resetAfter;
+};
+
+struct resetBeforeSegmentedFileStoreFixture : segmentedFileStoreFixture
+{
+  resetBeforeSegmentedFileStoreFixture() : segmentedFileStoreFixture( true, false ) {}
+};
+
+struct resetAfterSegmentedFileStoreFixture : segmentedFileStoreFixture
+{
+  resetAfterSegmentedFileStoreFixture() : segmentedFileStoreFixture( false, true ) {}
+};
+
+struct resetBeforeAndAfterSegmentedFileStoreFixture : segmentedFileStoreFixture
+{
+  resetBeforeAndAfterSegmentedFileStoreFixture() : segmentedFileStoreFixture( true, true ) {}
+};
+
+struct noResetSegmentedFileStoreFixture : segmentedFileStoreFixture
+{
+  noResetSegmentedFileStoreFixture() : segmentedFileStoreFixture( false, false ) {}
+};
+
+TEST_FIXTURE(resetBeforeAndAfterSegmentedFileStoreFixture, setGet)
+{
+  CHECK_MESSAGE_STORE_SET_GET;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterSegmentedFileStoreFixture, getRange)
+{
+  CHECK_MESSAGE_STORE_GET_RANGE;
+}
+
+TEST_FIXTURE(resetBeforeAndAfterSegmentedFileStoreFixture, setGetWithQuote)
+{
+  CHECK_MESSAGE_STORE_SET_GET_WITH_QUOTE;
+}
+
+TEST_FIXTURE(resetBeforeSegmentedFileStoreFixture, other)
+{
+  CHECK_MESSAGE_STORE_OTHER
+}
+
+TEST_FIXTURE(noResetSegmentedFileStoreFixture, reload)
+{
+  CHECK_MESSAGE_STORE_REFRESH
+}
+
+TEST_FIXTURE(resetAfterSegmentedFileStoreFixture, refresh)
+{
+  CHECK_MESSAGE_STORE_RELOAD
+}
+
+struct segmentFixture
+{
+  segmentFixture()
+  : sessionID( BeginString( "FIX.4.2" ),
+               SenderCompID( "SEGMENT" ), TargetCompID( "TEST" ) )
+  {
+    file_unlink( "store/FIX.4.2-SEGMENT-TEST.segments" );
+  }
+
+  ~segmentFixture()
+  {
+    SegmentedFileStore store( "store", sessionID );
+    store.reset();
+    file_unlink( "store/FIX.4.2-SEGMENT-TEST.segments" );
+  }
+
+  std::vector < std::string > fill( MessageStore& store, int count )
+  {
+    std::vector < std::string > messages;
+    for( int i = 1; i <= count; ++i )
+    {
+      FIX42::Heartbeat heartbeat;
+      heartbeat.getHeader().setField( MsgSeqNum( i ) );
+      messages.push_back( heartbeat.toString() );
+      store.set( i, messages.back() );
+    }
+    return messages;
+  }
+
+  SessionID sessionID;
+};
+
+TEST_FIXTURE(segmentFixture, rollsSegmentsAndReloads)
+{
+  SegmentedFileStore store( "store", sessionID, 4096 );
+  std::vector < std::string > expected = fill( store, 500 );
+  store.setNextSenderMsgSeqNum( 501 );
+  CHECK( store.getSegmentCount() > 1 );
+
+  std::vector < std::string > messages;
+  store.get( 1, 500, messages );
+  CHECK( expected == messages );
+
+  // a message stored again is read from the later segment
+  FIX42::NewOrderSingle newOrderSingle;
+  newOrderSingle.getHeader().setField( MsgSeqNum( 10 ) );
+  store.set( 10, newOrderSingle.toString() );
+  expected[ 9 ] = newOrderSingle.toString();
+
+  store.refresh();
+  CHECK_EQUAL( 501, store.getNextSenderMsgSeqNum() );
+  store.get( 0, 1000, messages );
+  CHECK( expected == messages );
+
+  SegmentedFileStore reopened( "store", sessionID, 4096 );
+  reopened.get( 1, 500, messages );
+  CHECK( expected == messages );
+}
+
+TEST_FIXTURE(segmentFixture, retentionDropsOldSegments)
+{
+  SegmentedFileStore store( "store", sessionID, 4096, 100 );
+  std::vector < std::string > expected = fill( store, 1000 );
+  CHECK( !file_exists( "store/FIX.4.2-SEGMENT-TEST.1.1.segment" ) );
+
+  MessageStoreRangeRecorder recorder;
+  store.getRange( 1, 1000, recorder );
+  CHECK( recorder.messages.size() >= 100 );
+  CHECK( recorder.messages.size() < 1000 );
+  CHECK_EQUAL( 1000, recorder.msgSeqNums.back() );
+  CHECK_EQUAL( expected.back(), recorder.messages.back() );
+
+  std::size_t retained = recorder.messages.size();
+  store.refresh();
+  std::vector < std::string > messages;
+  store.get( 1, 1000, messages );
+  CHECK_EQUAL( retained, messages.size() );
+}
+
+TEST_FIXTURE(segmentFixture, resetSwitchesGeneration)
+{
+  SegmentedFileStore store( "store", sessionID, 4096 );
+  fill( store, 100 );
+  store.setNextSenderMsgSeqNum( 101 );
+  store.setNextTargetMsgSeqNum( 50 );
+  int generation = store.getGeneration();
+
+  store.reset();
+  CHECK_EQUAL( generation + 1, store.getGeneration() );
+  CHECK_EQUAL( 1, store.getNextSenderMsgSeqNum() );
+  CHECK_EQUAL( 1, store.getNextTargetMsgSeqNum() );
+  CHECK( !file_exists( ( "store/FIX.4.2-SEGMENT-TEST."
+    + IntConvertor::convert( generation ) + ".1.segment" ).c_str() ) );
+
+  std::vector < std::string > messages;
+  store.get( 1, 100, messages );
+  CHECK_EQUAL( 0U, messages.size() );
+
+  fill( store, 3 );
+  store.refresh();
+  CHECK_EQUAL( generation + 1, store.getGeneration() );
+  CHECK_EQUAL( 1, store.getNextSenderMsgSeqNum() );
+  store.get( 1, 100, messages );
+  CHECK_EQUAL( 3U, messages.size() );
+}
+
+TEST_FIXTURE(segmentFixture, openSweepsOrphanedSegments)
+{
+  int generation = 0;
+  {
+    SegmentedFileStore store( "store", sessionID, 4096 );
+    fill( store, 100 );
+    generation = store.getGeneration();
+  }
+
+  // segments the cleaner did not get to before the process ended
+  std::string old = "store/FIX.4.2-SEGMENT-TEST."
+    + IntConvertor::convert( generation - 1 ) + ".1.segment";
+  std::string dropped = "store/FIX.4.2-SEGMENT-TEST."
+    + IntConvertor::convert( generation ) + ".0.segment";
+  std::string other = "store/FIX.4.2-SEGMENT-TEST-OTHER."
+    + IntConvertor::convert( generation - 1 ) + ".1.segment";
+  { std::ofstream stream( old.c_str() ); }
+  { std::ofstream stream( dropped.c_str() ); }
+  { std::ofstream stream( other.c_str() ); }
+
+  SegmentedFileStore store( "store", sessionID, 4096 );
+  CHECK( !file_exists( old.c_str() ) );
+  CHECK( !file_exists( dropped.c_str() ) );
+  CHECK( file_exists( other.c_str() ) );
+  CHECK( file_exists( ( "store/FIX.4.2-SEGMENT-TEST."
+    + IntConvertor::convert( generation ) + ".1.segment" ).c_str() ) );
+
+  std::vector < std::string > messages;
+  store.get( 1, 100, messages );
+  CHECK_EQUAL( 100U, messages.size() );
+  file_unlink( other.c_str() );
+}
+
+}
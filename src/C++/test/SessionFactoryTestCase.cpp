@@ -68,4 +68,25 @@ TEST(startDayAndEndDayAreDifferent)
   object.destroy(object.create(sessionID, settings));
 }
 
+TEST(sendQueueWaterMarksMustNotBeNegative)
+{
+  NullApplication application;
+  MemoryStoreFactory messageStoreFactory;
+  SessionFactory object(application, messageStoreFactory, 0);
+
+  SessionID sessionID("FIX.4.2", "SENDER", "TARGET");
+  Dictionary settings;
+  settings.setString(CONNECTION_TYPE, "initiator");
+  settings.setString(USE_DATA_DICTIONARY, "N");
+  settings.setString(START_TIME, "12:00:00");
+  settings.setString(END_TIME, "12:00:00");
+  settings.setString(HEARTBTINT, "30");
+  settings.setString(SEND_QUEUE_HIGH_WATER_BYTES, "-1");
+  CHECK_THROW(object.create(sessionID, settings), ConfigError);
+
+  settings.setString(SEND_QUEUE_HIGH_WATER_BYTES, "0");
+  settings.setString(SEND_QUEUE_LOW_WATER_MESSAGES, "-5");
+  CHECK_THROW(object.create(sessionID, settings), ConfigError);
+}
+
 }
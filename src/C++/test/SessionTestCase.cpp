@@ -26,6 +26,8 @@
 
 #include <UnitTest++.h>
 #include <Session.h>
+#include <Clock.h>
+#include <TimerQueue.h>
 #include <Responder.h>
 #include <Acceptor.h>
 #include <Values.h>
@@ -76,10 +78,17 @@ public:
     fromReject( 0 ),
     fromSequenceReset( 0 ),
     resent( 0 ),
-    disconnected( 0 )
+    disconnected( 0 ),
+    sendQueueBytes( 0 ),
+    sendQueueMessages( 0 ),
+    sendQueueDrained( 0 ),
+    sendResult( true )
     {}
 
-  bool send( const std::string& ) { return true; }
+  bool send( const std::string& message ) { lastSent = message; return sendResult; }
+  size_t getSendQueueBytes() { return sendQueueBytes; }
+  size_t getSendQueueMessages() { return sendQueueMessages; }
+  void onSendQueueDrained( const SessionID& ) { sendQueueDrained++; }
 
   void toAdmin( FIX::Message& message, const SessionID& )
   {
@@ -126,6 +135,7 @@ public:
   void fromApp( const FIX::Message& message, const SessionID& )
   throw( FieldNotFound, IncorrectDataFormat, IncorrectTagValue, UnsupportedMessageType )
   {
+    fromAppReceiveTime = message.getReceiveTime();
     MsgType msgType;
     message.getHeader().getField( msgType );
     if ( msgType == "8" )
@@ -158,6 +168,7 @@ public:
   FIX::Message sentLogon;
   FIX::Message sentResendRequest;
   FIX::Message sentHeartbeat;
+  std::string lastSent;
   int toLogon;
   int toResendRequest;
   int toHeartbeat;
@@ -172,6 +183,11 @@ public:
   int fromSequenceReset;
   int resent;
   int disconnected;
+  size_t sendQueueBytes;
+  size_t sendQueueMessages;
+  int sendQueueDrained;
+  bool sendResult;
+  DateTime fromAppReceiveTime;
 
   MemoryStoreFactory factory;
 };
@@ -464,6 +480,318 @@ TEST_FIXTURE(acceptorFixture, nextLogon)
   CHECK_EQUAL( 0, encryptMethod );
 }
 
+TEST_FIXTURE(acceptorFixture, nextPassesReceiveTimeToApplication)
+{
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  CHECK( object->receivedLogon() );
+
+  UtcTimeStamp receiveTime( 10, 20, 30, 123456789, 9 );
+  object->next( createNewOrderSingle( "ISLD", "TW", 2 ).toString(), receiveTime );
+  CHECK_EQUAL( 3, object->getExpectedTargetNum() );
+  CHECK( fromAppReceiveTime == receiveTime );
+  CHECK_EQUAL( 123456789U, fromAppReceiveTime.getNanosecond() );
+}
+
+#ifndef NO_LATENCY_HISTOGRAMS
+TEST_FIXTURE(acceptorFixture, latencyHistograms)
+{
+  SessionLatency& latency = object->getLatency();
+  object->setResponder( this );
+  object->next( createLogon( "ISLD", "TW", 1 ).toString(), UtcTimeStamp() );
+  CHECK( object->isLoggedOn() );
+  CHECK_EQUAL( 0, latency.getHistogram( SessionLatency::NEXT ).getCount() );
+
+  latency.setEnabled( true );
+  object->next( createNewOrderSingle( "ISLD", "TW", 2 ).toString(), UtcTimeStamp() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::NEXT ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::SET_STRING ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::VALIDATE ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::FROM_APP ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::LOG ).getCount() );
+
+  FIX42::NewOrderSingle order = createNewOrderSingle( "TW", "ISLD", 0 );
+  object->send( order );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::SEND_RAW ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::TO_APP ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::TO_STRING ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::PERSIST ).getCount() );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::SEND ).getCount() );
+  CHECK_EQUAL( 2, latency.getHistogram( SessionLatency::LOG ).getCount() );
+
+  latency.setEnabled( false );
+  object->send( order );
+  CHECK_EQUAL( 1, latency.getHistogram( SessionLatency::SEND_RAW ).getCount() );
+  latency.reset();
+  CHECK_EQUAL( 0, latency.getHistogram( SessionLatency::LOG ).getCount() );
+}
+#endif
+
+TEST_FIXTURE(acceptorFixture, statistics)
+{
+  SessionStatistics& statistics = object->getStatistics();
+  object->setResponder( this );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::NEXT_SENDER_MSG_SEQ_NUM ) );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM ) );
+
+  std::string logon = createLogon( "ISLD", "TW", 1 ).toString();
+  object->next( logon, UtcTimeStamp() );
+  CHECK( object->isLoggedOn() );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::MESSAGES_RECEIVED ) );
+  CHECK_EQUAL( (int64_t)logon.size(), statistics.get( SessionStatistics::BYTES_RECEIVED ) );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::MESSAGES_SENT ) );
+  CHECK_EQUAL( 2, statistics.get( SessionStatistics::NEXT_SENDER_MSG_SEQ_NUM ) );
+  CHECK_EQUAL( 2, statistics.get( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM ) );
+
+  FIX42::NewOrderSingle order = createNewOrderSingle( "TW", "ISLD", 0 );
+  object->send( order );
+  CHECK_EQUAL( 2, statistics.get( SessionStatistics::MESSAGES_SENT ) );
+  CHECK_EQUAL( 3, statistics.get( SessionStatistics::NEXT_SENDER_MSG_SEQ_NUM ) );
+
+  // the logon is gap filled and the order resent
+  object->next( createResendRequest( "ISLD", "TW", 2, 1, 0 ).toString(), UtcTimeStamp() );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::RESEND_REQUESTS_SERVED ) );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::GAP_FILLS_SENT ) );
+  CHECK_EQUAL( 4, statistics.get( SessionStatistics::MESSAGES_SENT ) );
+  CHECK_EQUAL( 3, statistics.get( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM ) );
+
+  object->next( createReject( "ISLD", "TW", 3, 2 ).toString(), UtcTimeStamp() );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::REJECTS_RECEIVED ) );
+  object->next( createSequenceReset( "ISLD", "TW", 0, 2 ).toString(), UtcTimeStamp() );
+  CHECK_EQUAL( 1, statistics.get( SessionStatistics::REJECTS_SENT ) );
+  CHECK_EQUAL( 4, statistics.get( SessionStatistics::MESSAGES_RECEIVED ) );
+  CHECK_EQUAL( 4, statistics.get( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM ) );
+
+  // a message the responder could not send is not counted
+  int64_t bytesSent = statistics.get( SessionStatistics::BYTES_SENT );
+  sendResult = false;
+  object->send( order );
+  CHECK_EQUAL( 5, statistics.get( SessionStatistics::MESSAGES_SENT ) );
+  CHECK_EQUAL( bytesSent, statistics.get( SessionStatistics::BYTES_SENT ) );
+  sendResult = true;
+
+  statistics.reset();
+  CHECK_EQUAL( 0, statistics.get( SessionStatistics::MESSAGES_RECEIVED ) );
+  CHECK_EQUAL( 0, statistics.get( SessionStatistics::BYTES_SENT ) );
+  CHECK_EQUAL( 4, statistics.get( SessionStatistics::NEXT_TARGET_MSG_SEQ_NUM ) );
+}
+
+class ManualClock : public Clock
+{
+public:
+  ManualClock() : m_monotonic( 0 ), m_fixedUtcTime( false ) {}
+
+  int64_t getMonotonic() { return m_monotonic; }
+  UtcTimeStamp getUtcTime()
+  { return m_fixedUtcTime ? m_utcTime : UtcTimeStamp(); }
+
+  void advance( int seconds )
+  {
+    m_monotonic += seconds * DateTime::NANOS_PER_SEC;
+    if ( m_fixedUtcTime )
+      setUtcTime( m_utcTime.getJulianDate(),
+                  m_utcTime.m_time + seconds * DateTime::NANOS_PER_SEC );
+  }
+
+  /// Fixes the wall clock at a time of day, in nanoseconds, of a julian date
+  void setUtcTime( int date, int64_t time )
+  {
+    date += (int)( time / DateTime::NANOS_PER_DAY );
+    time %= DateTime::NANOS_PER_DAY;
+    if ( time < 0 ) { --date; time += DateTime::NANOS_PER_DAY; }
+    m_utcTime.set( date, time );
+    m_fixedUtcTime = true;
+  }
+
+private:
+  int64_t m_monotonic;
+  UtcTimeStamp m_utcTime;
+  bool m_fixedUtcTime;
+};
+
+TEST(lastTimesInUtc)
+{
+  ManualClock clock;
+  int64_t second = 1 * DateTime::NANOS_PER_SEC;
+  clock.setUtcTime( 2455000, 10 * second );
+  SessionState state;
+  state.clock( &clock );
+  clock.advance( 5 );
+  state.lastReceivedMonotonic( clock.getMonotonic() );
+  clock.advance( 20 );
+
+  CHECK_EQUAL( 0, state.lastSentMonotonic() );
+  CHECK_EQUAL( 5 * second, state.lastReceivedMonotonic() );
+  UtcTimeStamp sent = state.lastSentTime();
+  CHECK_EQUAL( 2455000, sent.getJulianDate() );
+  CHECK_EQUAL( 10, sent.getSecond() );
+  UtcTimeStamp received = state.lastReceivedTime();
+  CHECK_EQUAL( 15, received.getSecond() );
+
+  // ten seconds before midnight is forty five seconds before 00:00:35
+  UtcTimeStamp before( sent );
+  before.set( 2454999, DateTime::NANOS_PER_DAY - 10 * second );
+  state.lastReceivedTime( before );
+  CHECK_EQUAL( -20 * second, state.lastReceivedMonotonic() );
+  CHECK( before == state.lastReceivedTime() );
+}
+
+TEST_FIXTURE(acceptorFixture, timersFollowClock)
+{
+  ManualClock clock;
+  object->setClock( &clock );
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  CHECK( object->isLoggedOn() );
+
+  clock.advance( 29 );
+  object->next();
+  CHECK_EQUAL( 0, toHeartbeat );
+
+  clock.advance( 1 );
+  object->next();
+  CHECK_EQUAL( 1, toHeartbeat );
+
+  clock.advance( 6 );
+  object->next();
+  CHECK( lastSent.find( "\00135=1\001" ) != std::string::npos );
+  CHECK_EQUAL( 0, disconnected );
+
+  clock.advance( 36 );
+  object->next();
+  CHECK_EQUAL( 1, disconnected );
+}
+
+TEST_FIXTURE(acceptorFixture, timerQueueSchedulesNextCheck)
+{
+  // the session lasts the whole day, stay clear of midnight and its start
+  ManualClock clock;
+  int64_t hour = 3600 * DateTime::NANOS_PER_SEC;
+  int64_t time = 6 * hour;
+  if ( startTime.m_time > 5 * hour && startTime.m_time < 7 * hour )
+    time = 18 * hour;
+  clock.setUtcTime( startTimeStamp.getJulianDate(), time );
+
+  TimerQueue timers;
+  object->setCheckLatency( false );
+  object->setClock( &clock );
+  object->setTimerQueue( &timers );
+  CHECK_EQUAL( 1U, timers.size() );
+
+  std::vector < Session* > sessions;
+  timers.pop( 0, sessions );
+  CHECK_EQUAL( 1U, sessions.size() );
+  CHECK( sessions.front() == object );
+
+  // the heartbeat is due before the session time is checked again
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  timers.process( clock.getMonotonic() );
+  CHECK_EQUAL( 30 * DateTime::NANOS_PER_SEC, object->getNextTimeout() );
+  CHECK_CLOSE( 30.0, timers.getTimeout( clock.getMonotonic() ), 0.001 );
+
+  clock.advance( 29 );
+  timers.process( clock.getMonotonic() );
+  CHECK_EQUAL( 0, toHeartbeat );
+  CHECK_EQUAL( 30 * DateTime::NANOS_PER_SEC, object->getNextTimeout() );
+
+  clock.advance( 1 );
+  timers.process( clock.getMonotonic() );
+  CHECK_EQUAL( 1, toHeartbeat );
+  // nothing was received since the logon, a test request follows
+  CHECK_EQUAL( 36 * DateTime::NANOS_PER_SEC, object->getNextTimeout() );
+
+  object->logout();
+  CHECK_EQUAL( 0, object->getNextTimeout() );
+
+  object->disconnect();
+  CHECK_EQUAL( 0U, timers.size() );
+  object->setTimerQueue( 0 );
+}
+
+TEST_FIXTURE(acceptorFixture, timerQueueSchedulesSessionTimeChange)
+{
+  // ten seconds before the session of the whole day ends at midnight
+  ManualClock clock;
+  clock.setUtcTime( startTimeStamp.getJulianDate() + 1,
+                    -10 * DateTime::NANOS_PER_SEC );
+
+  TimerQueue timers;
+  object->setCheckLatency( false );
+  object->setClock( &clock );
+  object->setTimerQueue( &timers );
+
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  timers.process( clock.getMonotonic() );
+  CHECK( object->isLoggedOn() );
+  CHECK_EQUAL( 10 * DateTime::NANOS_PER_SEC, object->getNextTimeout() );
+  CHECK_CLOSE( 10.0, timers.getTimeout( clock.getMonotonic() ), 0.001 );
+
+  clock.advance( 10 );
+  timers.process( clock.getMonotonic() );
+  CHECK( !object->isLoggedOn() );
+
+  object->disconnect();
+  object->setTimerQueue( 0 );
+}
+
+TEST_FIXTURE(acceptorFixture, trySendStopsAtSendQueueHighWater)
+{
+  object->setResponder( this );
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  CHECK( object->isLoggedOn() );
+
+  object->setSendQueueHighWaterMessages( 4 );
+  object->setSendQueueHighWaterBytes( 1000 );
+
+  sendQueueMessages = 3;
+  FIX42::NewOrderSingle order = createNewOrderSingle( "TW", "ISLD", 0 );
+  CHECK_EQUAL( Session::Sent, object->trySend( order ) );
+  CHECK_EQUAL( 3, object->getExpectedSenderNum() );
+
+  sendQueueMessages = 4;
+  CHECK_EQUAL( Session::WouldBlock, object->trySend( order ) );
+  CHECK_EQUAL( 3, object->getExpectedSenderNum() );
+
+  sendQueueMessages = 0;
+  sendQueueBytes = 1000;
+  CHECK_EQUAL( Session::WouldBlock, object->trySend( order ) );
+  CHECK_EQUAL( 3, object->getExpectedSenderNum() );
+}
+
+TEST_FIXTURE(acceptorFixture, sendQueueDrainedBelowLowWater)
+{
+  object->setResponder( this );
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+
+  object->setSendQueueHighWaterBytes( 1000 );
+  object->checkSendQueue();
+  CHECK_EQUAL( 0, sendQueueDrained );
+
+  sendQueueBytes = 1200;
+  FIX42::NewOrderSingle order = createNewOrderSingle( "TW", "ISLD", 0 );
+  CHECK_EQUAL( Session::WouldBlock, object->trySend( order ) );
+
+  // low water defaults to half the high water mark
+  sendQueueBytes = 600;
+  object->checkSendQueue();
+  CHECK_EQUAL( 0, sendQueueDrained );
+
+  sendQueueBytes = 500;
+  object->checkSendQueue();
+  CHECK_EQUAL( 1, sendQueueDrained );
+  object->checkSendQueue();
+  CHECK_EQUAL( 1, sendQueueDrained );
+
+  object->setSendQueueLowWaterBytes( 100 );
+  sendQueueBytes = 1000;
+  CHECK_EQUAL( Session::WouldBlock, object->trySend( order ) );
+  sendQueueBytes = 200;
+  object->checkSendQueue();
+  CHECK_EQUAL( 1, sendQueueDrained );
+  sendQueueBytes = 100;
+  object->checkSendQueue();
+  CHECK_EQUAL( 2, sendQueueDrained );
+  CHECK_EQUAL( Session::Sent, object->trySend( order ) );
+}
+
 TEST_FIXTURE(acceptorFixture, nextLogonNoEncryptMethod)
 {
   // send a correct logon
@@ -1049,6 +1377,107 @@ TEST_FIXTURE(acceptorFixture, nextResendRequest)
   CHECK_EQUAL( 11, resent );
 }
 
+TEST_FIXTURE(acceptorFixture, nextResendRequestInBatches)
+{
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  for ( int i = 2; i <= 150; ++i )
+  {
+    if ( i == 102 )
+    {
+      FIX::Message heartbeat = createHeartbeat( "ISLD", "TW", i );
+      CHECK( object->send( heartbeat ) );
+      continue;
+    }
+    FIX::Message message = createNewOrderSingle( "ISLD", "TW", i );
+    CHECK( object->send( message ) );
+  }
+
+  // more messages than fit in one batch, with a gap fill in the middle
+  object->next( createResendRequest( "ISLD", "TW", 2, 1, 0 ), UtcTimeStamp() );
+  CHECK_EQUAL( 2, toSequenceReset );
+  CHECK_EQUAL( 148, resent );
+
+  FIX::Message lastMessage( lastSent, false );
+  MsgSeqNum msgSeqNum;
+  lastMessage.getHeader().getField( msgSeqNum );
+  CHECK_EQUAL( 150, msgSeqNum );
+}
+
+/// Tells whether the store is being read while the application is called
+class ReadingStoreFactory : public MessageStoreFactory
+{
+public:
+  class Store : public MemoryStore
+  {
+  public:
+    Store( bool& reading ) : m_reading( reading ) {}
+
+    void getRange( int begin, int end, MessageStoreVisitor& visitor ) const
+    throw ( IOException )
+    {
+      m_reading = true;
+      MemoryStore::getRange( begin, end, visitor );
+      m_reading = false;
+    }
+
+  private:
+    bool& m_reading;
+  };
+
+  ReadingStoreFactory() : reading( false ) {}
+
+  MessageStore* create( const SessionID& ) { return new Store( reading ); }
+  void destroy( MessageStore* pStore ) { delete pStore; }
+
+  bool reading;
+};
+
+struct resendOutsideReadFixture : public sessionFixture
+{
+  resendOutsideReadFixture() : toAppWhileReading( 0 )
+  {
+    SessionID sessionID( BeginString( "FIX.4.2" ),
+                         SenderCompID( "TW" ), TargetCompID( "ISLD" ) );
+    TimeRange sessionTime( startTime, endTime );
+
+    DataDictionaryProvider provider;
+    provider.addTransportDataDictionary( sessionID.getBeginString(), "../spec/FIX42.xml" );
+    object = new Session( *this, readingFactory, sessionID, provider,
+                           sessionTime, 0, 0 );
+    object->setResponder( this );
+  }
+
+  ~resendOutsideReadFixture()
+  {
+    delete object;
+    object = 0;
+  }
+
+  void toApp( FIX::Message& message, const SessionID& sessionID )
+  throw( DoNotSend )
+  {
+    if( readingFactory.reading ) toAppWhileReading++;
+    TestCallback::toApp( message, sessionID );
+  }
+
+  ReadingStoreFactory readingFactory;
+  int toAppWhileReading;
+};
+
+TEST_FIXTURE(resendOutsideReadFixture, nextResendRequestCallsToAppAfterRead)
+{
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  for ( int i = 2; i <= 100; ++i )
+  {
+    FIX::Message message = createNewOrderSingle( "ISLD", "TW", i );
+    CHECK( object->send( message ) );
+  }
+
+  object->next( createResendRequest( "ISLD", "TW", 2, 1, 0 ), UtcTimeStamp() );
+  CHECK_EQUAL( 99, resent );
+  CHECK_EQUAL( 0, toAppWhileReading );
+}
+
 TEST_FIXTURE(acceptorFixture, nextResendRequestRepeatingGroup)
 {
   object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
@@ -1068,6 +1497,33 @@ TEST_FIXTURE(acceptorFixture, nextResendRequestRepeatingGroup)
   CHECK_EQUAL( message.toString(), lastResent.toString() );
 }
 
+TEST_FIXTURE(acceptorFixture, nextResendRequestWithoutToApp)
+{
+  object->setResendToApp( false );
+  object->next( createLogon( "ISLD", "TW", 1 ), UtcTimeStamp() );
+  FIX::Message message = createExecutionReport( "ISLD", "TW", 2 );
+  CHECK( object->send( message ) );
+  object->next( createResendRequest( "ISLD", "TW", 2, 1, 2 ), UtcTimeStamp() );
+  CHECK_EQUAL( 1, toSequenceReset );
+  CHECK_EQUAL( 0, resent );
+
+  // the rewritten header matches what the parsing path produces
+  FIX::Message resentMessage( lastSent, false );
+  PossDupFlag possDupFlag;
+  OrigSendingTime origSendingTime;
+  SendingTime sendingTime;
+  resentMessage.getHeader().getField( possDupFlag );
+  resentMessage.getHeader().getField( origSendingTime );
+  resentMessage.getHeader().getField( sendingTime );
+  CHECK( possDupFlag );
+  CHECK_EQUAL( message.getHeader().getField( FIELD::SendingTime ),
+               origSendingTime.getString() );
+  message.getHeader().setField( possDupFlag );
+  message.getHeader().setField( origSendingTime );
+  message.getHeader().setField( sendingTime );
+  CHECK_EQUAL( message.toString(), lastSent );
+}
+
 TEST_FIXTURE(acceptorT11Fixture, nextResendRequestT1142RepeatingGroup)
 {
   object->next( createT11Logon( "ISLD", "TW", 1 ), UtcTimeStamp() );
@@ -26,6 +26,7 @@
 
 #include <UnitTest++.h>
 #include <SocketAcceptor.h>
+#include <ThreadedSocketAcceptor.h>
 #include <Utility.h>
 #include <fix42/Logon.h>
 #include <sstream>
@@ -115,4 +116,52 @@ TEST_FIXTURE(receivePartialMessageFixture, receivePartialMessage)
   CHECK( socket_send( s, secondPart.c_str(), (int)strlen(secondPart.c_str()) ) );
   object->poll();
 }
+
+TEST(receiveBufferCapacityMustBePositive)
+{
+  SessionSettings settings;
+  std::string input =
+    "[DEFAULT]\n"
+    "ConnectionType=acceptor\n"
+    "SocketAcceptPort=5000\n"
+    "StartTime=00:00:00\n"
+    "EndTime=00:00:00\n"
+    "UseDataDictionary=N\n"
+    "SocketReceiveBufferCapacity=-1\n"
+    "[SESSION]\n"
+    "BeginString=FIX.4.2\n"
+    "SenderCompID=ISLD\n"
+    "TargetCompID=TW\n";
+  std::stringstream stream( input );
+  stream >> settings;
+
+  TestApplication application;
+  MemoryStoreFactory factory;
+  SocketAcceptor object( application, factory, settings );
+  CHECK_THROW( object.poll(), ConfigError );
+}
+
+TEST(threadedRefusesSendQueueMessages)
+{
+  SessionSettings settings;
+  std::string input =
+    "[DEFAULT]\n"
+    "ConnectionType=acceptor\n"
+    "SocketAcceptPort=5000\n"
+    "StartTime=00:00:00\n"
+    "EndTime=00:00:00\n"
+    "UseDataDictionary=N\n"
+    "SendQueueHighWaterMessages=10\n"
+    "[SESSION]\n"
+    "BeginString=FIX.4.2\n"
+    "SenderCompID=ISLD\n"
+    "TargetCompID=TW\n";
+  std::stringstream stream( input );
+  stream >> settings;
+
+  TestApplication application;
+  MemoryStoreFactory factory;
+  ThreadedSocketAcceptor object( application, factory, settings );
+  CHECK_THROW( object.start(), ConfigError );
+}
 }
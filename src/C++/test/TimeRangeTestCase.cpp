@@ -288,4 +288,75 @@ TEST(isInSameRangeWithDay)
   CHECK( TimeRange::isInSameRange(startTime, endTime, startDay, endDay, time1, time2) );
 }
 
+
+// a copy starts without cached results, so it evaluates the range itself
+static void checkCached( TimeRange& object, const UtcTimeStamp& creation,
+                         int date, int64_t time )
+{
+  UtcTimeStamp now;
+  now.set( date + (int)( time / DateTime::NANOS_PER_DAY ),
+           time % DateTime::NANOS_PER_DAY );
+
+  TimeRange fresh( object );
+  CHECK_EQUAL( fresh.isInRange( now ), object.isInRange( now ) );
+  CHECK_EQUAL( fresh.isInSameRange( now, creation ),
+               object.isInSameRange( now, creation ) );
+}
+
+static void checkCachedRange( TimeRange& object, const UtcTimeStamp& creation )
+{
+  int date = UtcDate( 26, 7, 2004 ).getJulianDate();
+  int64_t week = 7 * DateTime::NANOS_PER_DAY;
+
+  // sweep a week in uneven steps, then look at each half hour and the
+  // nanoseconds on either side of it
+  for( int64_t time = 0; time < week; time += 419 * DateTime::NANOS_PER_SEC + 7 )
+    checkCached( object, creation, date, time );
+
+  for( int64_t time = 1800 * DateTime::NANOS_PER_SEC; time < week; time += 1800 * DateTime::NANOS_PER_SEC )
+  {
+    checkCached( object, creation, date, time - 1 );
+    checkCached( object, creation, date, time );
+    checkCached( object, creation, date, time + 1 );
+  }
+}
+
+TEST(cachedResults)
+{
+  UtcTimeStamp creation( 10, 0, 0, 27, 7, 2004 );
+
+  TimeRange daily( UtcTimeOnly( 3, 0, 0 ), UtcTimeOnly( 18, 0, 0 ) );
+  checkCachedRange( daily, creation );
+
+  TimeRange overnight( UtcTimeOnly( 18, 0, 0 ), UtcTimeOnly( 3, 0, 0 ) );
+  checkCachedRange( overnight, UtcTimeStamp( 20, 0, 0, 27, 7, 2004 ) );
+
+  TimeRange weekly( UtcTimeOnly( 3, 0, 0 ), UtcTimeOnly( 18, 0, 0 ), 2, 5 );
+  checkCachedRange( weekly, creation );
+
+  TimeRange always( UtcTimeOnly( 0, 0, 0 ), UtcTimeOnly( 0, 0, 0 ) );
+  checkCachedRange( always, creation );
+
+  TimeRange local( LocalTimeOnly( 3, 0, 0 ), LocalTimeOnly( 18, 0, 0 ) );
+  checkCachedRange( local, creation );
+}
+
+TEST(getTimeToChange)
+{
+  TimeRange object( UtcTimeOnly( 3, 0, 0 ), UtcTimeOnly( 18, 0, 0 ) );
+
+  UtcTimeStamp time( 10, 0, 0, 27, 7, 2004 );
+  CHECK( object.isInRange( time ) );
+  CHECK_EQUAL( 8 * 3600 * DateTime::NANOS_PER_SEC + 1, object.getTimeToChange( time ) );
+
+  time = UtcTimeStamp( 19, 0, 0, 27, 7, 2004 );
+  CHECK( !object.isInRange( time ) );
+  CHECK_EQUAL( 5 * 3600 * DateTime::NANOS_PER_SEC, object.getTimeToChange( time ) );
+
+  time = UtcTimeStamp( 2, 0, 0, 28, 7, 2004 );
+  CHECK_EQUAL( 3600 * DateTime::NANOS_PER_SEC, object.getTimeToChange( time ) );
+  time += 3600;
+  CHECK( object.isInRange( time ) );
+}
+
 }
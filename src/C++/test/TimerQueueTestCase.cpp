@@ -0,0 +1,107 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <TimerQueue.h>
+#include <FieldTypes.h>
+
+using namespace FIX;
+
+SUITE(TimerQueueTests)
+{
+
+// the queue only compares the pointers of sessions it does not call
+static Session* session( int index )
+{
+  static char sessions[ 4 ];
+  return (Session*)&sessions[ index ];
+}
+
+TEST(popInDeadlineOrder)
+{
+  TimerQueue object;
+  object.schedule( session( 0 ), 30 );
+  object.schedule( session( 1 ), 10 );
+  object.schedule( session( 2 ), 20 );
+  CHECK_EQUAL( 3U, object.size() );
+
+  std::vector < Session* > sessions;
+  object.pop( 5, sessions );
+  CHECK_EQUAL( 0U, sessions.size() );
+
+  object.pop( 20, sessions );
+  CHECK_EQUAL( 2U, sessions.size() );
+  CHECK( sessions[ 0 ] == session( 1 ) );
+  CHECK( sessions[ 1 ] == session( 2 ) );
+  CHECK_EQUAL( 1U, object.size() );
+}
+
+TEST(scheduleKeepsEarliestDeadline)
+{
+  TimerQueue object;
+  object.schedule( session( 0 ), 30 );
+  object.schedule( session( 0 ), 40 );
+  object.schedule( session( 0 ), 10 );
+  CHECK_EQUAL( 1U, object.size() );
+
+  std::vector < Session* > sessions;
+  object.pop( 10, sessions );
+  CHECK_EQUAL( 1U, sessions.size() );
+
+  // the replaced deadline does not return the session again
+  sessions.clear();
+  object.pop( 50, sessions );
+  CHECK_EQUAL( 0U, sessions.size() );
+}
+
+TEST(cancel)
+{
+  TimerQueue object;
+  object.schedule( session( 0 ), 10 );
+  object.schedule( session( 1 ), 20 );
+  object.cancel( session( 0 ) );
+  CHECK_EQUAL( 1U, object.size() );
+
+  std::vector < Session* > sessions;
+  object.pop( 30, sessions );
+  CHECK_EQUAL( 1U, sessions.size() );
+  CHECK( sessions[ 0 ] == session( 1 ) );
+}
+
+TEST(getTimeout)
+{
+  TimerQueue object;
+  CHECK_EQUAL( 0.0, object.getTimeout( 0 ) );
+
+  object.schedule( session( 0 ), 2 * DateTime::NANOS_PER_SEC );
+  CHECK_CLOSE( 1.5, object.getTimeout( DateTime::NANOS_PER_SEC / 2 ), 0.000001 );
+  CHECK_CLOSE( 0.001, object.getTimeout( 3 * DateTime::NANOS_PER_SEC ), 0.000001 );
+
+  object.cancel( session( 0 ) );
+  CHECK_EQUAL( 0.0, object.getTimeout( 0 ) );
+}
+
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+** Copyright (c) 2001-2014
+**
+** This file is part of the QuickFIX FIX Engine
+**
+** This file may be distributed under the terms of the quickfixengine.org
+** license as defined by quickfixengine.org and appearing in the file
+** LICENSE included in the packaging of this file.
+**
+** This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+** WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+**
+** See http://www.quickfixengine.org/LICENSE for licensing information.
+**
+** Contact ask@quickfixengine.org if any conditions of this licensing are
+** not clear to you.
+**
+****************************************************************************/
+
+#ifdef _MSC_VER
+#pragma warning( disable : 4503 4355 4786 )
+#include "stdafx.h"
+#else
+#include "config.h"
+#endif
+
+#include <UnitTest++.h>
+#include <UtcTimeStampFormatter.h>
+#include <FieldConvertors.h>
+
+using namespace FIX;
+
+SUITE(UtcTimeStampFormatterTests)
+{
+
+TEST(formatPrecisions)
+{
+  UtcTimeStampFormatter object;
+  UtcTimeStamp input( 12, 5, 6, 123456789, 26, 4, 2000, 9 );
+
+  CHECK_EQUAL( "20000426-12:05:06", object.format( input, 0 ) );
+  CHECK_EQUAL( "20000426-12:05:06.123", object.format( input, 3 ) );
+  CHECK_EQUAL( "20000426-12:05:06.123456", object.format( input, 6 ) );
+  CHECK_EQUAL( "20000426-12:05:06.123456789", object.format( input, 9 ) );
+
+  for( int precision = 0; precision <= 9; ++precision )
+  {
+    CHECK_EQUAL( UtcTimeStampConvertor::convert( input, precision ),
+                 object.format( input, precision ) );
+  }
+}
+
+TEST(formatPadsFraction)
+{
+  UtcTimeStampFormatter object;
+  UtcTimeStamp input( 23, 59, 59, 1002, 31, 12, 1999, 9 );
+
+  CHECK_EQUAL( "19991231-23:59:59.000", object.format( input, 3 ) );
+  CHECK_EQUAL( "19991231-23:59:59.000001", object.format( input, 6 ) );
+  CHECK_EQUAL( "19991231-23:59:59.000001002", object.format( input, 9 ) );
+}
+
+TEST(formatFollowsSeconds)
+{
+  UtcTimeStampFormatter object;
+  UtcTimeStamp input( 23, 59, 59, 999, 31, 12, 1999, 3 );
+  CHECK_EQUAL( "19991231-23:59:59.999", object.format( input, 3 ) );
+
+  input.setHMS( 0, 0, 0, 1, 3 );
+  CHECK_EQUAL( "19991231-00:00:00.001", object.format( input, 3 ) );
+
+  input.setYMD( 2000, 1, 1 );
+  CHECK_EQUAL( "20000101-00:00:00.001", object.format( input, 3 ) );
+
+  input.setHMS( 0, 0, 1, 0, 3 );
+  CHECK_EQUAL( "20000101-00:00:01.000", object.format( input, 3 ) );
+}
+
+TEST(formatToBuffer)
+{
+  UtcTimeStampFormatter object;
+  UtcTimeStamp input( 12, 5, 6, 555, 26, 4, 2000, 3 );
+
+  char buffer[ UtcTimeStampFormatter::MAX_LENGTH ];
+  char* end = object.format( buffer, input, 3 );
+  CHECK_EQUAL( 21, end - buffer );
+  CHECK_EQUAL( "20000426-12:05:06.555", std::string( buffer, end ) );
+
+  std::string text = "52=";
+  object.append( text, input, 0 );
+  CHECK_EQUAL( "52=20000426-12:05:06", text );
+}
+
+}
@@ -29,17 +29,29 @@
 #ifndef _MSC_VER
 #include <DataDictionaryTestCase.cpp>
 #include <DictionaryTestCase.cpp>
+#include <DispatchedApplicationTestCase.cpp>
+#include <EventTestCase.cpp>
 #include <FieldBaseTestCase.cpp>
 #include <FieldConvertorsTestCase.cpp>
 #include <FileLogTestCase.cpp>
+#include <FilterLogTestCase.cpp>
+#include <BinaryLogTestCase.cpp>
 #include <FileStoreFactoryTestCase.cpp>
 #include <FileStoreTestCase.cpp>
 #include <FileUtilitiesTestCase.cpp>
 #include <HttpMessageTestCase.cpp>
 #include <HttpParserTestCase.cpp>
 #include <MemoryStoreTestCase.cpp>
+#include <CachedStoreTestCase.cpp>
+#include <ClockTestCase.cpp>
+#include <TimerQueueTestCase.cpp>
+#include <AsyncStoreTestCase.cpp>
 #include <MessageSortersTestCase.cpp>
 #include <MessagesTestCase.cpp>
+#include <MmapStoreTestCase.cpp>
+#include <SegmentedFileStoreTestCase.cpp>
+#include <JournalStoreTestCase.cpp>
+#include <LatencyTestCase.cpp>
 #include <MySQLStoreTestCase.cpp>
 #include <NullStoreTestCase.cpp>
 #include <OdbcStoreTestCase.cpp>
@@ -57,6 +69,7 @@
 #include <TimeRangeTestCase.cpp>
 #include <UtcTimeOnlyTestCase.cpp>
 #include <UtcTimeStampTestCase.cpp>
+#include <UtcTimeStampFormatterTestCase.cpp>
 #endif
 #include <UnitTest++.h>
 #include <TestReporterStdout.h>